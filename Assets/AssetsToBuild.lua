@@ -11,9 +11,17 @@ return
 	meshes =
 	{
 		-- The actual assets can be defined simply as relative path strings (the common case)
+		-- to a Lua mesh, a binary ".mesh" exported from Maya (which is much faster to build than the same mesh in Lua),
+		-- or a Wavefront OBJ file (whose "usemtl" materials become submeshes)
 		"Meshes/Car.lua",
-		"Meshes/Platform.lua",
-		"Meshes/Cylinder.lua",
+		-- or as tables with optional builder arguments
+		-- ("lods=N" generates up to N levels of detail, "clusters" splits LOD 0 into clusters that are culled on the CPU,
+		-- "compress" stores the vertices and indices with a smaller encoding that is decoded at load time,
+		-- "streams=split" stores the positions separately from the other attributes for position-only passes,
+		-- "soapositions" adds a copy of the positions in SIMD-friendly arrays for CPU queries like picking,
+		-- and "bvh" adds a bounding volume hierarchy over LOD 0 for ray queries on the CPU)
+		{ path = "Meshes/Platform.lua", arguments = { "lods=4", "clusters", "bvh" } },
+		{ path = "Meshes/Cylinder.lua", arguments = { "lods=4", "compress", "streams=split", "soapositions", "bvh" } },
 	},
 	materials =
 	{
@@ -24,6 +32,47 @@ return
 	},
 	textures = 
 	{
+		-- Textures are compressed with the preset in the "TexturePreset" environment variable ("normal" if it isn't set)
+		-- unless they have their own "preset" argument:
+		-- "preset=fast" uses the batched SIMD encoder for quick iteration, "preset=normal" uses DirectXTex,
+		-- and "preset=production" uses DirectXTex with dithering for release builds.
+		-- The presets also filter MIP maps with a box, a triangle, and a Kaiser-windowed sinc respectively,
+		-- and a "mipfilter" argument ("box", "triangle", or "kaiser") after the preset can choose a different one.
+		-- An "encoder" argument after the preset can still choose the encoder
+		-- ("encoder=fast" or "encoder=refined" for the batched encoder, or "encoder=directxtex").
+		-- Changing a texture's arguments or the default preset only rebuilds the textures that it affects.
+		-- A "usage" argument chooses the format: "usage=color" uses BC1 or BC3 (or BC7 with the production preset),
+		-- "usage=normal" uses BC5 (red and green only), and "usage=single" uses BC4 (red only).
+		-- Without one the usage comes from the file name: "_NRM" is a normal map, "_SPEC" is single channel, and anything else is color
 		"Textures/default.tga",
+		-- (textures that materials reference use these arguments too)
+		{ path = "Textures/road.jpg", arguments = { "preset=production" } },
+		"Meshes/cement_wall_COLOR.dds",
+		"Meshes/cement_wall_NRM.dds",
+		"Meshes/cement_wall_SPEC.dds",
+		"Meshes/floor_COLOR.dds",
+		"Meshes/floor_NRM.dds",
+		"Meshes/floor_SPEC.dds",
+		"Meshes/metal_brace_COLOR.dds",
+		"Meshes/metal_brace_NRM.dds",
+		"Meshes/metal_brace_SPEC.dds",
+		"Meshes/railing_COLOR.dds",
+		"Meshes/railing_NRM.dds",
+		"Meshes/railing_SPEC.dds",
+		"Meshes/wall_COLOR.dds",
+		"Meshes/wall_NRM.dds",
+		"Meshes/wall_SPEC.dds",
+	},
+	atlases =
+	{
+		-- Atlases are compressed with the same presets as textures (and take the same "preset", "encoder", and "mipfilter" arguments).
+		-- Their images don't need to be listed as textures
+		"Atlases/UI.atlas",
+	},
+	texturearrays =
+	{
+		-- Texture arrays take the same arguments as textures.
+		-- Every layer is compressed to the same format, which comes from the first layer's file name unless there is a "usage" argument
+		"TextureArrays/cement_wall.texarray",
 	},
 }
@@ -5,9 +5,10 @@ namespace
 {
 	Context* myCont = Context::GetContext();
 
-	struct sVertex
+	// Positions come from slot 0 and everything else from slot 1
+	// (meshes with interleaved vertices bind the same buffer to both slots)
+	struct sVertexAttributes
 	{
-		float x, y, z;
 		float u, v;
 		uint8_t r, g, b, a;
 	};
@@ -59,7 +60,7 @@ namespace Engine
 						positionElement.SemanticIndex = 0;	
 						positionElement.Format = DXGI_FORMAT_R32G32B32_FLOAT;
 						positionElement.InputSlot = 0;
-						positionElement.AlignedByteOffset = offsetof(sVertex, x);
+						positionElement.AlignedByteOffset = 0;
 						positionElement.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 						positionElement.InstanceDataStepRate = 0;	
 					}
@@ -69,8 +70,8 @@ namespace Engine
 						colorElement.SemanticName = "COLOR";
 						colorElement.SemanticIndex = 0;	
 						colorElement.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-						colorElement.InputSlot = 0;
-						colorElement.AlignedByteOffset = offsetof(sVertex, r);
+						colorElement.InputSlot = 1;
+						colorElement.AlignedByteOffset = offsetof(sVertexAttributes, r);
 						colorElement.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 						colorElement.InstanceDataStepRate = 0;	
 					}
@@ -80,8 +81,8 @@ namespace Engine
 						textureElement.SemanticName = "TEXCOORD";
 						textureElement.SemanticIndex = 0;	
 						textureElement.Format = DXGI_FORMAT_R32G32_FLOAT;
-						textureElement.InputSlot = 0;
-						textureElement.AlignedByteOffset = offsetof(sVertex, u);
+						textureElement.InputSlot = 1;
+						textureElement.AlignedByteOffset = offsetof(sVertexAttributes, u);
 						textureElement.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 						textureElement.InstanceDataStepRate = 0;	
 					}
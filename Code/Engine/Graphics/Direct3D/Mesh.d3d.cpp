@@ -3,65 +3,61 @@
 #include "../../Asserts/Asserts.h"
 #include "../../Logging/Logging.h"
 
+namespace
+{
+	bool CreateImmutableBuffer(const unsigned int i_bindFlags, const unsigned int i_size, const void* const i_data, ID3D11Buffer*& o_buffer,
+		const char* const i_bufferName)
+	{
+		Context* myCont = Context::GetContext();
+
+		D3D11_BUFFER_DESC bufferDescription = { 0 };
+		{
+			bufferDescription.ByteWidth = i_size;
+			bufferDescription.Usage = D3D11_USAGE_IMMUTABLE;	
+			bufferDescription.BindFlags = i_bindFlags;
+			bufferDescription.CPUAccessFlags = 0;	
+			bufferDescription.MiscFlags = 0;
+			bufferDescription.StructureByteStride = 0;	
+		}
+		D3D11_SUBRESOURCE_DATA initialData = { 0 };
+		{
+			initialData.pSysMem = i_data;
+		}
+
+		const HRESULT result = myCont->s_direct3dDevice->CreateBuffer(&bufferDescription, &initialData, &o_buffer);
+		if (FAILED(result))
+		{
+			ASSERT(false);
+			Engine::Logging::OutputError("Direct3D failed to create the %s buffer with HRESULT %#010x", i_bufferName, result);
+			return false;
+		}
+		return true;
+	}
+}
+
 namespace Engine
 {
 	namespace Mesh
 	{	
 		bool Mesh::Initialize()
 		{
-			Context* myCont = Context::GetContext();
+			if (vertexArray != NULL)
 			{
+				if (!CreateImmutableBuffer(D3D11_BIND_VERTEX_BUFFER, s_numVertices * sizeof(sVertex), vertexArray, s_vertexBuffer, "vertex"))
+				{
+					return false;
+				}
 			}
-
-			unsigned int bufferSize = s_numVertices * sizeof(sVertex);
-
-			D3D11_BUFFER_DESC bufferDescription = { 0 };
-			{
-				bufferDescription.ByteWidth = bufferSize;
-				bufferDescription.Usage = D3D11_USAGE_IMMUTABLE;	
-				bufferDescription.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-				bufferDescription.CPUAccessFlags = 0;	
-				bufferDescription.MiscFlags = 0;
-				bufferDescription.StructureByteStride = 0;	
-			}
-			D3D11_SUBRESOURCE_DATA initialData = { 0 };
-			{
-				initialData.pSysMem = reinterpret_cast<void *>(vertexArray);
-			}
-
-			const HRESULT result = myCont->s_direct3dDevice->CreateBuffer(&bufferDescription, &initialData, &s_vertexBuffer);
-			if (FAILED(result))
+			else
 			{
-				ASSERT(false);
-				Engine::Logging::OutputError("Direct3D failed to create the vertex buffer with HRESULT %#010x", result);
-				return false;
+				if (!CreateImmutableBuffer(D3D11_BIND_VERTEX_BUFFER, s_numVertices * sizeof(float) * 3, positionArray, s_vertexBuffer, "position")
+					|| !CreateImmutableBuffer(D3D11_BIND_VERTEX_BUFFER, s_numVertices * sizeof(sVertexAttributes), attributeArray, s_attributeBuffer,
+						"attribute"))
+				{
+					return false;
+				}
 			}
-
-			unsigned int bufferSizeInd = s_numIndices * sizeof(uint16_t);
-
-			D3D11_BUFFER_DESC bufferDescriptionInd = { 0 };
-			{
-				bufferDescriptionInd.ByteWidth = bufferSizeInd;
-				bufferDescriptionInd.Usage = D3D11_USAGE_IMMUTABLE;	
-				bufferDescriptionInd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-				bufferDescriptionInd.CPUAccessFlags = 0;	
-				bufferDescriptionInd.MiscFlags = 0;
-				bufferDescriptionInd.StructureByteStride = 0;	
-			}
-			D3D11_SUBRESOURCE_DATA initialDataInd = { 0 };
-			{
-				initialDataInd.pSysMem = reinterpret_cast<void*>(indiceArray);
-			}
-
-			const HRESULT resultInd = myCont->s_direct3dDevice->CreateBuffer(&bufferDescriptionInd, &initialDataInd, &s_indexBuffer);
-			if (FAILED(resultInd))
-			{
-				ASSERT(false);
-				Engine::Logging::OutputError("Direct3D failed to create the index buffer with HRESULT %#010x", result);
-				return false;
-			}
-
-			return true;
+			return CreateImmutableBuffer(D3D11_BIND_INDEX_BUFFER, s_indexDataSize, indiceArray, s_indexBuffer, "index");
 		}
 
 		bool Mesh::CleanUp()
@@ -73,35 +69,54 @@ namespace Engine
 				s_vertexBuffer->Release();
 				s_vertexBuffer = NULL;
 			}
+			if (s_attributeBuffer)
+			{
+				s_attributeBuffer->Release();
+				s_attributeBuffer = NULL;
+			}
 			if (s_indexBuffer)
 			{
 				s_indexBuffer->Release();
 				s_indexBuffer = NULL;
 			}
+			Platform::UnmapFile(s_mappedFile);
 			return !wereThereErrors;
 		}
 
-		void Mesh::Draw()
+		void Mesh::Bind(const sSubmesh& i_submesh, const bool i_positionsOnly)
 		{
 			Context* myCont = Context::GetContext();
 			{
+				// Effects read the positions from slot 0 and the other attributes (laid out like sVertexAttributes) from slot 1.
+				// An interleaved buffer is bound to both slots, offset so that its UVs are at the start of slot 1
 				const unsigned int startingSlot = 0;
-				const unsigned int vertexBufferCount = 1;
-				const unsigned int bufferStride = sizeof(sVertex);
-				const unsigned int bufferOffset = 0;
-				myCont->s_direct3dImmediateContext->IASetVertexBuffers(startingSlot, vertexBufferCount, &s_vertexBuffer, &bufferStride, &bufferOffset);
+				const unsigned int vertexBufferCount = i_positionsOnly ? 1 : 2;
+				ID3D11Buffer* buffers[2] = { s_vertexBuffer, s_vertexBuffer };
+				unsigned int bufferStrides[2] = { sizeof(sVertex), sizeof(sVertex) };
+				unsigned int bufferOffsets[2] = { 0, offsetof(sVertex, u) };
+				if (s_attributeBuffer != NULL)
+				{
+					buffers[1] = s_attributeBuffer;
+					bufferStrides[0] = sizeof(float) * 3;
+					bufferStrides[1] = sizeof(sVertexAttributes);
+					bufferOffsets[1] = 0;
+				}
+				myCont->s_direct3dImmediateContext->IASetVertexBuffers(startingSlot, vertexBufferCount, buffers, bufferStrides, bufferOffsets);
 			}
 			{
 				ASSERT(s_indexBuffer != NULL);
-				const DXGI_FORMAT format = DXGI_FORMAT_R16_UINT;
-				const unsigned int offset = 0;
-				myCont->s_direct3dImmediateContext->IASetIndexBuffer(s_indexBuffer, format, offset);
-			}
-			{
-				const unsigned int indexOfFirstIndexToUse = 0;
-				const unsigned int offsetToAddToEachIndex = 0;
-				myCont->s_direct3dImmediateContext->DrawIndexed(s_numIndices, indexOfFirstIndexToUse, offsetToAddToEachIndex);
+				const DXGI_FORMAT format = (i_submesh.indexSize == sizeof(uint16_t)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+				myCont->s_direct3dImmediateContext->IASetIndexBuffer(s_indexBuffer, format, i_submesh.indexOffset);
 			}
 		}
+
+		void Mesh::DrawIndices(const sSubmesh& i_submesh, const uint32_t i_firstIndex, const uint32_t i_indexCount)
+		{
+			Context* myCont = Context::GetContext();
+			// The index buffer is bound at the start of the submesh's indices, which are relative to its first vertex
+			const unsigned int indexOfFirstIndexToUse = i_firstIndex - i_submesh.firstIndex;
+			const int offsetToAddToEachIndex = static_cast<int>(i_submesh.firstVertex);
+			myCont->s_direct3dImmediateContext->DrawIndexed(i_indexCount, indexOfFirstIndexToUse, offsetToAddToEachIndex);
+		}
 	}
 }
\ No newline at end of file
@@ -125,7 +125,8 @@ bool Engine::Graphics::cRenderState::InitializeFromBits()
 	{
 		D3D11_RASTERIZER_DESC rasterizerStateDescription;
 		rasterizerStateDescription.FillMode = D3D11_FILL_SOLID;
-		rasterizerStateDescription.FrontCounterClockwise = FALSE;
+		// Built meshes are counter-clockwise on every platform
+		rasterizerStateDescription.FrontCounterClockwise = TRUE;
 		rasterizerStateDescription.DepthBias = 0;
 		rasterizerStateDescription.SlopeScaledDepthBias = 0.0f;
 		rasterizerStateDescription.DepthBiasClamp = 0.0f;
@@ -97,11 +97,13 @@ void Engine::Graphics::cSprite::Draw() const
 		}
 	}
 	{
+		// The effects' input layouts read the positions from slot 0 and the UVs and colors from slot 1
 		const unsigned int startingSlot = 0;
-		const unsigned int vertexBufferCount = 1;
-		const unsigned int bufferStride = sizeof( VertexFormat::sVertex );
-		const unsigned int bufferOffset = 0;
-		myCont->s_direct3dImmediateContext->IASetVertexBuffers( startingSlot, vertexBufferCount, &ms_vertexBuffer, &bufferStride, &bufferOffset );
+		const unsigned int vertexBufferCount = 2;
+		ID3D11Buffer* const buffers[vertexBufferCount] = { ms_vertexBuffer, ms_vertexBuffer };
+		const unsigned int bufferStrides[vertexBufferCount] = { sizeof( VertexFormat::sVertex ), sizeof( VertexFormat::sVertex ) };
+		const unsigned int bufferOffsets[vertexBufferCount] = { 0, offsetof( VertexFormat::sVertex, u ) };
+		myCont->s_direct3dImmediateContext->IASetVertexBuffers( startingSlot, vertexBufferCount, buffers, bufferStrides, bufferOffsets );
 	}
 	{
 		myCont->s_direct3dImmediateContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP );
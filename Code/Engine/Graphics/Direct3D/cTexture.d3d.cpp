@@ -14,21 +14,35 @@
 namespace
 {
 	Context* myCont = Context::GetContext();
+
+	DXGI_FORMAT GetDxgiFormat( const Engine::Graphics::TextureFormats::eFormat i_format );
+	bool CreateShaderResourceView( const char* const i_path, ID3D11Resource* const i_texture, const Engine::Graphics::sDdsInfo& i_ddsInfo,
+		const unsigned int i_mostDetailedMipLevel, ID3D11ShaderResourceView*& o_textureView );
 }
 
 void Engine::Graphics::cTexture::Bind( const unsigned int i_id ) const
 {
+	if ( m_streamingState )
+	{
+		m_streamingState->wasBoundRecently = true;
+	}
 	const unsigned int viewCount = 1;
 	myCont->s_direct3dImmediateContext->PSSetShaderResources( i_id, viewCount, &m_textureView );
 }
 
 bool Engine::Graphics::cTexture::CleanUp()
 {
+	StopStreaming();
 	if ( m_textureView )
 	{
 		m_textureView->Release();
 		m_textureView = NULL;
 	}
+	if ( m_texture )
+	{
+		m_texture->Release();
+		m_texture = NULL;
+	}
 
 	return true;
 }
@@ -37,115 +51,145 @@ bool Engine::Graphics::cTexture::Initialize( const char* const i_path, const sDd
 {
 	bool wereThereErrors = false;
 
-	ID3D11Texture2D* resource = NULL;
+	ASSERT( ( i_ddsInfo.type == TextureTypes::TwoDimensional ) || ( i_ddsInfo.firstResidentMipLevel == 0 ) );
+
 	D3D11_SUBRESOURCE_DATA* subResourceData = NULL;
+	const unsigned int residentMipLevelCount = i_ddsInfo.mipLevelCount - i_ddsInfo.firstResidentMipLevel;
+	// A volume texture has one subresource for each level (with all of its slices),
+	// and every other texture has one for each level of each layer (in the same order as the file)
+	const unsigned int layerCount_subResources = ( i_ddsInfo.type == TextureTypes::Volume ) ? 1 : i_ddsInfo.layerCount;
+	const unsigned int subResourceCount = residentMipLevelCount * layerCount_subResources;
+	const DXGI_FORMAT dxgiFormat = GetDxgiFormat( i_ddsInfo.format );
 
 	{
-		const size_t byteCountToAllocate = sizeof(D3D11_SUBRESOURCE_DATA) * i_ddsInfo.mipLevelCount;
+		const size_t byteCountToAllocate = sizeof(D3D11_SUBRESOURCE_DATA) * subResourceCount;
 		subResourceData = reinterpret_cast<D3D11_SUBRESOURCE_DATA*>( malloc( byteCountToAllocate ) );
 		if ( !subResourceData )
 		{
 			wereThereErrors = true;
 			ASSERTF( false, "Failed to allocate %u bytes", byteCountToAllocate );
-			Logging::OutputError( "Failed to allocate %u bytes for %u subresources for %s", byteCountToAllocate, i_ddsInfo.mipLevelCount, i_path );
+			Logging::OutputError( "Failed to allocate %u bytes for %u subresources for %s", byteCountToAllocate, subResourceCount, i_path );
 			goto OnExit;
 		}
 	}
 	{
-		unsigned int currentWidth = static_cast<unsigned int>( i_ddsInfo.width );
-		unsigned int currentHeight = static_cast<unsigned int>( i_ddsInfo.height );
 		const uint8_t* currentPosition = reinterpret_cast<const uint8_t*>( i_ddsInfo.imageData );
 		const uint8_t* const endOfFile = currentPosition + i_ddsInfo.imageDataSize;
 		const unsigned int blockSize = TextureFormats::GetSizeOfBlock( i_ddsInfo.format );
-		for ( unsigned int i = 0; i < i_ddsInfo.mipLevelCount; ++i )
+		for ( unsigned int layer = 0; layer < layerCount_subResources; ++layer )
 		{
-			const unsigned int blockCount_singleRow = ( currentWidth + 3 ) / 4;
-			const unsigned int byteCount_singleRow = blockCount_singleRow * blockSize;
-			const unsigned int rowCount = ( currentHeight + 3 ) / 4;
-			const unsigned int byteCount_currentMipLevel = byteCount_singleRow * rowCount;
-			{
-				D3D11_SUBRESOURCE_DATA& currentSubResourceData = subResourceData[i];
-				currentSubResourceData.pSysMem = currentPosition;
-				currentSubResourceData.SysMemPitch = byteCount_singleRow;
-				currentSubResourceData.SysMemSlicePitch = byteCount_currentMipLevel;
-			}
+			unsigned int currentWidth = std::max( i_ddsInfo.width >> i_ddsInfo.firstResidentMipLevel, 1u );
+			unsigned int currentHeight = std::max( i_ddsInfo.height >> i_ddsInfo.firstResidentMipLevel, 1u );
+			unsigned int currentDepth = std::max( i_ddsInfo.depth >> i_ddsInfo.firstResidentMipLevel, 1u );
+			for ( unsigned int i = 0; i < residentMipLevelCount; ++i )
 			{
-				currentPosition += byteCount_currentMipLevel;
-				if ( currentPosition <= endOfFile )
+				const unsigned int blockCount_singleRow = ( currentWidth + 3 ) / 4;
+				const unsigned int byteCount_singleRow = blockCount_singleRow * blockSize;
+				const unsigned int rowCount = ( currentHeight + 3 ) / 4;
+				const unsigned int byteCount_singleSlice = byteCount_singleRow * rowCount;
+				const unsigned int byteCount_currentMipLevel = byteCount_singleSlice * currentDepth;
 				{
-					currentWidth = std::max( currentWidth / 2, 1u );
-					currentHeight = std::max( currentHeight / 2, 1u );
+					D3D11_SUBRESOURCE_DATA& currentSubResourceData = subResourceData[( layer * residentMipLevelCount ) + i];
+					currentSubResourceData.pSysMem = currentPosition;
+					currentSubResourceData.SysMemPitch = byteCount_singleRow;
+					currentSubResourceData.SysMemSlicePitch = byteCount_singleSlice;
 				}
-				else
 				{
-					wereThereErrors = true;
-					ASSERTF( false, "DDS file not big enough" );
-					Logging::OutputError( "The DDS file %s isn't big enough to hold the data that its header claims to", i_path );
-					goto OnExit;
+					currentPosition += byteCount_currentMipLevel;
+					if ( currentPosition <= endOfFile )
+					{
+						currentWidth = std::max( currentWidth / 2, 1u );
+						currentHeight = std::max( currentHeight / 2, 1u );
+						currentDepth = std::max( currentDepth / 2, 1u );
+					}
+					else
+					{
+						wereThereErrors = true;
+						ASSERTF( false, "DDS file not big enough" );
+						Logging::OutputError( "The DDS file %s isn't big enough to hold the data that its header claims to", i_path );
+						goto OnExit;
+					}
 				}
 			}
 		}
 		ASSERTF( currentPosition == endOfFile, "The DDS file %s has more data than it should", i_path );
 	}
-	DXGI_FORMAT dxgiFormat = DXGI_FORMAT_UNKNOWN;
-	switch ( i_ddsInfo.format )
 	{
-		case TextureFormats::BC1: dxgiFormat = DXGI_FORMAT_BC1_UNORM; break;
-		case TextureFormats::BC3: dxgiFormat = DXGI_FORMAT_BC3_UNORM; break;
-	}
-	{
-		D3D11_TEXTURE2D_DESC textureDescription = { 0 };
+		// A texture that is streamed in is created with every level,
+		// but shaders can only sample the resident ones until the rest are uploaded
+		const bool isStreamed = i_ddsInfo.firstResidentMipLevel > 0;
+		HRESULT result;
+		if ( i_ddsInfo.type == TextureTypes::Volume )
+		{
+			D3D11_TEXTURE3D_DESC textureDescription = { 0 };
+			{
+				textureDescription.Width = i_ddsInfo.width;
+				textureDescription.Height = i_ddsInfo.height;
+				textureDescription.Depth = i_ddsInfo.depth;
+				textureDescription.MipLevels = i_ddsInfo.mipLevelCount;
+				textureDescription.Format = dxgiFormat;
+				textureDescription.Usage = D3D11_USAGE_IMMUTABLE;
+				textureDescription.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+				textureDescription.CPUAccessFlags = 0;
+				textureDescription.MiscFlags = 0;
+			}
+			ID3D11Texture3D* texture = NULL;
+			result = myCont->s_direct3dDevice->CreateTexture3D( &textureDescription, subResourceData, &texture );
+			m_texture = texture;
+		}
+		else
 		{
-			textureDescription.Width = i_ddsInfo.width;
-			textureDescription.Height = i_ddsInfo.height;
-			textureDescription.MipLevels = i_ddsInfo.mipLevelCount;
-			textureDescription.ArraySize = 1;
-			textureDescription.Format = dxgiFormat;
+			D3D11_TEXTURE2D_DESC textureDescription = { 0 };
 			{
-				DXGI_SAMPLE_DESC& sampleDescription = textureDescription.SampleDesc;
-				sampleDescription.Count = 1;	
-				sampleDescription.Quality = 0;	
+				textureDescription.Width = i_ddsInfo.width;
+				textureDescription.Height = i_ddsInfo.height;
+				textureDescription.MipLevels = i_ddsInfo.mipLevelCount;
+				// The faces of a cube map are its layers
+				textureDescription.ArraySize = i_ddsInfo.layerCount;
+				textureDescription.Format = dxgiFormat;
+				{
+					DXGI_SAMPLE_DESC& sampleDescription = textureDescription.SampleDesc;
+					sampleDescription.Count = 1;	
+					sampleDescription.Quality = 0;	
+				}
+				textureDescription.Usage = isStreamed ? D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+				textureDescription.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+				textureDescription.CPUAccessFlags = 0;	
+				textureDescription.MiscFlags = ( i_ddsInfo.type == TextureTypes::Cube ) ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
 			}
-			textureDescription.Usage = D3D11_USAGE_IMMUTABLE;	
-			textureDescription.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-			textureDescription.CPUAccessFlags = 0;	
-			textureDescription.MiscFlags = 0;
+			// Initial data has to be given for either every subresource or none of them
+			ID3D11Texture2D* texture = NULL;
+			result = myCont->s_direct3dDevice->CreateTexture2D( &textureDescription, isStreamed ? NULL : subResourceData, &texture );
+			m_texture = texture;
 		}
-		const HRESULT result = myCont->s_direct3dDevice->CreateTexture2D( &textureDescription, subResourceData, &resource );
 		if ( FAILED( result ) )
 		{
 			wereThereErrors = true;
-			ASSERTF( false, "CreateTexture2D() failed" );
+			ASSERTF( false, "Creating a texture failed" );
 			Engine::Logging::OutputError( "Direct3D failed to create a texture from %s with HRESULT %#010x", i_path, result );
 			goto OnExit;
 		}
-	}
-	{
-		D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDescription;
+		if ( isStreamed )
 		{
-			shaderResourceViewDescription.Format = dxgiFormat;
-			shaderResourceViewDescription.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+			for ( unsigned int i = 0; i < residentMipLevelCount; ++i )
 			{
-				D3D11_TEX2D_SRV& shaderResourceView2dDescription = shaderResourceViewDescription.Texture2D;
-				shaderResourceView2dDescription.MostDetailedMip = 0;	
-				shaderResourceView2dDescription.MipLevels = -1;	
+				const D3D11_SUBRESOURCE_DATA& currentSubResourceData = subResourceData[i];
+				myCont->s_direct3dImmediateContext->UpdateSubresource( m_texture, i_ddsInfo.firstResidentMipLevel + i, NULL,
+					currentSubResourceData.pSysMem, currentSubResourceData.SysMemPitch, currentSubResourceData.SysMemSlicePitch );
 			}
 		}
-		const HRESULT result = myCont->s_direct3dDevice->CreateShaderResourceView( resource, &shaderResourceViewDescription, &m_textureView );
-		if ( FAILED( result ) )
-		{
-			wereThereErrors = true;
-			ASSERTF( false, "CreateShaderResourceView() failed" );
-			Engine::Logging::OutputError( "Direct3D failed to create a shader resource view for %s with HRESULT %#010x", i_path, result );
-			goto OnExit;
-		}
+	}
+	if ( !CreateShaderResourceView( i_path, m_texture, i_ddsInfo, i_ddsInfo.firstResidentMipLevel, m_textureView ) )
+	{
+		wereThereErrors = true;
+		goto OnExit;
 	}
 
 OnExit:
-	if ( resource )
+	if ( wereThereErrors && m_texture )
 	{
-		resource->Release();
-		resource = NULL;
+		m_texture->Release();
+		m_texture = NULL;
 	}
 	if ( subResourceData )
 	{
@@ -155,3 +199,98 @@ OnExit:
 
 	return !wereThereErrors;
 }
+
+bool Engine::Graphics::cTexture::UploadMipLevel( const unsigned int i_mipLevel, const void* const i_data, const size_t i_dataSize )
+{
+	ASSERT( m_streamingState && m_texture );
+	const sDdsInfo& ddsInfo = m_streamingState->ddsInfo;
+	{
+		const unsigned int width = std::max( ddsInfo.width >> i_mipLevel, 1u );
+		const unsigned int byteCount_singleRow = ( ( width + 3 ) / 4 ) * TextureFormats::GetSizeOfBlock( ddsInfo.format );
+		myCont->s_direct3dImmediateContext->UpdateSubresource( m_texture, i_mipLevel, NULL,
+			i_data, byteCount_singleRow, static_cast<unsigned int>( i_dataSize ) );
+	}
+	// A view can't change which levels it covers, and so a new one replaces the old one
+	ID3D11ShaderResourceView* textureView = NULL;
+	if ( CreateShaderResourceView( m_streamingState->path.c_str(), m_texture, ddsInfo, i_mipLevel, textureView ) )
+	{
+		m_textureView->Release();
+		m_textureView = textureView;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+namespace
+{
+	DXGI_FORMAT GetDxgiFormat( const Engine::Graphics::TextureFormats::eFormat i_format )
+	{
+		switch ( i_format )
+		{
+			case Engine::Graphics::TextureFormats::BC1: return DXGI_FORMAT_BC1_UNORM;
+			case Engine::Graphics::TextureFormats::BC3: return DXGI_FORMAT_BC3_UNORM;
+			case Engine::Graphics::TextureFormats::BC4: return DXGI_FORMAT_BC4_UNORM;
+			case Engine::Graphics::TextureFormats::BC5: return DXGI_FORMAT_BC5_UNORM;
+			case Engine::Graphics::TextureFormats::BC7: return DXGI_FORMAT_BC7_UNORM;
+		}
+		return DXGI_FORMAT_UNKNOWN;
+	}
+
+	bool CreateShaderResourceView( const char* const i_path, ID3D11Resource* const i_texture, const Engine::Graphics::sDdsInfo& i_ddsInfo,
+		const unsigned int i_mostDetailedMipLevel, ID3D11ShaderResourceView*& o_textureView )
+	{
+		D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDescription;
+		{
+			shaderResourceViewDescription.Format = GetDxgiFormat( i_ddsInfo.format );
+			// Every type of view uses every level from the most detailed one to the smallest
+			const UINT useEveryLevel = -1;
+			switch ( i_ddsInfo.type )
+			{
+				case Engine::Graphics::TextureTypes::TwoDimensionalArray:
+				{
+					shaderResourceViewDescription.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+					D3D11_TEX2D_ARRAY_SRV& shaderResourceViewArrayDescription = shaderResourceViewDescription.Texture2DArray;
+					shaderResourceViewArrayDescription.MostDetailedMip = i_mostDetailedMipLevel;
+					shaderResourceViewArrayDescription.MipLevels = useEveryLevel;
+					shaderResourceViewArrayDescription.FirstArraySlice = 0;
+					shaderResourceViewArrayDescription.ArraySize = i_ddsInfo.layerCount;
+				}
+				break;
+				case Engine::Graphics::TextureTypes::Cube:
+				{
+					shaderResourceViewDescription.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+					D3D11_TEXCUBE_SRV& shaderResourceViewCubeDescription = shaderResourceViewDescription.TextureCube;
+					shaderResourceViewCubeDescription.MostDetailedMip = i_mostDetailedMipLevel;
+					shaderResourceViewCubeDescription.MipLevels = useEveryLevel;
+				}
+				break;
+				case Engine::Graphics::TextureTypes::Volume:
+				{
+					shaderResourceViewDescription.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE3D;
+					D3D11_TEX3D_SRV& shaderResourceView3dDescription = shaderResourceViewDescription.Texture3D;
+					shaderResourceView3dDescription.MostDetailedMip = i_mostDetailedMipLevel;
+					shaderResourceView3dDescription.MipLevels = useEveryLevel;
+				}
+				break;
+				default:
+				{
+					shaderResourceViewDescription.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+					D3D11_TEX2D_SRV& shaderResourceView2dDescription = shaderResourceViewDescription.Texture2D;
+					shaderResourceView2dDescription.MostDetailedMip = i_mostDetailedMipLevel;
+					shaderResourceView2dDescription.MipLevels = useEveryLevel;
+				}
+			}
+		}
+		const HRESULT result = myCont->s_direct3dDevice->CreateShaderResourceView( i_texture, &shaderResourceViewDescription, &o_textureView );
+		if ( FAILED( result ) )
+		{
+			ASSERTF( false, "CreateShaderResourceView() failed" );
+			Engine::Logging::OutputError( "Direct3D failed to create a shader resource view for %s with HRESULT %#010x", i_path, result );
+			return false;
+		}
+		return true;
+	}
+}
@@ -31,13 +31,18 @@ namespace Engine
 			Math::cVector s_pos;
 			Math::cVector s_rot;
 			Materials::Material* s_mat;
+			// The materials of the mesh's material slots
+			// (submeshes whose slot has no material here are drawn with s_mat)
+			std::vector<Materials::Material*> s_slotMats;
 		};
 
 		struct DrawCallData
 		{
 			Mesh::Mesh* s_mesh;
 			Materials::Material* s_mat;
+			std::vector<Materials::Material*> s_slotMats;
 			ConstantBuffer::sDrawCall s_drawCall;
+			Math::cVector s_pos;
 		};
 
 		struct SpriteCallData
@@ -91,6 +96,8 @@ namespace Engine
 			~GraphicsData();
 
 			static GraphicsData* m_graphicsData;
+			// Texture levels that are bigger than the mip tail are streamed in after each frame is presented, this many bytes at a time
+			static const size_t s_textureStreamingBytesPerFrame = 4 * 1024 * 1024;
 
 			std::vector<Engine::Graphics::DrawCallData> s_MeshList;
 			std::vector<Engine::Graphics::SpriteCallData> s_SprList;
@@ -127,6 +134,8 @@ namespace Engine
 			Engine::Math::cVector* s_camPos;
 			Engine::Math::cQuaternion* s_camOri;
 			Engine::Camera::Camera* s_camera;
+			// The aspect ratio that the projection was created with
+			float s_aspectRatio;
 		};
 	}
 }
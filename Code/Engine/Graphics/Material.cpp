@@ -24,7 +24,7 @@ namespace Engine
 				const char* texpath = reinterpret_cast<const char*>(s_data + sizeof(ConstantBuffer::sMaterial) + sizeof(uint16_t));
 				const char* effpath = reinterpret_cast<const char*>(s_data + sizeof(ConstantBuffer::sMaterial) + sizeof(uint16_t) + size);
 
-				s_texture.Load(texpath);
+				s_texture = cTexture::Acquire(texpath);
 				s_effect.LoadFile(effpath);
 				s_constantBuffer.Initialize(ConstantBuffer::sBufferType::materialType, sizeof(ConstantBuffer::sMaterial), reinterpret_cast<void*>(&mat));
 
@@ -39,16 +39,26 @@ namespace Engine
 					wereThereErrors = true;
 				if (!s_effect.CleanUp())
 					wereThereErrors = true;
-				if (!s_texture.CleanUp())
-					wereThereErrors = true;
+				cTexture::Release(s_texture);
 
 				return !wereThereErrors;
 			}
 
+			Material::Material() : s_texture(NULL)
+			{
+
+			}
+
+			Material::~Material()
+			{
+				cTexture::Release(s_texture);
+			}
+
 			void Material::Bind()
 			{
 				unsigned int id = 0;
-				s_texture.Bind(id);
+				if (s_texture)
+					s_texture->Bind(id);
 				s_effect.Set();
 				s_constantBuffer.Bind();
 			}
@@ -16,12 +16,16 @@ namespace Engine
 			private:
 				Effect::Effect s_effect;
 				ConstantBuffer::ConstantBuffer s_constantBuffer;
-				cTexture s_texture;
+				// Textures are shared between materials (see cTexture::Acquire())
+				cTexture* s_texture;
 
 			public:
 				bool Load(const char* i_filepath);
 				bool CleanUp();
 				void Bind();
+
+				Material();
+				~Material();
 			};
 		}
 	}
@@ -1,8 +1,68 @@
 #include "Mesh.h"
+#include "MeshCodec.h"
+#include "MeshFormat.h"
+#include "MeshRaycast.h"
 #include "../Asserts/Asserts.h"
 #include "../Logging/Logging.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+
+namespace
+{
+	bool IsSphereInViewVolume(const float i_sphere_local[4], const Engine::Mesh::sViewVolume& i_viewVolume)
+	{
+		// Meshes are only ever rotated and translated, and so the radius doesn't change
+		const float radius = i_sphere_local[3];
+		const Engine::Math::cVector center_world = i_viewVolume.transform_localToWorld.TransformPoint(
+			Engine::Math::cVector(i_sphere_local[0], i_sphere_local[1], i_sphere_local[2]));
+
+		// The test is done in camera space (the camera looks down -z)
+		const Engine::Math::cVector center_camera = i_viewVolume.transform_worldToCamera.TransformPoint(center_world);
+		const float z = center_camera.z();
+		if (((z - radius) > -i_viewVolume.z_nearPlane) || ((z + radius) < -i_viewVolume.z_farPlane))
+		{
+			return false;
+		}
+		const float tanHalfFov_y = std::tan(i_viewVolume.fieldOfView_y * 0.5f);
+		const float tanHalfFov_x = tanHalfFov_y * i_viewVolume.aspectRatio;
+		const float planeScale_y = 1.0f / std::sqrt(1.0f + (tanHalfFov_y * tanHalfFov_y));
+		const float planeScale_x = 1.0f / std::sqrt(1.0f + (tanHalfFov_x * tanHalfFov_x));
+		if ((((center_camera.y() + (z * tanHalfFov_y)) * planeScale_y) > radius)
+			|| (((-center_camera.y() + (z * tanHalfFov_y)) * planeScale_y) > radius)
+			|| (((center_camera.x() + (z * tanHalfFov_x)) * planeScale_x) > radius)
+			|| (((-center_camera.x() + (z * tanHalfFov_x)) * planeScale_x) > radius))
+		{
+			return false;
+		}
+		return true;
+	}
+
+	// Points o_stream at a vertex stream in the mapped file, or decodes it into io_decoded if the mesh is compressed
+	bool LoadVertexStream(const uint8_t* const i_fileData, const Engine::Mesh::sSection& i_section, const uint32_t i_vertexCount, const size_t i_stride,
+		const bool i_isCompressed, std::vector<uint8_t>& io_decoded, const void*& o_stream)
+	{
+		if (i_isCompressed)
+		{
+			io_decoded.resize(i_vertexCount * i_stride);
+			if (!Engine::Mesh::Codec::DecodeVertices(i_fileData + i_section.offset, i_section.size, i_vertexCount, i_stride, io_decoded.data()))
+			{
+				return false;
+			}
+			o_stream = io_decoded.data();
+		}
+		else
+		{
+			if (i_section.size != (i_vertexCount * i_stride))
+			{
+				return false;
+			}
+			o_stream = i_fileData + i_section.offset;
+		}
+		return true;
+	}
+}
 
 namespace Engine
 {
@@ -10,26 +70,446 @@ namespace Engine
 	{
 		bool Mesh::LoadFile(const char* i_path)
 		{
-			bool wereThereErrors = false;
+			{
+				std::string errorMessage;
+				if (!Platform::MapFile(i_path, s_mappedFile, &errorMessage))
+				{
+					Engine::Logging::OutputError("Failed to load the mesh %s: %s", i_path, errorMessage.c_str());
+					return false;
+				}
+			}
+
+			// Reject files from other tools or older versions of MeshBuilder before looking at anything else
+			const uint8_t* const fileData = reinterpret_cast<const uint8_t*>(s_mappedFile.data);
+			const size_t fileSize = s_mappedFile.size;
+			const sFileHeader* const header = reinterpret_cast<const sFileHeader*>(fileData);
+			if ((fileSize < sizeof(sFileHeader)) || (header->magic != s_fileMagic))
+			{
+				ASSERTF(false, "Not a mesh file");
+				Engine::Logging::OutputError("%s isn't a built mesh", i_path);
+				return false;
+			}
+			if ((header->version != s_fileVersion) || (header->headerSize != sizeof(sFileHeader)) || (header->vertexSize != sizeof(sVertex)))
+			{
+				ASSERTF(false, "Outdated mesh file");
+				Engine::Logging::OutputError("The mesh %s was built with a different version of MeshBuilder and must be rebuilt", i_path);
+				return false;
+			}
+			if (((fileSize - sizeof(sFileHeader)) / sizeof(sSection)) < header->sectionCount)
+			{
+				ASSERTF(false, "Truncated mesh file");
+				Engine::Logging::OutputError("The section directory of the mesh %s is truncated", i_path);
+				return false;
+			}
+			if (CalculateChecksum(fileData + sizeof(sFileHeader), fileSize - sizeof(sFileHeader)) != header->checksum)
+			{
+				ASSERTF(false, "Corrupt mesh file");
+				Engine::Logging::OutputError("The mesh %s is corrupt (its checksum doesn't match)", i_path);
+				return false;
+			}
+			s_numVertices = header->vertexCount;
+			s_numIndices = header->indexCount;
+			s_indexDataSize = header->indexDataSize;
+			s_bounds = header->bounds;
+			const bool isCompressed = (header->flags & FILEFLAG_COMPRESSED) != 0;
+			const bool areStreamsSplit = (header->flags & FILEFLAG_SPLITSTREAMS) != 0;
 
-			Platform::sDataFromFile s_Filedata;
+			// Everything else points directly into the mapped file
+			const sSection* const sections = reinterpret_cast<const sSection*>(fileData + sizeof(sFileHeader));
+			const sSection* vertexSection = NULL;
+			const sSection* positionSection = NULL;
+			const sSection* attributeSection = NULL;
+			const sSection* indexSection = NULL;
+			const sSection* bvhNodeSection = NULL;
+			const sSection* bvhTriangleSection = NULL;
+			positionArray_soa = NULL;
+			lodArray = NULL;
+			s_numLods = 0;
+			clusterArray = NULL;
+			s_numClusters = 0;
+			submeshArray = NULL;
+			s_numSubmeshes = 0;
+			s_materialSlotNames.clear();
+			s_bvh.nodes = NULL;
+			s_bvh.nodeCount = 0;
+			s_bvh.packets = NULL;
+			s_bvh.packetCount = 0;
+			for (uint32_t i = 0; i < header->sectionCount; ++i)
+			{
+				const sSection& section = sections[i];
+				if ((section.offset > fileSize) || (section.size > (fileSize - section.offset)) || ((section.offset % s_sectionAlignment) != 0))
+				{
+					ASSERTF(false, "Invalid mesh section");
+					Engine::Logging::OutputError("A section of the mesh %s is outside of the file or misaligned", i_path);
+					return false;
+				}
+				const uint8_t* const sectionData = fileData + section.offset;
+				switch (section.type)
+				{
+				case SECTION_VERTICES:
+					vertexSection = &section;
+					break;
+				case SECTION_INDICES:
+					indexSection = &section;
+					break;
+				case SECTION_LODS:
+					lodArray = reinterpret_cast<const sLod*>(sectionData);
+					s_numLods = section.size / sizeof(sLod);
+					break;
+				case SECTION_CLUSTERS:
+					clusterArray = reinterpret_cast<const sCluster*>(sectionData);
+					s_numClusters = section.size / sizeof(sCluster);
+					break;
+				case SECTION_POSITIONS:
+					positionSection = &section;
+					break;
+				case SECTION_ATTRIBUTES:
+					attributeSection = &section;
+					break;
+				case SECTION_POSITIONS_SOA:
+					if (section.size != (GetPaddedCount_soa(s_numVertices) * 3 * sizeof(float)))
+					{
+						ASSERTF(false, "Invalid mesh section size");
+						Engine::Logging::OutputError("The SoA positions of the mesh %s don't match the vertex count in its header", i_path);
+						return false;
+					}
+					positionArray_soa = reinterpret_cast<const float*>(sectionData);
+					break;
+				case SECTION_SUBMESHES:
+					submeshArray = reinterpret_cast<const sSubmesh*>(sectionData);
+					s_numSubmeshes = section.size / sizeof(sSubmesh);
+					break;
+				case SECTION_MATERIALSLOTS:
+					{
+						const char* const names = reinterpret_cast<const char*>(sectionData);
+						if ((section.size > 0) && (names[section.size - 1] != '\0'))
+						{
+							ASSERTF(false, "Invalid material slots");
+							Engine::Logging::OutputError("The material slot names of the mesh %s aren't terminated", i_path);
+							return false;
+						}
+						for (uint32_t offset = 0; offset < section.size; offset += static_cast<uint32_t>(strlen(names + offset)) + 1)
+						{
+							s_materialSlotNames.push_back(names + offset);
+						}
+					}
+					break;
+				case SECTION_BVHNODES:
+					bvhNodeSection = &section;
+					break;
+				case SECTION_BVHTRIANGLES:
+					bvhTriangleSection = &section;
+					break;
+				default:
+					// Sections from newer tools that this version doesn't need are skipped
+					break;
+				}
+			}
+			if ((areStreamsSplit ? ((positionSection == NULL) || (attributeSection == NULL)) : (vertexSection == NULL))
+				|| (indexSection == NULL) || (s_numLods == 0) || (s_numSubmeshes == 0))
+			{
+				ASSERTF(false, "Missing mesh sections");
+				Engine::Logging::OutputError("The mesh %s is missing its vertices, indices, levels of detail, or submeshes", i_path);
+				return false;
+			}
+			// Every level of detail and cluster is drawn directly from the index buffer
+			for (uint32_t i = 0; i < s_numLods; ++i)
+			{
+				const sLod& lod = lodArray[i];
+				if ((lod.firstIndex > s_numIndices) || (lod.indexCount > (s_numIndices - lod.firstIndex)))
+				{
+					ASSERTF(false, "Invalid level of detail");
+					Engine::Logging::OutputError("A level of detail of the mesh %s refers to indices that don't exist", i_path);
+					return false;
+				}
+			}
+			for (uint32_t i = 0; i < s_numClusters; ++i)
+			{
+				const sCluster& cluster = clusterArray[i];
+				if ((cluster.firstIndex > s_numIndices) || (cluster.indexCount > (s_numIndices - cluster.firstIndex)))
+				{
+					ASSERTF(false, "Invalid cluster");
+					Engine::Logging::OutputError("A cluster of the mesh %s refers to indices that don't exist", i_path);
+					return false;
+				}
+			}
+			for (uint32_t i = 0; i < s_numSubmeshes; ++i)
+			{
+				const sSubmesh& submesh = submeshArray[i];
+				if ((submesh.lodCount == 0) || (submesh.firstLod > s_numLods) || (submesh.lodCount > (s_numLods - submesh.firstLod))
+					|| (submesh.firstCluster > s_numClusters) || (submesh.clusterCount > (s_numClusters - submesh.firstCluster))
+					|| (submesh.materialSlot >= s_materialSlotNames.size()))
+				{
+					ASSERTF(false, "Invalid submesh");
+					Engine::Logging::OutputError("A submesh of the mesh %s refers to levels of detail, clusters, or a material slot that don't exist", i_path);
+					return false;
+				}
+				// The submesh's indices end where the next submesh's start,
+				// and every level of detail and cluster must be in that range
+				const uint32_t endIndex = ((i + 1) < s_numSubmeshes) ? submeshArray[i + 1].firstIndex : s_numIndices;
+				bool areIndicesValid = ((submesh.indexSize == sizeof(uint16_t)) || (submesh.indexSize == sizeof(uint32_t)))
+					&& ((submesh.indexOffset % submesh.indexSize) == 0) && (submesh.firstIndex <= endIndex) && (endIndex <= s_numIndices)
+					&& (submesh.indexOffset <= s_indexDataSize)
+					&& ((static_cast<uint64_t>(endIndex - submesh.firstIndex) * submesh.indexSize) <= (s_indexDataSize - submesh.indexOffset))
+					&& (submesh.firstVertex <= s_numVertices) && (submesh.vertexCount <= (s_numVertices - submesh.firstVertex));
+				for (uint32_t j = submesh.firstLod; areIndicesValid && (j < (submesh.firstLod + submesh.lodCount)); ++j)
+				{
+					areIndicesValid = (lodArray[j].firstIndex >= submesh.firstIndex) && ((lodArray[j].firstIndex + lodArray[j].indexCount) <= endIndex);
+				}
+				for (uint32_t j = submesh.firstCluster; areIndicesValid && (j < (submesh.firstCluster + submesh.clusterCount)); ++j)
+				{
+					areIndicesValid = (clusterArray[j].firstIndex >= submesh.firstIndex) && ((clusterArray[j].firstIndex + clusterArray[j].indexCount) <= endIndex);
+				}
+				if (!areIndicesValid)
+				{
+					ASSERTF(false, "Invalid submesh indices");
+					Engine::Logging::OutputError("The indices of a submesh of the mesh %s don't fit in the index buffer", i_path);
+					return false;
+				}
+			}
+			if (bvhNodeSection || bvhTriangleSection)
+			{
+				if (bvhNodeSection && bvhTriangleSection
+					&& ((bvhNodeSection->size % sizeof(sBvhNode)) == 0) && ((bvhTriangleSection->size % sizeof(sBvhTrianglePacket)) == 0))
+				{
+					s_bvh.nodes = reinterpret_cast<const sBvhNode*>(fileData + bvhNodeSection->offset);
+					s_bvh.nodeCount = bvhNodeSection->size / sizeof(sBvhNode);
+					s_bvh.packets = reinterpret_cast<const sBvhTrianglePacket*>(fileData + bvhTriangleSection->offset);
+					s_bvh.packetCount = bvhTriangleSection->size / sizeof(sBvhTrianglePacket);
+				}
+				if (!Raycast::IsValid(s_bvh, s_numIndices / 3))
+				{
+					ASSERTF(false, "Invalid BVH");
+					Engine::Logging::OutputError("The BVH of the mesh %s is incomplete or refers to nodes or triangles that don't exist", i_path);
+					return false;
+				}
+			}
 
-			if (!Platform::LoadBinaryFile(i_path, s_Filedata))
-				wereThereErrors = true;
+			{
+				bool wereStreamsLoaded;
+				vertexArray = NULL;
+				positionArray = NULL;
+				attributeArray = NULL;
+				if (areStreamsSplit)
+				{
+					const void* positions = NULL;
+					const void* attributes = NULL;
+					wereStreamsLoaded =
+						LoadVertexStream(fileData, *positionSection, s_numVertices, sizeof(float) * 3, isCompressed, s_decodedVertices, positions)
+						&& LoadVertexStream(fileData, *attributeSection, s_numVertices, sizeof(sVertexAttributes), isCompressed, s_decodedAttributes, attributes);
+					positionArray = reinterpret_cast<const float*>(positions);
+					attributeArray = reinterpret_cast<const sVertexAttributes*>(attributes);
+				}
+				else
+				{
+					const void* vertices = NULL;
+					wereStreamsLoaded = LoadVertexStream(fileData, *vertexSection, s_numVertices, sizeof(sVertex), isCompressed, s_decodedVertices, vertices);
+					vertexArray = reinterpret_cast<const sVertex*>(vertices);
+				}
+				if (!wereStreamsLoaded)
+				{
+					ASSERTF(false, "Invalid vertex data");
+					Engine::Logging::OutputError("The vertex data of the mesh %s is corrupt or doesn't match the vertex count in its header", i_path);
+					return false;
+				}
+			}
 
-			uint8_t* s_data = reinterpret_cast<uint8_t*>(s_Filedata.data);
-			s_numVertices = *reinterpret_cast<uint16_t*>(s_data);
-			vertexArray = reinterpret_cast<sVertex*>(s_data + 2);
+			if (isCompressed)
+			{
+				std::vector<uint32_t> indices(s_numIndices);
+				if (!Codec::DecodeIndices(fileData + indexSection->offset, indexSection->size, s_numIndices, indices.data()))
+				{
+					ASSERTF(false, "Corrupt index data");
+					Engine::Logging::OutputError("The compressed index data of the mesh %s is corrupt", i_path);
+					return false;
+				}
+				// The encoding has every index as 32 bits, and each submesh's are narrowed to the size that it is drawn with
+				s_decodedIndices.assign(s_indexDataSize, 0);
+				for (uint32_t i = 0; i < s_numSubmeshes; ++i)
+				{
+					const sSubmesh& submesh = submeshArray[i];
+					const uint32_t endIndex = ((i + 1) < s_numSubmeshes) ? submeshArray[i + 1].firstIndex : s_numIndices;
+					uint8_t* const submeshIndices = s_decodedIndices.data() + submesh.indexOffset;
+					if (submesh.indexSize == sizeof(uint16_t))
+					{
+						uint16_t* const indices16 = reinterpret_cast<uint16_t*>(submeshIndices);
+						for (uint32_t j = submesh.firstIndex; j < endIndex; ++j)
+						{
+							indices16[j - submesh.firstIndex] = static_cast<uint16_t>(indices[j]);
+						}
+					}
+					else
+					{
+						memcpy(submeshIndices, indices.data() + submesh.firstIndex, (endIndex - submesh.firstIndex) * sizeof(uint32_t));
+					}
+				}
+				indiceArray = s_decodedIndices.data();
+			}
+			else
+			{
+				if (indexSection->size != s_indexDataSize)
+				{
+					ASSERTF(false, "Invalid mesh section size");
+					Engine::Logging::OutputError("The index section of the mesh %s doesn't match the index count in its header", i_path);
+					return false;
+				}
+				indiceArray = fileData + indexSection->offset;
+			}
 
-			s_numIndices = *reinterpret_cast<uint16_t*>(s_data + 2 + (s_numVertices * sizeof(sVertex)));
-			indiceArray = reinterpret_cast<uint16_t*>(s_data + 2 + 2 + (s_numVertices * sizeof(sVertex)));
+			return Initialize();
+		}
+
+		unsigned int Mesh::SelectLod(const float i_distance, const unsigned int i_submeshIndex) const
+		{
+			// Roughly the angle that one pixel covers with a 60 degree field of view at 720p
+			const float maxErrorPerUnitOfDistance = 0.0015f;
+			const float maxError = i_distance * maxErrorPerUnitOfDistance;
+
+			ASSERT(i_submeshIndex < s_numSubmeshes);
+			const sSubmesh& submesh = submeshArray[i_submeshIndex];
+			const sLod* const lods = lodArray + submesh.firstLod;
+			unsigned int lodIndex = 0;
+			while (((lodIndex + 1) < submesh.lodCount) && (lods[lodIndex + 1].geometricError <= maxError))
+			{
+				++lodIndex;
+			}
+			return lodIndex;
+		}
+
+		bool Mesh::IsVisible(const sViewVolume& i_viewVolume) const
+		{
+			return IsSphereInViewVolume(s_bounds.sphere, i_viewVolume);
+		}
+
+		bool Mesh::IsSubmeshVisible(const sViewVolume& i_viewVolume, const unsigned int i_submeshIndex) const
+		{
+			ASSERT(i_submeshIndex < s_numSubmeshes);
+			return IsSphereInViewVolume(submeshArray[i_submeshIndex].bounds.sphere, i_viewVolume);
+		}
+
+		void Mesh::Draw(const unsigned int i_lodIndex, const unsigned int i_submeshIndex)
+		{
+			ASSERT((i_submeshIndex < s_numSubmeshes) && (i_lodIndex < submeshArray[i_submeshIndex].lodCount));
+			const sLod& lod = lodArray[submeshArray[i_submeshIndex].firstLod + i_lodIndex];
+			Bind(submeshArray[i_submeshIndex]);
+			DrawIndices(submeshArray[i_submeshIndex], lod.firstIndex, lod.indexCount);
+		}
+
+		void Mesh::DrawPositions(const unsigned int i_lodIndex, const unsigned int i_submeshIndex)
+		{
+			ASSERT((i_submeshIndex < s_numSubmeshes) && (i_lodIndex < submeshArray[i_submeshIndex].lodCount));
+			const sLod& lod = lodArray[submeshArray[i_submeshIndex].firstLod + i_lodIndex];
+			const bool positionsOnly = true;
+			Bind(submeshArray[i_submeshIndex], positionsOnly);
+			DrawIndices(submeshArray[i_submeshIndex], lod.firstIndex, lod.indexCount);
+		}
+
+		bool Mesh::GetPositions_soa(sPositions_soa& o_positions) const
+		{
+			if (positionArray_soa == NULL)
+			{
+				return false;
+			}
+			o_positions.vertexCount = s_numVertices;
+			o_positions.paddedCount = GetPaddedCount_soa(s_numVertices);
+			o_positions.x = positionArray_soa;
+			o_positions.y = positionArray_soa + o_positions.paddedCount;
+			o_positions.z = positionArray_soa + (o_positions.paddedCount * 2);
+			return true;
+		}
+
+		bool Mesh::IntersectRay(const Raycast::sRay& i_ray, Raycast::sHit& o_hit) const
+		{
+			ASSERT(HasBvh());
+			return Raycast::IntersectRay(s_bvh, i_ray, o_hit);
+		}
+
+		void Mesh::IntersectRays(const Raycast::sRay* const i_rays, const size_t i_rayCount, Raycast::sHit* const o_hits) const
+		{
+			ASSERT(HasBvh());
+			Raycast::IntersectRays(s_bvh, i_rays, i_rayCount, o_hits);
+		}
+
+		unsigned int Mesh::GetSubmeshOfTriangle(const uint32_t i_triangleIndex) const
+		{
+			const uint32_t index = i_triangleIndex * 3;
+			for (uint32_t i = 0; i < s_numSubmeshes; ++i)
+			{
+				const sSubmesh& submesh = submeshArray[i];
+				if ((index >= submesh.firstIndex) && ((index - submesh.firstIndex) < submesh.indexCount))
+				{
+					return i;
+				}
+			}
+			ASSERTF(false, "The triangle isn't in LOD 0 of any submesh");
+			return 0;
+		}
+
+		void Mesh::DrawVisibleClusters(const sViewVolume& i_viewVolume, const unsigned int i_submeshIndex)
+		{
+			ASSERT(i_submeshIndex < s_numSubmeshes);
+			const sSubmesh& submesh = submeshArray[i_submeshIndex];
+			if (submesh.clusterCount == 0)
+			{
+				Draw(0, i_submeshIndex);
+				return;
+			}
+
+			// Neighboring visible clusters are contiguous in the index buffer,
+			// and so they get merged into a single draw
+			s_visibleRanges.clear();
+			for (uint32_t i = submesh.firstCluster; i < (submesh.firstCluster + submesh.clusterCount); ++i)
+			{
+				const sCluster& cluster = clusterArray[i];
+				if (!IsClusterVisible(cluster, i_viewVolume))
+				{
+					continue;
+				}
+				if (!s_visibleRanges.empty()
+					&& ((s_visibleRanges.back().firstIndex + s_visibleRanges.back().indexCount) == cluster.firstIndex))
+				{
+					s_visibleRanges.back().indexCount += cluster.indexCount;
+				}
+				else
+				{
+					const sIndexRange range = { cluster.firstIndex, cluster.indexCount };
+					s_visibleRanges.push_back(range);
+				}
+			}
+
+			if (!s_visibleRanges.empty())
+			{
+				Bind(submesh);
+				for (std::vector<sIndexRange>::const_iterator it = s_visibleRanges.begin(); it != s_visibleRanges.end(); ++it)
+				{
+					DrawIndices(submesh, it->firstIndex, it->indexCount);
+				}
+			}
+		}
+
+		bool Mesh::IsClusterVisible(const sCluster& i_cluster, const sViewVolume& i_viewVolume) const
+		{
+			if (!IsSphereInViewVolume(i_cluster.boundingSphere, i_viewVolume))
+			{
+				return false;
+			}
 
-			if (!Initialize())
+			// Backface test with the normal cone
+			if (i_cluster.coneCutoff < 1.0f)
 			{
-				wereThereErrors = true;
+				const Math::cVector apex_world = i_viewVolume.transform_localToWorld.TransformPoint(
+					Math::cVector(i_cluster.coneApex[0], i_cluster.coneApex[1], i_cluster.coneApex[2]));
+				const Math::cVector axis_world = i_viewVolume.transform_localToWorld.TransformDirection(
+					Math::cVector(i_cluster.coneAxis[0], i_cluster.coneAxis[1], i_cluster.coneAxis[2]));
+				const Math::cVector cameraToApex = apex_world - i_viewVolume.cameraPosition_world;
+				const float distance = cameraToApex.GetLength();
+				if ((distance > 0.0f) && (Math::Dot(cameraToApex, axis_world) >= (i_cluster.coneCutoff * distance)))
+				{
+					return false;
+				}
 			}
 
-			return !wereThereErrors;
+			return true;
 		}
 	}
 }
\ No newline at end of file
@@ -2,9 +2,14 @@
 #define MESH_H
 
 #include "Configuration.h"
+#include "MeshFormat.h"
+#include "MeshRaycast.h"
 #include "../Platform/Platform.h"
+#include "../Math/cMatrix_transformation.h"
+#include "../Math/cVector.h"
 
 #include <cstdint>
+#include <vector>
 
 #if defined( PLATFORM_D3D )
 	#include <D3D11.h>
@@ -17,11 +22,26 @@ namespace Engine
 {
 	namespace Mesh
 	{
-		struct sVertex
+		// Positions as separate x, y, and z arrays, each padded to a multiple of 4
+		struct sPositions_soa
 		{
-			float x, y, z;
-			float u, v;
-			uint8_t r, g, b, a;
+			const float* x;
+			const float* y;
+			const float* z;
+			uint32_t vertexCount;
+			uint32_t paddedCount;
+		};
+
+		// Where a mesh is and what the camera can see, for culling clusters on the CPU
+		struct sViewVolume
+		{
+			Math::cMatrix_transformation transform_localToWorld;
+			Math::cMatrix_transformation transform_worldToCamera;
+			Math::cVector cameraPosition_world;
+			float fieldOfView_y;
+			float aspectRatio;
+			float z_nearPlane;
+			float z_farPlane;
 		};
 		
 		class Mesh
@@ -29,26 +49,93 @@ namespace Engine
 		public:
 			bool LoadFile(const char* i_path);
 			bool CleanUp();
-			void Draw();
+			// Levels of detail and clusters are numbered separately for each submesh
+			void Draw(const unsigned int i_lodIndex = 0, const unsigned int i_submeshIndex = 0);
+			// Only binds the positions, for passes (like depth passes) whose effects don't read any other attributes
+			void DrawPositions(const unsigned int i_lodIndex = 0, const unsigned int i_submeshIndex = 0);
+			// Draws LOD 0 without the clusters that are outside of the view volume or that face away from the camera
+			void DrawVisibleClusters(const sViewVolume& i_viewVolume, const unsigned int i_submeshIndex = 0);
+
+			// Returns the coarsest level of detail whose geometric error,
+			// seen from the given distance, is still too small to notice
+			unsigned int SelectLod(const float i_distance, const unsigned int i_submeshIndex = 0) const;
+			unsigned int GetLodCount(const unsigned int i_submeshIndex = 0) const { return submeshArray[i_submeshIndex].lodCount; }
+			unsigned int GetClusterCount(const unsigned int i_submeshIndex = 0) const { return submeshArray[i_submeshIndex].clusterCount; }
+			unsigned int GetSubmeshCount() const { return s_numSubmeshes; }
+			const sSubmesh& GetSubmesh(const unsigned int i_submeshIndex) const { return submeshArray[i_submeshIndex]; }
+			// Submeshes refer to materials by slot, and each slot has the name of the material that it was exported with
+			unsigned int GetMaterialSlotCount() const { return static_cast<unsigned int>(s_materialSlotNames.size()); }
+			const char* GetMaterialSlotName(const unsigned int i_slot) const { return s_materialSlotNames[i_slot]; }
+			// The bounds are in the mesh's local space and come precomputed from MeshBuilder
+			const sBounds& GetBounds() const { return s_bounds; }
+			// Whether the bounding sphere is at least partially inside of the view volume
+			bool IsVisible(const sViewVolume& i_viewVolume) const;
+			bool IsSubmeshVisible(const sViewVolume& i_viewVolume, const unsigned int i_submeshIndex) const;
+			// Returns false if the mesh wasn't built with SoA positions
+			bool GetPositions_soa(sPositions_soa& o_positions) const;
+			// Ray queries (in the mesh's local space) against LOD 0 of every submesh only work if the mesh was built with a BVH.
+			// The barycentrics of a hit are for the triangle's vertices in the order of the index buffer that is drawn
+			bool HasBvh() const { return s_bvh.nodeCount > 0; }
+			bool IntersectRay(const Raycast::sRay& i_ray, Raycast::sHit& o_hit) const;
+			// Rays are traced 4 at a time, which is faster than one at a time when they are close together and point the same way
+			void IntersectRays(const Raycast::sRay* const i_rays, const size_t i_rayCount, Raycast::sHit* const o_hits) const;
+			// Returns the submesh whose LOD 0 has the given triangle
+			unsigned int GetSubmeshOfTriangle(const uint32_t i_triangleIndex) const;
 
 		private:
+			struct sIndexRange
+			{
+				uint32_t firstIndex;
+				uint32_t indexCount;
+			};
+
 			bool Initialize();
+			// The index buffer is bound for the size of the submesh's indices
+			void Bind(const sSubmesh& i_submesh, const bool i_positionsOnly = false);
+			void DrawIndices(const sSubmesh& i_submesh, const uint32_t i_firstIndex, const uint32_t i_indexCount);
+			bool IsClusterVisible(const sCluster& i_cluster, const sViewVolume& i_viewVolume) const;
 
-			uint16_t s_numVertices;
-			uint16_t s_numIndices;
+			uint32_t s_numVertices;
+			uint32_t s_numIndices;
+			uint32_t s_indexDataSize;
+			uint32_t s_numLods;
+			uint32_t s_numClusters;
+			uint32_t s_numSubmeshes;
+			sBounds s_bounds;
 
-			sVertex* vertexArray;
-			uint16_t* indiceArray;
+			// Either vertexArray or both positionArray and attributeArray are used, depending on whether the streams are split
+			const sVertex* vertexArray;
+			const float* positionArray;
+			const sVertexAttributes* attributeArray;
+			const float* positionArray_soa;
+			const void* indiceArray;
+			const sLod* lodArray;
+			const sCluster* clusterArray;
+			const sSubmesh* submeshArray;
+			Raycast::sBvh s_bvh;
+			std::vector<const char*> s_materialSlotNames;
+			std::vector<sIndexRange> s_visibleRanges;
+			// Compressed meshes are decoded into these
+			std::vector<uint8_t> s_decodedVertices;
+			std::vector<uint8_t> s_decodedAttributes;
+			std::vector<uint8_t> s_decodedIndices;
+			// The built file stays mapped while the mesh is loaded
+			Platform::sMappedFile s_mappedFile;
 
 #if defined( PLATFORM_D3D )
+			// This holds the positions when the streams are split
 			ID3D11Buffer* s_vertexBuffer = NULL;
+			ID3D11Buffer* s_attributeBuffer = NULL;
 			ID3D11Buffer* s_indexBuffer = NULL;
 
 #elif defined( PLATFORM_GL )
 			GLuint s_vertexArrayId = 0;
+			// Only the positions are enabled in this one (it is only created when the streams are split)
+			GLuint s_positionArrayId = 0;
 
 #ifdef GRAPHICS_ISDEVICEDEBUGINFOENABLED
 			GLuint s_vertexBufferId = 0;
+			GLuint s_attributeBufferId = 0;
 			GLuint s_indexBufferId = 0;
 #endif
 
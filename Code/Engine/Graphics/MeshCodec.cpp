@@ -0,0 +1,299 @@
+#include "MeshCodec.h"
+
+#include <cstring>
+
+#if defined( _M_X64 ) || defined( _M_IX86 ) || defined( __SSE2__ )
+	#define MESHCODEC_SIMD
+	#include <emmintrin.h>
+	#include <tmmintrin.h>
+	#if defined( _MSC_VER )
+		#include <intrin.h>
+		#define MESHCODEC_TARGET_SSSE3
+	#else
+		#define MESHCODEC_TARGET_SSSE3 __attribute__( ( target( "ssse3" ) ) )
+	#endif
+#endif
+
+namespace
+{
+	const unsigned int s_maxVertexSize = 256;
+
+	// The number of data bytes in a block of 16 vertices for each 2-bit plane width code
+	const size_t s_planeDataSizes[4] = { 0, 4, 8, 16 };
+
+	uint32_t UnZigZag(const uint32_t i_value)
+	{
+		return (i_value >> 1) ^ (0u - (i_value & 1u));
+	}
+
+#ifndef MESHCODEC_SIMD
+	uint8_t UnZigZag(const uint8_t i_value)
+	{
+		return static_cast<uint8_t>((i_value >> 1) ^ (0u - (i_value & 1u)));
+	}
+
+	void DecodePlane_scalar(const uint8_t* const i_data, const unsigned int i_widthCode, const uint8_t i_previous, uint8_t o_values[16])
+	{
+		uint8_t previous = i_previous;
+		for (unsigned int i = 0; i < 16; ++i)
+		{
+			uint8_t value;
+			switch (i_widthCode)
+			{
+			case 0: value = 0; break;
+			case 1: value = (i_data[i / 4] >> ((i % 4) * 2)) & 0x03; break;
+			case 2: value = (i_data[i / 2] >> ((i % 2) * 4)) & 0x0f; break;
+			default: value = i_data[i]; break;
+			}
+			previous = static_cast<uint8_t>(previous + UnZigZag(value));
+			o_values[i] = previous;
+		}
+	}
+#else
+	void DecodePlane_sse2(const uint8_t* const i_data, const unsigned int i_widthCode, const uint8_t i_previous, uint8_t o_values[16])
+	{
+		__m128i values;
+		switch (i_widthCode)
+		{
+		case 0:
+			values = _mm_setzero_si128();
+			break;
+		case 1:
+			{
+				int32_t packed;
+				memcpy(&packed, i_data, sizeof(packed));
+				const __m128i bytes = _mm_cvtsi32_si128(packed);
+				const __m128i mask = _mm_set1_epi8(0x03);
+				const __m128i a = _mm_and_si128(bytes, mask);
+				const __m128i b = _mm_and_si128(_mm_srli_epi16(bytes, 2), mask);
+				const __m128i c = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+				const __m128i d = _mm_and_si128(_mm_srli_epi16(bytes, 6), mask);
+				values = _mm_unpacklo_epi16(_mm_unpacklo_epi8(a, b), _mm_unpacklo_epi8(c, d));
+			}
+			break;
+		case 2:
+			{
+				const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(i_data));
+				const __m128i mask = _mm_set1_epi8(0x0f);
+				values = _mm_unpacklo_epi8(_mm_and_si128(bytes, mask), _mm_and_si128(_mm_srli_epi16(bytes, 4), mask));
+			}
+			break;
+		default:
+			values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i_data));
+			break;
+		}
+
+		// Zigzag decode
+		{
+			const __m128i halved = _mm_and_si128(_mm_srli_epi16(values, 1), _mm_set1_epi8(0x7f));
+			const __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(values, _mm_set1_epi8(1)));
+			values = _mm_xor_si128(halved, sign);
+		}
+		// Prefix sum of the deltas
+		values = _mm_add_epi8(values, _mm_slli_si128(values, 1));
+		values = _mm_add_epi8(values, _mm_slli_si128(values, 2));
+		values = _mm_add_epi8(values, _mm_slli_si128(values, 4));
+		values = _mm_add_epi8(values, _mm_slli_si128(values, 8));
+		values = _mm_add_epi8(values, _mm_set1_epi8(static_cast<char>(i_previous)));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(o_values), values);
+	}
+
+	// Interleaves 4 planes at a time into the 4-byte words of 16 vertices
+	void TransposePlanes_sse2(const uint8_t i_planes[][16], const size_t i_vertexSize, const uint32_t i_vertexCount, uint8_t* const o_vertices)
+	{
+		for (size_t plane = 0; plane < i_vertexSize; plane += 4)
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i_planes[plane]));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i_planes[plane + 1]));
+			const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i_planes[plane + 2]));
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(i_planes[plane + 3]));
+			const __m128i ab_low = _mm_unpacklo_epi8(a, b);
+			const __m128i ab_high = _mm_unpackhi_epi8(a, b);
+			const __m128i cd_low = _mm_unpacklo_epi8(c, d);
+			const __m128i cd_high = _mm_unpackhi_epi8(c, d);
+			uint32_t words[16];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(words), _mm_unpacklo_epi16(ab_low, cd_low));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(words + 4), _mm_unpackhi_epi16(ab_low, cd_low));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(words + 8), _mm_unpacklo_epi16(ab_high, cd_high));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(words + 12), _mm_unpackhi_epi16(ab_high, cd_high));
+			for (uint32_t i = 0; i < i_vertexCount; ++i)
+			{
+				memcpy(o_vertices + (i * i_vertexSize) + plane, &words[i], sizeof(uint32_t));
+			}
+		}
+	}
+
+	// For every control byte, the shuffle that moves the 4 variable-length values into 32-bit lanes
+	// and the total number of bytes that they use
+	struct sIndexShuffleTables
+	{
+		uint8_t shuffles[256][16];
+		uint8_t lengths[256];
+
+		sIndexShuffleTables()
+		{
+			for (unsigned int control = 0; control < 256; ++control)
+			{
+				uint8_t sourceByte = 0;
+				for (unsigned int lane = 0; lane < 4; ++lane)
+				{
+					const unsigned int length = ((control >> (lane * 2)) & 0x03) + 1;
+					for (unsigned int i = 0; i < 4; ++i)
+					{
+						// The high bit of a shuffle index makes the destination byte 0
+						shuffles[control][(lane * 4) + i] = (i < length) ? sourceByte++ : static_cast<uint8_t>(0x80);
+					}
+				}
+				lengths[control] = sourceByte;
+			}
+		}
+	};
+
+	bool IsSsse3Supported()
+	{
+#if defined( _MSC_VER )
+		int cpuInfo[4];
+		__cpuid(cpuInfo, 1);
+		return (cpuInfo[2] & (1 << 9)) != 0;
+#else
+		return __builtin_cpu_supports("ssse3") != 0;
+#endif
+	}
+
+	// Decodes as many groups of 4 indices as can be read safely with 16-byte loads,
+	// and returns how many indices were decoded
+	MESHCODEC_TARGET_SSSE3 uint32_t DecodeIndices_ssse3(const uint8_t* const i_control, const uint8_t*& io_data, const uint8_t* const i_dataEnd,
+		const uint32_t i_indexCount, uint32_t& io_previous, uint32_t* const o_indices)
+	{
+		static const sIndexShuffleTables s_tables;
+
+		uint32_t i = 0;
+		__m128i previous = _mm_set1_epi32(static_cast<int>(io_previous));
+		while (((i + 4) <= i_indexCount) && ((i_dataEnd - io_data) >= 16))
+		{
+			const uint8_t control = i_control[i / 4];
+			__m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(io_data));
+			values = _mm_shuffle_epi8(values, _mm_loadu_si128(reinterpret_cast<const __m128i*>(s_tables.shuffles[control])));
+			io_data += s_tables.lengths[control];
+
+			// Zigzag decode
+			values = _mm_xor_si128(_mm_srli_epi32(values, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(values, _mm_set1_epi32(1))));
+			// Prefix sum of the deltas
+			values = _mm_add_epi32(values, _mm_slli_si128(values, 4));
+			values = _mm_add_epi32(values, _mm_slli_si128(values, 8));
+			values = _mm_add_epi32(values, previous);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(o_indices + i), values);
+			previous = _mm_shuffle_epi32(values, _MM_SHUFFLE(3, 3, 3, 3));
+			i += 4;
+		}
+		io_previous = static_cast<uint32_t>(_mm_cvtsi128_si32(previous));
+		return i;
+	}
+#endif
+}
+
+bool Engine::Mesh::Codec::DecodeVertices(const uint8_t* const i_data, const size_t i_dataSize,
+	const uint32_t i_vertexCount, const size_t i_vertexSize, void* const o_vertices)
+{
+	if ((i_vertexSize == 0) || (i_vertexSize > s_maxVertexSize))
+	{
+		return false;
+	}
+	const size_t headerSize = (i_vertexSize + 3) / 4;
+
+	uint8_t previous[s_maxVertexSize] = { 0 };
+	uint8_t planes[s_maxVertexSize][s_vertexBlockSize];
+	const uint8_t* data = i_data;
+	const uint8_t* const dataEnd = i_data + i_dataSize;
+	uint8_t* const vertices = reinterpret_cast<uint8_t*>(o_vertices);
+	for (uint32_t firstVertex = 0; firstVertex < i_vertexCount; firstVertex += s_vertexBlockSize)
+	{
+		if (static_cast<size_t>(dataEnd - data) < headerSize)
+		{
+			return false;
+		}
+		const uint8_t* const header = data;
+		data += headerSize;
+
+		for (size_t plane = 0; plane < i_vertexSize; ++plane)
+		{
+			const unsigned int widthCode = (header[plane / 4] >> ((plane % 4) * 2)) & 0x03;
+			const size_t planeDataSize = s_planeDataSizes[widthCode];
+			if (static_cast<size_t>(dataEnd - data) < planeDataSize)
+			{
+				return false;
+			}
+#ifdef MESHCODEC_SIMD
+			DecodePlane_sse2(data, widthCode, previous[plane], planes[plane]);
+#else
+			DecodePlane_scalar(data, widthCode, previous[plane], planes[plane]);
+#endif
+			data += planeDataSize;
+			previous[plane] = planes[plane][s_vertexBlockSize - 1];
+		}
+
+		// Transpose the planes back into vertices
+		const uint32_t blockVertexCount = ((i_vertexCount - firstVertex) < s_vertexBlockSize) ? (i_vertexCount - firstVertex) : s_vertexBlockSize;
+		uint8_t* const blockVertices = vertices + (firstVertex * i_vertexSize);
+#ifdef MESHCODEC_SIMD
+		if ((i_vertexSize % 4) == 0)
+		{
+			TransposePlanes_sse2(planes, i_vertexSize, blockVertexCount, blockVertices);
+		}
+		else
+#endif
+		{
+			for (uint32_t i = 0; i < blockVertexCount; ++i)
+			{
+				uint8_t* const vertex = blockVertices + (i * i_vertexSize);
+				for (size_t plane = 0; plane < i_vertexSize; ++plane)
+				{
+					vertex[plane] = planes[plane][i];
+				}
+			}
+		}
+	}
+
+	return data == dataEnd;
+}
+
+bool Engine::Mesh::Codec::DecodeIndices(const uint8_t* const i_data, const size_t i_dataSize,
+	const uint32_t i_indexCount, uint32_t* const o_indices)
+{
+	const size_t controlSize = (static_cast<size_t>(i_indexCount) + 3) / 4;
+	if (i_dataSize < controlSize)
+	{
+		return false;
+	}
+	const uint8_t* const control = i_data;
+	const uint8_t* data = i_data + controlSize;
+	const uint8_t* const dataEnd = i_data + i_dataSize;
+
+	uint32_t previous = 0;
+	uint32_t i = 0;
+#ifdef MESHCODEC_SIMD
+	static const bool s_isSsse3Supported = IsSsse3Supported();
+	if (s_isSsse3Supported)
+	{
+		i = DecodeIndices_ssse3(control, data, dataEnd, i_indexCount, previous, o_indices);
+	}
+#endif
+	for (; i < i_indexCount; ++i)
+	{
+		const size_t length = ((control[i / 4] >> ((i % 4) * 2)) & 0x03) + 1;
+		if (static_cast<size_t>(dataEnd - data) < length)
+		{
+			return false;
+		}
+		uint32_t value = 0;
+		for (size_t byte = 0; byte < length; ++byte)
+		{
+			value |= static_cast<uint32_t>(data[byte]) << (byte * 8);
+		}
+		data += length;
+		previous += UnZigZag(value);
+		o_indices[i] = previous;
+	}
+
+	return data == dataEnd;
+}
@@ -0,0 +1,37 @@
+#ifndef MESHCODEC_H
+#define MESHCODEC_H
+
+// A lossless encoding of mesh data that is much smaller on disk than the raw buffers
+// and that can be decoded faster than it can be read.
+//
+// Vertices are split into blocks of 16; inside of a block every byte position of the vertex ("byte plane")
+// is delta coded against the previous vertex, zigzag coded, and bit packed with the fewest bits (0, 2, 4 or 8)
+// that fit all 16 values. A block starts with the 2-bit widths of all of its planes.
+//
+// Indices are delta coded against the previous index, zigzag coded, and stored as 1-4 little-endian bytes each
+// (the byte counts are 2-bit codes in a control byte per 4 indices, and all of the control bytes come first).
+// MeshBuilder rotates each triangle (before it builds the BVH, which refers to the corners by their order) so that the deltas are as small as possible,
+// which means that triangles that share an edge with the previous one mostly cost a single byte per index
+// (the decoded indices are always in the same order as the ones that were encoded).
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine
+{
+	namespace Mesh
+	{
+		namespace Codec
+		{
+			const unsigned int s_vertexBlockSize = 16;
+
+			// Both functions return false if the encoded data is truncated or corrupt
+			bool DecodeVertices(const uint8_t* const i_data, const size_t i_dataSize,
+				const uint32_t i_vertexCount, const size_t i_vertexSize, void* const o_vertices);
+			bool DecodeIndices(const uint8_t* const i_data, const size_t i_dataSize,
+				const uint32_t i_indexCount, uint32_t* const o_indices);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef MESHFORMAT_H
+#define MESHFORMAT_H
+
+// This file is shared by MeshBuilder (which writes built meshes) and Mesh (which reads them),
+// and so every record that is stored in a file is only declared here.
+//
+// A built mesh is a header followed by a directory of sections and then the sections themselves.
+// Every section starts at an offset (from the start of the file) that is a multiple of its alignment,
+// and so a file can be used directly from a memory-mapped view without copying anything.
+//
+// The indices of each submesh are relative to the submesh's first vertex (which is added back when it is drawn),
+// and each submesh's indices are 16-bit if that is enough for the vertices it uses and 32-bit otherwise.
+//
+// The same file is used by every platform: front-facing triangles are counter-clockwise,
+// and the Direct3D rasterizer state is set up to expect that so the indices can be uploaded as they are.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine
+{
+	namespace Mesh
+	{
+		// "MESH" when read as bytes
+		const uint32_t s_fileMagic = 0x4853454d;
+		// Files with a different version must be rebuilt (or upgraded by running MeshBuilder on them)
+		const uint32_t s_fileVersion = 5;
+
+		// Sections that are uploaded to the GPU are aligned to cache lines, and everything else to 16 bytes
+		const uint32_t s_bufferSectionAlignment = 64;
+		const uint32_t s_sectionAlignment = 16;
+
+		enum eFileFlags : uint32_t
+		{
+			// The vertex and index sections are encoded with MeshCodec
+			FILEFLAG_COMPRESSED = 1 << 0,
+			// The positions and the other attributes are in separate streams instead of a single interleaved one
+			FILEFLAG_SPLITSTREAMS = 1 << 1,
+		};
+
+		enum eSectionType : uint32_t
+		{
+			SECTION_VERTICES,	// sVertex[vertexCount] (or its encoding)
+			SECTION_INDICES,	// The uint16_t or uint32_t indices of each submesh in order (or the encoding of all of them as uint32_t[indexCount])
+			SECTION_LODS,	// sLod[]
+			SECTION_CLUSTERS,	// sCluster[] (optional)
+			SECTION_POSITIONS,	// float[vertexCount][3] (or its encoding), instead of the vertices when the streams are split
+			SECTION_ATTRIBUTES,	// sVertexAttributes[vertexCount] (or its encoding), instead of the vertices when the streams are split
+			SECTION_POSITIONS_SOA,	// float x[paddedCount], y[paddedCount], z[paddedCount] for the CPU (optional and never compressed)
+			SECTION_SUBMESHES,	// sSubmesh[] (every mesh has at least one)
+			SECTION_MATERIALSLOTS,	// The NUL-terminated name of each material slot that the submeshes refer to
+			SECTION_BVHNODES,	// sBvhNode[] with the root first (optional, and only with SECTION_BVHTRIANGLES)
+			SECTION_BVHTRIANGLES,	// sBvhTrianglePacket[] that the leaves of the BVH refer to
+		};
+
+		// The number of positions in each of the SoA arrays
+		inline uint32_t GetPaddedCount_soa(const uint32_t i_vertexCount)
+		{
+			return (i_vertexCount + 3) & ~3u;
+		}
+
+		// Bounding volumes in the mesh's local space
+		struct sBounds
+		{
+			float aabbMin[3];
+			float aabbMax[3];
+			float sphere[4];	// center xyz, radius
+		};
+
+		struct sVertex
+		{
+			float x, y, z;
+			float u, v;
+			uint8_t r, g, b, a;
+		};
+
+		// Meshes with split streams store the positions as float[3] and everything else as these
+		struct sVertexAttributes
+		{
+			float u, v;
+			uint8_t r, g, b, a;
+		};
+
+		// A contiguous range of the index buffer that draws one level of detail.
+		// The geometric error is the approximate distance (in mesh units)
+		// that the simplified surface deviates from the original one
+		struct sLod
+		{
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			float geometricError;
+		};
+
+		// A small group of neighboring triangles of LOD 0 (a "meshlet") that can be culled as a unit before drawing.
+		// The normal cone bounds the facing of every triangle in the cluster:
+		// the whole cluster faces away from any point p for which dot( normalize( coneApex - p ), coneAxis ) >= coneCutoff
+		// (a cutoff of 1 means that the triangles face too many directions and the cluster must never be cone culled)
+		struct sCluster
+		{
+			float boundingSphere[4];	// center xyz, radius
+			float coneApex[3];
+			float coneAxis[3];
+			float coneCutoff;
+			uint32_t firstIndex;
+			uint32_t indexCount;
+		};
+
+		// A part of the mesh that is drawn with one material.
+		// Every submesh has its own levels of detail and clusters (which are ranges of the mesh's arrays),
+		// but all of them share the mesh's vertex and index buffers.
+		// Its indices are relative to firstVertex and all have the same size, and start at indexOffset bytes into the index buffer
+		// (a level of detail or cluster that starts at index i starts at indexOffset + ( i - firstIndex ) * indexSize bytes)
+		struct sSubmesh
+		{
+			uint32_t firstIndex;	// of LOD 0
+			uint32_t indexCount;
+			uint32_t firstVertex;	// the range of vertices that the levels of detail use
+			uint32_t vertexCount;
+			uint32_t materialSlot;
+			uint32_t firstLod;
+			uint32_t lodCount;
+			uint32_t firstCluster;
+			uint32_t clusterCount;
+			uint32_t indexOffset;	// in bytes, of firstIndex in the uncompressed index section
+			uint32_t indexSize;	// of every index of the submesh
+			sBounds bounds;
+		};
+
+		// A bounding volume hierarchy over the triangles of LOD 0 of every submesh, for ray queries on the CPU.
+		// The two children of an interior node are next to each other, and a node's children always come after it
+		struct sBvhNode
+		{
+			float aabbMin[3];
+			uint32_t offset;	// of the first child for interior nodes, or of the first triangle packet for leaves
+			float aabbMax[3];
+			uint32_t packetCount;	// 0 for interior nodes
+		};
+
+		// Four triangles of a leaf in SIMD-friendly arrays, stored as their first vertex and the edges from it to the other two.
+		// The triangle indices are where each triangle is in the index buffer (divided by 3),
+		// and unused lanes are UINT32_MAX (with zero-length edges that can't be hit)
+		struct sBvhTrianglePacket
+		{
+			float vertex0[3][4];
+			float edge1[3][4];
+			float edge2[3][4];
+			uint32_t triangleIndices[4];
+		};
+
+		// No path from the root to a leaf is longer than this, which bounds the stack that traversal needs
+		const unsigned int s_maxBvhDepth = 64;
+
+		struct sFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t headerSize;	// sizeof( sFileHeader ), which is where the section directory starts
+			uint32_t flags;	// eFileFlags
+			uint32_t vertexCount;
+			uint32_t vertexSize;
+			uint32_t indexCount;
+			uint32_t indexDataSize;	// in bytes, of the uncompressed index section
+			uint32_t sectionCount;
+			uint32_t checksum;	// of everything after the header
+			sBounds bounds;
+		};
+
+		struct sSection
+		{
+			uint32_t type;	// eSectionType
+			uint32_t reserved;
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		// Adler-32
+		inline uint32_t CalculateChecksum(const uint8_t* const i_data, const size_t i_size)
+		{
+			const uint32_t modulus = 65521;
+			// The largest number of bytes that can be summed before the sums could overflow
+			const size_t maxRunLength = 5552;
+
+			uint32_t a = 1, b = 0;
+			size_t offset = 0;
+			while (offset < i_size)
+			{
+				const size_t runEnd = ((i_size - offset) > maxRunLength) ? (offset + maxRunLength) : i_size;
+				for (; offset < runEnd; ++offset)
+				{
+					a += i_data[offset];
+					b += a;
+				}
+				a %= modulus;
+				b %= modulus;
+			}
+			return (b << 16) | a;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,410 @@
+#include "MeshRaycast.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include <emmintrin.h>
+
+namespace
+{
+	using Engine::Mesh::sBvhNode;
+	using Engine::Mesh::sBvhTrianglePacket;
+	using Engine::Mesh::Raycast::sBvh;
+	using Engine::Mesh::Raycast::sHit;
+	using Engine::Mesh::Raycast::sRay;
+
+	const unsigned int s_packetSize = 4;
+
+	struct sStackEntry
+	{
+		const sBvhNode* node;
+		float distance;	// The closest that any ray enters the node
+	};
+
+	// A direction component of zero would make its inverse infinite,
+	// and multiplying that by the zero distance to a box's face would be NaN
+	float GetSafeInverse(const float i_value)
+	{
+		const float minimumMagnitude = 1.0e-20f;
+		return 1.0f / ((std::fabs(i_value) >= minimumMagnitude) ? i_value : ((i_value < 0.0f) ? -minimumMagnitude : minimumMagnitude));
+	}
+
+	float GetMinimum(__m128 i_values)
+	{
+		i_values = _mm_min_ps(i_values, _mm_shuffle_ps(i_values, i_values, _MM_SHUFFLE(2, 3, 0, 1)));
+		i_values = _mm_min_ps(i_values, _mm_shuffle_ps(i_values, i_values, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(i_values);
+	}
+	float GetMaximum(__m128 i_values)
+	{
+		i_values = _mm_max_ps(i_values, _mm_shuffle_ps(i_values, i_values, _MM_SHUFFLE(2, 3, 0, 1)));
+		i_values = _mm_max_ps(i_values, _mm_shuffle_ps(i_values, i_values, _MM_SHUFFLE(1, 0, 3, 2)));
+		return _mm_cvtss_f32(i_values);
+	}
+
+	__m128 Select(const __m128 i_mask, const __m128 i_ifTrue, const __m128 i_ifFalse)
+	{
+		return _mm_or_ps(_mm_and_ps(i_mask, i_ifTrue), _mm_andnot_ps(i_mask, i_ifFalse));
+	}
+
+	// Moller-Trumbore for 4 ray/triangle pairs, where either the ray or the triangle can be the same in every lane.
+	// Returns a mask of the lanes whose ray hits its triangle between 0 and its max distance
+	// (triangles with zero area are never hit, because their determinant is zero)
+	__m128 IntersectTriangles(const __m128 i_origin[3], const __m128 i_direction[3],
+		const __m128 i_vertex0[3], const __m128 i_edge1[3], const __m128 i_edge2[3], const __m128 i_maxDistance,
+		__m128& o_distance, __m128& o_u, __m128& o_v)
+	{
+		const __m128 p[3] =
+		{
+			_mm_sub_ps(_mm_mul_ps(i_direction[1], i_edge2[2]), _mm_mul_ps(i_direction[2], i_edge2[1])),
+			_mm_sub_ps(_mm_mul_ps(i_direction[2], i_edge2[0]), _mm_mul_ps(i_direction[0], i_edge2[2])),
+			_mm_sub_ps(_mm_mul_ps(i_direction[0], i_edge2[1]), _mm_mul_ps(i_direction[1], i_edge2[0])),
+		};
+		const __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(i_edge1[0], p[0]), _mm_mul_ps(i_edge1[1], p[1])), _mm_mul_ps(i_edge1[2], p[2]));
+		const __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+		const __m128 s[3] = { _mm_sub_ps(i_origin[0], i_vertex0[0]), _mm_sub_ps(i_origin[1], i_vertex0[1]), _mm_sub_ps(i_origin[2], i_vertex0[2]) };
+		o_u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(s[0], p[0]), _mm_mul_ps(s[1], p[1])), _mm_mul_ps(s[2], p[2])), inverseDeterminant);
+		const __m128 q[3] =
+		{
+			_mm_sub_ps(_mm_mul_ps(s[1], i_edge1[2]), _mm_mul_ps(s[2], i_edge1[1])),
+			_mm_sub_ps(_mm_mul_ps(s[2], i_edge1[0]), _mm_mul_ps(s[0], i_edge1[2])),
+			_mm_sub_ps(_mm_mul_ps(s[0], i_edge1[1]), _mm_mul_ps(s[1], i_edge1[0])),
+		};
+		o_v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(i_direction[0], q[0]), _mm_mul_ps(i_direction[1], q[1])), _mm_mul_ps(i_direction[2], q[2])),
+			inverseDeterminant);
+		o_distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(i_edge2[0], q[0]), _mm_mul_ps(i_edge2[1], q[1])), _mm_mul_ps(i_edge2[2], q[2])),
+			inverseDeterminant);
+
+		const __m128 zero = _mm_setzero_ps();
+		__m128 mask = _mm_cmpneq_ps(determinant, zero);
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(o_u, zero));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(o_v, zero));
+		mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(o_u, o_v), _mm_set1_ps(1.0f)));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(o_distance, zero));
+		return _mm_and_ps(mask, _mm_cmplt_ps(o_distance, i_maxDistance));
+	}
+
+	// Returns the distance at which a single ray enters the node's box, or FLT_MAX if it doesn't before the max distance
+	float IntersectBox(const sBvhNode& i_node, const __m128 i_origin, const __m128 i_inverseDirection, const float i_maxDistance)
+	{
+		const __m128 distances_min = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(i_node.aabbMin), i_origin), i_inverseDirection);
+		const __m128 distances_max = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(i_node.aabbMax), i_origin), i_inverseDirection);
+		// The fourth lane was loaded from the node's offset or packet count, and so it's replaced with the first lane
+		__m128 entries = _mm_min_ps(distances_min, distances_max);
+		__m128 exits = _mm_max_ps(distances_min, distances_max);
+		entries = _mm_shuffle_ps(entries, entries, _MM_SHUFFLE(0, 2, 1, 0));
+		exits = _mm_shuffle_ps(exits, exits, _MM_SHUFFLE(0, 2, 1, 0));
+		const float entry = std::max(GetMaximum(entries), 0.0f);
+		const float exit = std::min(GetMinimum(exits), i_maxDistance);
+		return (entry <= exit) ? entry : FLT_MAX;
+	}
+
+	// Returns a mask of the rays that enter the node's box before their max distance
+	__m128 IntersectBox(const sBvhNode& i_node, const __m128 i_origin[3], const __m128 i_inverseDirection[3], const __m128 i_maxDistance,
+		__m128& o_entry)
+	{
+		__m128 entry = _mm_setzero_ps();
+		__m128 exit = i_maxDistance;
+		for (unsigned int axis = 0; axis < 3; ++axis)
+		{
+			const __m128 distance_min = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(i_node.aabbMin[axis]), i_origin[axis]), i_inverseDirection[axis]);
+			const __m128 distance_max = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(i_node.aabbMax[axis]), i_origin[axis]), i_inverseDirection[axis]);
+			entry = _mm_max_ps(entry, _mm_min_ps(distance_min, distance_max));
+			exit = _mm_min_ps(exit, _mm_max_ps(distance_min, distance_max));
+		}
+		o_entry = entry;
+		return _mm_cmple_ps(entry, exit);
+	}
+
+	// Pops nodes until one is found that might still be closer than the closest hit
+	bool PopNode(const sStackEntry* const i_stack, unsigned int& io_stackSize, const float i_maxDistance, const sBvhNode*& o_node)
+	{
+		while (io_stackSize > 0)
+		{
+			const sStackEntry& entry = i_stack[--io_stackSize];
+			if (entry.distance <= i_maxDistance)
+			{
+				o_node = entry.node;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Up to 4 rays are traced together, and the lanes of the rest are inactive (with a negative max distance)
+	void IntersectRays_packet(const sBvh& i_bvh, const sRay* const i_rays, const size_t i_rayCount, sHit* const o_hits)
+	{
+		float origins[3][s_packetSize], directions[3][s_packetSize], inverseDirections[3][s_packetSize], maxDistances[s_packetSize];
+		for (unsigned int lane = 0; lane < s_packetSize; ++lane)
+		{
+			const sRay& ray = i_rays[(lane < i_rayCount) ? lane : 0];
+			for (unsigned int axis = 0; axis < 3; ++axis)
+			{
+				origins[axis][lane] = ray.origin[axis];
+				directions[axis][lane] = ray.direction[axis];
+				inverseDirections[axis][lane] = GetSafeInverse(ray.direction[axis]);
+			}
+			maxDistances[lane] = (lane < i_rayCount) ? ray.maxDistance : -1.0f;
+		}
+		__m128 origin[3], direction[3], inverseDirection[3];
+		for (unsigned int axis = 0; axis < 3; ++axis)
+		{
+			origin[axis] = _mm_loadu_ps(origins[axis]);
+			direction[axis] = _mm_loadu_ps(directions[axis]);
+			inverseDirection[axis] = _mm_loadu_ps(inverseDirections[axis]);
+		}
+		__m128 closestDistance = _mm_loadu_ps(maxDistances);
+		__m128 closestU = _mm_setzero_ps(), closestV = _mm_setzero_ps();
+		__m128 closestTriangle = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(Engine::Mesh::Raycast::s_noHit)));
+
+		sStackEntry stack[Engine::Mesh::s_maxBvhDepth];
+		unsigned int stackSize = 0;
+		const sBvhNode* node = i_bvh.nodes;
+		{
+			__m128 entry;
+			if (_mm_movemask_ps(IntersectBox(*node, origin, inverseDirection, closestDistance, entry)) == 0)
+			{
+				node = NULL;
+			}
+		}
+		while (node)
+		{
+			if (node->packetCount > 0)
+			{
+				for (uint32_t i = node->offset; i < (node->offset + node->packetCount); ++i)
+				{
+					const sBvhTrianglePacket& packet = i_bvh.packets[i];
+					for (unsigned int lane = 0; lane < s_packetSize; ++lane)
+					{
+						if (packet.triangleIndices[lane] == Engine::Mesh::Raycast::s_noHit)
+						{
+							continue;
+						}
+						const __m128 vertex0[3] =
+							{ _mm_set1_ps(packet.vertex0[0][lane]), _mm_set1_ps(packet.vertex0[1][lane]), _mm_set1_ps(packet.vertex0[2][lane]) };
+						const __m128 edge1[3] =
+							{ _mm_set1_ps(packet.edge1[0][lane]), _mm_set1_ps(packet.edge1[1][lane]), _mm_set1_ps(packet.edge1[2][lane]) };
+						const __m128 edge2[3] =
+							{ _mm_set1_ps(packet.edge2[0][lane]), _mm_set1_ps(packet.edge2[1][lane]), _mm_set1_ps(packet.edge2[2][lane]) };
+						__m128 distance, u, v;
+						const __m128 mask = IntersectTriangles(origin, direction, vertex0, edge1, edge2, closestDistance, distance, u, v);
+						if (_mm_movemask_ps(mask) != 0)
+						{
+							closestDistance = Select(mask, distance, closestDistance);
+							closestU = Select(mask, u, closestU);
+							closestV = Select(mask, v, closestV);
+							closestTriangle = Select(mask, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(packet.triangleIndices[lane]))), closestTriangle);
+						}
+					}
+				}
+				if (!PopNode(stack, stackSize, GetMaximum(closestDistance), node))
+				{
+					break;
+				}
+				continue;
+			}
+
+			const sBvhNode* const children = i_bvh.nodes + node->offset;
+			__m128 entries[2];
+			const __m128 masks[2] =
+			{
+				IntersectBox(children[0], origin, inverseDirection, closestDistance, entries[0]),
+				IntersectBox(children[1], origin, inverseDirection, closestDistance, entries[1]),
+			};
+			const int areChildrenHit[2] = { _mm_movemask_ps(masks[0]), _mm_movemask_ps(masks[1]) };
+			if ((areChildrenHit[0] != 0) && (areChildrenHit[1] != 0))
+			{
+				// The child that any of the rays enters first is visited first
+				const __m128 infinity = _mm_set1_ps(FLT_MAX);
+				const float distances[2] = { GetMinimum(Select(masks[0], entries[0], infinity)), GetMinimum(Select(masks[1], entries[1], infinity)) };
+				const unsigned int nearChild = (distances[1] < distances[0]) ? 1 : 0;
+				const sStackEntry farEntry = { children + (1 - nearChild), distances[1 - nearChild] };
+				stack[stackSize++] = farEntry;
+				node = children + nearChild;
+			}
+			else if (areChildrenHit[0] != 0)
+			{
+				node = children;
+			}
+			else if (areChildrenHit[1] != 0)
+			{
+				node = children + 1;
+			}
+			else if (!PopNode(stack, stackSize, GetMaximum(closestDistance), node))
+			{
+				break;
+			}
+		}
+
+		float distances[s_packetSize], us[s_packetSize], vs[s_packetSize];
+		uint32_t triangles[s_packetSize];
+		_mm_storeu_ps(distances, closestDistance);
+		_mm_storeu_ps(us, closestU);
+		_mm_storeu_ps(vs, closestV);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(triangles), _mm_castps_si128(closestTriangle));
+		for (size_t lane = 0; lane < i_rayCount; ++lane)
+		{
+			sHit& hit = o_hits[lane];
+			hit.distance = distances[lane];
+			hit.barycentrics[0] = us[lane];
+			hit.barycentrics[1] = vs[lane];
+			hit.triangleIndex = triangles[lane];
+		}
+	}
+}
+
+namespace Engine
+{
+	namespace Mesh
+	{
+		namespace Raycast
+		{
+			bool IsValid(const sBvh& i_bvh, const uint32_t i_triangleCount)
+			{
+				if (i_bvh.nodeCount == 0)
+				{
+					return false;
+				}
+				// Children always come after their parent, and so the depth of every node is known by the time that it's reached
+				std::vector<uint8_t> depths(i_bvh.nodeCount, 0);
+				for (uint32_t i = 0; i < i_bvh.nodeCount; ++i)
+				{
+					const sBvhNode& node = i_bvh.nodes[i];
+					if (node.packetCount == 0)
+					{
+						const unsigned int childDepth = depths[i] + 1u;
+						if ((node.offset <= i) || (node.offset >= (i_bvh.nodeCount - 1)) || (childDepth >= s_maxBvhDepth))
+						{
+							return false;
+						}
+						depths[node.offset] = std::max(depths[node.offset], static_cast<uint8_t>(childDepth));
+						depths[node.offset + 1] = std::max(depths[node.offset + 1], static_cast<uint8_t>(childDepth));
+					}
+					else if ((node.offset > i_bvh.packetCount) || (node.packetCount > (i_bvh.packetCount - node.offset)))
+					{
+						return false;
+					}
+				}
+				for (uint32_t i = 0; i < i_bvh.packetCount; ++i)
+				{
+					for (unsigned int lane = 0; lane < s_packetSize; ++lane)
+					{
+						const uint32_t triangleIndex = i_bvh.packets[i].triangleIndices[lane];
+						if ((triangleIndex != s_noHit) && (triangleIndex >= i_triangleCount))
+						{
+							return false;
+						}
+					}
+				}
+				return true;
+			}
+
+			bool IntersectRay(const sBvh& i_bvh, const sRay& i_ray, sHit& o_hit)
+			{
+				o_hit.distance = i_ray.maxDistance;
+				o_hit.barycentrics[0] = o_hit.barycentrics[1] = 0.0f;
+				o_hit.triangleIndex = s_noHit;
+
+				const __m128 origin_aos = _mm_setr_ps(i_ray.origin[0], i_ray.origin[1], i_ray.origin[2], 0.0f);
+				const __m128 inverseDirection_aos = _mm_setr_ps(GetSafeInverse(i_ray.direction[0]), GetSafeInverse(i_ray.direction[1]),
+					GetSafeInverse(i_ray.direction[2]), 0.0f);
+				// Each triangle of a packet is tested in its own lane
+				const __m128 origin[3] = { _mm_set1_ps(i_ray.origin[0]), _mm_set1_ps(i_ray.origin[1]), _mm_set1_ps(i_ray.origin[2]) };
+				const __m128 direction[3] = { _mm_set1_ps(i_ray.direction[0]), _mm_set1_ps(i_ray.direction[1]), _mm_set1_ps(i_ray.direction[2]) };
+
+				sStackEntry stack[s_maxBvhDepth];
+				unsigned int stackSize = 0;
+				const sBvhNode* node = i_bvh.nodes;
+				if ((i_bvh.nodeCount == 0) || (IntersectBox(*node, origin_aos, inverseDirection_aos, o_hit.distance) == FLT_MAX))
+				{
+					return false;
+				}
+				while (node)
+				{
+					if (node->packetCount > 0)
+					{
+						for (uint32_t i = node->offset; i < (node->offset + node->packetCount); ++i)
+						{
+							const sBvhTrianglePacket& packet = i_bvh.packets[i];
+							const __m128 vertex0[3] = { _mm_loadu_ps(packet.vertex0[0]), _mm_loadu_ps(packet.vertex0[1]), _mm_loadu_ps(packet.vertex0[2]) };
+							const __m128 edge1[3] = { _mm_loadu_ps(packet.edge1[0]), _mm_loadu_ps(packet.edge1[1]), _mm_loadu_ps(packet.edge1[2]) };
+							const __m128 edge2[3] = { _mm_loadu_ps(packet.edge2[0]), _mm_loadu_ps(packet.edge2[1]), _mm_loadu_ps(packet.edge2[2]) };
+							__m128 distance, u, v;
+							const int mask = _mm_movemask_ps(
+								IntersectTriangles(origin, direction, vertex0, edge1, edge2, _mm_set1_ps(o_hit.distance), distance, u, v));
+							if (mask != 0)
+							{
+								float distances[s_packetSize], us[s_packetSize], vs[s_packetSize];
+								_mm_storeu_ps(distances, distance);
+								_mm_storeu_ps(us, u);
+								_mm_storeu_ps(vs, v);
+								for (unsigned int lane = 0; lane < s_packetSize; ++lane)
+								{
+									if (((mask & (1 << lane)) != 0) && (distances[lane] < o_hit.distance))
+									{
+										o_hit.distance = distances[lane];
+										o_hit.barycentrics[0] = us[lane];
+										o_hit.barycentrics[1] = vs[lane];
+										o_hit.triangleIndex = packet.triangleIndices[lane];
+									}
+								}
+							}
+						}
+						if (!PopNode(stack, stackSize, o_hit.distance, node))
+						{
+							break;
+						}
+						continue;
+					}
+
+					const sBvhNode* const children = i_bvh.nodes + node->offset;
+					const float distances[2] =
+					{
+						IntersectBox(children[0], origin_aos, inverseDirection_aos, o_hit.distance),
+						IntersectBox(children[1], origin_aos, inverseDirection_aos, o_hit.distance),
+					};
+					if ((distances[0] != FLT_MAX) && (distances[1] != FLT_MAX))
+					{
+						const unsigned int nearChild = (distances[1] < distances[0]) ? 1 : 0;
+						const sStackEntry farEntry = { children + (1 - nearChild), distances[1 - nearChild] };
+						stack[stackSize++] = farEntry;
+						node = children + nearChild;
+					}
+					else if (distances[0] != FLT_MAX)
+					{
+						node = children;
+					}
+					else if (distances[1] != FLT_MAX)
+					{
+						node = children + 1;
+					}
+					else if (!PopNode(stack, stackSize, o_hit.distance, node))
+					{
+						break;
+					}
+				}
+				return o_hit.triangleIndex != s_noHit;
+			}
+
+			void IntersectRays(const sBvh& i_bvh, const sRay* const i_rays, const size_t i_rayCount, sHit* const o_hits)
+			{
+				for (size_t i = 0; i < i_rayCount; i += s_packetSize)
+				{
+					const size_t rayCount = std::min(i_rayCount - i, static_cast<size_t>(s_packetSize));
+					if (i_bvh.nodeCount > 0)
+					{
+						IntersectRays_packet(i_bvh, i_rays + i, rayCount, o_hits + i);
+					}
+					else
+					{
+						for (size_t j = 0; j < rayCount; ++j)
+						{
+							IntersectRay(i_bvh, i_rays[i + j], o_hits[i + j]);
+						}
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef MESHRAYCAST_H
+#define MESHRAYCAST_H
+
+// Ray queries against the bounding volume hierarchy that MeshBuilder stores in a mesh (with the "bvh" argument).
+//
+// A single ray is tested against the 4 triangles of a packet at once,
+// and batches of rays are traced 4 at a time through the hierarchy together
+// (which is faster when the rays are coherent, like the rays through neighboring pixels,
+// because each node is then only loaded once for all 4).
+// This doesn't depend on the rest of the engine so that tools and benchmarks can use it too.
+
+#include "MeshFormat.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine
+{
+	namespace Mesh
+	{
+		namespace Raycast
+		{
+			// The triangle index of a ray that didn't hit anything
+			const uint32_t s_noHit = UINT32_MAX;
+
+			// Rays are in the mesh's local space.
+			// The direction doesn't have to be normalized, and distances are measured in multiples of its length
+			struct sRay
+			{
+				float origin[3];
+				float direction[3];
+				float maxDistance;
+			};
+
+			// The point that was hit is origin + ( direction * distance ),
+			// and it's also vertex0 + ( ( vertex1 - vertex0 ) * barycentrics[0] ) + ( ( vertex2 - vertex0 ) * barycentrics[1] )
+			// where the vertices are in the order of the triangle in the built mesh
+			struct sHit
+			{
+				float distance;
+				float barycentrics[2];
+				uint32_t triangleIndex;	// The triangle's first index is at triangleIndex * 3
+			};
+
+			struct sBvh
+			{
+				const sBvhNode* nodes;
+				uint32_t nodeCount;
+				const sBvhTrianglePacket* packets;
+				uint32_t packetCount;
+			};
+
+			// Makes sure that traversing the BVH can't read outside of its arrays or overflow its stack,
+			// and that every triangle index is less than the given triangle count
+			bool IsValid(const sBvh& i_bvh, const uint32_t i_triangleCount);
+
+			// Finds the closest hit between 0 and the ray's max distance, and returns false if there isn't one
+			bool IntersectRay(const sBvh& i_bvh, const sRay& i_ray, sHit& o_hit);
+			// Finds the closest hit of every ray
+			// (the rays that don't hit anything have s_noHit as their triangle index)
+			void IntersectRays(const sBvh& i_bvh, const sRay* const i_rays, const size_t i_rayCount, sHit* const o_hits);
+		}
+	}
+}
+
+#endif
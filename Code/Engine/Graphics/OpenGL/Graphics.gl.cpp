@@ -31,7 +31,7 @@ Engine::Graphics::GraphicsData::GraphicsData() :
 #ifdef GRAPHICS_ISDEVICEDEBUGINFOENABLED
 	s_vertexBufferId(0),
 #endif
-	s_camPos(nullptr), s_camOri(nullptr), s_camera(nullptr)
+	s_camPos(nullptr), s_camOri(nullptr), s_camera(nullptr), s_aspectRatio(1.0f)
 {
 	s_camPos = new Engine::Math::cVector(0.0f, 1.5f, 10.0f);
 	s_camOri = new Engine::Math::cQuaternion;
@@ -67,16 +67,71 @@ void Engine::Graphics::GraphicsData::RenderFrame()
 
 	for (std::vector<Engine::Graphics::DrawCallData>::iterator it = s_MeshList.begin(); it != s_MeshList.end(); ++it)
 	{
-		it->s_mat->Bind();
+		Engine::Mesh::sViewVolume viewVolume;
+		viewVolume.transform_localToWorld = it->s_drawCall.g_transform_localToWorld;
+		viewVolume.transform_worldToCamera = s_Frame.g_transform_worldToCamera;
+		viewVolume.cameraPosition_world = s_camera->Pos();
+		viewVolume.fieldOfView_y = s_camera->fov();
+		viewVolume.aspectRatio = s_aspectRatio;
+		viewVolume.z_nearPlane = s_camera->nearPlaneDist();
+		viewVolume.z_farPlane = s_camera->farPlaneDist();
+		if (!it->s_mesh->IsVisible(viewVolume))
+		{
+			continue;
+		}
+
 		s_Draw = it->s_drawCall;
 		s_DrawBuffer.Update(reinterpret_cast<void*>(&s_Draw));
-		it->s_mesh->Draw();
+		const float distanceToCamera = (it->s_pos - s_camera->Pos()).GetLength();
+		// All of the submeshes share the mesh's buffers, and so only the material and the index ranges change between them
+		const unsigned int submeshCount = it->s_mesh->GetSubmeshCount();
+		Engine::Graphics::Materials::Material* boundMaterial = NULL;
+		for (unsigned int i = 0; i < submeshCount; ++i)
+		{
+			if ((submeshCount > 1) && !it->s_mesh->IsSubmeshVisible(viewVolume, i))
+			{
+				continue;
+			}
+			const unsigned int materialSlot = it->s_mesh->GetSubmesh(i).materialSlot;
+			Engine::Graphics::Materials::Material* const material =
+				((materialSlot < it->s_slotMats.size()) && it->s_slotMats[materialSlot]) ? it->s_slotMats[materialSlot] : it->s_mat;
+			if (material != boundMaterial)
+			{
+				material->Bind();
+				boundMaterial = material;
+			}
+			const unsigned int lodIndex = it->s_mesh->SelectLod(distanceToCamera, i);
+			if ((lodIndex == 0) && (it->s_mesh->GetClusterCount(i) > 0))
+			{
+				it->s_mesh->DrawVisibleClusters(viewVolume, i);
+			}
+			else
+			{
+				it->s_mesh->Draw(lodIndex, i);
+			}
+		}
 	}
 	s_MeshList.clear();
 
+	// Sprites are drawn in the order that they were submitted,
+	// but consecutive sprites that use the same material and atlas page only bind them once
+	Engine::Graphics::Materials::Material* boundMaterial = NULL;
+	const cTexture* boundTexture = NULL;
 	for (std::vector<Engine::Graphics::SpriteCallData>::iterator it = s_SprList.begin(); it != s_SprList.end(); ++it)
 	{
-		it->s_mat->Bind();
+		const cTexture* const texture = it->s_sprite->GetTexture();
+		// A sprite that isn't in an atlas needs its material's texture, and so an atlas page that is bound must be replaced
+		if ((it->s_mat != boundMaterial) || (!texture && boundTexture))
+		{
+			it->s_mat->Bind();
+			boundMaterial = it->s_mat;
+			boundTexture = NULL;
+		}
+		if (texture && (texture != boundTexture))
+		{
+			texture->Bind(0);
+			boundTexture = texture;
+		}
 		it->s_sprite->Draw();
 	}
 	s_SprList.clear();
@@ -84,6 +139,8 @@ void Engine::Graphics::GraphicsData::RenderFrame()
 		BOOL result = SwapBuffers(s_deviceContext);
 		ASSERT(result != FALSE);
 	}
+
+	cTexture::StreamMipLevels(s_textureStreamingBytesPerFrame);
 }
 
 void Engine::Graphics::GraphicsData::SetMesh(Engine::Graphics::MeshData& i_mesh)
@@ -95,7 +152,9 @@ void Engine::Graphics::GraphicsData::SetMesh(Engine::Graphics::MeshData& i_mesh)
 	tempDraw.g_transform_localToWorld = tempMat;
 	Engine::Graphics::DrawCallData s_data;
 	s_data.s_mesh = i_mesh.s_mesh;
+	s_data.s_pos = i_mesh.s_pos;
 	s_data.s_mat = i_mesh.s_mat;
+	s_data.s_slotMats = i_mesh.s_slotMats;
 	s_data.s_drawCall = tempDraw;
 	s_MeshList.push_back(s_data);
 }
@@ -202,7 +261,8 @@ bool Engine::Graphics::GraphicsData::CreateConstantBuffer()
 
 	s_Frame.g_elapsedSecondCount_total = Engine::Time::GetElapsedSecondCount_total();
 	s_Frame.g_transform_worldToCamera = Engine::Math::cMatrix_transformation::CreateWorldToCameraTransform(s_camera->Ori(), s_camera->Pos());
-	s_Frame.g_transform_cameraToScreen = Engine::Math::cMatrix_transformation::CreateCameraToProjectedTransform(s_camera->fov(), static_cast<float>(m_viewport[2] / m_viewport[3]), s_camera->nearPlaneDist(), s_camera->farPlaneDist());
+	s_aspectRatio = static_cast<float>(m_viewport[2] / m_viewport[3]);
+	s_Frame.g_transform_cameraToScreen = Engine::Math::cMatrix_transformation::CreateCameraToProjectedTransform(s_camera->fov(), s_aspectRatio, s_camera->nearPlaneDist(), s_camera->farPlaneDist());
 
 	if (!s_FrameBuffer.Initialize(Engine::ConstantBuffer::sBufferType::frameType, sizeof(Engine::ConstantBuffer::sFrame), reinterpret_cast<void*>(&s_Frame)))
 	{
@@ -3,215 +3,216 @@
 #include "../../Logging/Logging.h"
 #include "../../../External/Lua/Includes.h"
 
-namespace Engine
+namespace
 {
-	namespace Mesh
+	bool CreateVertexArray(GLuint& o_vertexArrayId)
 	{
-		bool Mesh::Initialize()
+		const GLsizei arrayCount = 1;
+		glGenVertexArrays(arrayCount, &o_vertexArrayId);
+		const GLenum errorCode = glGetError();
+		if (errorCode == GL_NO_ERROR)
 		{
-			bool wereThereErrors = false;
-			GLuint vertexBufferId = 0;
-			GLuint indexBufferId = 0;
+			glBindVertexArray(o_vertexArrayId);
+			const GLenum errorCode = glGetError();
+			if (errorCode != GL_NO_ERROR)
+			{
+				ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				Engine::Logging::OutputError("OpenGL failed to bind the vertex array: %s",
+					reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				return false;
+			}
+		}
+		else
+		{
+			ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+			Engine::Logging::OutputError("OpenGL failed to get an unused vertex array ID: %s",
+				reinterpret_cast<const char*>(gluErrorString(errorCode)));
+			return false;
+		}
+		return true;
+	}
 
+	bool CreateBuffer(const GLenum i_target, const unsigned int i_size, const void* const i_data, GLuint& o_bufferId, const char* const i_bufferName)
+	{
+		{
+			const GLsizei bufferCount = 1;
+			glGenBuffers(bufferCount, &o_bufferId);
+			const GLenum errorCode = glGetError();
+			if (errorCode == GL_NO_ERROR)
 			{
-				const GLsizei arrayCount = 1;
-				glGenVertexArrays(arrayCount, &s_vertexArrayId);
+				glBindBuffer(i_target, o_bufferId);
 				const GLenum errorCode = glGetError();
-				if (errorCode == GL_NO_ERROR)
-				{
-					glBindVertexArray(s_vertexArrayId);
-					const GLenum errorCode = glGetError();
-					if (errorCode != GL_NO_ERROR)
-					{
-						wereThereErrors = true;
-						ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						Engine::Logging::OutputError("OpenGL failed to bind the vertex array: %s",
-							reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						goto OnExit;
-					}
-				}
-				else
+				if (errorCode != GL_NO_ERROR)
 				{
-					wereThereErrors = true;
 					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					Engine::Logging::OutputError("OpenGL failed to get an unused vertex array ID: %s",
+					Engine::Logging::OutputError("OpenGL failed to bind the %s buffer: %s", i_bufferName,
 						reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					goto OnExit;
+					return false;
 				}
 			}
+			else
+			{
+				ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				Engine::Logging::OutputError("OpenGL failed to get an unused %s buffer ID: %s", i_bufferName,
+					reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				return false;
+			}
+		}
+		{
+			glBufferData(i_target, i_size, reinterpret_cast<const GLvoid*>(i_data), GL_STATIC_DRAW);
+			const GLenum errorCode = glGetError();
+			if (errorCode != GL_NO_ERROR)
+			{
+				ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				Engine::Logging::OutputError("OpenGL failed to allocate the %s buffer: %s", i_bufferName,
+					reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				return false;
+			}
+		}
+		return true;
+	}
 
+	// The attribute reads from whichever buffer is currently bound to GL_ARRAY_BUFFER
+	bool SetVertexAttribute(const GLuint i_location, const GLint i_elementCount, const GLenum i_type, const GLboolean i_isNormalized,
+		const GLsizei i_stride, const size_t i_offset, const char* const i_attributeName)
+	{
+		glVertexAttribPointer(i_location, i_elementCount, i_type, i_isNormalized, i_stride, reinterpret_cast<GLvoid*>(i_offset));
+		const GLenum errorCode = glGetError();
+		if (errorCode == GL_NO_ERROR)
+		{
+			glEnableVertexAttribArray(i_location);
+			const GLenum errorCode = glGetError();
+			if (errorCode != GL_NO_ERROR)
 			{
-				const GLsizei bufferCount = 1;
-				glGenBuffers(bufferCount, &vertexBufferId);
-				const GLenum errorCode = glGetError();
-				if (errorCode == GL_NO_ERROR)
-				{
-					glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
-					const GLenum errorCode = glGetError();
-					if (errorCode != GL_NO_ERROR)
-					{
-						wereThereErrors = true;
-						ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						Engine::Logging::OutputError("OpenGL failed to bind the vertex buffer: %s",
-							reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						goto OnExit;
-					}
-				}
-				else
+				ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				Engine::Logging::OutputError("OpenGL failed to enable the %s vertex attribute at location %u: %s",
+					i_attributeName, i_location, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				return false;
+			}
+		}
+		else
+		{
+			ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+			Engine::Logging::OutputError("OpenGL failed to set the %s vertex attribute at location %u: %s",
+				i_attributeName, i_location, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+			return false;
+		}
+		return true;
+	}
+
+	bool DeleteBuffer(GLuint& io_bufferId, const char* const i_bufferName)
+	{
+		bool wereThereErrors = false;
+		if (io_bufferId != 0)
+		{
+			const GLsizei bufferCount = 1;
+			glDeleteBuffers(bufferCount, &io_bufferId);
+			const GLenum errorCode = glGetError();
+			if (errorCode != GL_NO_ERROR)
+			{
+				wereThereErrors = true;
+				ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				Engine::Logging::OutputError("OpenGL failed to delete the %s buffer: %s", i_bufferName,
+					reinterpret_cast<const char*>(gluErrorString(errorCode)));
+			}
+			io_bufferId = 0;
+		}
+		return !wereThereErrors;
+	}
+
+	bool DeleteVertexArray(GLuint& io_vertexArrayId)
+	{
+		bool wereThereErrors = false;
+		if (io_vertexArrayId != 0)
+		{
+			const GLsizei arrayCount = 1;
+			glDeleteVertexArrays(arrayCount, &io_vertexArrayId);
+			const GLenum errorCode = glGetError();
+			if (errorCode != GL_NO_ERROR)
+			{
+				wereThereErrors = true;
+				ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
+				Engine::Logging::OutputError("OpenGL failed to delete the vertex array: %s",
+					reinterpret_cast<const char*>(gluErrorString(errorCode)));
+			}
+			io_vertexArrayId = 0;
+		}
+		return !wereThereErrors;
+	}
+}
+
+namespace Engine
+{
+	namespace Mesh
+	{
+		bool Mesh::Initialize()
+		{
+			bool wereThereErrors = false;
+			GLuint vertexBufferId = 0;
+			GLuint attributeBufferId = 0;
+			GLuint indexBufferId = 0;
+
+			if (!CreateVertexArray(s_vertexArrayId))
+			{
+				wereThereErrors = true;
+				goto OnExit;
+			}
+			if (vertexArray != NULL)
+			{
+				const GLsizei stride = sizeof(sVertex);
+				if (!CreateBuffer(GL_ARRAY_BUFFER, s_numVertices * sizeof(sVertex), vertexArray, vertexBufferId, "vertex")
+					|| !SetVertexAttribute(0, 3, GL_FLOAT, GL_FALSE, stride, offsetof(sVertex, x), "POSITION")
+					|| !SetVertexAttribute(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, offsetof(sVertex, r), "COLOR")
+					|| !SetVertexAttribute(2, 2, GL_FLOAT, GL_FALSE, stride, offsetof(sVertex, u), "TEXCOORD"))
 				{
 					wereThereErrors = true;
-					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					Engine::Logging::OutputError("OpenGL failed to get an unused vertex buffer ID: %s",
-						reinterpret_cast<const char*>(gluErrorString(errorCode)));
 					goto OnExit;
 				}
 			}
+			else
 			{
-				const unsigned int bufferSize = s_numVertices * sizeof(sVertex);
-
-				glBufferData(GL_ARRAY_BUFFER, bufferSize, reinterpret_cast<GLvoid*>(vertexArray),
-					GL_STATIC_DRAW);
-				const GLenum errorCode = glGetError();
-				if (errorCode != GL_NO_ERROR)
+				const GLsizei positionStride = sizeof(float) * 3;
+				const GLsizei attributeStride = sizeof(sVertexAttributes);
+				if (!CreateBuffer(GL_ARRAY_BUFFER, s_numVertices * positionStride, positionArray, vertexBufferId, "position")
+					|| !SetVertexAttribute(0, 3, GL_FLOAT, GL_FALSE, positionStride, 0, "POSITION")
+					|| !CreateBuffer(GL_ARRAY_BUFFER, s_numVertices * attributeStride, attributeArray, attributeBufferId, "attribute")
+					|| !SetVertexAttribute(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, attributeStride, offsetof(sVertexAttributes, r), "COLOR")
+					|| !SetVertexAttribute(2, 2, GL_FLOAT, GL_FALSE, attributeStride, offsetof(sVertexAttributes, u), "TEXCOORD"))
 				{
 					wereThereErrors = true;
-					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					Engine::Logging::OutputError("OpenGL failed to allocate the vertex buffer: %s",
-						reinterpret_cast<const char*>(gluErrorString(errorCode)));
 					goto OnExit;
 				}
 			}
+			if (!CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, s_indexDataSize, indiceArray, indexBufferId, "index"))
 			{
-				const GLsizei stride = sizeof(sVertex);
-
-				{
-					const GLuint vertexElementLocation = 0;
-					const GLint elementCount = 3;
-					const GLboolean notNormalized = GL_FALSE;
-					glVertexAttribPointer(vertexElementLocation, elementCount, GL_FLOAT, notNormalized, stride,
-						reinterpret_cast<GLvoid*>(offsetof(sVertex, x)));
-					const GLenum errorCode = glGetError();
-					if (errorCode == GL_NO_ERROR)
-					{
-						glEnableVertexAttribArray(vertexElementLocation);
-						const GLenum errorCode = glGetError();
-						if (errorCode != GL_NO_ERROR)
-						{
-							wereThereErrors = true;
-							ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							Engine::Logging::OutputError("OpenGL failed to enable the POSITION vertex attribute at location %u: %s",
-								vertexElementLocation, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							goto OnExit;
-						}
-					}
-					else
-					{
-						wereThereErrors = true;
-						ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						Engine::Logging::OutputError("OpenGL failed to set the POSITION vertex attribute at location %u: %s",
-							vertexElementLocation, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						goto OnExit;
-					}
-				}
-				{
-					const GLuint vertexElementLocation = 1;
-					const GLint elementCount = 4;
-					const GLboolean isNormalized = GL_TRUE;	
-					glVertexAttribPointer(vertexElementLocation, elementCount, GL_UNSIGNED_BYTE, isNormalized, stride,
-						reinterpret_cast<GLvoid*>(offsetof(sVertex, r)));
-					const GLenum errorCode = glGetError();
-					if (errorCode == GL_NO_ERROR)
-					{
-						glEnableVertexAttribArray(vertexElementLocation);
-						const GLenum errorCode = glGetError();
-						if (errorCode != GL_NO_ERROR)
-						{
-							wereThereErrors = true;
-							ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							Engine::Logging::OutputError("OpenGL failed to enable the POSITION vertex attribute at location %u: %s",
-								vertexElementLocation, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							goto OnExit;
-						}
-					}
-					else
-					{
-						wereThereErrors = true;
-						ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						Engine::Logging::OutputError("OpenGL failed to set the POSITION vertex attribute at location %u: %s",
-							vertexElementLocation, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						goto OnExit;
-					}
-				}
-				{
-					const GLuint vertexElementLocation = 2;
-					const GLint elementCount = 2;
-					const GLboolean notNormalized = GL_FALSE;	
-					glVertexAttribPointer(vertexElementLocation, elementCount, GL_FLOAT, notNormalized, stride,
-						reinterpret_cast<GLvoid*>(offsetof(sVertex, u)));
-					const GLenum errorCode = glGetError();
-					if (errorCode == GL_NO_ERROR)
-					{
-						glEnableVertexAttribArray(vertexElementLocation);
-						const GLenum errorCode = glGetError();
-						if (errorCode != GL_NO_ERROR)
-						{
-							wereThereErrors = true;
-							ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							Engine::Logging::OutputError("OpenGL failed to enable the POSITION vertex attribute at location %u: %s",
-								vertexElementLocation, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							goto OnExit;
-						}
-					}
-					else
-					{
-						wereThereErrors = true;
-						ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						Engine::Logging::OutputError("OpenGL failed to set the POSITION vertex attribute at location %u: %s",
-							vertexElementLocation, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						goto OnExit;
-					}
-				}
+				wereThereErrors = true;
+				goto OnExit;
 			}
 
+			// A second vertex array that only reads the positions (the index buffer binding is part of a vertex array's state)
+			if (attributeBufferId != 0)
 			{
-				const GLsizei bufferCount = 1;
-				glGenBuffers(bufferCount, &indexBufferId);
-				const GLenum errorCode = glGetError();
-				if (errorCode == GL_NO_ERROR)
+				if (!CreateVertexArray(s_positionArrayId))
+				{
+					wereThereErrors = true;
+					goto OnExit;
+				}
+				glBindBuffer(GL_ARRAY_BUFFER, vertexBufferId);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
 				{
-					glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId);
 					const GLenum errorCode = glGetError();
 					if (errorCode != GL_NO_ERROR)
 					{
 						wereThereErrors = true;
 						ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-						Engine::Logging::OutputError("OpenGL failed to bind the index buffer: %s",
+						Engine::Logging::OutputError("OpenGL failed to bind the buffers of the position vertex array: %s",
 							reinterpret_cast<const char*>(gluErrorString(errorCode)));
 						goto OnExit;
 					}
 				}
-				else
-				{
-					wereThereErrors = true;
-					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					Engine::Logging::OutputError("OpenGL failed to get an unused index buffer ID: %s",
-						reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					goto OnExit;
-				}
-			}
-
-			{
-				const unsigned int bufferSize = s_numIndices * sizeof(uint16_t);
-
-				glBufferData(GL_ELEMENT_ARRAY_BUFFER, bufferSize, reinterpret_cast<GLvoid*>(indiceArray),
-					GL_STATIC_DRAW);
-				const GLenum errorCode = glGetError();
-				if (errorCode != GL_NO_ERROR)
+				if (!SetVertexAttribute(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 3, 0, "POSITION"))
 				{
 					wereThereErrors = true;
-					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					Engine::Logging::OutputError("OpenGL failed to allocate the index buffer: %s",
-						reinterpret_cast<const char*>(gluErrorString(errorCode)));
 					goto OnExit;
 				}
 			}
@@ -224,44 +225,19 @@ namespace Engine
 				const GLenum errorCode = glGetError();
 				if (errorCode == GL_NO_ERROR)
 				{
-					if (vertexBufferId != 0)
-					{
-#ifndef GRAPHICS_ISDEVICEDEBUGINFOENABLED
-						const GLsizei bufferCount = 1;
-						glDeleteBuffers(bufferCount, &vertexBufferId);
-						const GLenum errorCode = glGetError();
-						if (errorCode != GL_NO_ERROR)
-						{
-							wereThereErrors = true;
-							ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							Engine::Logging::OutputError("OpenGL failed to vertex buffer: %s",
-								reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							goto OnExit;
-						}
-						vertexBufferId = 0;
-#else
-						s_vertexBufferId = vertexBufferId;
-#endif
-					}
-					if (indexBufferId != 0)
-					{
 #ifndef GRAPHICS_ISDEVICEDEBUGINFOENABLED
-						const GLsizei bufferCount = 1;
-						glDeleteBuffers(bufferCount, &indexBufferId);
-						const GLenum errorCode = glGetError();
-						if (errorCode != GL_NO_ERROR)
-						{
-							wereThereErrors = true;
-							ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							Engine::Logging::OutputError("OpenGL failed to index buffer: %s",
-								reinterpret_cast<const char*>(gluErrorString(errorCode)));
-							goto OnExit;
-						}
-						indexBufferId = 0;
+					// The vertex arrays keep the buffers alive, and so their names can be deleted right away
+					if (!DeleteBuffer(vertexBufferId, "vertex"))
+						wereThereErrors = true;
+					if (!DeleteBuffer(attributeBufferId, "attribute"))
+						wereThereErrors = true;
+					if (!DeleteBuffer(indexBufferId, "index"))
+						wereThereErrors = true;
 #else
-						s_indexBufferId = indexBufferId;
+					s_vertexBufferId = vertexBufferId;
+					s_attributeBufferId = attributeBufferId;
+					s_indexBufferId = indexBufferId;
 #endif
-					}
 				}
 				else
 				{
@@ -269,7 +245,6 @@ namespace Engine
 					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
 					Engine::Logging::OutputError("OpenGL failed to unbind the vertex array: %s",
 						reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					goto OnExit;
 				}
 			}
 
@@ -281,66 +256,39 @@ namespace Engine
 			bool wereThereErrors = false;
 			
 #ifdef GRAPHICS_ISDEVICEDEBUGINFOENABLED
-			if (s_vertexBufferId != 0)
-			{
-				const GLsizei bufferCount = 1;
-				glDeleteBuffers(bufferCount, &s_vertexBufferId);
-				const GLenum errorCode = glGetError();
-				if (errorCode != GL_NO_ERROR)
-				{
-					wereThereErrors = true;
-					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					Logging::OutputError("OpenGL failed to delete the vertex buffer: %s",
-						reinterpret_cast<const char*>(gluErrorString(errorCode)));
-				}
-				s_vertexBufferId = 0;
-			}
-			if (s_indexBufferId != 0)
-			{
-				const GLsizei bufferCount = 1;
-				glDeleteBuffers(bufferCount, &s_indexBufferId);
-				const GLenum errorCode = glGetError();
-				if (errorCode != GL_NO_ERROR)
-				{
-					wereThereErrors = true;
-					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					Logging::OutputError("OpenGL failed to delete the index buffer: %s",
-						reinterpret_cast<const char*>(gluErrorString(errorCode)));
-				}
-				s_indexBufferId = 0;
-			}
+			if (!DeleteBuffer(s_vertexBufferId, "vertex"))
+				wereThereErrors = true;
+			if (!DeleteBuffer(s_attributeBufferId, "attribute"))
+				wereThereErrors = true;
+			if (!DeleteBuffer(s_indexBufferId, "index"))
+				wereThereErrors = true;
 #endif
 			
-			if (s_vertexArrayId != 0)
-			{
-				const GLsizei arrayCount = 1;
-				glDeleteVertexArrays(arrayCount, &s_vertexArrayId);
-				const GLenum errorCode = glGetError();
-				if (errorCode != GL_NO_ERROR)
-				{
-					wereThereErrors = true;
-					ASSERTF(false, reinterpret_cast<const char*>(gluErrorString(errorCode)));
-					Logging::OutputError("OpenGL failed to delete the vertex array: %s",
-						reinterpret_cast<const char*>(gluErrorString(errorCode)));
-				}
-				s_vertexArrayId = 0;
-			}
+			if (!DeleteVertexArray(s_vertexArrayId))
+				wereThereErrors = true;
+			if (!DeleteVertexArray(s_positionArrayId))
+				wereThereErrors = true;
+			Platform::UnmapFile(s_mappedFile);
 			return !wereThereErrors;
 		}
 
-		void Mesh::Draw()
+		void Mesh::Bind(const sSubmesh&, const bool i_positionsOnly)
 		{
-			{
-				glBindVertexArray(s_vertexArrayId);
-				ASSERT(glGetError() == GL_NO_ERROR);
-			}
-			{
-				const GLenum mode = GL_TRIANGLES;
-				const GLenum indexType = GL_UNSIGNED_SHORT;
-				const GLvoid* const offset = 0;
-				glDrawElements(mode, s_numIndices, indexType, offset);
-				ASSERT(glGetError() == GL_NO_ERROR);
-			}
+			// The index buffer is part of the vertex array's state, and the submesh's index size is only needed when drawing
+			glBindVertexArray((i_positionsOnly && (s_positionArrayId != 0)) ? s_positionArrayId : s_vertexArrayId);
+			ASSERT(glGetError() == GL_NO_ERROR);
+		}
+
+		void Mesh::DrawIndices(const sSubmesh& i_submesh, const uint32_t i_firstIndex, const uint32_t i_indexCount)
+		{
+			const GLenum mode = GL_TRIANGLES;
+			const GLenum indexType = (i_submesh.indexSize == sizeof(uint16_t)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+			const GLvoid* const offset = reinterpret_cast<GLvoid*>(
+				static_cast<uintptr_t>(i_submesh.indexOffset + ((i_firstIndex - i_submesh.firstIndex) * i_submesh.indexSize)));
+			// The submesh's indices are relative to its first vertex
+			const GLint baseVertex = static_cast<GLint>(i_submesh.firstVertex);
+			glDrawElementsBaseVertex(mode, static_cast<GLsizei>(i_indexCount), indexType, offset, baseVertex);
+			ASSERT(glGetError() == GL_NO_ERROR);
 		}
 	}
 }
\ No newline at end of file
@@ -4,15 +4,25 @@
 #include "../../Asserts/Asserts.h"
 #include "../../Logging/Logging.h"
 
+namespace
+{
+	GLenum GetGlFormat( const Engine::Graphics::TextureFormats::eFormat i_format );
+	GLenum GetGlTarget( const Engine::Graphics::TextureTypes::eType i_type );
+}
+
 void Engine::Graphics::cTexture::Bind( const unsigned int i_id ) const
 {
+	if ( m_streamingState )
+	{
+		m_streamingState->wasBoundRecently = true;
+	}
 	{
 		glActiveTexture( GL_TEXTURE0 + static_cast<GLint>( i_id ) );
 		ASSERT( glGetError() == GL_NO_ERROR );
 	}
 	{
 		ASSERT( m_textureId != 0 );
-		glBindTexture( GL_TEXTURE_2D, m_textureId );
+		glBindTexture( m_target, m_textureId );
 		ASSERT( glGetError() == GL_NO_ERROR );
 	}
 }
@@ -21,6 +31,7 @@ bool Engine::Graphics::cTexture::CleanUp()
 {
 	bool wereThereErrors = false;
 
+	StopStreaming();
 	if ( m_textureId != 0 )
 	{
 		const GLsizei textureCount = 1;
@@ -41,7 +52,18 @@ bool Engine::Graphics::cTexture::CleanUp()
 
 bool Engine::Graphics::cTexture::Initialize( const char* const i_path, const sDdsInfo& i_ddsInfo )
 {
+	ASSERT( ( i_ddsInfo.type == TextureTypes::TwoDimensional ) || ( i_ddsInfo.firstResidentMipLevel == 0 ) );
+
 	bool wereThereErrors = false;
+	m_target = GetGlTarget( i_ddsInfo.type );
+	// OpenGL only allows BPTC compression for 3D textures (S3TC and RGTC are 2D only)
+	if ( ( i_ddsInfo.type == TextureTypes::Volume ) && ( i_ddsInfo.format != TextureFormats::BC7 ) )
+	{
+		wereThereErrors = true;
+		ASSERT( false );
+		Engine::Logging::OutputError( "The volume texture %s must be BC7, because OpenGL can't use BC1, BC3, BC4, or BC5 for 3D textures", i_path );
+		goto OnExit;
+	}
 	{
 		const GLsizei textureCount = 1;
 		glGenTextures( textureCount, &m_textureId );
@@ -50,7 +72,7 @@ bool Engine::Graphics::cTexture::Initialize( const char* const i_path, const sDd
 		{
 			if ( m_textureId != 0 )
 			{
-				glBindTexture( GL_TEXTURE_2D, m_textureId );
+				glBindTexture( m_target, m_textureId );
 				const GLenum errorCode = glGetError();
 				if ( errorCode != GL_NO_ERROR )
 				{
@@ -79,53 +101,110 @@ bool Engine::Graphics::cTexture::Initialize( const char* const i_path, const sDd
 		}
 	}
 	{
-		GLsizei currentWidth = static_cast<GLsizei>( i_ddsInfo.width );
-		GLsizei currentHeight = static_cast<GLsizei>( i_ddsInfo.height );
+		// A texture that is streamed in only has its resident levels until the rest are uploaded,
+		// and so the base level keeps it complete
+		const GLint firstResidentMipLevel = static_cast<GLint>( i_ddsInfo.firstResidentMipLevel );
+		glTexParameteri( m_target, GL_TEXTURE_BASE_LEVEL, firstResidentMipLevel );
+		glTexParameteri( m_target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>( i_ddsInfo.mipLevelCount ) - 1 );
+		const GLenum errorCode = glGetError();
+		if ( errorCode != GL_NO_ERROR )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
+			Engine::Logging::OutputError( "OpenGL failed to set the MIP levels of %s: %s",
+				i_path, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
+			goto OnExit;
+		}
+	}
+	{
 		const uint8_t* currentPosition = reinterpret_cast<const uint8_t*>( i_ddsInfo.imageData );
 		const uint8_t* const endOfFile = currentPosition + i_ddsInfo.imageDataSize;
 		const GLsizei blockSize = static_cast<GLsizei>( TextureFormats::GetSizeOfBlock( i_ddsInfo.format ) );
 		const GLint borderWidth = 0;
-		GLenum glFormat = 0;
-		switch ( i_ddsInfo.format )
+		const GLenum glFormat = GetGlFormat( i_ddsInfo.format );
+		const GLsizei layerCount = static_cast<GLsizei>( i_ddsInfo.layerCount );
+		if ( i_ddsInfo.type == TextureTypes::TwoDimensionalArray )
 		{
-			case TextureFormats::BC1: glFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT; break;
-			case TextureFormats::BC3: glFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+			// Each level of an array has every layer but the file has every level of each layer,
+			// and so the levels are allocated first and then each layer is copied into them
+			for ( GLint i = 0; i < static_cast<GLint>( i_ddsInfo.mipLevelCount ); ++i )
+			{
+				const GLsizei width = std::max( static_cast<GLsizei>( i_ddsInfo.width >> i ), 1 );
+				const GLsizei height = std::max( static_cast<GLsizei>( i_ddsInfo.height >> i ), 1 );
+				const GLsizei byteCount_singleLayer = ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * blockSize;
+				const void* const noDataYet = NULL;
+				glCompressedTexImage3D( GL_TEXTURE_2D_ARRAY, i, glFormat, width, height, layerCount,
+					borderWidth, byteCount_singleLayer * layerCount, noDataYet );
+			}
+			const GLenum errorCode = glGetError();
+			if ( errorCode != GL_NO_ERROR )
+			{
+				wereThereErrors = true;
+				ASSERTF( false, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
+				Engine::Logging::OutputError( "OpenGL failed to allocate the layers of %s: %s",
+					i_path, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
+				goto OnExit;
+			}
 		}
-		for ( GLint i = 0; i < static_cast<GLint>( i_ddsInfo.mipLevelCount ); ++i )
+		// A volume texture stores each level with all of its slices, and so its levels are uploaded like a single layer's
+		const GLsizei layerCount_file = ( i_ddsInfo.type == TextureTypes::Volume ) ? 1 : layerCount;
+		for ( GLsizei layer = 0; layer < layerCount_file; ++layer )
 		{
-			const GLsizei blockCount_singleRow = ( currentWidth + 3 ) / 4;
-			const GLsizei byteCount_singleRow = blockCount_singleRow * blockSize;
-			const GLsizei rowCount = ( currentHeight + 3 ) / 4;
-			const GLsizei byteCount_currentMipLevel = byteCount_singleRow * rowCount;
-			glCompressedTexImage2D( GL_TEXTURE_2D, i, glFormat, currentWidth, currentHeight,
-				borderWidth, byteCount_currentMipLevel, currentPosition );
-			const GLenum errorCode = glGetError();
-			if ( errorCode == GL_NO_ERROR )
+			GLsizei currentWidth = std::max( static_cast<GLsizei>( i_ddsInfo.width >> i_ddsInfo.firstResidentMipLevel ), 1 );
+			GLsizei currentHeight = std::max( static_cast<GLsizei>( i_ddsInfo.height >> i_ddsInfo.firstResidentMipLevel ), 1 );
+			GLsizei currentDepth = std::max( static_cast<GLsizei>( i_ddsInfo.depth >> i_ddsInfo.firstResidentMipLevel ), 1 );
+			for ( GLint i = static_cast<GLint>( i_ddsInfo.firstResidentMipLevel ); i < static_cast<GLint>( i_ddsInfo.mipLevelCount ); ++i )
 			{
+				const GLsizei blockCount_singleRow = ( currentWidth + 3 ) / 4;
+				const GLsizei byteCount_singleRow = blockCount_singleRow * blockSize;
+				const GLsizei rowCount = ( currentHeight + 3 ) / 4;
+				const GLsizei byteCount_currentMipLevel = byteCount_singleRow * rowCount * currentDepth;
+				if ( byteCount_currentMipLevel > ( endOfFile - currentPosition ) )
 				{
-					currentPosition += byteCount_currentMipLevel;
-					if ( currentPosition <= endOfFile )
-					{
-						currentWidth = std::max( currentWidth / 2, 1 );
-						currentHeight = std::max( currentHeight / 2, 1 );
-					}
-					else
+					wereThereErrors = true;
+					ASSERTF( false, "DDS file not big enough" );
+					Logging::OutputError( "The DDS file %s isn't big enough to hold the data that its header claims to", i_path );
+					goto OnExit;
+				}
+				switch ( i_ddsInfo.type )
+				{
+					case TextureTypes::TwoDimensionalArray:
 					{
-						wereThereErrors = true;
-						ASSERTF( false, "DDS file not big enough" );
-						Logging::OutputError( "The DDS file %s isn't big enough to hold the data that its header claims to", i_path );
-						goto OnExit;
+						const GLint offset = 0;
+						const GLsizei depth_singleLayer = 1;
+						glCompressedTexSubImage3D( GL_TEXTURE_2D_ARRAY, i, offset, offset, layer, currentWidth, currentHeight, depth_singleLayer,
+							glFormat, byteCount_currentMipLevel, currentPosition );
 					}
-				
+					break;
+					case TextureTypes::Cube:
+						// The faces in a DDS file are in the same order as OpenGL's cube map targets
+						glCompressedTexImage2D( GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer, i, glFormat, currentWidth, currentHeight,
+							borderWidth, byteCount_currentMipLevel, currentPosition );
+						break;
+					case TextureTypes::Volume:
+						glCompressedTexImage3D( GL_TEXTURE_3D, i, glFormat, currentWidth, currentHeight, currentDepth,
+							borderWidth, byteCount_currentMipLevel, currentPosition );
+						break;
+					default:
+						glCompressedTexImage2D( GL_TEXTURE_2D, i, glFormat, currentWidth, currentHeight,
+							borderWidth, byteCount_currentMipLevel, currentPosition );
+				}
+				const GLenum errorCode = glGetError();
+				if ( errorCode == GL_NO_ERROR )
+				{
+					currentPosition += byteCount_currentMipLevel;
+					currentWidth = std::max( currentWidth / 2, 1 );
+					currentHeight = std::max( currentHeight / 2, 1 );
+					currentDepth = std::max( currentDepth / 2, 1 );
+				}
+				else
+				{
+					wereThereErrors = true;
+					ASSERTF( false, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
+					Engine::Logging::OutputError( "OpenGL failed to copy the texture data from MIP level %u of layer %u of %s: %s",
+						i, layer, i_path, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
+					goto OnExit;
 				}
-			}
-			else
-			{
-				bool wereThereErrors = true;
-				ASSERTF( false, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
-				Engine::Logging::OutputError( "OpenGL failed to copy the texture data from MIP level %u of %s: %s",
-					i, i_path, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
-				goto OnExit;
 			}
 		}
 		ASSERTF( currentPosition == endOfFile, "The DDS file %s has more data than it should", i_path );
@@ -143,3 +222,56 @@ OnExit:
 	
 	return !wereThereErrors;
 }
+
+bool Engine::Graphics::cTexture::UploadMipLevel( const unsigned int i_mipLevel, const void* const i_data, const size_t i_dataSize )
+{
+	ASSERT( m_streamingState && ( m_textureId != 0 ) );
+	const sDdsInfo& ddsInfo = m_streamingState->ddsInfo;
+	// Whichever texture was bound is drawn with again after its material is bound, and so it doesn't need to be restored
+	glBindTexture( GL_TEXTURE_2D, m_textureId );
+	{
+		const GLsizei width = std::max( static_cast<GLsizei>( ddsInfo.width >> i_mipLevel ), 1 );
+		const GLsizei height = std::max( static_cast<GLsizei>( ddsInfo.height >> i_mipLevel ), 1 );
+		const GLint borderWidth = 0;
+		glCompressedTexImage2D( GL_TEXTURE_2D, static_cast<GLint>( i_mipLevel ), GetGlFormat( ddsInfo.format ), width, height,
+			borderWidth, static_cast<GLsizei>( i_dataSize ), i_data );
+	}
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, static_cast<GLint>( i_mipLevel ) );
+	const GLenum errorCode = glGetError();
+	if ( errorCode != GL_NO_ERROR )
+	{
+		ASSERTF( false, reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
+		Engine::Logging::OutputError( "OpenGL failed to stream in MIP level %u of %s: %s",
+			i_mipLevel, m_streamingState->path.c_str(), reinterpret_cast<const char*>( gluErrorString( errorCode ) ) );
+		return false;
+	}
+	return true;
+}
+
+namespace
+{
+	GLenum GetGlFormat( const Engine::Graphics::TextureFormats::eFormat i_format )
+	{
+		switch ( i_format )
+		{
+			case Engine::Graphics::TextureFormats::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			case Engine::Graphics::TextureFormats::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			// These are the same blocks as BC4, BC5, and BC7, which are core in OpenGL 4.2
+			case Engine::Graphics::TextureFormats::BC4: return GL_COMPRESSED_RED_RGTC1;
+			case Engine::Graphics::TextureFormats::BC5: return GL_COMPRESSED_RG_RGTC2;
+			case Engine::Graphics::TextureFormats::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		}
+		return 0;
+	}
+
+	GLenum GetGlTarget( const Engine::Graphics::TextureTypes::eType i_type )
+	{
+		switch ( i_type )
+		{
+			case Engine::Graphics::TextureTypes::TwoDimensionalArray: return GL_TEXTURE_2D_ARRAY;
+			case Engine::Graphics::TextureTypes::Cube: return GL_TEXTURE_CUBE_MAP;
+			case Engine::Graphics::TextureTypes::Volume: return GL_TEXTURE_3D;
+		}
+		return GL_TEXTURE_2D;
+	}
+}
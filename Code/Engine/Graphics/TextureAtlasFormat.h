@@ -0,0 +1,53 @@
+#ifndef TEXTUREATLASFORMAT_H
+#define TEXTUREATLASFORMAT_H
+
+// This file is shared by TextureBuilder (which packs atlases) and cTextureAtlas (which reads them).
+//
+// A built atlas is a lookup table file and a built texture for each of its pages (see GetAtlasPagePath()).
+// The lookup table is a header, the regions sorted by name (with strcmp()), and then the NUL-terminated names.
+// Region texture coordinates are in the same space as cSprite's
+// (where the bottom of a page is 0 and its top is 1 on every platform).
+
+#include <cstdint>
+#include <string>
+
+namespace Engine
+{
+	namespace Graphics
+	{
+		// "ATLS" when read as bytes
+		const uint32_t s_atlasFileMagic = 0x534c5441;
+		// Files with a different version must be rebuilt
+		const uint32_t s_atlasFileVersion = 1;
+
+		struct sAtlasFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t pageCount;
+			uint32_t regionCount;
+			// The size of the names that follow the regions
+			uint32_t nameByteCount;
+		};
+
+		struct sAtlasRegion
+		{
+			// The offset of the region's name from the start of the names
+			uint32_t nameOffset;
+			uint32_t pageIndex;
+			float left, right, top, bottom;
+		};
+
+		// "Atlases/UI.bin" has the pages "Atlases/UI_page0.dds", "Atlases/UI_page1.dds", and so on
+		inline std::string GetAtlasPagePath( const std::string& i_atlasPath, const uint32_t i_pageIndex )
+		{
+			const size_t lastSlash = i_atlasPath.find_last_of( "/\\" );
+			const size_t extension = i_atlasPath.find_last_of( '.' );
+			const std::string pathWithoutExtension = ( ( extension != std::string::npos ) && ( ( lastSlash == std::string::npos ) || ( extension > lastSlash ) ) ) ?
+				i_atlasPath.substr( 0, extension ) : i_atlasPath;
+			return pathWithoutExtension + "_page" + std::to_string( i_pageIndex ) + ".dds";
+		}
+	}
+}
+
+#endif
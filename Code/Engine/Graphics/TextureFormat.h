@@ -0,0 +1,93 @@
+#ifndef TEXTUREFORMAT_H
+#define TEXTUREFORMAT_H
+
+// This file is shared by TextureBuilder (which writes built textures) and cTexture (which reads them).
+//
+// A built texture is a DDS file, but when a single 2D texture has mip levels bigger than the mip tail they are stored in a different order
+// so that the texture can be created from a small part at the start of the file and then streamed in
+// (texture arrays, cube maps, and volume textures are always stored in the normal order):
+//	* The headers (the DDS header and the DXT10 header if there is one) are the same as any other DDS file
+//	* Then the mip tail (every level that is no bigger than s_maxMipTailDimension in either dimension) from largest to smallest,
+//		which is the same as the end of a normal DDS file
+//	* Then the rest of the levels from smallest to largest, which is the order that they are streamed in
+// The DDS header's reserved fields say where the mip tail is (see sMipTailHeader),
+// and a file without them is a normal DDS file that is uploaded all at once.
+// The reserved fields also have a key that identifies the texture's contents (see sContentKeyHeader).
+//
+// Textures with the same contents are only loaded once at runtime:
+// the asset build system writes an alias table (see sAliasFileHeader) that maps every texture
+// to the first texture (sorted by path) with the same content key.
+
+#include <cstdint>
+
+namespace Engine
+{
+	namespace Graphics
+	{
+		// "MTAL" when read as bytes
+		const uint32_t s_mipTailMarker = 0x4c41544d;
+		// Levels this size or smaller are always loaded,
+		// which is at most a few KB for every block-compressed format
+		const uint32_t s_maxMipTailDimension = 64;
+
+		// This is stored at the start of DDS_HEADER::dwReserved1
+		struct sMipTailHeader
+		{
+			uint32_t marker;
+			// The largest level that is in the mip tail
+			uint32_t firstMipLevel;
+			// The size of the mip tail's data, which starts right after the headers
+			uint32_t byteCount;
+		};
+
+		// "TKEY" when read as bytes
+		const uint32_t s_contentKeyMarker = 0x59454b54;
+
+		// This is stored in DDS_HEADER::dwReserved1 right after sMipTailHeader.
+		// The key is a hash of the decoded source pixels, the resolved build options (like the usage and the chosen format),
+		// the platform, and the version of TextureBuilder.
+		// Two textures with the same key are built the same way from the same pixels, and so (barring a hash collision) have the same built data
+		struct sContentKeyHeader
+		{
+			uint32_t marker;
+			// The key is split so that the header doesn't need to be 8-byte aligned
+			uint32_t key_low, key_high;
+		};
+
+		// "TALS" when read as bytes
+		const uint32_t s_aliasFileMagic = 0x534c4154;
+		// Files with a different version are ignored
+		const uint32_t s_aliasFileVersion = 1;
+
+		// The alias table is the header, the aliases, and then the NUL-terminated paths.
+		// Paths are lowercase with forward slashes, and start with "data/" like the paths in built materials
+		struct sAliasFileHeader
+		{
+			uint32_t magic;
+			uint32_t version;
+			uint32_t aliasCount;
+			// The size of the paths that follow the aliases
+			uint32_t pathByteCount;
+		};
+
+		struct sAlias
+		{
+			// The offsets of the paths from the start of the paths
+			uint32_t aliasPathOffset;
+			uint32_t texturePathOffset;
+		};
+
+		inline uint32_t GetFirstMipTailLevel( const uint32_t i_width, const uint32_t i_height, const uint32_t i_mipLevelCount )
+		{
+			uint32_t mipLevel = 0;
+			while ( ( ( mipLevel + 1 ) < i_mipLevelCount )
+				&& ( ( ( i_width >> mipLevel ) > s_maxMipTailDimension ) || ( ( i_height >> mipLevel ) > s_maxMipTailDimension ) ) )
+			{
+				++mipLevel;
+			}
+			return mipLevel;
+		}
+	}
+}
+
+#endif
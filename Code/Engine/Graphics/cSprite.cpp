@@ -1,7 +1,13 @@
 #include "cSprite.h"
 
+#include "cTextureAtlas.h"
+#include "../Asserts/Asserts.h"
+#include "../Logging/Logging.h"
+
 Engine::Graphics::cSprite::cSprite( const float i_position_left, const float i_position_right, const float i_position_top, const float i_position_bottom,
 	const float i_texcoord_left, const float i_texcoord_right, const float i_texcoord_top, const float i_texcoord_bottom )
+	:
+	m_texture( NULL )
 {
 	m_position_screen.left = i_position_left;
 	m_position_screen.right = i_position_right;
@@ -13,3 +19,34 @@ Engine::Graphics::cSprite::cSprite( const float i_position_left, const float i_p
 	m_textureCoordinates.top = i_texcoord_top;
 	m_textureCoordinates.bottom = i_texcoord_bottom;
 }
+
+Engine::Graphics::cSprite::cSprite( const float i_position_left, const float i_position_right, const float i_position_top, const float i_position_bottom,
+	const cTextureAtlas& i_atlas, const char* const i_regionName )
+	:
+	m_texture( NULL )
+{
+	m_position_screen.left = i_position_left;
+	m_position_screen.right = i_position_right;
+	m_position_screen.top = i_position_top;
+	m_position_screen.bottom = i_position_bottom;
+
+	const sAtlasRegion* const region = i_atlas.FindRegion( i_regionName );
+	if ( region )
+	{
+		m_textureCoordinates.left = region->left;
+		m_textureCoordinates.right = region->right;
+		m_textureCoordinates.top = region->top;
+		m_textureCoordinates.bottom = region->bottom;
+		m_texture = &i_atlas.GetPage( region->pageIndex );
+	}
+	else
+	{
+		// The sprite is still drawn with its material's whole texture
+		ASSERTF( false, "The texture atlas doesn't have a region named %s", i_regionName );
+		Logging::OutputError( "The texture atlas doesn't have a region named %s", i_regionName );
+		m_textureCoordinates.left = 0.0f;
+		m_textureCoordinates.right = 1.0f;
+		m_textureCoordinates.top = 1.0f;
+		m_textureCoordinates.bottom = 0.0f;
+	}
+}
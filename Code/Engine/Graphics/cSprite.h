@@ -17,6 +17,9 @@ namespace Engine
 {
 	namespace Graphics
 	{
+		class cTexture;
+		class cTextureAtlas;
+
 		class cSprite
 		{
 		public:
@@ -27,6 +30,13 @@ namespace Engine
 
 			cSprite( const float i_position_left, const float i_position_right, const float i_position_top, const float i_position_bottom,
 				const float i_texcoord_left, const float i_texcoord_right, const float i_texcoord_top, const float i_texcoord_bottom );
+			// The sprite uses the texture coordinates of the atlas region with the name,
+			// and the atlas page is bound instead of its material's texture when it is drawn
+			cSprite( const float i_position_left, const float i_position_right, const float i_position_top, const float i_position_bottom,
+				const cTextureAtlas& i_atlas, const char* const i_regionName );
+
+			// NULL unless the sprite is in an atlas
+			const cTexture* GetTexture() const { return m_texture; }
 
 		private:
 			struct
@@ -37,6 +47,7 @@ namespace Engine
 			{
 				float left, right, top, bottom;
 			} m_textureCoordinates;
+			const cTexture* m_texture;
 
 #if defined( PLATFORM_D3D )
 			static ID3D11Buffer* ms_vertexBuffer;
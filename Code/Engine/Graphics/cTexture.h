@@ -3,6 +3,8 @@
 
 #include "Configuration.h"
 
+#include <cstddef>
+
 #ifdef PLATFORM_GL
 	#include "OpenGL/Includes.h"
 #endif
@@ -12,6 +14,7 @@ namespace Engine
 	namespace Graphics
 	{
 		struct sDdsInfo;
+		struct sStreamingState;
 	}
 
 	namespace Platform
@@ -25,6 +28,7 @@ namespace DirectX
 }
 
 #ifdef PLATFORM_D3D
+	struct ID3D11Resource;
 	struct ID3D11ShaderResourceView;
 #endif
 
@@ -36,8 +40,26 @@ namespace Engine
 		{
 		public:
 			void Bind( const unsigned int i_id ) const;
+			// Textures can be 2D textures, 2D texture arrays, cube maps, or volume textures.
+			// Only the mip tail of a single 2D texture is uploaded when it is loaded,
+			// and the larger levels are uploaded later by StreamMipLevels()
 			bool Load( const char* const i_path );
 			bool CleanUp();
+			bool IsFullyResident() const { return m_streamingState == NULL; }
+
+			// Uploads the next larger level of textures that are still being streamed in until the budget is used up
+			// (at least one level is always uploaded if any are left, even if it is bigger than the budget).
+			// This should be called once a frame.
+			static void StreamMipLevels( const size_t i_maxByteCount );
+
+			// Textures that are loaded with Acquire() are shared by everything that uses the same path
+			// and by every path that the alias table maps to the same texture (see TextureFormat.h).
+			// Each one is cleaned up when it has been released as many times as it was acquired
+			static cTexture* Acquire( const char* const i_path );
+			static void Release( cTexture*& io_texture );
+			// This must be called before any textures are acquired,
+			// and if the file doesn't exist then textures are only shared by path
+			static bool LoadAliases( const char* const i_path );
 
 			cTexture();
 			~cTexture();
@@ -45,13 +67,25 @@ namespace Engine
 		private:
 
 #if defined( PLATFORM_D3D )
+			// This is a 2D texture (with any number of layers) or a 3D texture
+			ID3D11Resource* m_texture;
 			ID3D11ShaderResourceView* m_textureView;
 #elif defined( PLATFORM_GL )
 			GLuint m_textureId;
+			// GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP, or GL_TEXTURE_3D
+			GLenum m_target;
 #endif
+			sStreamingState* m_streamingState;
 
 		private:
 			bool Initialize( const char* const i_path, const sDdsInfo& i_ddsInfo );
+			// Uploads the next larger level and lets shaders sample it
+			bool UploadMipLevel( const unsigned int i_mipLevel, const void* const i_data, const size_t i_dataSize );
+			void StopStreaming();
+
+			// A texture owns its GPU resources and its streaming state (which refers back to it)
+			cTexture( const cTexture& i_texture );
+			cTexture& operator=( const cTexture& i_texture );
 		};
 	}
 }
@@ -1,6 +1,10 @@
 #ifndef GRAPHICS_CTEXTURE_INTERNAL_H
 #define GRAPHICS_CTEXTURE_INTERNAL_H
 
+#include <cstdint>
+#include <string>
+#include "../../Platform/Platform.h"
+
 namespace Engine
 {
 	namespace Graphics
@@ -33,25 +37,71 @@ namespace Engine
 				}
 				return 0;
 			}
+			inline size_t GetByteCountOfMipLevel( const eFormat i_format, const unsigned int i_width, const unsigned int i_height,
+				const unsigned int i_mipLevel )
+			{
+				const unsigned int width = ( ( i_width >> i_mipLevel ) > 0 ) ? ( i_width >> i_mipLevel ) : 1;
+				const unsigned int height = ( ( i_height >> i_mipLevel ) > 0 ) ? ( i_height >> i_mipLevel ) : 1;
+				return static_cast<size_t>( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * GetSizeOfBlock( i_format );
+			}
+		}
+
+		namespace TextureTypes
+		{
+			enum eType
+			{
+				TwoDimensional,
+				// The layers are stored one after another, each with every one of its levels
+				TwoDimensionalArray,
+				// The 6 faces are stored like the layers of an array (in the order +X, -X, +Y, -Y, +Z, -Z)
+				Cube,
+				// Each level is stored with all of its slices, and a level has half as many slices as the one before it
+				Volume,
+			};
 		}
 
 		struct sDdsInfo
 		{
+			// This is the data of every level from firstResidentMipLevel to the smallest, from largest to smallest
+			// (for every layer or face)
 			const void* imageData;
 			size_t imageDataSize;
 			unsigned int width, height;
+			// Only volume textures have more than one slice
+			unsigned int depth;
+			// The number of array layers (or 6 for the faces of a cube map)
+			unsigned int layerCount;
 			unsigned int mipLevelCount;
+			// Levels that are bigger than this are streamed in later
+			// (which only single 2D textures do)
+			unsigned int firstResidentMipLevel;
 			TextureFormats::eFormat format;
+			TextureTypes::eType type;
 
 			sDdsInfo()
 				:
 				imageData( nullptr ), imageDataSize( 0 ),
-				width( 0 ), height( 0 ), mipLevelCount( 0 ),
-				format( TextureFormats::Unknown )
+				width( 0 ), height( 0 ), depth( 1 ), layerCount( 1 ), mipLevelCount( 0 ), firstResidentMipLevel( 0 ),
+				format( TextureFormats::Unknown ), type( TextureTypes::TwoDimensional )
 			{
 
 			}
 		};
+
+		// A texture whose larger levels haven't all been uploaded yet keeps its file mapped until they have
+		struct sStreamingState
+		{
+			Platform::sMappedFile mappedFile;
+			std::string path;
+			sDdsInfo ddsInfo;
+			// The data of the level that is streamed in next (which is one level bigger than the largest resident one)
+			const uint8_t* nextMipLevelData;
+			const uint8_t* endOfFile;
+			// Textures that have been bound since the last time levels were streamed get theirs first
+			bool wasBoundRecently;
+
+			sStreamingState() : nextMipLevelData( nullptr ), endOfFile( nullptr ), wasBoundRecently( false ) {}
+		};
 	}
 }
 
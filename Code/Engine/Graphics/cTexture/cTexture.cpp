@@ -1,19 +1,49 @@
 #include "../cTexture.h"
 #include "Internal.h"
+
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <string>
+#include <vector>
+#include "../TextureFormat.h"
 #include "../../Asserts/Asserts.h"
 #include "../../Logging/Logging.h"
 #include "../../Platform/Platform.h"
 #include "../../../External/DirectXTex/DirectXTex/DDS.h"
 
+namespace
+{
+	// Formats can come from either a legacy FourCC or the DXGI format in a DXT10 header
+	// (only the UNORM variants are supported, since the engine doesn't use sRGB or signed textures)
+	Engine::Graphics::TextureFormats::eFormat GetFormat( const uint32_t i_fourCc );
+	Engine::Graphics::TextureFormats::eFormat GetFormat( const DXGI_FORMAT i_dxgiFormat );
+
+	// Every texture that still has levels to stream in, in the order that they were loaded
+	std::vector<Engine::Graphics::cTexture*> s_texturesBeingStreamed;
+
+	struct sSharedTexture
+	{
+		Engine::Graphics::cTexture* texture;
+		unsigned int referenceCount;
+	};
+	// Paths are normalized the same way as the ones in the alias table
+	std::map<std::string, sSharedTexture> s_sharedTextures;
+	std::map<std::string, std::string> s_textureAliases;
+
+	std::string NormalizePath( const char* const i_path );
+}
+
 bool Engine::Graphics::cTexture::Load( const char* const i_path )
 {
 	bool wereThereErrors = false;
 
-	Platform::sDataFromFile dataFromFile;
+	// The file is mapped instead of read so that only the pages with the headers and the mip tail are read from disk while loading
+	Platform::sMappedFile mappedFile;
 
 	{
 		std::string errorMessage;
-		if ( !Platform::LoadBinaryFile( i_path, dataFromFile, &errorMessage ) )
+		if ( !Platform::MapFile( i_path, mappedFile, &errorMessage ) )
 		{
 			wereThereErrors = true;
 			ASSERTF( false, errorMessage.c_str() );
@@ -22,8 +52,8 @@ bool Engine::Graphics::cTexture::Load( const char* const i_path )
 		}
 	}
 
-	const uint8_t* currentPosition = reinterpret_cast<uint8_t*>( dataFromFile.data );
-	size_t remainingSize = dataFromFile.size;
+	const uint8_t* currentPosition = reinterpret_cast<const uint8_t*>( mappedFile.data );
+	size_t remainingSize = mappedFile.size;
 	if ( ( remainingSize >= sizeof( DirectX::DDS_MAGIC ) )
 		&& ( *reinterpret_cast<const uint32_t*>( currentPosition ) == DirectX::DDS_MAGIC ) )
 	{
@@ -78,77 +108,338 @@ bool Engine::Graphics::cTexture::Load( const char* const i_path )
 		}
 	}
 
+	TextureFormats::eFormat format = TextureFormats::Unknown;
+	TextureTypes::eType type = TextureTypes::TwoDimensional;
+	unsigned int layerCount = 1;
 	{
 		if ( header_dxt10 )
 		{
-			wereThereErrors = true;
-			ASSERT( false );
-			Logging::OutputError( "The DDS file %s uses a DXT10 header, which is unsupported", i_path );
-			goto OnExit;
+			if ( header_dxt10->resourceDimension == DirectX::DDS_DIMENSION_TEXTURE2D )
+			{
+				if ( header_dxt10->miscFlag & DirectX::DDS_RESOURCE_MISC_TEXTURECUBE )
+				{
+					type = TextureTypes::Cube;
+				}
+				else if ( header_dxt10->arraySize > 1 )
+				{
+					type = TextureTypes::TwoDimensionalArray;
+				}
+			}
+			else if ( header_dxt10->resourceDimension == DirectX::DDS_DIMENSION_TEXTURE3D )
+			{
+				type = TextureTypes::Volume;
+			}
+			else
+			{
+				wereThereErrors = true;
+				ASSERT( false );
+				Logging::OutputError( "The DDS file %s isn't a 2D texture, a cube map, or a volume texture, which are the only ones supported", i_path );
+				goto OnExit;
+			}
+			if ( header_dxt10->arraySize == 0 )
+			{
+				wereThereErrors = true;
+				ASSERTF( false, "Invalid DDS file %s", i_path );
+				Logging::OutputError( "The DXT10 header in the DDS file %s has an array size of 0", i_path );
+				goto OnExit;
+			}
+			else if ( ( ( type == TextureTypes::Cube ) || ( type == TextureTypes::Volume ) ) && ( header_dxt10->arraySize != 1 ) )
+			{
+				wereThereErrors = true;
+				ASSERT( false );
+				Logging::OutputError( "The DDS file %s is an array of cube maps or volume textures, which is unsupported", i_path );
+				goto OnExit;
+			}
+			layerCount = ( type == TextureTypes::Cube ) ? 6 : header_dxt10->arraySize;
+			format = GetFormat( header_dxt10->dxgiFormat );
+		}
+		else if ( header->ddspf.dwFlags & DDS_FOURCC )
+		{
+			if ( header->dwFlags & DDS_HEADER_FLAGS_VOLUME )
+			{
+				type = TextureTypes::Volume;
+			}
+			else if ( header->dwCaps2 & DDS_CUBEMAP )
+			{
+				// Only Direct3D 9 allowed a cube map to leave out some of its faces
+				if ( ( header->dwCaps2 & DDS_CUBEMAP_ALLFACES ) != DDS_CUBEMAP_ALLFACES )
+				{
+					wereThereErrors = true;
+					ASSERT( false );
+					Logging::OutputError( "The DDS file %s is a cube map without all 6 faces, which is unsupported", i_path );
+					goto OnExit;
+				}
+				type = TextureTypes::Cube;
+				layerCount = 6;
+			}
+			format = GetFormat( header->ddspf.dwFourCC );
 		}
-		if ( header->dwFlags & DDS_HEADER_FLAGS_VOLUME )
+		else
 		{
 			wereThereErrors = true;
 			ASSERT( false );
-			Logging::OutputError( "The DDS file %s is a volume texture, which is unsupported", i_path );
+			Logging::OutputError( "The DDS file %s doesn't use a FourCC pixel format, which is unsupported", i_path );
 			goto OnExit;
 		}
-		else if ( header->dwCaps & DDS_CUBEMAP )
+		if ( format == TextureFormats::Unknown )
 		{
 			wereThereErrors = true;
 			ASSERT( false );
-			Logging::OutputError( "The DDS file %s is a cube texture, which is unsupported", i_path );
+			Logging::OutputError( "The DDS file %s isn't one of the supported formats: BC1, BC3, BC4, BC5, BC7", i_path );
 			goto OnExit;
 		}
-		if ( header->ddspf.dwFlags & DDS_FOURCC )
+	}
+
+	{
+		sDdsInfo ddsInfo;
+		{
+			{
+				ddsInfo.imageData = currentPosition;
+				ddsInfo.imageDataSize = remainingSize;
+			}
+			ddsInfo.width = static_cast<unsigned int>( header->dwWidth );
+			ddsInfo.height = static_cast<unsigned int>( header->dwHeight );
+			if ( ( type == TextureTypes::Volume ) && ( header->dwDepth > 0 ) )
+			{
+				ddsInfo.depth = static_cast<unsigned int>( header->dwDepth );
+			}
+			ddsInfo.layerCount = layerCount;
+			ddsInfo.mipLevelCount = static_cast<unsigned int>( header->dwMipMapCount );
+			ddsInfo.format = format;
+			ddsInfo.type = type;
+		}
+		// TextureBuilder stores the mip tail first when a single 2D texture has larger levels (see TextureFormat.h)
+		const sMipTailHeader* const mipTailHeader = reinterpret_cast<const sMipTailHeader*>( header->dwReserved1 );
+		if ( mipTailHeader->marker == s_mipTailMarker )
 		{
-			if ( ( header->ddspf.dwFourCC != DirectX::DDSPF_DXT1.dwFourCC )
-				&& ( header->ddspf.dwFourCC != DirectX::DDSPF_DXT5.dwFourCC ) )
+			if ( type != TextureTypes::TwoDimensional )
 			{
 				wereThereErrors = true;
-				ASSERT( false );
-				Logging::OutputError( "The DDS file %s isn't one of the supported formats: BC1, BC3", i_path );
+				ASSERTF( false, "Invalid DDS file %s", i_path );
+				Logging::OutputError( "The DDS file %s has a mip tail header, but only single 2D textures can be streamed in", i_path );
+				goto OnExit;
+			}
+			size_t streamedByteCount = 0;
+			for ( unsigned int i = 0; i < mipTailHeader->firstMipLevel; ++i )
+			{
+				streamedByteCount += TextureFormats::GetByteCountOfMipLevel( format, ddsInfo.width, ddsInfo.height, i );
+			}
+			if ( ( mipTailHeader->firstMipLevel >= ddsInfo.mipLevelCount ) || ( mipTailHeader->byteCount > remainingSize )
+				|| ( streamedByteCount > ( remainingSize - mipTailHeader->byteCount ) ) )
+			{
+				wereThereErrors = true;
+				ASSERTF( false, "Invalid DDS file %s", i_path );
+				Logging::OutputError( "The DDS file %s isn't big enough to hold the data that its mip tail header claims to", i_path );
 				goto OnExit;
 			}
+			ddsInfo.imageDataSize = mipTailHeader->byteCount;
+			ddsInfo.firstResidentMipLevel = mipTailHeader->firstMipLevel;
 		}
-		else
+		if ( !Initialize( i_path, ddsInfo ) )
 		{
 			wereThereErrors = true;
-			ASSERT( false );
-			Logging::OutputError( "The DDS file %s doesn't use a FourCC pixel format, which is unsupported", i_path );
 			goto OnExit;
 		}
+
+		if ( ddsInfo.firstResidentMipLevel > 0 )
+		{
+			m_streamingState = new sStreamingState;
+			m_streamingState->mappedFile = mappedFile;
+			m_streamingState->path = i_path;
+			m_streamingState->ddsInfo = ddsInfo;
+			m_streamingState->nextMipLevelData = currentPosition + ddsInfo.imageDataSize;
+			m_streamingState->endOfFile = currentPosition + remainingSize;
+			s_texturesBeingStreamed.push_back( this );
+			// The streaming state owns the mapping now
+			mappedFile = Platform::sMappedFile();
+		}
 	}
 
+OnExit:
+
+	if ( mappedFile.data )
 	{
-		sDdsInfo ddsInfo;
+		Platform::UnmapFile( mappedFile );
+	}
+
+	return !wereThereErrors;
+}
+
+void Engine::Graphics::cTexture::StreamMipLevels( const size_t i_maxByteCount )
+{
+	size_t streamedByteCount = 0;
+	// Textures that were bound since the last call get a level first (since they are the ones that are being drawn),
+	// and then every texture gets a level in turn until the budget is used up
+	bool shouldOnlyBoundTexturesBeStreamed = true;
+	while ( !s_texturesBeingStreamed.empty() && ( ( streamedByteCount < i_maxByteCount ) || ( streamedByteCount == 0 ) ) )
+	{
+		for ( size_t i = 0; ( i < s_texturesBeingStreamed.size() ) && ( ( streamedByteCount < i_maxByteCount ) || ( streamedByteCount == 0 ) ); )
 		{
+			cTexture* const texture = s_texturesBeingStreamed[i];
+			sStreamingState& streamingState = *texture->m_streamingState;
+			if ( shouldOnlyBoundTexturesBeStreamed && !streamingState.wasBoundRecently )
 			{
-				ddsInfo.imageData = currentPosition;
-				ddsInfo.imageDataSize = remainingSize;
+				++i;
+				continue;
 			}
-			ddsInfo.width = static_cast<unsigned int>( header->dwWidth );
-			ddsInfo.height = static_cast<unsigned int>( header->dwHeight );
-			ddsInfo.mipLevelCount = static_cast<unsigned int>( header->dwMipMapCount );
+			const unsigned int mipLevel = streamingState.ddsInfo.firstResidentMipLevel - 1;
+			const size_t byteCount = TextureFormats::GetByteCountOfMipLevel( streamingState.ddsInfo.format,
+				streamingState.ddsInfo.width, streamingState.ddsInfo.height, mipLevel );
+			ASSERT( ( streamingState.nextMipLevelData + byteCount ) <= streamingState.endOfFile );
+			streamedByteCount += byteCount;
+			if ( texture->UploadMipLevel( mipLevel, streamingState.nextMipLevelData, byteCount ) )
 			{
-				if ( header->ddspf.dwFourCC == DirectX::DDSPF_DXT1.dwFourCC )
+				streamingState.ddsInfo.firstResidentMipLevel = mipLevel;
+				streamingState.nextMipLevelData += byteCount;
+				if ( mipLevel > 0 )
 				{
-					ddsInfo.format = TextureFormats::BC1;
-				}
-				else if ( header->ddspf.dwFourCC == DirectX::DDSPF_DXT5.dwFourCC )
-				{
-					ddsInfo.format = TextureFormats::BC3;
-				}
-				else
-				{
-					ddsInfo.format = TextureFormats::Unknown;
+					++i;
+					continue;
 				}
 			}
+			// The texture is removed from the list once every level has been uploaded
+			// (or if one can't be, in which case it keeps using the levels that it has)
+			texture->StopStreaming();
 		}
-		if ( !Initialize( i_path, ddsInfo ) )
+		shouldOnlyBoundTexturesBeStreamed = false;
+	}
+
+	for ( std::vector<cTexture*>::iterator it = s_texturesBeingStreamed.begin(); it != s_texturesBeingStreamed.end(); ++it )
+	{
+		( *it )->m_streamingState->wasBoundRecently = false;
+	}
+}
+
+void Engine::Graphics::cTexture::StopStreaming()
+{
+	if ( m_streamingState )
+	{
+		Platform::UnmapFile( m_streamingState->mappedFile );
+		delete m_streamingState;
+		m_streamingState = NULL;
+		s_texturesBeingStreamed.erase( std::find( s_texturesBeingStreamed.begin(), s_texturesBeingStreamed.end(), this ) );
+	}
+}
+
+Engine::Graphics::cTexture* Engine::Graphics::cTexture::Acquire( const char* const i_path )
+{
+	std::string path = NormalizePath( i_path );
+	{
+		const std::map<std::string, std::string>::const_iterator alias = s_textureAliases.find( path );
+		if ( alias != s_textureAliases.end() )
+		{
+			path = alias->second;
+		}
+	}
+	{
+		const std::map<std::string, sSharedTexture>::iterator sharedTexture = s_sharedTextures.find( path );
+		if ( sharedTexture != s_sharedTextures.end() )
+		{
+			++sharedTexture->second.referenceCount;
+			return sharedTexture->second.texture;
+		}
+	}
+	cTexture* const texture = new cTexture;
+	if ( !texture->Load( path.c_str() ) )
+	{
+		delete texture;
+		return NULL;
+	}
+	sSharedTexture sharedTexture;
+	{
+		sharedTexture.texture = texture;
+		sharedTexture.referenceCount = 1;
+	}
+	s_sharedTextures.insert( std::make_pair( path, sharedTexture ) );
+	return texture;
+}
+
+void Engine::Graphics::cTexture::Release( cTexture*& io_texture )
+{
+	if ( !io_texture )
+	{
+		return;
+	}
+	for ( std::map<std::string, sSharedTexture>::iterator i = s_sharedTextures.begin(); i != s_sharedTextures.end(); ++i )
+	{
+		if ( i->second.texture == io_texture )
+		{
+			if ( --i->second.referenceCount == 0 )
+			{
+				delete io_texture;
+				s_sharedTextures.erase( i );
+			}
+			io_texture = NULL;
+			return;
+		}
+	}
+	ASSERTF( false, "A texture that wasn't acquired can't be released" );
+	io_texture = NULL;
+}
+
+bool Engine::Graphics::cTexture::LoadAliases( const char* const i_path )
+{
+	bool wereThereErrors = false;
+
+	Platform::sDataFromFile dataFromFile;
+	if ( !Platform::DoesFileExist( i_path ) )
+	{
+		goto OnExit;
+	}
+	{
+		std::string errorMessage;
+		if ( !Platform::LoadBinaryFile( i_path, dataFromFile, &errorMessage ) )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, errorMessage.c_str() );
+			Logging::OutputError( "Failed to load the texture alias table %s: %s", i_path, errorMessage.c_str() );
+			goto OnExit;
+		}
+	}
+	{
+		const uint8_t* const data = reinterpret_cast<const uint8_t*>( dataFromFile.data );
+		if ( dataFromFile.size < sizeof( sAliasFileHeader ) )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, "Invalid texture alias table %s", i_path );
+			Logging::OutputError( "The texture alias table %s isn't big enough for a header", i_path );
+			goto OnExit;
+		}
+		const sAliasFileHeader& header = *reinterpret_cast<const sAliasFileHeader*>( data );
+		if ( ( header.magic != s_aliasFileMagic ) || ( header.version != s_aliasFileVersion ) )
+		{
+			// Textures are still shared by path, and so the game works (with more memory) until its assets are rebuilt
+			Logging::OutputMessage( "The texture alias table %s has the wrong magic number or version and is ignored", i_path );
+			goto OnExit;
+		}
+		const size_t aliasesByteCount = sizeof( sAlias ) * header.aliasCount;
+		if ( dataFromFile.size != ( sizeof( sAliasFileHeader ) + aliasesByteCount + header.pathByteCount ) )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, "Invalid texture alias table %s", i_path );
+			Logging::OutputError( "The size of the texture alias table %s doesn't match its header", i_path );
+			goto OnExit;
+		}
+		const sAlias* const aliases = reinterpret_cast<const sAlias*>( data + sizeof( sAliasFileHeader ) );
+		const char* const paths = reinterpret_cast<const char*>( data + sizeof( sAliasFileHeader ) + aliasesByteCount );
+		if ( ( header.pathByteCount > 0 ) && ( paths[header.pathByteCount - 1] != '\0' ) )
 		{
+			wereThereErrors = true;
+			ASSERTF( false, "Invalid texture alias table %s", i_path );
+			Logging::OutputError( "The paths in the texture alias table %s aren't terminated", i_path );
 			goto OnExit;
 		}
+		for ( uint32_t i = 0; i < header.aliasCount; ++i )
+		{
+			if ( ( aliases[i].aliasPathOffset >= header.pathByteCount ) || ( aliases[i].texturePathOffset >= header.pathByteCount ) )
+			{
+				wereThereErrors = true;
+				ASSERTF( false, "Invalid texture alias table %s", i_path );
+				Logging::OutputError( "Alias %u in the texture alias table %s is out of range", i, i_path );
+				goto OnExit;
+			}
+			s_textureAliases[NormalizePath( paths + aliases[i].aliasPathOffset )] = NormalizePath( paths + aliases[i].texturePathOffset );
+		}
 	}
 
 OnExit:
@@ -161,10 +452,11 @@ OnExit:
 Engine::Graphics::cTexture::cTexture()
 	:
 #if defined( PLATFORM_D3D )
-	m_textureView( NULL )
+	m_texture( NULL ), m_textureView( NULL ),
 #elif defined( PLATFORM_GL )
-	m_textureId( 0 )
+	m_textureId( 0 ), m_target( GL_TEXTURE_2D ),
 #endif
+	m_streamingState( NULL )
 {
 
 }
@@ -173,3 +465,50 @@ Engine::Graphics::cTexture::~cTexture()
 {
 	CleanUp();
 }
+
+namespace
+{
+	std::string NormalizePath( const char* const i_path )
+	{
+		std::string path( i_path );
+		for ( std::string::iterator i = path.begin(); i != path.end(); ++i )
+		{
+			*i = ( *i == '\\' ) ? '/' : static_cast<char>( tolower( static_cast<unsigned char>( *i ) ) );
+		}
+		return path;
+	}
+
+	Engine::Graphics::TextureFormats::eFormat GetFormat( const uint32_t i_fourCc )
+	{
+		if ( i_fourCc == DirectX::DDSPF_DXT1.dwFourCC )
+		{
+			return Engine::Graphics::TextureFormats::BC1;
+		}
+		else if ( i_fourCc == DirectX::DDSPF_DXT5.dwFourCC )
+		{
+			return Engine::Graphics::TextureFormats::BC3;
+		}
+		else if ( ( i_fourCc == DirectX::DDSPF_BC4_UNORM.dwFourCC ) || ( i_fourCc == MAKEFOURCC( 'A', 'T', 'I', '1' ) ) )
+		{
+			return Engine::Graphics::TextureFormats::BC4;
+		}
+		else if ( ( i_fourCc == DirectX::DDSPF_BC5_UNORM.dwFourCC ) || ( i_fourCc == MAKEFOURCC( 'A', 'T', 'I', '2' ) ) )
+		{
+			return Engine::Graphics::TextureFormats::BC5;
+		}
+		return Engine::Graphics::TextureFormats::Unknown;
+	}
+
+	Engine::Graphics::TextureFormats::eFormat GetFormat( const DXGI_FORMAT i_dxgiFormat )
+	{
+		switch ( i_dxgiFormat )
+		{
+			case DXGI_FORMAT_BC1_TYPELESS: case DXGI_FORMAT_BC1_UNORM: return Engine::Graphics::TextureFormats::BC1;
+			case DXGI_FORMAT_BC3_TYPELESS: case DXGI_FORMAT_BC3_UNORM: return Engine::Graphics::TextureFormats::BC3;
+			case DXGI_FORMAT_BC4_TYPELESS: case DXGI_FORMAT_BC4_UNORM: return Engine::Graphics::TextureFormats::BC4;
+			case DXGI_FORMAT_BC5_TYPELESS: case DXGI_FORMAT_BC5_UNORM: return Engine::Graphics::TextureFormats::BC5;
+			case DXGI_FORMAT_BC7_TYPELESS: case DXGI_FORMAT_BC7_UNORM: return Engine::Graphics::TextureFormats::BC7;
+		}
+		return Engine::Graphics::TextureFormats::Unknown;
+	}
+}
@@ -0,0 +1,165 @@
+#include "cTextureAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include "../Asserts/Asserts.h"
+#include "../Logging/Logging.h"
+#include "../Platform/Platform.h"
+
+namespace
+{
+	struct sCompareRegionToName
+	{
+		const char* names;
+
+		bool operator()( const Engine::Graphics::sAtlasRegion& i_region, const char* const i_name ) const
+		{
+			return strcmp( names + i_region.nameOffset, i_name ) < 0;
+		}
+	};
+}
+
+bool Engine::Graphics::cTextureAtlas::Load( const char* const i_path )
+{
+	bool wereThereErrors = false;
+
+	Platform::sDataFromFile dataFromFile;
+	{
+		std::string errorMessage;
+		if ( !Platform::LoadBinaryFile( i_path, dataFromFile, &errorMessage ) )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, errorMessage.c_str() );
+			Logging::OutputError( "Failed to load texture atlas from file %s: %s", i_path, errorMessage.c_str() );
+			goto OnExit;
+		}
+	}
+
+	{
+		const uint8_t* const data = reinterpret_cast<const uint8_t*>( dataFromFile.data );
+		if ( dataFromFile.size < sizeof( sAtlasFileHeader ) )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, "Invalid texture atlas %s", i_path );
+			Logging::OutputError( "The texture atlas %s isn't big enough for a header", i_path );
+			goto OnExit;
+		}
+		const sAtlasFileHeader& header = *reinterpret_cast<const sAtlasFileHeader*>( data );
+		if ( ( header.magic != s_atlasFileMagic ) || ( header.version != s_atlasFileVersion ) )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, "Invalid texture atlas %s", i_path );
+			Logging::OutputError( "The texture atlas %s has the wrong magic number or version and must be rebuilt", i_path );
+			goto OnExit;
+		}
+		const size_t regionsByteCount = sizeof( sAtlasRegion ) * header.regionCount;
+		if ( dataFromFile.size != ( sizeof( sAtlasFileHeader ) + regionsByteCount + header.nameByteCount ) )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, "Invalid texture atlas %s", i_path );
+			Logging::OutputError( "The size of the texture atlas %s doesn't match its header", i_path );
+			goto OnExit;
+		}
+		const sAtlasRegion* const regions = reinterpret_cast<const sAtlasRegion*>( data + sizeof( sAtlasFileHeader ) );
+		const char* const names = reinterpret_cast<const char*>( data + sizeof( sAtlasFileHeader ) + regionsByteCount );
+		if ( ( header.nameByteCount > 0 ) && ( names[header.nameByteCount - 1] != '\0' ) )
+		{
+			wereThereErrors = true;
+			ASSERTF( false, "Invalid texture atlas %s", i_path );
+			Logging::OutputError( "The region names in the texture atlas %s aren't terminated", i_path );
+			goto OnExit;
+		}
+		for ( uint32_t i = 0; i < header.regionCount; ++i )
+		{
+			if ( ( regions[i].nameOffset >= header.nameByteCount ) || ( regions[i].pageIndex >= header.pageCount ) )
+			{
+				wereThereErrors = true;
+				ASSERTF( false, "Invalid texture atlas %s", i_path );
+				Logging::OutputError( "Region %u in the texture atlas %s is out of range", i, i_path );
+				goto OnExit;
+			}
+		}
+		m_regions.assign( regions, regions + header.regionCount );
+		m_names.assign( names, names + header.nameByteCount );
+
+		m_pages = new cTexture[header.pageCount];
+		m_pageCount = header.pageCount;
+		for ( uint32_t i = 0; i < m_pageCount; ++i )
+		{
+			const std::string pagePath = GetAtlasPagePath( i_path, i );
+			if ( !m_pages[i].Load( pagePath.c_str() ) )
+			{
+				wereThereErrors = true;
+				goto OnExit;
+			}
+		}
+	}
+
+OnExit:
+
+	dataFromFile.Free();
+	if ( wereThereErrors )
+	{
+		CleanUp();
+	}
+
+	return !wereThereErrors;
+}
+
+bool Engine::Graphics::cTextureAtlas::CleanUp()
+{
+	bool wereThereErrors = false;
+
+	if ( m_pages )
+	{
+		for ( uint32_t i = 0; i < m_pageCount; ++i )
+		{
+			if ( !m_pages[i].CleanUp() )
+			{
+				wereThereErrors = true;
+			}
+		}
+		delete [] m_pages;
+		m_pages = NULL;
+	}
+	m_pageCount = 0;
+	m_regions.clear();
+	m_names.clear();
+
+	return !wereThereErrors;
+}
+
+const Engine::Graphics::sAtlasRegion* Engine::Graphics::cTextureAtlas::FindRegion( const char* const i_name ) const
+{
+	if ( m_regions.empty() )
+	{
+		return NULL;
+	}
+	sCompareRegionToName compare;
+	compare.names = &m_names[0];
+	const std::vector<sAtlasRegion>::const_iterator region = std::lower_bound( m_regions.begin(), m_regions.end(), i_name, compare );
+	if ( ( region != m_regions.end() ) && ( strcmp( compare.names + region->nameOffset, i_name ) == 0 ) )
+	{
+		return &( *region );
+	}
+	return NULL;
+}
+
+const Engine::Graphics::cTexture& Engine::Graphics::cTextureAtlas::GetPage( const uint32_t i_pageIndex ) const
+{
+	ASSERT( i_pageIndex < m_pageCount );
+	return m_pages[i_pageIndex];
+}
+
+Engine::Graphics::cTextureAtlas::cTextureAtlas()
+	:
+	m_pages( NULL ), m_pageCount( 0 )
+{
+
+}
+
+Engine::Graphics::cTextureAtlas::~cTextureAtlas()
+{
+	CleanUp();
+}
@@ -0,0 +1,44 @@
+#ifndef GRAPHICS_CTEXTUREATLAS_H
+#define GRAPHICS_CTEXTUREATLAS_H
+
+#include "cTexture.h"
+#include "TextureAtlasFormat.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	namespace Graphics
+	{
+		// Many sprite images packed into a few pages by TextureBuilder
+		// so that sprites which use the same page can be drawn without binding another texture
+		class cTextureAtlas
+		{
+		public:
+			bool Load( const char* const i_path );
+			bool CleanUp();
+
+			// Returns NULL if the atlas doesn't have a region with the name
+			const sAtlasRegion* FindRegion( const char* const i_name ) const;
+			const cTexture& GetPage( const uint32_t i_pageIndex ) const;
+			uint32_t GetPageCount() const { return m_pageCount; }
+
+			cTextureAtlas();
+			~cTextureAtlas();
+
+		private:
+			// An array instead of a std::vector because textures can't be copied
+			cTexture* m_pages;
+			uint32_t m_pageCount;
+			std::vector<sAtlasRegion> m_regions;
+			std::vector<char> m_names;
+
+		private:
+			cTextureAtlas( const cTextureAtlas& i_atlas );
+			cTextureAtlas& operator=( const cTextureAtlas& i_atlas );
+		};
+	}
+}
+
+#endif
@@ -82,6 +82,22 @@ Engine::Math::cMatrix_transformation::cMatrix_transformation(const cQuaternion&
 	m_22 = 1.0f - _2xx - _2yy;
 }
 
+Engine::Math::cVector Engine::Math::cMatrix_transformation::TransformPoint(const cVector& i_point) const
+{
+	return cVector(
+		(i_point.m_x * m_00) + (i_point.m_y * m_10) + (i_point.m_z * m_20) + m_30,
+		(i_point.m_x * m_01) + (i_point.m_y * m_11) + (i_point.m_z * m_21) + m_31,
+		(i_point.m_x * m_02) + (i_point.m_y * m_12) + (i_point.m_z * m_22) + m_32);
+}
+
+Engine::Math::cVector Engine::Math::cMatrix_transformation::TransformDirection(const cVector& i_direction) const
+{
+	return cVector(
+		(i_direction.m_x * m_00) + (i_direction.m_y * m_10) + (i_direction.m_z * m_20),
+		(i_direction.m_x * m_01) + (i_direction.m_y * m_11) + (i_direction.m_z * m_21),
+		(i_direction.m_x * m_02) + (i_direction.m_y * m_12) + (i_direction.m_z * m_22));
+}
+
 Engine::Math::cMatrix_transformation::cMatrix_transformation(
 	const float i_00, const float i_10, const float i_20, const float i_30,
 	const float i_01, const float i_11, const float i_21, const float i_31,
@@ -28,6 +28,10 @@ namespace Engine
 			cMatrix_transformation();
 			cMatrix_transformation( const cQuaternion& i_rotation, const cVector& i_translation );
 
+			// Transforms the way that the shaders do (as a row vector multiplied on the left)
+			cVector TransformPoint( const cVector& i_point ) const;
+			cVector TransformDirection( const cVector& i_direction ) const;
+
 		private:
 
 			float m_00, m_10, m_20, m_30,
@@ -30,6 +30,18 @@ namespace Engine
 			sDataFromFile() : data( NULL ), size( 0 ) {}
 		};
 
+		// A read-only view of a whole file that the OS pages in on demand instead of copying it.
+		// The data stays valid until UnmapFile() is called
+		struct sMappedFile
+		{
+			const void* data;
+			size_t size;
+			void* fileHandle;
+			void* mappingHandle;
+
+			sMappedFile() : data( NULL ), size( 0 ), fileHandle( NULL ), mappingHandle( NULL ) {}
+		};
+
 		bool CopyFile( const char* const i_path_source, const char* i_path_target,
 			const bool i_shouldFunctionFailIfTargetAlreadyExists = false, const bool i_shouldTargetFileTimeBeModified = false,
 			std::string* o_errorMessage = NULL );
@@ -40,6 +52,8 @@ namespace Engine
 		bool GetLastWriteTime( const char* const i_path, uint64_t& o_lastWriteTime, std::string* const o_errorMessage = NULL );
 		bool InvalidateLastWriteTime( const char* const i_path, std::string* const o_errorMessage = NULL );
 		bool LoadBinaryFile( const char* const i_path, sDataFromFile& o_data, std::string* const o_errorMessage = NULL );
+		bool MapFile( const char* const i_path, sMappedFile& o_mappedFile, std::string* const o_errorMessage = NULL );
+		void UnmapFile( sMappedFile& io_mappedFile );
 		bool WriteBinaryFile( const char* const i_path, const void* const i_data, const size_t i_size, std::string* const o_errorMessage = NULL );
 	}
 }
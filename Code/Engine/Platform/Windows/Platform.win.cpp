@@ -58,6 +58,32 @@ bool Engine::Platform::LoadBinaryFile( const char* const i_path, sDataFromFile&
 	return result;
 }
 
+bool Engine::Platform::MapFile( const char* const i_path, sMappedFile& o_mappedFile, std::string* const o_errorMessage )
+{
+	Windows::sMappedFile mappedFile;
+	const bool result = Windows::MapFile( i_path, mappedFile, o_errorMessage );
+	{
+		o_mappedFile.data = mappedFile.data;
+		o_mappedFile.size = mappedFile.size;
+		o_mappedFile.fileHandle = mappedFile.fileHandle;
+		o_mappedFile.mappingHandle = mappedFile.mappingHandle;
+	}
+	return result;
+}
+
+void Engine::Platform::UnmapFile( sMappedFile& io_mappedFile )
+{
+	Windows::sMappedFile mappedFile;
+	{
+		mappedFile.data = io_mappedFile.data;
+		mappedFile.size = io_mappedFile.size;
+		mappedFile.fileHandle = ( io_mappedFile.fileHandle != NULL ) ? io_mappedFile.fileHandle : INVALID_HANDLE_VALUE;
+		mappedFile.mappingHandle = io_mappedFile.mappingHandle;
+	}
+	Windows::UnmapFile( mappedFile );
+	io_mappedFile = sMappedFile();
+}
+
 bool Engine::Platform::WriteBinaryFile( const char* const i_path, const void* const i_data, const size_t i_size, std::string* const o_errorMessage )
 {
 	return Windows::WriteBinaryFile( i_path, i_data, i_size, o_errorMessage );
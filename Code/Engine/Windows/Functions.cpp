@@ -689,6 +689,124 @@ OnExit:
 	return !wereThereErrors;
 }
 
+bool Engine::Windows::MapFile( const char* const i_path, sMappedFile& o_mappedFile, std::string* const o_errorMessage )
+{
+	bool wereThereErrors = false;
+
+	{
+		const DWORD desiredAccess = FILE_GENERIC_READ;
+		const DWORD otherProgramsCanStillReadTheFile = FILE_SHARE_READ;
+		SECURITY_ATTRIBUTES* useDefaultSecurity = NULL;
+		const DWORD onlySucceedIfFileExists = OPEN_EXISTING;
+		const DWORD readFromStartToEnd = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN;
+		const HANDLE dontUseTemplateFile = NULL;
+		o_mappedFile.fileHandle = CreateFile( i_path, desiredAccess, otherProgramsCanStillReadTheFile,
+			useDefaultSecurity, onlySucceedIfFileExists, readFromStartToEnd, dontUseTemplateFile );
+		if ( o_mappedFile.fileHandle == INVALID_HANDLE_VALUE )
+		{
+			wereThereErrors = true;
+			if ( o_errorMessage )
+			{
+				const std::string windowsError = Engine::Windows::GetLastSystemError();
+				std::ostringstream errorMessage;
+				errorMessage << "Windows failed to open the file \"" << i_path << "\" for reading: " << windowsError;
+				*o_errorMessage = errorMessage.str();
+			}
+			goto OnExit;
+		}
+	}
+	{
+		LARGE_INTEGER fileSize_integer;
+		if ( GetFileSizeEx( o_mappedFile.fileHandle, &fileSize_integer ) != FALSE )
+		{
+			ASSERT( fileSize_integer.QuadPart <= SIZE_MAX );
+			o_mappedFile.size = static_cast<size_t>( fileSize_integer.QuadPart );
+		}
+		else
+		{
+			wereThereErrors = true;
+			if ( o_errorMessage )
+			{
+				const std::string windowsError = Engine::Windows::GetLastSystemError();
+				std::ostringstream errorMessage;
+				errorMessage << "Windows failed to get the size of the file \"" << i_path << "\": " << windowsError;
+				*o_errorMessage = errorMessage.str();
+			}
+			goto OnExit;
+		}
+	}
+	// Empty files can't be mapped
+	if ( o_mappedFile.size == 0 )
+	{
+		goto OnExit;
+	}
+	{
+		SECURITY_ATTRIBUTES* useDefaultSecurity = NULL;
+		const DWORD mapTheWholeFile = 0;
+		const char* const noName = NULL;
+		o_mappedFile.mappingHandle = CreateFileMapping( o_mappedFile.fileHandle, useDefaultSecurity, PAGE_READONLY,
+			mapTheWholeFile, mapTheWholeFile, noName );
+		if ( o_mappedFile.mappingHandle == NULL )
+		{
+			wereThereErrors = true;
+			if ( o_errorMessage )
+			{
+				const std::string windowsError = Engine::Windows::GetLastSystemError();
+				std::ostringstream errorMessage;
+				errorMessage << "Windows failed to create a mapping of the file \"" << i_path << "\": " << windowsError;
+				*o_errorMessage = errorMessage.str();
+			}
+			goto OnExit;
+		}
+	}
+	{
+		const DWORD fromTheStart = 0;
+		const SIZE_T mapTheWholeFile = 0;
+		o_mappedFile.data = MapViewOfFile( o_mappedFile.mappingHandle, FILE_MAP_READ, fromTheStart, fromTheStart, mapTheWholeFile );
+		if ( o_mappedFile.data == NULL )
+		{
+			wereThereErrors = true;
+			if ( o_errorMessage )
+			{
+				const std::string windowsError = Engine::Windows::GetLastSystemError();
+				std::ostringstream errorMessage;
+				errorMessage << "Windows failed to map a view of the file \"" << i_path << "\": " << windowsError;
+				*o_errorMessage = errorMessage.str();
+			}
+			goto OnExit;
+		}
+	}
+
+OnExit:
+
+	if ( wereThereErrors )
+	{
+		UnmapFile( o_mappedFile );
+	}
+
+	return !wereThereErrors;
+}
+
+void Engine::Windows::UnmapFile( sMappedFile& io_mappedFile )
+{
+	if ( io_mappedFile.data != NULL )
+	{
+		UnmapViewOfFile( io_mappedFile.data );
+		io_mappedFile.data = NULL;
+	}
+	if ( io_mappedFile.mappingHandle != NULL )
+	{
+		CloseHandle( io_mappedFile.mappingHandle );
+		io_mappedFile.mappingHandle = NULL;
+	}
+	if ( io_mappedFile.fileHandle != INVALID_HANDLE_VALUE )
+	{
+		CloseHandle( io_mappedFile.fileHandle );
+		io_mappedFile.fileHandle = INVALID_HANDLE_VALUE;
+	}
+	io_mappedFile.size = 0;
+}
+
 bool Engine::Windows::WriteBinaryFile( const char* const i_path, const void* const i_data, const size_t i_size, std::string* const o_errorMessage )
 {
 	bool wereThereErrors = false;
@@ -33,6 +33,8 @@ PFNGLBUFFERDATAPROC glBufferData = NULL;
 PFNGLBUFFERSUBDATAPROC glBufferSubData = NULL;
 PFNGLCOMPILESHADERPROC glCompileShader = NULL;
 PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage2D = NULL;
+PFNGLCOMPRESSEDTEXIMAGE3DPROC glCompressedTexImage3D = NULL;
+PFNGLCOMPRESSEDTEXSUBIMAGE3DPROC glCompressedTexSubImage3D = NULL;
 PFNGLCREATEPROGRAMPROC glCreateProgram = NULL;
 PFNGLCREATESHADERPROC glCreateShader = NULL;
 PFNGLDELETEBUFFERSPROC glDeleteBuffers = NULL;
@@ -40,6 +42,7 @@ PFNGLDELETEPROGRAMPROC glDeleteProgram = NULL;
 PFNGLDELETESAMPLERSPROC glDeleteSamplers = NULL;
 PFNGLDELETESHADERPROC glDeleteShader = NULL;
 PFNGLDELETEVERTEXARRAYSPROC glDeleteVertexArrays = NULL;
+PFNGLDRAWELEMENTSBASEVERTEXPROC glDrawElementsBaseVertex = NULL;
 PFNGLENABLEVERTEXATTRIBARRAYARBPROC glEnableVertexAttribArray = NULL;
 PFNGLGENBUFFERSPROC glGenBuffers = NULL;
 PFNGLGENSAMPLERSPROC glGenSamplers = NULL;
@@ -108,6 +111,8 @@ bool Engine::OpenGlExtensions::Load( std::string* o_errorMessage )
 	OPENGLEXTENSIONS_LOADFUNCTION( glBufferSubData, PFNGLBUFFERSUBDATAPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glCompileShader, PFNGLCOMPILESHADERPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glCompressedTexImage2D, PFNGLCOMPRESSEDTEXIMAGE2DPROC );
+	OPENGLEXTENSIONS_LOADFUNCTION( glCompressedTexImage3D, PFNGLCOMPRESSEDTEXIMAGE3DPROC );
+	OPENGLEXTENSIONS_LOADFUNCTION( glCompressedTexSubImage3D, PFNGLCOMPRESSEDTEXSUBIMAGE3DPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glCreateProgram, PFNGLCREATEPROGRAMPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glCreateShader, PFNGLCREATESHADERPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glDeleteBuffers, PFNGLDELETEBUFFERSPROC );
@@ -115,6 +120,7 @@ bool Engine::OpenGlExtensions::Load( std::string* o_errorMessage )
 	OPENGLEXTENSIONS_LOADFUNCTION( glDeleteVertexArrays, PFNGLDELETEVERTEXARRAYSPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glDeleteSamplers, PFNGLDELETESAMPLERSPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glDeleteShader, PFNGLDELETESHADERPROC );
+	OPENGLEXTENSIONS_LOADFUNCTION( glDrawElementsBaseVertex, PFNGLDRAWELEMENTSBASEVERTEXPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glEnableVertexAttribArray, PFNGLENABLEVERTEXATTRIBARRAYARBPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glGenBuffers, PFNGLGENBUFFERSPROC );
 	OPENGLEXTENSIONS_LOADFUNCTION( glGenSamplers, PFNGLGENSAMPLERSPROC );
@@ -1,6 +1,6 @@
 #include "cMyGame.h"
 
-Engine::cMyGame::cMyGame() : m_numMesh(8), m_numMat(4), m_meshData(nullptr), s_camPos(nullptr), s_camOri(nullptr), s_Camera(nullptr), m_meshMat(nullptr)
+Engine::cMyGame::cMyGame() : m_numMesh(8), m_numMat(4), m_meshData(nullptr), spr1(nullptr), s_camPos(nullptr), s_camOri(nullptr), s_Camera(nullptr), m_meshMat(nullptr), m_uiAtlas(nullptr)
 {
 
 }
@@ -23,6 +23,9 @@ bool Engine::cMyGame::Initialize()
 	const char* const matpath3 = "data/Materials/mat3.bin";
 	const char* const matpath4 = "data/Materials/mat4.bin";
 
+	const char* const atlaspath = "data/Atlases/UI.bin";
+	const char* const texturealiaspath = "data/TextureAliases.bin";
+
 	m_meshData = new Engine::Graphics::MeshData[m_numMesh];
 	for (int i = 0; i < m_numMesh; i++)
 	{
@@ -34,10 +37,16 @@ bool Engine::cMyGame::Initialize()
 	s_camPos = new Engine::Math::cVector(0.0f, 5.0f, 20.0f);
 	s_camOri = new Engine::Math::cQuaternion;
 	s_Camera = new Engine::Camera::Camera(*s_camPos, *s_camOri, Engine::Math::ConvertDegreesToRadians(60.0f), 0.1f, 100.0f);
-	spr1 = new Engine::Graphics::cSprite(-0.3f, 0.3f, 1.0f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f);
-	spr1->Initialize();
 	bool wereThereErrors = false;
 
+	m_uiAtlas = new Engine::Graphics::cTextureAtlas;
+	if (!m_uiAtlas->Load(atlaspath))
+	{
+		wereThereErrors = true;
+	}
+	spr1 = new Engine::Graphics::cSprite(-0.3f, 0.3f, 1.0f, 0.5f, *m_uiAtlas, "alien");
+	spr1->Initialize();
+
 	if (!m_meshData->s_mesh->LoadFile(path))
 	{
 		wereThereErrors = true;
@@ -70,6 +79,11 @@ bool Engine::cMyGame::Initialize()
 	{
 		wereThereErrors = true;
 	}
+	// Materials whose textures have the same contents share one texture
+	if (!Engine::Graphics::cTexture::LoadAliases(texturealiaspath))
+	{
+		wereThereErrors = true;
+	}
 	if (!m_meshMat->Load(matpath1))
 	{
 		wereThereErrors = true;
@@ -178,6 +192,11 @@ bool Engine::cMyGame::CleanUp()
 		spr1->CleanUp();
 		delete spr1;
 	}
+	if (m_uiAtlas)
+	{
+		m_uiAtlas->CleanUp();
+		delete m_uiAtlas;
+	}
 
 	Engine::Graphics::GraphicsData::Destroy();
 
@@ -14,6 +14,7 @@
 #include "../../Engine/Math/cQuaternion.h"
 #include "../../Engine/Graphics/Camera.h"
 #include "../../Engine/Graphics/cSprite.h"
+#include "../../Engine/Graphics/cTextureAtlas.h"
 
 #if defined( PLATFORM_WINDOWS )
 #include "Resource Files/Resource.h"
@@ -63,6 +64,7 @@ namespace Engine
 		Camera::Camera* s_Camera;
 
 		Engine::Graphics::Materials::Material* m_meshMat;
+		Engine::Graphics::cTextureAtlas* m_uiAtlas;
 	};
 }
 
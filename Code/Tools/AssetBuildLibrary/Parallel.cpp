@@ -0,0 +1,45 @@
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+unsigned int Engine::AssetBuild::GetWorkerThreadCount()
+{
+	// hardware_concurrency() is allowed to return 0 when it doesn't know
+	return std::max( std::thread::hardware_concurrency(), 1u );
+}
+
+void Engine::AssetBuild::ParallelFor( const size_t i_count, const std::function<void( const size_t )>& i_function )
+{
+	const size_t threadCount = std::min( static_cast<size_t>( GetWorkerThreadCount() ), i_count );
+	if ( threadCount <= 1 )
+	{
+		for ( size_t i = 0; i < i_count; ++i )
+		{
+			i_function( i );
+		}
+		return;
+	}
+
+	// Work is handed out one index at a time so that uneven items don't leave threads idle
+	std::atomic<size_t> nextIndex( 0 );
+	const auto work = [&]()
+	{
+		for ( size_t i = nextIndex++; i < i_count; i = nextIndex++ )
+		{
+			i_function( i );
+		}
+	};
+	std::vector<std::thread> threads;
+	threads.reserve( threadCount - 1 );
+	for ( size_t i = 1; i < threadCount; ++i )
+	{
+		threads.push_back( std::thread( work ) );
+	}
+	work();
+	for ( std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); ++it )
+	{
+		it->join();
+	}
+}
@@ -0,0 +1,21 @@
+#ifndef ASSETBUILD_PARALLEL_H
+#define ASSETBUILD_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		// The number of threads (including the calling one) that parallel work is split across
+		unsigned int GetWorkerThreadCount();
+
+		// Calls i_function( i ) for every i in [0, i_count) and returns once all of the calls have finished.
+		// The calls run on up to GetWorkerThreadCount() threads in no particular order,
+		// and so each one must only write to its own outputs (which keeps the results deterministic)
+		void ParallelFor( const size_t i_count, const std::function<void( const size_t )>& i_function );
+	}
+}
+
+#endif
@@ -167,3 +167,61 @@ void Engine::AssetBuild::OutputErrorMessage( const char* const i_errorMessage, c
 	std::cerr << ( i_optionalFileName ? i_optionalFileName : "Asset Build" ) << ": error: " <<
 		i_errorMessage << "\n";
 }
+
+bool Engine::AssetBuild::LoadTableFromFile( const char* const i_path, const char* const i_notATableErrorMessage, lua_State*& o_luaState )
+{
+	bool wereThereErrors = false;
+
+	o_luaState = luaL_newstate();
+	if ( !o_luaState )
+	{
+		wereThereErrors = true;
+		OutputErrorMessage( "Failed to create a new Lua state", i_path );
+		goto OnExit;
+	}
+
+	{
+		const int stackTopBeforeLoad = lua_gettop( o_luaState );
+		{
+			const int luaResult = luaL_loadfile( o_luaState, i_path );
+			if ( luaResult != LUA_OK )
+			{
+				wereThereErrors = true;
+				OutputErrorMessage( lua_tostring( o_luaState, -1 ), i_path );
+				lua_pop( o_luaState, 1 );
+				goto OnExit;
+			}
+		}
+		{
+			const int argumentCount = 0;
+			const int returnValueCount = LUA_MULTRET;
+			const int noMessageHandler = 0;
+			const int luaResult = lua_pcall( o_luaState, argumentCount, returnValueCount, noMessageHandler );
+			if ( luaResult != LUA_OK )
+			{
+				wereThereErrors = true;
+				OutputErrorMessage( lua_tostring( o_luaState, -1 ), i_path );
+				lua_pop( o_luaState, 1 );
+				goto OnExit;
+			}
+			const int returnedValueCount = lua_gettop( o_luaState ) - stackTopBeforeLoad;
+			if ( ( returnedValueCount != 1 ) || !lua_istable( o_luaState, -1 ) )
+			{
+				wereThereErrors = true;
+				OutputErrorMessage( i_notATableErrorMessage, i_path );
+				lua_pop( o_luaState, returnedValueCount );
+				goto OnExit;
+			}
+		}
+	}
+
+OnExit:
+
+	if ( wereThereErrors && o_luaState )
+	{
+		lua_close( o_luaState );
+		o_luaState = NULL;
+	}
+
+	return !wereThereErrors;
+}
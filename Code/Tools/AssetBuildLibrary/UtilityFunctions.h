@@ -3,6 +3,8 @@
 
 #include <string>
 
+struct lua_State;
+
 namespace Engine
 {
 	namespace AssetBuild
@@ -11,6 +13,9 @@ namespace Engine
 			std::string& o_builtRelativePath, std::string* const o_errorMessage );
 
 		bool GetAssetBuildSystemPath( std::string& o_path, std::string* const o_errorMessage );
+		// Runs a Lua source file that must return a single table, and leaves the table on top of a new Lua state's stack.
+		// The caller must pop the table and close the state; if loading fails the errors are output and the state is NULL
+		bool LoadTableFromFile( const char* const i_path, const char* const i_notATableErrorMessage, lua_State*& o_luaState );
 		void OutputErrorMessage( const char* const i_errorMessage, const char* const i_optionalFileName = NULL );
 	}
 }
@@ -9,6 +9,7 @@ bool Engine::AssetBuild::cbBuilder::ParseCommandArgumentsAndBuild( char** i_argu
 	const unsigned int requiredArgumentCount = 2;
 	if ( actualArgumentCount >= requiredArgumentCount )
 	{
+		m_path_builder = i_arguments[0];
 		m_path_source = i_arguments[commandCount + 0];
 		m_path_target = i_arguments[commandCount + 1];
 
@@ -43,7 +44,7 @@ bool Engine::AssetBuild::cbBuilder::ParseCommandArgumentsAndBuild( char** i_argu
 
 Engine::AssetBuild::cbBuilder::cbBuilder()
 	:
-	m_path_source( NULL ), m_path_target( NULL )
+	m_path_builder( NULL ), m_path_source( NULL ), m_path_target( NULL )
 {
 
 }
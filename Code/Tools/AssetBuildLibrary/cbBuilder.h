@@ -24,6 +24,8 @@ namespace Engine
 			cbBuilder();
 
 		protected:
+			// The builder's own executable
+			const char* m_path_builder;
 			const char* m_path_source;
 			const char* m_path_target;
 
@@ -0,0 +1,90 @@
+#include "BatchedBlockEncoder.h"
+
+#include "Internal.h"
+
+#if defined( _MSC_VER )
+	#include <intrin.h>
+	#include <immintrin.h>
+#endif
+
+namespace
+{
+	typedef void ( *tEncodeBlockRow )( const Engine::AssetBuild::BlockCompression::eFormat, const Engine::AssetBuild::BlockCompression::eQuality,
+		const uint8_t* const, const size_t, const size_t, const size_t, uint8_t* const );
+
+	struct sEncoder
+	{
+		tEncodeBlockRow encodeBlockRow;
+		unsigned int batchSize;
+	};
+
+	sEncoder ChooseEncoder();
+	const sEncoder& GetEncoder();
+}
+
+bool Engine::AssetBuild::BlockCompression::IsSupported()
+{
+	return GetEncoder().encodeBlockRow != NULL;
+}
+
+unsigned int Engine::AssetBuild::BlockCompression::GetBatchSize()
+{
+	return GetEncoder().batchSize;
+}
+
+void Engine::AssetBuild::BlockCompression::EncodeBlockRow( const eFormat i_format, const eQuality i_quality,
+	const uint8_t* const i_pixels, const size_t i_rowPitch, const size_t i_width, const size_t i_height, uint8_t* const o_blocks )
+{
+	const tEncodeBlockRow encodeBlockRow = GetEncoder().encodeBlockRow;
+	if ( encodeBlockRow )
+	{
+		encodeBlockRow( i_format, i_quality, i_pixels, i_rowPitch, i_width, i_height, o_blocks );
+	}
+}
+
+namespace
+{
+	sEncoder ChooseEncoder()
+	{
+		bool isSse41Supported = false, isAvx2Supported = false;
+#if defined( _MSC_VER )
+		{
+			int registers[4];
+			__cpuid( registers, 0 );
+			const int highestFunction = registers[0];
+			__cpuid( registers, 1 );
+			isSse41Supported = ( registers[2] & ( 1 << 19 ) ) != 0;
+			// AVX2 can only be used if the OS also saves the AVX registers
+			const bool isXsaveEnabled = ( registers[2] & ( 1 << 27 ) ) != 0;
+			const bool isAvxSupported = ( registers[2] & ( 1 << 28 ) ) != 0;
+			if ( isXsaveEnabled && isAvxSupported && ( ( _xgetbv( 0 ) & 0x6 ) == 0x6 ) && ( highestFunction >= 7 ) )
+			{
+				__cpuidex( registers, 7, 0 );
+				isAvx2Supported = ( registers[1] & ( 1 << 5 ) ) != 0;
+			}
+		}
+#else
+		__builtin_cpu_init();
+		isSse41Supported = __builtin_cpu_supports( "sse4.1" ) != 0;
+		isAvx2Supported = __builtin_cpu_supports( "avx2" ) != 0;
+#endif
+		sEncoder encoder = { NULL, 0 };
+		if ( isAvx2Supported )
+		{
+			encoder.encodeBlockRow = Engine::AssetBuild::BlockCompression::EncodeBlockRow_avx2;
+			encoder.batchSize = 8;
+		}
+		else if ( isSse41Supported )
+		{
+			encoder.encodeBlockRow = Engine::AssetBuild::BlockCompression::EncodeBlockRow_sse41;
+			encoder.batchSize = 4;
+		}
+		return encoder;
+	}
+
+	const sEncoder& GetEncoder()
+	{
+		static const sEncoder s_encoder = ChooseEncoder();
+		return s_encoder;
+	}
+}
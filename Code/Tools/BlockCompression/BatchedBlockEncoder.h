@@ -0,0 +1,53 @@
+#ifndef BLOCKCOMPRESSION_BATCHEDBLOCKENCODER_H
+#define BLOCKCOMPRESSION_BATCHEDBLOCKENCODER_H
+
+// An alternative to DirectXTex's BC1 and BC3 encoders that encodes several blocks at once,
+// with one SIMD lane per block (4 with SSE4.1 or 8 with AVX2, depending on what the CPU supports).
+// This library doesn't depend on DirectXTex or on the engine
+// so that TextureBuilder and the benchmark that compares it against DirectXTex can both use it
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace BlockCompression
+		{
+			enum eFormat
+			{
+				// Only the color is encoded (every pixel is treated as opaque)
+				BC1,
+				// The color is encoded like BC1 and the alpha is encoded separately with its own endpoints
+				BC3,
+			};
+
+			enum eQuality
+			{
+				// The color endpoints are the extremes of the block's pixels along their principal axis
+				Fast,
+				// The color endpoints are then refit with least squares to the indices that were chosen,
+				// which takes about twice as long
+				Refined,
+			};
+
+			// Returns false if the CPU doesn't support SSE4.1
+			// (in which case nothing can be encoded, and DirectXTex must be used instead)
+			bool IsSupported();
+			// Returns how many blocks are encoded together
+			unsigned int GetBatchSize();
+
+			inline size_t GetSizeOfBlock( const eFormat i_format ) { return ( i_format == BC1 ) ? 8 : 16; }
+
+			// Encodes one row of blocks from pixels with 8 bits per channel in RGBA order.
+			// The height is the number of rows of pixels (at most 4),
+			// and pixels past the right or bottom edge of the image are copied from the closest edge.
+			// The blocks are written one after another, and the results don't depend on the batch size
+			void EncodeBlockRow( const eFormat i_format, const eQuality i_quality,
+				const uint8_t* const i_pixels, const size_t i_rowPitch, const size_t i_width, const size_t i_height, uint8_t* const o_blocks );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,401 @@
+// The encoder is written once in terms of vector operations with one lane per block,
+// and this file is included by a source file for each instruction set
+// after it has defined the following for its vector width (in an anonymous namespace):
+//	tFloats, tInts, s_laneCount,
+//	SetAll(), Load(), Store(), Add(), Subtract(), Multiply(), Divide(), Min(), Max(), Round(), Floor(),
+//	IsLess(), IsEqual(), Select(), ConvertToInts(), ShiftLeft(), Or(), SetZeroInts(), and StoreInts().
+// Everything here is in an anonymous namespace too, and nothing from the standard library is used,
+// so that code compiled with different instructions can't be shared between the source files
+
+#include <cstring>
+
+// A multiply followed by an add must not be fused into one instruction (which only rounds once)
+// when the instruction set has FMA, or the blocks would depend on which source file encoded them
+#if defined( _MSC_VER )
+	#pragma fp_contract( off )
+#elif defined( __clang__ )
+	#pragma STDC FP_CONTRACT OFF
+#elif defined( __GNUC__ )
+	#pragma GCC optimize( "fp-contract=off" )
+#endif
+
+namespace
+{
+	// The 16 pixels of each block in a batch, stored by channel (RGBA) and then by pixel
+	struct sBatch
+	{
+		float values[4][16][s_laneCount];
+	};
+
+	struct sColorBlocks
+	{
+		// Each endpoint is stored both as it will be decoded (with 8 bits per channel) and packed as 5:6:5
+		tFloats endpoints[2][3];
+		tFloats packedEndpoints[2];
+		tFloats indices[16];
+		// The sum of the squared differences between the pixels and their decoded colors
+		tFloats error;
+	};
+
+	struct sAlphaBlocks
+	{
+		tFloats endpoints[2];
+		// The 3 bit indices of the first and last 8 pixels
+		tInts indices[2];
+	};
+
+	void GatherBatch( const uint8_t* const i_pixels, const size_t i_rowPitch, const size_t i_width, const size_t i_height,
+		const size_t i_firstBlock, const size_t i_blockCount, sBatch& o_batch )
+	{
+		for ( size_t lane = 0; lane < s_laneCount; ++lane )
+		{
+			// A partial batch is filled with copies of its last block
+			const size_t block = i_firstBlock + ( ( lane < i_blockCount ) ? lane : ( i_blockCount - 1 ) );
+			for ( size_t y = 0; y < 4; ++y )
+			{
+				const uint8_t* const row = i_pixels + ( ( ( y < i_height ) ? y : ( i_height - 1 ) ) * i_rowPitch );
+				for ( size_t x = 0; x < 4; ++x )
+				{
+					const size_t column = ( block * 4 ) + x;
+					const uint8_t* const pixel = row + ( ( ( column < i_width ) ? column : ( i_width - 1 ) ) * 4 );
+					for ( size_t channel = 0; channel < 4; ++channel )
+					{
+						o_batch.values[channel][( y * 4 ) + x][lane] = pixel[channel];
+					}
+				}
+			}
+		}
+	}
+
+	tFloats Clamp( const tFloats& i_value, const float i_min, const float i_max )
+	{
+		return Min( Max( i_value, SetAll( i_min ) ), SetAll( i_max ) );
+	}
+
+	// Rounds a color to the closest 5:6:5 color and replaces it with how that color is decoded
+	void QuantizeColor( tFloats io_color[3], tFloats& o_packed )
+	{
+		const tFloats red = Round( Multiply( Clamp( io_color[0], 0.0f, 255.0f ), SetAll( 31.0f / 255.0f ) ) );
+		const tFloats green = Round( Multiply( Clamp( io_color[1], 0.0f, 255.0f ), SetAll( 63.0f / 255.0f ) ) );
+		const tFloats blue = Round( Multiply( Clamp( io_color[2], 0.0f, 255.0f ), SetAll( 31.0f / 255.0f ) ) );
+		// The high bits are repeated in the low bits when a channel is expanded to 8 bits
+		io_color[0] = Add( Multiply( red, SetAll( 8.0f ) ), Floor( Multiply( red, SetAll( 1.0f / 4.0f ) ) ) );
+		io_color[1] = Add( Multiply( green, SetAll( 4.0f ) ), Floor( Multiply( green, SetAll( 1.0f / 16.0f ) ) ) );
+		io_color[2] = Add( Multiply( blue, SetAll( 8.0f ) ), Floor( Multiply( blue, SetAll( 1.0f / 4.0f ) ) ) );
+		o_packed = Add( Add( Multiply( red, SetAll( 2048.0f ) ), Multiply( green, SetAll( 32.0f ) ) ), blue );
+	}
+
+	void SelectColorIndices( const sBatch& i_batch, sColorBlocks& io_blocks )
+	{
+		// Index 0 and 1 are the endpoints, and 2 and 3 are a third and two thirds of the way from the first to the second
+		tFloats palette[4][3];
+		for ( size_t channel = 0; channel < 3; ++channel )
+		{
+			const tFloats& endpoint0 = io_blocks.endpoints[0][channel];
+			const tFloats& endpoint1 = io_blocks.endpoints[1][channel];
+			palette[0][channel] = endpoint0;
+			palette[1][channel] = endpoint1;
+			palette[2][channel] = Multiply( Add( Add( endpoint0, endpoint0 ), endpoint1 ), SetAll( 1.0f / 3.0f ) );
+			palette[3][channel] = Multiply( Add( Add( endpoint1, endpoint1 ), endpoint0 ), SetAll( 1.0f / 3.0f ) );
+		}
+		io_blocks.error = SetAll( 0.0f );
+		for ( size_t pixel = 0; pixel < 16; ++pixel )
+		{
+			const tFloats red = Load( i_batch.values[0][pixel] );
+			const tFloats green = Load( i_batch.values[1][pixel] );
+			const tFloats blue = Load( i_batch.values[2][pixel] );
+			tFloats closestError = SetAll( 1.0e30f ), closestIndex = SetAll( 0.0f );
+			for ( size_t index = 0; index < 4; ++index )
+			{
+				const tFloats differenceRed = Subtract( red, palette[index][0] );
+				const tFloats differenceGreen = Subtract( green, palette[index][1] );
+				const tFloats differenceBlue = Subtract( blue, palette[index][2] );
+				const tFloats error = Add( Add( Multiply( differenceRed, differenceRed ), Multiply( differenceGreen, differenceGreen ) ),
+					Multiply( differenceBlue, differenceBlue ) );
+				closestIndex = Select( IsLess( error, closestError ), SetAll( static_cast<float>( index ) ), closestIndex );
+				closestError = Min( error, closestError );
+			}
+			io_blocks.indices[pixel] = closestIndex;
+			io_blocks.error = Add( io_blocks.error, closestError );
+		}
+	}
+
+	// Quantizes the endpoints, orders them, and then chooses the closest index for every pixel
+	void FinishColorBlocks( const sBatch& i_batch, sColorBlocks& io_blocks )
+	{
+		QuantizeColor( io_blocks.endpoints[0], io_blocks.packedEndpoints[0] );
+		QuantizeColor( io_blocks.endpoints[1], io_blocks.packedEndpoints[1] );
+		// The first endpoint must be greater so that the block is decoded with 4 colors (instead of 3 and black)
+		{
+			const tFloats shouldSwap = IsLess( io_blocks.packedEndpoints[0], io_blocks.packedEndpoints[1] );
+			for ( size_t channel = 0; channel < 3; ++channel )
+			{
+				const tFloats endpoint0 = io_blocks.endpoints[0][channel];
+				io_blocks.endpoints[0][channel] = Select( shouldSwap, io_blocks.endpoints[1][channel], endpoint0 );
+				io_blocks.endpoints[1][channel] = Select( shouldSwap, endpoint0, io_blocks.endpoints[1][channel] );
+			}
+			const tFloats packedEndpoint0 = io_blocks.packedEndpoints[0];
+			io_blocks.packedEndpoints[0] = Select( shouldSwap, io_blocks.packedEndpoints[1], packedEndpoint0 );
+			io_blocks.packedEndpoints[1] = Select( shouldSwap, packedEndpoint0, io_blocks.packedEndpoints[1] );
+		}
+		SelectColorIndices( i_batch, io_blocks );
+	}
+
+	// Solves for the endpoints that minimize the squared error of the current indices
+	// (a block whose pixels all have the same weight keeps its current endpoints)
+	void RefitColorEndpoints( const sBatch& i_batch, const sColorBlocks& i_blocks, tFloats o_endpoints[2][3] )
+	{
+		tFloats sum_weight0Squared = SetAll( 0.0f ), sum_weight0Weight1 = SetAll( 0.0f ), sum_weight1Squared = SetAll( 0.0f );
+		tFloats sum_weight0Color[3] = { SetAll( 0.0f ), SetAll( 0.0f ), SetAll( 0.0f ) };
+		tFloats sum_weight1Color[3] = { SetAll( 0.0f ), SetAll( 0.0f ), SetAll( 0.0f ) };
+		for ( size_t pixel = 0; pixel < 16; ++pixel )
+		{
+			const tFloats& index = i_blocks.indices[pixel];
+			const tFloats weight0 = Select( IsEqual( index, SetAll( 0.0f ) ), SetAll( 1.0f ),
+				Select( IsEqual( index, SetAll( 1.0f ) ), SetAll( 0.0f ),
+				Select( IsEqual( index, SetAll( 2.0f ) ), SetAll( 2.0f / 3.0f ), SetAll( 1.0f / 3.0f ) ) ) );
+			const tFloats weight1 = Subtract( SetAll( 1.0f ), weight0 );
+			sum_weight0Squared = Add( sum_weight0Squared, Multiply( weight0, weight0 ) );
+			sum_weight0Weight1 = Add( sum_weight0Weight1, Multiply( weight0, weight1 ) );
+			sum_weight1Squared = Add( sum_weight1Squared, Multiply( weight1, weight1 ) );
+			for ( size_t channel = 0; channel < 3; ++channel )
+			{
+				const tFloats color = Load( i_batch.values[channel][pixel] );
+				sum_weight0Color[channel] = Add( sum_weight0Color[channel], Multiply( weight0, color ) );
+				sum_weight1Color[channel] = Add( sum_weight1Color[channel], Multiply( weight1, color ) );
+			}
+		}
+		const tFloats determinant = Subtract( Multiply( sum_weight0Squared, sum_weight1Squared ), Multiply( sum_weight0Weight1, sum_weight0Weight1 ) );
+		const tFloats isSolvable = IsLess( SetAll( 1.0f / 1024.0f ), determinant );
+		const tFloats determinant_reciprocal = Divide( SetAll( 1.0f ), Max( determinant, SetAll( 1.0f / 1024.0f ) ) );
+		for ( size_t channel = 0; channel < 3; ++channel )
+		{
+			const tFloats endpoint0 = Multiply( Subtract( Multiply( sum_weight1Squared, sum_weight0Color[channel] ),
+				Multiply( sum_weight0Weight1, sum_weight1Color[channel] ) ), determinant_reciprocal );
+			const tFloats endpoint1 = Multiply( Subtract( Multiply( sum_weight0Squared, sum_weight1Color[channel] ),
+				Multiply( sum_weight0Weight1, sum_weight0Color[channel] ) ), determinant_reciprocal );
+			o_endpoints[0][channel] = Select( isSolvable, endpoint0, i_blocks.endpoints[0][channel] );
+			o_endpoints[1][channel] = Select( isSolvable, endpoint1, i_blocks.endpoints[1][channel] );
+		}
+	}
+
+	void KeepBetterColorBlocks( const sColorBlocks& i_candidate, sColorBlocks& io_best )
+	{
+		const tFloats isBetter = IsLess( i_candidate.error, io_best.error );
+		for ( size_t endpoint = 0; endpoint < 2; ++endpoint )
+		{
+			for ( size_t channel = 0; channel < 3; ++channel )
+			{
+				io_best.endpoints[endpoint][channel] = Select( isBetter, i_candidate.endpoints[endpoint][channel], io_best.endpoints[endpoint][channel] );
+			}
+			io_best.packedEndpoints[endpoint] = Select( isBetter, i_candidate.packedEndpoints[endpoint], io_best.packedEndpoints[endpoint] );
+		}
+		for ( size_t pixel = 0; pixel < 16; ++pixel )
+		{
+			io_best.indices[pixel] = Select( isBetter, i_candidate.indices[pixel], io_best.indices[pixel] );
+		}
+		io_best.error = Min( i_candidate.error, io_best.error );
+	}
+
+	void EncodeColor( const sBatch& i_batch, const Engine::AssetBuild::BlockCompression::eQuality i_quality, sColorBlocks& o_blocks )
+	{
+		tFloats mean[3];
+		for ( size_t channel = 0; channel < 3; ++channel )
+		{
+			tFloats sum = SetAll( 0.0f );
+			for ( size_t pixel = 0; pixel < 16; ++pixel )
+			{
+				sum = Add( sum, Load( i_batch.values[channel][pixel] ) );
+			}
+			mean[channel] = Multiply( sum, SetAll( 1.0f / 16.0f ) );
+		}
+		// The covariance matrix is symmetric, and so only 6 of its elements are needed
+		// (rr, rg, rb, gg, gb, and bb)
+		tFloats covariance[6];
+		for ( size_t i = 0; i < 6; ++i )
+		{
+			covariance[i] = SetAll( 0.0f );
+		}
+		for ( size_t pixel = 0; pixel < 16; ++pixel )
+		{
+			const tFloats red = Subtract( Load( i_batch.values[0][pixel] ), mean[0] );
+			const tFloats green = Subtract( Load( i_batch.values[1][pixel] ), mean[1] );
+			const tFloats blue = Subtract( Load( i_batch.values[2][pixel] ), mean[2] );
+			covariance[0] = Add( covariance[0], Multiply( red, red ) );
+			covariance[1] = Add( covariance[1], Multiply( red, green ) );
+			covariance[2] = Add( covariance[2], Multiply( red, blue ) );
+			covariance[3] = Add( covariance[3], Multiply( green, green ) );
+			covariance[4] = Add( covariance[4], Multiply( green, blue ) );
+			covariance[5] = Add( covariance[5], Multiply( blue, blue ) );
+		}
+		// The principal axis is found by power iteration,
+		// starting from the row of the covariance matrix with the largest variance
+		// (which can't be perpendicular to the axis unless the colors don't vary at all)
+		tFloats axis[3] = { covariance[0], covariance[1], covariance[2] };
+		{
+			const tFloats isGreenLarger = IsLess( covariance[0], covariance[3] );
+			axis[0] = Select( isGreenLarger, covariance[1], axis[0] );
+			axis[1] = Select( isGreenLarger, covariance[3], axis[1] );
+			axis[2] = Select( isGreenLarger, covariance[4], axis[2] );
+			const tFloats isBlueLargest = IsLess( Max( covariance[0], covariance[3] ), covariance[5] );
+			axis[0] = Select( isBlueLargest, covariance[2], axis[0] );
+			axis[1] = Select( isBlueLargest, covariance[4], axis[1] );
+			axis[2] = Select( isBlueLargest, covariance[5], axis[2] );
+		}
+		const unsigned int iterationCount = ( i_quality == Engine::AssetBuild::BlockCompression::Fast ) ? 2 : 8;
+		for ( unsigned int i = 0; i < iterationCount; ++i )
+		{
+			const tFloats red = Add( Add( Multiply( covariance[0], axis[0] ), Multiply( covariance[1], axis[1] ) ), Multiply( covariance[2], axis[2] ) );
+			const tFloats green = Add( Add( Multiply( covariance[1], axis[0] ), Multiply( covariance[3], axis[1] ) ), Multiply( covariance[4], axis[2] ) );
+			const tFloats blue = Add( Add( Multiply( covariance[2], axis[0] ), Multiply( covariance[4], axis[1] ) ), Multiply( covariance[5], axis[2] ) );
+			// The axis is scaled so that its largest component is 1 to keep the values from overflowing
+			const tFloats largestComponent = Max( Max( Max( red, Subtract( SetAll( 0.0f ), red ) ), Max( green, Subtract( SetAll( 0.0f ), green ) ) ),
+				Max( blue, Subtract( SetAll( 0.0f ), blue ) ) );
+			const tFloats scale = Divide( SetAll( 1.0f ), Max( largestComponent, SetAll( 1.0e-20f ) ) );
+			axis[0] = Multiply( red, scale );
+			axis[1] = Multiply( green, scale );
+			axis[2] = Multiply( blue, scale );
+		}
+		// The initial endpoints are the extremes of the pixels projected onto the axis
+		{
+			tFloats projection_min = SetAll( 0.0f ), projection_max = SetAll( 0.0f );
+			for ( size_t pixel = 0; pixel < 16; ++pixel )
+			{
+				const tFloats projection = Add( Add(
+					Multiply( Subtract( Load( i_batch.values[0][pixel] ), mean[0] ), axis[0] ),
+					Multiply( Subtract( Load( i_batch.values[1][pixel] ), mean[1] ), axis[1] ) ),
+					Multiply( Subtract( Load( i_batch.values[2][pixel] ), mean[2] ), axis[2] ) );
+				projection_min = Min( projection, projection_min );
+				projection_max = Max( projection, projection_max );
+			}
+			const tFloats lengthSquared_reciprocal = Divide( SetAll( 1.0f ),
+				Max( Add( Add( Multiply( axis[0], axis[0] ), Multiply( axis[1], axis[1] ) ), Multiply( axis[2], axis[2] ) ), SetAll( 1.0e-20f ) ) );
+			projection_min = Multiply( projection_min, lengthSquared_reciprocal );
+			projection_max = Multiply( projection_max, lengthSquared_reciprocal );
+			for ( size_t channel = 0; channel < 3; ++channel )
+			{
+				o_blocks.endpoints[0][channel] = Add( mean[channel], Multiply( axis[channel], projection_max ) );
+				o_blocks.endpoints[1][channel] = Add( mean[channel], Multiply( axis[channel], projection_min ) );
+			}
+		}
+		FinishColorBlocks( i_batch, o_blocks );
+		if ( i_quality == Engine::AssetBuild::BlockCompression::Refined )
+		{
+			for ( unsigned int i = 0; i < 2; ++i )
+			{
+				sColorBlocks candidate;
+				RefitColorEndpoints( i_batch, o_blocks, candidate.endpoints );
+				FinishColorBlocks( i_batch, candidate );
+				KeepBetterColorBlocks( candidate, o_blocks );
+			}
+		}
+	}
+
+	// The endpoints are the minimum and maximum alpha,
+	// which always uses the mode with 6 interpolated values (and the indices are then just rounded)
+	void EncodeAlpha( const sBatch& i_batch, sAlphaBlocks& o_blocks )
+	{
+		tFloats alpha_min = Load( i_batch.values[3][0] ), alpha_max = alpha_min;
+		for ( size_t pixel = 1; pixel < 16; ++pixel )
+		{
+			const tFloats alpha = Load( i_batch.values[3][pixel] );
+			alpha_min = Min( alpha, alpha_min );
+			alpha_max = Max( alpha, alpha_max );
+		}
+		o_blocks.endpoints[0] = alpha_max;
+		o_blocks.endpoints[1] = alpha_min;
+		const tFloats scale = Divide( SetAll( 7.0f ), Max( Subtract( alpha_max, alpha_min ), SetAll( 1.0f ) ) );
+		o_blocks.indices[0] = o_blocks.indices[1] = SetZeroInts();
+		for ( size_t pixel = 0; pixel < 16; ++pixel )
+		{
+			// The steps are numbered from the minimum (0) to the maximum (7),
+			// but index 0 is the maximum, index 1 is the minimum, and indices 2-7 are the steps from the maximum down
+			const tFloats step = Round( Multiply( Subtract( Load( i_batch.values[3][pixel] ), alpha_min ), scale ) );
+			const tFloats index = Select( IsEqual( step, SetAll( 7.0f ) ), SetAll( 0.0f ),
+				Select( IsEqual( step, SetAll( 0.0f ) ), SetAll( 1.0f ), Subtract( SetAll( 8.0f ), step ) ) );
+			tInts& indices = o_blocks.indices[pixel / 8];
+			indices = Or( indices, ShiftLeft( ConvertToInts( index ), static_cast<int>( ( pixel % 8 ) * 3 ) ) );
+		}
+	}
+
+	void WriteBlocks( const Engine::AssetBuild::BlockCompression::eFormat i_format, const sColorBlocks& i_color, const sAlphaBlocks* const i_alpha,
+		const size_t i_blockCount, uint8_t* const o_blocks )
+	{
+		float packedEndpoints[2][s_laneCount];
+		Store( packedEndpoints[0], i_color.packedEndpoints[0] );
+		Store( packedEndpoints[1], i_color.packedEndpoints[1] );
+		int32_t colorIndices[s_laneCount];
+		{
+			// When both endpoints are the same the block is decoded with 3 colors and black,
+			// but every index is the same color anyway and so they are all set to the first one
+			const tFloats areEndpointsEqual = IsEqual( i_color.packedEndpoints[0], i_color.packedEndpoints[1] );
+			tInts indices = SetZeroInts();
+			for ( size_t pixel = 0; pixel < 16; ++pixel )
+			{
+				const tFloats index = Select( areEndpointsEqual, SetAll( 0.0f ), i_color.indices[pixel] );
+				indices = Or( indices, ShiftLeft( ConvertToInts( index ), static_cast<int>( pixel * 2 ) ) );
+			}
+			StoreInts( colorIndices, indices );
+		}
+		float alphaEndpoints[2][s_laneCount];
+		int32_t alphaIndices[2][s_laneCount];
+		if ( i_alpha )
+		{
+			Store( alphaEndpoints[0], i_alpha->endpoints[0] );
+			Store( alphaEndpoints[1], i_alpha->endpoints[1] );
+			StoreInts( alphaIndices[0], i_alpha->indices[0] );
+			StoreInts( alphaIndices[1], i_alpha->indices[1] );
+		}
+
+		const size_t blockSize = Engine::AssetBuild::BlockCompression::GetSizeOfBlock( i_format );
+		for ( size_t lane = 0; lane < i_blockCount; ++lane )
+		{
+			uint8_t* block = o_blocks + ( lane * blockSize );
+			if ( i_format == Engine::AssetBuild::BlockCompression::BC3 )
+			{
+				block[0] = static_cast<uint8_t>( alphaEndpoints[0][lane] );
+				block[1] = static_cast<uint8_t>( alphaEndpoints[1][lane] );
+				const uint64_t indices = static_cast<uint64_t>( static_cast<uint32_t>( alphaIndices[0][lane] ) )
+					| ( static_cast<uint64_t>( static_cast<uint32_t>( alphaIndices[1][lane] ) ) << 24 );
+				for ( size_t i = 0; i < 6; ++i )
+				{
+					block[2 + i] = static_cast<uint8_t>( indices >> ( i * 8 ) );
+				}
+				block += 8;
+			}
+			// The blocks are little-endian, like the CPU
+			const uint16_t endpoint0 = static_cast<uint16_t>( packedEndpoints[0][lane] );
+			const uint16_t endpoint1 = static_cast<uint16_t>( packedEndpoints[1][lane] );
+			const uint32_t indices = static_cast<uint32_t>( colorIndices[lane] );
+			memcpy( block, &endpoint0, sizeof( endpoint0 ) );
+			memcpy( block + 2, &endpoint1, sizeof( endpoint1 ) );
+			memcpy( block + 4, &indices, sizeof( indices ) );
+		}
+	}
+
+	void EncodeBlockRow_batched( const Engine::AssetBuild::BlockCompression::eFormat i_format, const Engine::AssetBuild::BlockCompression::eQuality i_quality,
+		const uint8_t* const i_pixels, const size_t i_rowPitch, const size_t i_width, const size_t i_height, uint8_t* const o_blocks )
+	{
+		if ( ( i_width == 0 ) || ( i_height == 0 ) )
+		{
+			return;
+		}
+		const size_t blockCount = ( i_width + 3 ) / 4;
+		const size_t blockSize = Engine::AssetBuild::BlockCompression::GetSizeOfBlock( i_format );
+		for ( size_t firstBlock = 0; firstBlock < blockCount; firstBlock += s_laneCount )
+		{
+			const size_t batchSize = ( ( blockCount - firstBlock ) < s_laneCount ) ? ( blockCount - firstBlock ) : s_laneCount;
+			sBatch batch;
+			GatherBatch( i_pixels, i_rowPitch, i_width, ( i_height < 4 ) ? i_height : 4, firstBlock, batchSize, batch );
+			sColorBlocks color;
+			EncodeColor( batch, i_quality, color );
+			sAlphaBlocks alpha;
+			const bool shouldEncodeAlpha = i_format == Engine::AssetBuild::BlockCompression::BC3;
+			if ( shouldEncodeAlpha )
+			{
+				EncodeAlpha( batch, alpha );
+			}
+			WriteBlocks( i_format, color, shouldEncodeAlpha ? &alpha : NULL, batchSize, o_blocks + ( firstBlock * blockSize ) );
+		}
+	}
+}
@@ -0,0 +1,41 @@
+// This file is compiled with AVX2 enabled (unlike the rest of the project),
+// and its functions are only called if the CPU supports it
+
+#include "Internal.h"
+
+#include <immintrin.h>
+
+namespace
+{
+	typedef __m256 tFloats;
+	typedef __m256i tInts;
+	const size_t s_laneCount = 8;
+
+	inline tFloats SetAll( const float i_value ) { return _mm256_set1_ps( i_value ); }
+	inline tFloats Load( const float* const i_values ) { return _mm256_loadu_ps( i_values ); }
+	inline void Store( float* const o_values, const tFloats& i_values ) { _mm256_storeu_ps( o_values, i_values ); }
+	inline tFloats Add( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm256_add_ps( i_lhs, i_rhs ); }
+	inline tFloats Subtract( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm256_sub_ps( i_lhs, i_rhs ); }
+	inline tFloats Multiply( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm256_mul_ps( i_lhs, i_rhs ); }
+	inline tFloats Divide( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm256_div_ps( i_lhs, i_rhs ); }
+	inline tFloats Min( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm256_min_ps( i_lhs, i_rhs ); }
+	inline tFloats Max( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm256_max_ps( i_lhs, i_rhs ); }
+	inline tFloats Round( const tFloats& i_values ) { return _mm256_round_ps( i_values, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ); }
+	inline tFloats Floor( const tFloats& i_values ) { return _mm256_floor_ps( i_values ); }
+	inline tFloats IsLess( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm256_cmp_ps( i_lhs, i_rhs, _CMP_LT_OQ ); }
+	inline tFloats IsEqual( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm256_cmp_ps( i_lhs, i_rhs, _CMP_EQ_OQ ); }
+	inline tFloats Select( const tFloats& i_mask, const tFloats& i_ifTrue, const tFloats& i_ifFalse ) { return _mm256_blendv_ps( i_ifFalse, i_ifTrue, i_mask ); }
+	inline tInts ConvertToInts( const tFloats& i_values ) { return _mm256_cvtps_epi32( i_values ); }
+	inline tInts ShiftLeft( const tInts& i_values, const int i_bitCount ) { return _mm256_sll_epi32( i_values, _mm_cvtsi32_si128( i_bitCount ) ); }
+	inline tInts Or( const tInts& i_lhs, const tInts& i_rhs ) { return _mm256_or_si256( i_lhs, i_rhs ); }
+	inline tInts SetZeroInts() { return _mm256_setzero_si256(); }
+	inline void StoreInts( int32_t* const o_values, const tInts& i_values ) { _mm256_storeu_si256( reinterpret_cast<__m256i*>( o_values ), i_values ); }
+}
+
+#include "BatchedBlockEncoder.inl"
+
+void Engine::AssetBuild::BlockCompression::EncodeBlockRow_avx2( const eFormat i_format, const eQuality i_quality,
+	const uint8_t* const i_pixels, const size_t i_rowPitch, const size_t i_width, const size_t i_height, uint8_t* const o_blocks )
+{
+	EncodeBlockRow_batched( i_format, i_quality, i_pixels, i_rowPitch, i_width, i_height, o_blocks );
+}
@@ -0,0 +1,38 @@
+#include "Internal.h"
+
+#include <smmintrin.h>
+
+namespace
+{
+	typedef __m128 tFloats;
+	typedef __m128i tInts;
+	const size_t s_laneCount = 4;
+
+	inline tFloats SetAll( const float i_value ) { return _mm_set1_ps( i_value ); }
+	inline tFloats Load( const float* const i_values ) { return _mm_loadu_ps( i_values ); }
+	inline void Store( float* const o_values, const tFloats& i_values ) { _mm_storeu_ps( o_values, i_values ); }
+	inline tFloats Add( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm_add_ps( i_lhs, i_rhs ); }
+	inline tFloats Subtract( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm_sub_ps( i_lhs, i_rhs ); }
+	inline tFloats Multiply( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm_mul_ps( i_lhs, i_rhs ); }
+	inline tFloats Divide( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm_div_ps( i_lhs, i_rhs ); }
+	inline tFloats Min( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm_min_ps( i_lhs, i_rhs ); }
+	inline tFloats Max( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm_max_ps( i_lhs, i_rhs ); }
+	inline tFloats Round( const tFloats& i_values ) { return _mm_round_ps( i_values, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC ); }
+	inline tFloats Floor( const tFloats& i_values ) { return _mm_floor_ps( i_values ); }
+	inline tFloats IsLess( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm_cmplt_ps( i_lhs, i_rhs ); }
+	inline tFloats IsEqual( const tFloats& i_lhs, const tFloats& i_rhs ) { return _mm_cmpeq_ps( i_lhs, i_rhs ); }
+	inline tFloats Select( const tFloats& i_mask, const tFloats& i_ifTrue, const tFloats& i_ifFalse ) { return _mm_blendv_ps( i_ifFalse, i_ifTrue, i_mask ); }
+	inline tInts ConvertToInts( const tFloats& i_values ) { return _mm_cvtps_epi32( i_values ); }
+	inline tInts ShiftLeft( const tInts& i_values, const int i_bitCount ) { return _mm_sll_epi32( i_values, _mm_cvtsi32_si128( i_bitCount ) ); }
+	inline tInts Or( const tInts& i_lhs, const tInts& i_rhs ) { return _mm_or_si128( i_lhs, i_rhs ); }
+	inline tInts SetZeroInts() { return _mm_setzero_si128(); }
+	inline void StoreInts( int32_t* const o_values, const tInts& i_values ) { _mm_storeu_si128( reinterpret_cast<__m128i*>( o_values ), i_values ); }
+}
+
+#include "BatchedBlockEncoder.inl"
+
+void Engine::AssetBuild::BlockCompression::EncodeBlockRow_sse41( const eFormat i_format, const eQuality i_quality,
+	const uint8_t* const i_pixels, const size_t i_rowPitch, const size_t i_width, const size_t i_height, uint8_t* const o_blocks )
+{
+	EncodeBlockRow_batched( i_format, i_quality, i_pixels, i_rowPitch, i_width, i_height, o_blocks );
+}
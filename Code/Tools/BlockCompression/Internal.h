@@ -0,0 +1,22 @@
+#ifndef BLOCKCOMPRESSION_INTERNAL_H
+#define BLOCKCOMPRESSION_INTERNAL_H
+
+#include "BatchedBlockEncoder.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace BlockCompression
+		{
+			// Each of these is compiled in its own source file with the instructions that it needs,
+			// and only the one that the CPU supports is called
+			void EncodeBlockRow_sse41( const eFormat i_format, const eQuality i_quality,
+				const uint8_t* const i_pixels, const size_t i_rowPitch, const size_t i_width, const size_t i_height, uint8_t* const o_blocks );
+			void EncodeBlockRow_avx2( const eFormat i_format, const eQuality i_quality,
+				const uint8_t* const i_pixels, const size_t i_rowPitch, const size_t i_width, const size_t i_height, uint8_t* const o_blocks );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,273 @@
+// Compares the quality (PSNR) and speed of the batched BC1/BC3 encoder against DirectXTex's encoder,
+// which is what TextureBuilder uses by default.
+// Every texture is compressed on a single thread (TextureBuilder spreads the same work over every core),
+// and without arguments a synthetic texture is used.
+// Usage: BlockCompressionBenchmark [texturePath...]
+
+#include <chrono>
+#include <cmath>
+#include <codecvt>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <locale>
+#include <string>
+#include <vector>
+#include "../../External/DirectXTex/Includes.h"
+#include "../BlockCompression/BatchedBlockEncoder.h"
+#include "../BlockCompression/Internal.h"
+
+namespace
+{
+	struct sQuality
+	{
+		double psnr_color;
+		double psnr_alpha;
+	};
+
+	bool LoadTexture( const char* const i_path, DirectX::ScratchImage& o_image );
+	void GenerateTexture( const size_t i_width, const size_t i_height, DirectX::ScratchImage& o_image );
+	double CompressWithDirectXTex( const DirectX::Image& i_image, const DXGI_FORMAT i_format, DirectX::ScratchImage& o_texture );
+	double CompressWithBatchedEncoder( const DirectX::Image& i_image, const DXGI_FORMAT i_format,
+		const Engine::AssetBuild::BlockCompression::eQuality i_quality, const bool i_shouldOnlyUseSse41, DirectX::ScratchImage& o_texture );
+	bool MeasureQuality( const DirectX::Image& i_image, const DirectX::ScratchImage& i_texture, sQuality& o_quality );
+}
+
+int main( int i_argumentCount, char** i_arguments )
+{
+	if ( !Engine::AssetBuild::BlockCompression::IsSupported() )
+	{
+		fprintf( stderr, "The batched encoder needs a CPU with SSE4.1\n" );
+		return EXIT_FAILURE;
+	}
+	if ( FAILED( CoInitialize( NULL ) ) )
+	{
+		fprintf( stderr, "COM couldn't be initialized\n" );
+		return EXIT_FAILURE;
+	}
+	printf( "The batched encoder encodes %u blocks at a time\n", Engine::AssetBuild::BlockCompression::GetBatchSize() );
+
+	bool wereThereErrors = false;
+	const int textureCount = ( i_argumentCount > 1 ) ? ( i_argumentCount - 1 ) : 1;
+	for ( int i = 0; i < textureCount; ++i )
+	{
+		DirectX::ScratchImage sourceImage;
+		const char* const name = ( i_argumentCount > 1 ) ? i_arguments[i + 1] : "Synthetic";
+		if ( i_argumentCount > 1 )
+		{
+			if ( !LoadTexture( name, sourceImage ) )
+			{
+				wereThereErrors = true;
+				continue;
+			}
+		}
+		else
+		{
+			GenerateTexture( 2048, 2048, sourceImage );
+		}
+		const DirectX::Image& image = *sourceImage.GetImage( 0, 0, 0 );
+		const DXGI_FORMAT format = sourceImage.IsAlphaAllOpaque() ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
+		const double megapixelCount = static_cast<double>( image.width * image.height ) / 1.0e6;
+		printf( "%s (%u x %u, %s):\n", name, static_cast<unsigned int>( image.width ), static_cast<unsigned int>( image.height ),
+			( format == DXGI_FORMAT_BC1_UNORM ) ? "BC1" : "BC3" );
+
+		DirectX::ScratchImage texture_directXTex;
+		const double seconds_directXTex = CompressWithDirectXTex( image, format, texture_directXTex );
+		sQuality quality_directXTex;
+		if ( ( seconds_directXTex < 0.0 ) || !MeasureQuality( image, texture_directXTex, quality_directXTex ) )
+		{
+			fprintf( stderr, "DirectXTex failed to compress %s\n", name );
+			wereThereErrors = true;
+			continue;
+		}
+		printf( "  DirectXTex:      %7.2f MP/s, PSNR %6.2f dB (color) %6.2f dB (alpha)\n",
+			megapixelCount / seconds_directXTex, quality_directXTex.psnr_color, quality_directXTex.psnr_alpha );
+
+		const Engine::AssetBuild::BlockCompression::eQuality qualities[] =
+			{ Engine::AssetBuild::BlockCompression::Fast, Engine::AssetBuild::BlockCompression::Refined };
+		const char* const qualityNames[] = { "Batched (fast):  ", "Batched (refined):" };
+		for ( size_t j = 0; j < 2; ++j )
+		{
+			DirectX::ScratchImage texture_batched, texture_sse41;
+			const double seconds_batched = CompressWithBatchedEncoder( image, format, qualities[j], false, texture_batched );
+			const double seconds_sse41 = CompressWithBatchedEncoder( image, format, qualities[j], true, texture_sse41 );
+			sQuality quality_batched;
+			if ( ( seconds_batched < 0.0 ) || ( seconds_sse41 < 0.0 ) || !MeasureQuality( image, texture_batched, quality_batched ) )
+			{
+				fprintf( stderr, "The batched encoder failed to compress %s\n", name );
+				wereThereErrors = true;
+				continue;
+			}
+			printf( "  %s %7.2f MP/s, PSNR %6.2f dB (color) %6.2f dB (alpha), %+.2f dB (color) compared to DirectXTex, %.1fx faster\n",
+				qualityNames[j], megapixelCount / seconds_batched, quality_batched.psnr_color, quality_batched.psnr_alpha,
+				quality_batched.psnr_color - quality_directXTex.psnr_color, seconds_directXTex / seconds_batched );
+			// The blocks must be the same no matter how many are encoded at a time
+			const DirectX::Image& blocks_batched = *texture_batched.GetImage( 0, 0, 0 );
+			const DirectX::Image& blocks_sse41 = *texture_sse41.GetImage( 0, 0, 0 );
+			if ( memcmp( blocks_batched.pixels, blocks_sse41.pixels, blocks_batched.slicePitch ) != 0 )
+			{
+				fprintf( stderr, "The blocks encoded with AVX2 don't match the blocks encoded with SSE4.1\n" );
+				wereThereErrors = true;
+			}
+		}
+	}
+
+	CoUninitialize();
+	return wereThereErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+namespace
+{
+	bool LoadTexture( const char* const i_path, DirectX::ScratchImage& o_image )
+	{
+		std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> stringConverter;
+		const std::wstring path( stringConverter.from_bytes( i_path ) );
+		const std::wstring extension = path.substr( path.find_last_of( L'.' ) + 1 );
+		DirectX::ScratchImage loadedImage;
+		HRESULT result;
+		if ( extension == L"dds" )
+		{
+			result = DirectX::LoadFromDDSFile( path.c_str(), DirectX::DDS_FLAGS_EXPAND_LUMINANCE, NULL, loadedImage );
+		}
+		else if ( extension == L"tga" )
+		{
+			result = DirectX::LoadFromTGAFile( path.c_str(), NULL, loadedImage );
+		}
+		else
+		{
+			result = DirectX::LoadFromWICFile( path.c_str(), DirectX::WIC_FLAGS_IGNORE_SRGB, NULL, loadedImage );
+		}
+		if ( FAILED( result ) )
+		{
+			fprintf( stderr, "%s couldn't be loaded\n", i_path );
+			return false;
+		}
+		// Only the first image is compressed, and both encoders are given the same 8 bit RGBA pixels
+		const DirectX::Image& image = *loadedImage.GetImage( 0, 0, 0 );
+		if ( DirectX::IsCompressed( image.format ) )
+		{
+			result = DirectX::Decompress( image, DXGI_FORMAT_R8G8B8A8_UNORM, o_image );
+		}
+		else if ( image.format != DXGI_FORMAT_R8G8B8A8_UNORM )
+		{
+			result = DirectX::Convert( image, DXGI_FORMAT_R8G8B8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, o_image );
+		}
+		else
+		{
+			result = o_image.InitializeFromImage( image );
+		}
+		if ( FAILED( result ) )
+		{
+			fprintf( stderr, "%s couldn't be converted to 8 bit RGBA\n", i_path );
+			return false;
+		}
+		return true;
+	}
+
+	void GenerateTexture( const size_t i_width, const size_t i_height, DirectX::ScratchImage& o_image )
+	{
+		// Smooth gradients (where the endpoints matter most) with some noise and hard edges,
+		// and an alpha channel so that BC3 is tested
+		o_image.Initialize2D( DXGI_FORMAT_R8G8B8A8_UNORM, i_width, i_height, 1, 1 );
+		const DirectX::Image& image = *o_image.GetImage( 0, 0, 0 );
+		uint32_t randomState = 1;
+		for ( size_t y = 0; y < i_height; ++y )
+		{
+			uint8_t* const row = image.pixels + ( y * image.rowPitch );
+			for ( size_t x = 0; x < i_width; ++x )
+			{
+				randomState = ( randomState * 1664525u ) + 1013904223u;
+				const float noise = static_cast<float>( randomState >> 24 ) / 16.0f - 8.0f;
+				const float u = static_cast<float>( x ) / static_cast<float>( i_width );
+				const float v = static_cast<float>( y ) / static_cast<float>( i_height );
+				const bool isStripe = ( ( x / 64 ) % 5 ) == 0;
+				const float color[4] =
+				{
+					128.0f + ( 100.0f * std::sin( u * 20.0f ) ) + noise,
+					isStripe ? 30.0f : ( 255.0f * v ),
+					128.0f + ( 110.0f * std::cos( u * v * 40.0f ) ) + ( noise * 0.5f ),
+					255.0f * ( 0.5f + ( 0.5f * std::sin( ( u * 7.0f ) + ( v * 3.0f ) ) ) ),
+				};
+				for ( size_t channel = 0; channel < 4; ++channel )
+				{
+					const float value = ( color[channel] < 0.0f ) ? 0.0f : ( ( color[channel] > 255.0f ) ? 255.0f : color[channel] );
+					row[( x * 4 ) + channel] = static_cast<uint8_t>( value + 0.5f );
+				}
+			}
+		}
+	}
+
+	double CompressWithDirectXTex( const DirectX::Image& i_image, const DXGI_FORMAT i_format, DirectX::ScratchImage& o_texture )
+	{
+		const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		if ( FAILED( DirectX::Compress( i_image, i_format, DirectX::TEX_COMPRESS_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT, o_texture ) ) )
+		{
+			return -1.0;
+		}
+		return std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+	}
+
+	double CompressWithBatchedEncoder( const DirectX::Image& i_image, const DXGI_FORMAT i_format,
+		const Engine::AssetBuild::BlockCompression::eQuality i_quality, const bool i_shouldOnlyUseSse41, DirectX::ScratchImage& o_texture )
+	{
+		if ( FAILED( o_texture.Initialize2D( i_format, i_image.width, i_image.height, 1, 1 ) ) )
+		{
+			return -1.0;
+		}
+		const DirectX::Image& texture = *o_texture.GetImage( 0, 0, 0 );
+		const Engine::AssetBuild::BlockCompression::eFormat format = ( i_format == DXGI_FORMAT_BC1_UNORM ) ?
+			Engine::AssetBuild::BlockCompression::BC1 : Engine::AssetBuild::BlockCompression::BC3;
+		const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		for ( size_t firstRow = 0, blockRow = 0; firstRow < i_image.height; firstRow += 4, ++blockRow )
+		{
+			const uint8_t* const pixels = i_image.pixels + ( firstRow * i_image.rowPitch );
+			const size_t rowCount = ( ( i_image.height - firstRow ) < 4 ) ? ( i_image.height - firstRow ) : 4;
+			uint8_t* const blocks = texture.pixels + ( blockRow * texture.rowPitch );
+			if ( i_shouldOnlyUseSse41 )
+			{
+				Engine::AssetBuild::BlockCompression::EncodeBlockRow_sse41( format, i_quality, pixels, i_image.rowPitch, i_image.width, rowCount, blocks );
+			}
+			else
+			{
+				Engine::AssetBuild::BlockCompression::EncodeBlockRow( format, i_quality, pixels, i_image.rowPitch, i_image.width, rowCount, blocks );
+			}
+		}
+		return std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+	}
+
+	bool MeasureQuality( const DirectX::Image& i_image, const DirectX::ScratchImage& i_texture, sQuality& o_quality )
+	{
+		DirectX::ScratchImage decompressedImage;
+		if ( FAILED( DirectX::Decompress( *i_texture.GetImage( 0, 0, 0 ), DXGI_FORMAT_R8G8B8A8_UNORM, decompressedImage ) ) )
+		{
+			return false;
+		}
+		const DirectX::Image& decompressed = *decompressedImage.GetImage( 0, 0, 0 );
+		double squaredError_color = 0.0, squaredError_alpha = 0.0;
+		for ( size_t y = 0; y < i_image.height; ++y )
+		{
+			const uint8_t* const sourceRow = i_image.pixels + ( y * i_image.rowPitch );
+			const uint8_t* const decompressedRow = decompressed.pixels + ( y * decompressed.rowPitch );
+			for ( size_t x = 0; x < ( i_image.width * 4 ); ++x )
+			{
+				const double difference = static_cast<double>( sourceRow[x] ) - static_cast<double>( decompressedRow[x] );
+				if ( ( x % 4 ) == 3 )
+				{
+					squaredError_alpha += difference * difference;
+				}
+				else
+				{
+					squaredError_color += difference * difference;
+				}
+			}
+		}
+		// A perfect match is reported as 100 dB instead of infinity
+		const double pixelCount = static_cast<double>( i_image.width * i_image.height );
+		const double meanSquaredError_color = squaredError_color / ( pixelCount * 3.0 );
+		const double meanSquaredError_alpha = squaredError_alpha / pixelCount;
+		o_quality.psnr_color = ( meanSquaredError_color > 0.0 ) ? ( 10.0 * std::log10( ( 255.0 * 255.0 ) / meanSquaredError_color ) ) : 100.0;
+		o_quality.psnr_alpha = ( meanSquaredError_alpha > 0.0 ) ? ( 10.0 * std::log10( ( 255.0 * 255.0 ) / meanSquaredError_alpha ) ) : 100.0;
+		return true;
+	}
+}
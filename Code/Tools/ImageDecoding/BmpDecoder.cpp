@@ -0,0 +1,248 @@
+#include "Internal.h"
+
+#include <cstring>
+
+namespace
+{
+	namespace Compressions
+	{
+		enum eCompression
+		{
+			Rgb = 0,
+			Rle8 = 1,
+			Rle4 = 2,
+			BitFields = 3,
+			AlphaBitFields = 6,
+		};
+	}
+
+	const size_t s_fileHeaderSize = 14;
+
+	inline uint32_t ReadLittleEndian32( const uint8_t* const i_data )
+	{
+		return i_data[0] | ( static_cast<uint32_t>( i_data[1] ) << 8 ) | ( static_cast<uint32_t>( i_data[2] ) << 16 )
+			| ( static_cast<uint32_t>( i_data[3] ) << 24 );
+	}
+	inline unsigned int ReadLittleEndian16( const uint8_t* const i_data )
+	{
+		return i_data[0] | ( static_cast<unsigned int>( i_data[1] ) << 8 );
+	}
+
+	// A channel stored as a bit mask is extracted and scaled to 8 bits
+	struct sChannelMask
+	{
+		uint32_t mask;
+		unsigned int shift;
+		unsigned int bitCount;
+
+		uint8_t Extract( const uint32_t i_value ) const
+		{
+			if ( mask == 0 )
+			{
+				return 0;
+			}
+			const uint32_t value = ( i_value & mask ) >> shift;
+			if ( bitCount >= 8 )
+			{
+				return static_cast<uint8_t>( value >> ( bitCount - 8 ) );
+			}
+			const uint32_t maxValue = ( 1u << bitCount ) - 1;
+			return static_cast<uint8_t>( ( ( value * 255 ) + ( maxValue / 2 ) ) / maxValue );
+		}
+
+		explicit sChannelMask( const uint32_t i_mask ) : mask( i_mask ), shift( 0 ), bitCount( 0 )
+		{
+			if ( mask != 0 )
+			{
+				while ( ( ( mask >> shift ) & 1 ) == 0 ) ++shift;
+				while ( ( shift + bitCount ) < 32 && ( ( ( mask >> ( shift + bitCount ) ) & 1 ) != 0 ) ) ++bitCount;
+			}
+		}
+	};
+}
+
+bool Engine::AssetBuild::ImageDecoding::DecodeBmp( const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image,
+	std::string* const o_errorMessage )
+{
+	if ( ( i_dataSize < ( s_fileHeaderSize + 12 ) ) || ( i_data[0] != 'B' ) || ( i_data[1] != 'M' ) )
+	{
+		return ReportError( "The BMP file is too small to have a header", o_errorMessage );
+	}
+	const size_t pixelDataOffset = ReadLittleEndian32( i_data + 10 );
+	const uint8_t* const infoHeader = i_data + s_fileHeaderSize;
+	const size_t infoHeaderSize = ReadLittleEndian32( infoHeader );
+	if ( ( infoHeaderSize != 12 ) && ( infoHeaderSize != 40 ) && ( infoHeaderSize != 52 ) && ( infoHeaderSize != 56 )
+		&& ( infoHeaderSize != 108 ) && ( infoHeaderSize != 124 ) )
+	{
+		return ReportError( "The BMP file's header version isn't supported", o_errorMessage );
+	}
+	if ( ( s_fileHeaderSize + infoHeaderSize ) > i_dataSize )
+	{
+		return ReportError( "The BMP file ends in the middle of its header", o_errorMessage );
+	}
+
+	// The original OS/2 header has 16 bit dimensions and 3 byte palette entries
+	const bool isOs2Header = infoHeaderSize == 12;
+	int64_t width, height;
+	unsigned int bitsPerPixel;
+	unsigned int compression = Compressions::Rgb;
+	size_t paletteEntryCount = 0;
+	uint32_t masks[4] = { 0 };
+	if ( isOs2Header )
+	{
+		width = ReadLittleEndian16( infoHeader + 4 );
+		height = ReadLittleEndian16( infoHeader + 6 );
+		bitsPerPixel = ReadLittleEndian16( infoHeader + 10 );
+	}
+	else
+	{
+		width = static_cast<int32_t>( ReadLittleEndian32( infoHeader + 4 ) );
+		height = static_cast<int32_t>( ReadLittleEndian32( infoHeader + 8 ) );
+		bitsPerPixel = ReadLittleEndian16( infoHeader + 14 );
+		compression = ReadLittleEndian32( infoHeader + 16 );
+		paletteEntryCount = ReadLittleEndian32( infoHeader + 32 );
+		if ( ( compression == Compressions::BitFields ) || ( compression == Compressions::AlphaBitFields ) )
+		{
+			// Version 1 headers store the masks after the header, and later versions store them in it
+			const size_t maskCount = ( compression == Compressions::AlphaBitFields ) ? 4 : 3;
+			const uint8_t* const maskData = infoHeader + 40;
+			if ( ( s_fileHeaderSize + 40 + ( maskCount * 4 ) ) > i_dataSize )
+			{
+				return ReportError( "The BMP file ends in the middle of its header", o_errorMessage );
+			}
+			for ( size_t i = 0; i < maskCount; ++i )
+			{
+				masks[i] = ReadLittleEndian32( maskData + ( i * 4 ) );
+			}
+		}
+		if ( ( infoHeaderSize >= 56 ) && ( compression != Compressions::AlphaBitFields ) )
+		{
+			masks[3] = ReadLittleEndian32( infoHeader + 52 );
+		}
+	}
+	if ( ( compression == Compressions::Rle8 ) || ( compression == Compressions::Rle4 ) )
+	{
+		return ReportError( "RLE-compressed BMP files aren't supported", o_errorMessage );
+	}
+	if ( ( compression != Compressions::Rgb ) && ( compression != Compressions::BitFields ) && ( compression != Compressions::AlphaBitFields ) )
+	{
+		return ReportError( "The BMP file's compression isn't supported", o_errorMessage );
+	}
+	// A negative height means that the rows are stored starting with the top one
+	const bool isTopToBottom = height < 0;
+	if ( isTopToBottom )
+	{
+		height = -height;
+	}
+	if ( ( width <= 0 ) || ( height == 0 ) || ( static_cast<uint64_t>( width * height ) > s_maxPixelCount ) )
+	{
+		return ReportError( "The BMP file's dimensions are invalid or too big", o_errorMessage );
+	}
+	if ( ( bitsPerPixel != 1 ) && ( bitsPerPixel != 4 ) && ( bitsPerPixel != 8 ) && ( bitsPerPixel != 16 )
+		&& ( bitsPerPixel != 24 ) && ( bitsPerPixel != 32 ) )
+	{
+		return ReportError( "The BMP file's bit depth isn't supported", o_errorMessage );
+	}
+
+	// Palettes are stored as BGR(X)
+	uint8_t palette[256 * 4] = { 0 };
+	if ( bitsPerPixel <= 8 )
+	{
+		const size_t maxEntryCount = size_t( 1 ) << bitsPerPixel;
+		if ( ( paletteEntryCount == 0 ) || ( paletteEntryCount > maxEntryCount ) )
+		{
+			paletteEntryCount = maxEntryCount;
+		}
+		const size_t bytesPerEntry = isOs2Header ? 3 : 4;
+		const size_t paletteOffset = s_fileHeaderSize + infoHeaderSize
+			+ ( ( compression == Compressions::BitFields ) && ( infoHeaderSize == 40 ) ? 12 : 0 );
+		if ( ( paletteOffset + ( paletteEntryCount * bytesPerEntry ) ) > i_dataSize )
+		{
+			return ReportError( "The BMP file ends in the middle of its palette", o_errorMessage );
+		}
+		for ( size_t i = 0; i < paletteEntryCount; ++i )
+		{
+			const uint8_t* const entry = i_data + paletteOffset + ( i * bytesPerEntry );
+			palette[( i * 4 ) + 0] = entry[2];
+			palette[( i * 4 ) + 1] = entry[1];
+			palette[( i * 4 ) + 2] = entry[0];
+			palette[( i * 4 ) + 3] = 0xff;
+		}
+	}
+	// Without bit fields 16 bit pixels are 5:5:5 and 32 bit pixels have no alpha
+	if ( compression == Compressions::Rgb )
+	{
+		if ( bitsPerPixel == 16 )
+		{
+			masks[0] = 0x7c00;
+			masks[1] = 0x03e0;
+			masks[2] = 0x001f;
+			masks[3] = 0;
+		}
+		else if ( bitsPerPixel == 32 )
+		{
+			masks[0] = 0x00ff0000;
+			masks[1] = 0x0000ff00;
+			masks[2] = 0x000000ff;
+			masks[3] = 0;
+		}
+	}
+	const sChannelMask channelMasks[] = { sChannelMask( masks[0] ), sChannelMask( masks[1] ), sChannelMask( masks[2] ), sChannelMask( masks[3] ) };
+	const bool hasAlpha = ( ( bitsPerPixel == 16 ) || ( bitsPerPixel == 32 ) ) && ( masks[3] != 0 );
+
+	// Rows are padded to 4 bytes
+	const size_t widthInPixels = static_cast<size_t>( width );
+	const size_t heightInPixels = static_cast<size_t>( height );
+	const size_t rowSize = ( ( ( widthInPixels * bitsPerPixel ) + 31 ) / 32 ) * 4;
+	if ( ( pixelDataOffset > i_dataSize ) || ( ( rowSize * heightInPixels ) > ( i_dataSize - pixelDataOffset ) ) )
+	{
+		return ReportError( "The BMP file ends in the middle of its image data", o_errorMessage );
+	}
+
+	o_image.width = widthInPixels;
+	o_image.height = heightInPixels;
+	o_image.hasAlpha = hasAlpha;
+	o_image.pixels.resize( o_image.GetSlicePitch() );
+	for ( size_t y = 0; y < heightInPixels; ++y )
+	{
+		const uint8_t* const sourceRow = i_data + pixelDataOffset + ( ( isTopToBottom ? y : ( heightInPixels - 1 - y ) ) * rowSize );
+		uint8_t* const row = &o_image.pixels[y * o_image.GetRowPitch()];
+		switch ( bitsPerPixel )
+		{
+			case 1:
+			case 4:
+			case 8:
+				{
+					const unsigned int mask = ( 1u << bitsPerPixel ) - 1;
+					for ( size_t x = 0; x < widthInPixels; ++x )
+					{
+						const size_t bitOffset = x * bitsPerPixel;
+						const unsigned int index = ( sourceRow[bitOffset / 8] >> ( 8 - bitsPerPixel - ( bitOffset % 8 ) ) ) & mask;
+						memcpy( row + ( x * 4 ), palette + ( index * 4 ), 4 );
+					}
+				}
+				break;
+			case 24:
+				for ( size_t x = 0; x < widthInPixels; ++x )
+				{
+					row[( x * 4 ) + 0] = sourceRow[( x * 3 ) + 2];
+					row[( x * 4 ) + 1] = sourceRow[( x * 3 ) + 1];
+					row[( x * 4 ) + 2] = sourceRow[( x * 3 ) + 0];
+					row[( x * 4 ) + 3] = 0xff;
+				}
+				break;
+			case 16:
+			case 32:
+				for ( size_t x = 0; x < widthInPixels; ++x )
+				{
+					const uint32_t value = ( bitsPerPixel == 16 ) ? ReadLittleEndian16( sourceRow + ( x * 2 ) ) : ReadLittleEndian32( sourceRow + ( x * 4 ) );
+					row[( x * 4 ) + 0] = channelMasks[0].Extract( value );
+					row[( x * 4 ) + 1] = channelMasks[1].Extract( value );
+					row[( x * 4 ) + 2] = channelMasks[2].Extract( value );
+					row[( x * 4 ) + 3] = hasAlpha ? channelMasks[3].Extract( value ) : 0xff;
+				}
+				break;
+		}
+	}
+	return true;
+}
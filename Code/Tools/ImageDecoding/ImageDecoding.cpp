@@ -0,0 +1,78 @@
+#include "ImageDecoding.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include "Internal.h"
+
+Engine::AssetBuild::ImageDecoding::eFileType Engine::AssetBuild::ImageDecoding::DetectFileType(
+	const uint8_t* const i_data, const size_t i_dataSize, const char* const i_path )
+{
+	{
+		const uint8_t pngSignature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		if ( ( i_dataSize >= sizeof( pngSignature ) ) && ( memcmp( i_data, pngSignature, sizeof( pngSignature ) ) == 0 ) )
+		{
+			return Png;
+		}
+	}
+	if ( ( i_dataSize >= 3 ) && ( i_data[0] == 0xff ) && ( i_data[1] == 0xd8 ) && ( i_data[2] == 0xff ) )
+	{
+		return Jpeg;
+	}
+	if ( ( i_dataSize >= 2 ) && ( i_data[0] == 'B' ) && ( i_data[1] == 'M' ) )
+	{
+		return Bmp;
+	}
+	if ( i_path )
+	{
+		const char* const extension = strrchr( i_path, '.' );
+		if ( extension && ( strlen( extension ) == 4 )
+			&& ( tolower( extension[1] ) == 't' ) && ( tolower( extension[2] ) == 'g' ) && ( tolower( extension[3] ) == 'a' ) )
+		{
+			return Tga;
+		}
+	}
+	return Unknown;
+}
+
+bool Engine::AssetBuild::ImageDecoding::Decode( const eFileType i_fileType, const uint8_t* const i_data, const size_t i_dataSize,
+	sImage& o_image, std::string* const o_errorMessage )
+{
+	switch ( i_fileType )
+	{
+		case Png: return DecodePng( i_data, i_dataSize, o_image, o_errorMessage );
+		case Jpeg: return DecodeJpeg( i_data, i_dataSize, o_image, o_errorMessage );
+		case Tga: return DecodeTga( i_data, i_dataSize, o_image, o_errorMessage );
+		case Bmp: return DecodeBmp( i_data, i_dataSize, o_image, o_errorMessage );
+		default: return ReportError( "The file isn't a PNG, JPEG, TGA, or BMP", o_errorMessage );
+	}
+}
+
+bool Engine::AssetBuild::ImageDecoding::DecodeFile( const char* const i_path, sImage& o_image, std::string* const o_errorMessage )
+{
+	std::vector<uint8_t> data;
+	{
+		FILE* const file = fopen( i_path, "rb" );
+		if ( !file )
+		{
+			return ReportError( "The file couldn't be opened", o_errorMessage );
+		}
+		bool wasReadSuccessful = false;
+		if ( fseek( file, 0, SEEK_END ) == 0 )
+		{
+			const long fileSize = ftell( file );
+			if ( ( fileSize >= 0 ) && ( fseek( file, 0, SEEK_SET ) == 0 ) )
+			{
+				data.resize( static_cast<size_t>( fileSize ) );
+				wasReadSuccessful = data.empty() || ( fread( data.data(), 1, data.size(), file ) == data.size() );
+			}
+		}
+		fclose( file );
+		if ( !wasReadSuccessful )
+		{
+			return ReportError( "The file couldn't be read", o_errorMessage );
+		}
+	}
+	const eFileType fileType = DetectFileType( data.data(), data.size(), i_path );
+	return Decode( fileType, data.data(), data.size(), o_image, o_errorMessage );
+}
@@ -0,0 +1,61 @@
+#ifndef IMAGEDECODING_IMAGEDECODING_H
+#define IMAGEDECODING_IMAGEDECODING_H
+
+// Decoders for the source image formats that textures are authored in (PNG, JPEG, TGA, and BMP)
+// that don't need COM or the Windows Imaging Component, and so can run on any platform.
+// This library doesn't depend on DirectXTex or on the engine,
+// but the decoded pixels have the same layout as a DirectX::Image in DXGI_FORMAT_R8G8B8A8_UNORM
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace ImageDecoding
+		{
+			enum eFileType
+			{
+				Png,
+				Jpeg,
+				Tga,
+				Bmp,
+
+				Unknown
+			};
+
+			// Pixels are 8 bits per channel in RGBA order, starting with the top row,
+			// and there is no padding between rows.
+			// Channels that the source doesn't have are filled in like WIC does
+			// (gray is copied to red, green, and blue, and alpha is opaque)
+			struct sImage
+			{
+				std::vector<uint8_t> pixels;
+				size_t width, height;
+				// Whether the source had an alpha channel (or transparency) at all
+				bool hasAlpha;
+
+				size_t GetRowPitch() const { return width * 4; }
+				size_t GetSlicePitch() const { return GetRowPitch() * height; }
+
+				sImage() : width( 0 ), height( 0 ), hasAlpha( false ) {}
+			};
+
+			// PNG, JPEG, and BMP files are identified by their signatures,
+			// and TGA files (which don't have one) by their extension
+			eFileType DetectFileType( const uint8_t* const i_data, const size_t i_dataSize, const char* const i_path );
+
+			// These return false with a description of the problem in o_errorMessage
+			// if the data is corrupt or uses a feature that isn't supported
+			// (progressive or arithmetic-coded JPEGs, CMYK JPEGs, and RLE-compressed BMPs)
+			bool Decode( const eFileType i_fileType, const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image,
+				std::string* const o_errorMessage = NULL );
+			bool DecodeFile( const char* const i_path, sImage& o_image, std::string* const o_errorMessage = NULL );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,401 @@
+#include "Internal.h"
+
+#include <cstring>
+
+namespace
+{
+	// Deflate codes are at most 15 bits, and every table is indexed by the next 15 bits of the stream
+	// so that every symbol is decoded with a single lookup
+	const unsigned int s_maxCodeLength = 15;
+
+	// Each entry is the symbol in the upper bits and the length of its code in the lower 4 bits
+	// (a length of 0 means that those bits aren't the start of any code)
+	struct sHuffmanTable
+	{
+		uint16_t entries[1 << s_maxCodeLength];
+		unsigned int tableBitCount;
+	};
+
+	const uint16_t s_lengthBases[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const uint8_t s_lengthExtraBits[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const uint16_t s_distanceBases[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+		4097, 6145, 8193, 12289, 16385, 24577 };
+	const uint8_t s_distanceExtraBits[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	class cBitReader
+	{
+	public:
+		// Bits past the end of the data are read as zeros, and IsPastEnd() says whether any were needed
+		void Refill()
+		{
+			while ( m_bitCount <= 56 )
+			{
+				const uint64_t byte = ( m_position < m_dataSize ) ? m_data[m_position] : 0;
+				++m_position;
+				m_bits |= byte << m_bitCount;
+				m_bitCount += 8;
+			}
+		}
+		uint32_t Peek( const unsigned int i_bitCount ) const { return static_cast<uint32_t>( m_bits & ( ( uint64_t( 1 ) << i_bitCount ) - 1 ) ); }
+		void Consume( const unsigned int i_bitCount ) { m_bits >>= i_bitCount; m_bitCount -= i_bitCount; }
+		uint32_t Read( const unsigned int i_bitCount )
+		{
+			if ( m_bitCount < i_bitCount )
+			{
+				Refill();
+			}
+			const uint32_t bits = Peek( i_bitCount );
+			Consume( i_bitCount );
+			return bits;
+		}
+		// Drops the bits that are left in the current byte and returns the position of the next one
+		size_t AlignToByte()
+		{
+			Consume( m_bitCount % 8 );
+			const size_t position = m_position - ( m_bitCount / 8 );
+			m_bits = 0;
+			m_bitCount = 0;
+			m_position = position;
+			return position;
+		}
+		void Skip( const size_t i_byteCount ) { m_position += i_byteCount; }
+		bool IsPastEnd() const { return ( m_position - ( m_bitCount / 8 ) ) > m_dataSize; }
+
+		cBitReader( const uint8_t* const i_data, const size_t i_dataSize )
+			: m_data( i_data ), m_dataSize( i_dataSize ), m_position( 0 ), m_bits( 0 ), m_bitCount( 0 ) {}
+
+	private:
+		const uint8_t* m_data;
+		size_t m_dataSize;
+		size_t m_position;
+		uint64_t m_bits;
+		unsigned int m_bitCount;
+	};
+
+	bool BuildHuffmanTable( const uint8_t* const i_codeLengths, const unsigned int i_symbolCount, sHuffmanTable& o_table );
+	bool DecodeSymbol( cBitReader& io_bitReader, const sHuffmanTable& i_table, unsigned int& o_symbol );
+	bool InflateBlock( cBitReader& io_bitReader, const sHuffmanTable& i_literalTable, const sHuffmanTable& i_distanceTable,
+		std::vector<uint8_t>& io_data, size_t& io_size, std::string* const o_errorMessage );
+	bool ReadDynamicTables( cBitReader& io_bitReader, sHuffmanTable& o_literalTable, sHuffmanTable& o_distanceTable, std::string* const o_errorMessage );
+}
+
+bool Engine::AssetBuild::ImageDecoding::Inflate( const uint8_t* const i_data, const size_t i_dataSize, std::vector<uint8_t>& o_data,
+	const size_t i_expectedSize, std::string* const o_errorMessage )
+{
+	// The zlib header says how the data was compressed
+	if ( i_dataSize < 2 )
+	{
+		return ReportError( "The compressed data is missing its zlib header", o_errorMessage );
+	}
+	{
+		const unsigned int compressionMethod = i_data[0] & 0xf;
+		const bool isHeaderValid = ( ( ( static_cast<unsigned int>( i_data[0] ) << 8 ) | i_data[1] ) % 31 ) == 0;
+		const bool isDictionaryPreset = ( i_data[1] & 0x20 ) != 0;
+		if ( ( compressionMethod != 8 ) || !isHeaderValid || isDictionaryPreset )
+		{
+			return ReportError( "The compressed data has an invalid zlib header", o_errorMessage );
+		}
+	}
+
+	// The tables are too big for the stack
+	std::vector<sHuffmanTable> tables( 2 );
+	sHuffmanTable& literalTable = tables[0];
+	sHuffmanTable& distanceTable = tables[1];
+	// The data is decompressed into a buffer that grows as needed, and is trimmed to its final size at the end
+	o_data.resize( ( i_expectedSize > 0 ) ? i_expectedSize : ( i_dataSize * 4 ) );
+	size_t size = 0;
+	cBitReader bitReader( i_data + 2, i_dataSize - 2 );
+	for ( bool isFinalBlock = false; !isFinalBlock; )
+	{
+		isFinalBlock = bitReader.Read( 1 ) != 0;
+		const uint32_t blockType = bitReader.Read( 2 );
+		if ( blockType == 0 )
+		{
+			// Stored blocks are copied as they are
+			const size_t position = bitReader.AlignToByte();
+			if ( ( position + 4 ) > ( i_dataSize - 2 ) )
+			{
+				return ReportError( "The compressed data ends in the middle of a stored block", o_errorMessage );
+			}
+			const uint8_t* const header = i_data + 2 + position;
+			const size_t length = header[0] | ( header[1] << 8 );
+			const size_t lengthComplement = header[2] | ( header[3] << 8 );
+			if ( ( length ^ 0xffff ) != lengthComplement )
+			{
+				return ReportError( "A stored block in the compressed data has an invalid length", o_errorMessage );
+			}
+			if ( ( position + 4 + length ) > ( i_dataSize - 2 ) )
+			{
+				return ReportError( "The compressed data ends in the middle of a stored block", o_errorMessage );
+			}
+			if ( ( size + length ) > o_data.size() )
+			{
+				o_data.resize( ( size + length ) * 2 );
+			}
+			memcpy( &o_data[size], header + 4, length );
+			size += length;
+			bitReader.Skip( 4 + length );
+		}
+		else if ( blockType == 1 )
+		{
+			uint8_t codeLengths[288 + 32];
+			{
+				unsigned int i = 0;
+				for ( ; i < 144; ++i ) codeLengths[i] = 8;
+				for ( ; i < 256; ++i ) codeLengths[i] = 9;
+				for ( ; i < 280; ++i ) codeLengths[i] = 7;
+				for ( ; i < 288; ++i ) codeLengths[i] = 8;
+				for ( ; i < ( 288 + 32 ); ++i ) codeLengths[i] = 5;
+			}
+			BuildHuffmanTable( codeLengths, 288, literalTable );
+			BuildHuffmanTable( codeLengths + 288, 32, distanceTable );
+			if ( !InflateBlock( bitReader, literalTable, distanceTable, o_data, size, o_errorMessage ) )
+			{
+				return false;
+			}
+		}
+		else if ( blockType == 2 )
+		{
+			if ( !ReadDynamicTables( bitReader, literalTable, distanceTable, o_errorMessage )
+				|| !InflateBlock( bitReader, literalTable, distanceTable, o_data, size, o_errorMessage ) )
+			{
+				return false;
+			}
+		}
+		else
+		{
+			return ReportError( "The compressed data has an invalid block type", o_errorMessage );
+		}
+		if ( bitReader.IsPastEnd() )
+		{
+			return ReportError( "The compressed data ends too early", o_errorMessage );
+		}
+	}
+	// The Adler-32 checksum after the data isn't verified
+	o_data.resize( size );
+	return true;
+}
+
+namespace
+{
+	bool BuildHuffmanTable( const uint8_t* const i_codeLengths, const unsigned int i_symbolCount, sHuffmanTable& o_table )
+	{
+		// Codes are assigned in order of length and then symbol (RFC 1951 section 3.2.2)
+		unsigned int lengthCounts[s_maxCodeLength + 1] = { 0 };
+		unsigned int maxLength = 0;
+		for ( unsigned int i = 0; i < i_symbolCount; ++i )
+		{
+			++lengthCounts[i_codeLengths[i]];
+			maxLength = ( i_codeLengths[i] > maxLength ) ? i_codeLengths[i] : maxLength;
+		}
+		lengthCounts[0] = 0;
+		unsigned int nextCodes[s_maxCodeLength + 2];
+		{
+			unsigned int code = 0;
+			int remainingCodeCount = 1;
+			for ( unsigned int length = 1; length <= s_maxCodeLength; ++length )
+			{
+				code = ( code + lengthCounts[length - 1] ) << 1;
+				nextCodes[length] = code;
+				remainingCodeCount = ( remainingCodeCount << 1 ) - static_cast<int>( lengthCounts[length] );
+				if ( remainingCodeCount < 0 )
+				{
+					// Too many codes of this length
+					return false;
+				}
+			}
+		}
+		// The table only needs to be as big as the longest code (which keeps small tables fast to build)
+		o_table.tableBitCount = ( maxLength > 0 ) ? maxLength : 1;
+		const unsigned int tableSize = 1u << o_table.tableBitCount;
+		memset( o_table.entries, 0, sizeof( o_table.entries[0] ) * tableSize );
+		for ( unsigned int symbol = 0; symbol < i_symbolCount; ++symbol )
+		{
+			const unsigned int length = i_codeLengths[symbol];
+			if ( length == 0 )
+			{
+				continue;
+			}
+			// Huffman codes are stored starting with their most significant bit, but the stream is read starting with the least significant one
+			const unsigned int code = nextCodes[length]++;
+			unsigned int reversedCode = 0;
+			for ( unsigned int i = 0; i < length; ++i )
+			{
+				reversedCode |= ( ( code >> i ) & 1 ) << ( length - 1 - i );
+			}
+			const uint16_t entry = static_cast<uint16_t>( ( symbol << 4 ) | length );
+			for ( unsigned int index = reversedCode; index < tableSize; index += ( 1u << length ) )
+			{
+				o_table.entries[index] = entry;
+			}
+		}
+		return true;
+	}
+
+	bool DecodeSymbol( cBitReader& io_bitReader, const sHuffmanTable& i_table, unsigned int& o_symbol )
+	{
+		const uint16_t entry = i_table.entries[io_bitReader.Peek( i_table.tableBitCount )];
+		const unsigned int length = entry & 0xf;
+		if ( length == 0 )
+		{
+			return false;
+		}
+		io_bitReader.Consume( length );
+		o_symbol = entry >> 4;
+		return true;
+	}
+
+	bool InflateBlock( cBitReader& io_bitReader, const sHuffmanTable& i_literalTable, const sHuffmanTable& i_distanceTable,
+		std::vector<uint8_t>& io_data, size_t& io_size, std::string* const o_errorMessage )
+	{
+		using Engine::AssetBuild::ImageDecoding::ReportError;
+
+		size_t size = io_size;
+		while ( true )
+		{
+			// A refill is always enough for a length and a distance with their extra bits (15 + 5 + 15 + 13 bits)
+			io_bitReader.Refill();
+			if ( io_bitReader.IsPastEnd() )
+			{
+				// Otherwise the zeros that are read past the end could decode as literals forever
+				return ReportError( "The compressed data ends too early", o_errorMessage );
+			}
+			unsigned int symbol;
+			if ( !DecodeSymbol( io_bitReader, i_literalTable, symbol ) )
+			{
+				return ReportError( "The compressed data has an invalid literal or length code", o_errorMessage );
+			}
+			if ( symbol < 256 )
+			{
+				if ( size == io_data.size() )
+				{
+					io_data.resize( io_data.size() * 2 );
+				}
+				io_data[size++] = static_cast<uint8_t>( symbol );
+				continue;
+			}
+			else if ( symbol == 256 )
+			{
+				break;
+			}
+			symbol -= 257;
+			if ( symbol >= 29 )
+			{
+				return ReportError( "The compressed data has an invalid length code", o_errorMessage );
+			}
+			const size_t length = s_lengthBases[symbol] + io_bitReader.Peek( s_lengthExtraBits[symbol] );
+			io_bitReader.Consume( s_lengthExtraBits[symbol] );
+			unsigned int distanceSymbol;
+			if ( !DecodeSymbol( io_bitReader, i_distanceTable, distanceSymbol ) || ( distanceSymbol >= 30 ) )
+			{
+				return ReportError( "The compressed data has an invalid distance code", o_errorMessage );
+			}
+			const size_t distance = s_distanceBases[distanceSymbol] + io_bitReader.Peek( s_distanceExtraBits[distanceSymbol] );
+			io_bitReader.Consume( s_distanceExtraBits[distanceSymbol] );
+			if ( distance > size )
+			{
+				return ReportError( "The compressed data refers to data before its start", o_errorMessage );
+			}
+			if ( ( size + length ) > io_data.size() )
+			{
+				io_data.resize( ( size + length ) * 2 );
+			}
+			uint8_t* const target = &io_data[size];
+			const uint8_t* const source = target - distance;
+			if ( distance >= length )
+			{
+				memcpy( target, source, length );
+			}
+			else
+			{
+				// The copy overlaps itself (which is how runs are encoded), and so it must be done a byte at a time
+				for ( size_t i = 0; i < length; ++i )
+				{
+					target[i] = source[i];
+				}
+			}
+			size += length;
+		}
+		io_size = size;
+		return true;
+	}
+
+	bool ReadDynamicTables( cBitReader& io_bitReader, sHuffmanTable& o_literalTable, sHuffmanTable& o_distanceTable, std::string* const o_errorMessage )
+	{
+		using Engine::AssetBuild::ImageDecoding::ReportError;
+
+		const unsigned int literalCount = io_bitReader.Read( 5 ) + 257;
+		const unsigned int distanceCount = io_bitReader.Read( 5 ) + 1;
+		const unsigned int codeLengthCodeCount = io_bitReader.Read( 4 ) + 4;
+		if ( ( literalCount > 286 ) || ( distanceCount > 30 ) )
+		{
+			return ReportError( "The compressed data has too many codes", o_errorMessage );
+		}
+		// The code lengths are themselves Huffman-coded
+		sHuffmanTable& codeLengthTable = o_distanceTable;
+		{
+			const uint8_t order[] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+			uint8_t codeLengthCodeLengths[19] = { 0 };
+			for ( unsigned int i = 0; i < codeLengthCodeCount; ++i )
+			{
+				codeLengthCodeLengths[order[i]] = static_cast<uint8_t>( io_bitReader.Read( 3 ) );
+			}
+			if ( !BuildHuffmanTable( codeLengthCodeLengths, 19, codeLengthTable ) )
+			{
+				return ReportError( "The compressed data has invalid code length codes", o_errorMessage );
+			}
+		}
+		uint8_t codeLengths[286 + 30];
+		for ( unsigned int i = 0; i < ( literalCount + distanceCount ); )
+		{
+			io_bitReader.Refill();
+			unsigned int symbol;
+			if ( !DecodeSymbol( io_bitReader, codeLengthTable, symbol ) )
+			{
+				return ReportError( "The compressed data has an invalid code length code", o_errorMessage );
+			}
+			if ( symbol < 16 )
+			{
+				codeLengths[i++] = static_cast<uint8_t>( symbol );
+				continue;
+			}
+			uint8_t repeatedLength = 0;
+			unsigned int repeatCount;
+			if ( symbol == 16 )
+			{
+				if ( i == 0 )
+				{
+					return ReportError( "The compressed data repeats a code length before the first one", o_errorMessage );
+				}
+				repeatedLength = codeLengths[i - 1];
+				repeatCount = 3 + io_bitReader.Read( 2 );
+			}
+			else if ( symbol == 17 )
+			{
+				repeatCount = 3 + io_bitReader.Read( 3 );
+			}
+			else
+			{
+				repeatCount = 11 + io_bitReader.Read( 7 );
+			}
+			if ( ( i + repeatCount ) > ( literalCount + distanceCount ) )
+			{
+				return ReportError( "The compressed data has too many code lengths", o_errorMessage );
+			}
+			for ( unsigned int j = 0; j < repeatCount; ++j )
+			{
+				codeLengths[i++] = repeatedLength;
+			}
+		}
+		if ( codeLengths[256] == 0 )
+		{
+			return ReportError( "The compressed data has no end of block code", o_errorMessage );
+		}
+		if ( !BuildHuffmanTable( codeLengths, literalCount, o_literalTable )
+			|| !BuildHuffmanTable( codeLengths + literalCount, distanceCount, o_distanceTable ) )
+		{
+			return ReportError( "The compressed data has invalid Huffman codes", o_errorMessage );
+		}
+		return true;
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef IMAGEDECODING_INTERNAL_H
+#define IMAGEDECODING_INTERNAL_H
+
+#include "ImageDecoding.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace ImageDecoding
+		{
+			bool DecodePng( const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image, std::string* const o_errorMessage );
+			bool DecodeJpeg( const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image, std::string* const o_errorMessage );
+			bool DecodeTga( const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image, std::string* const o_errorMessage );
+			bool DecodeBmp( const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image, std::string* const o_errorMessage );
+
+			// Decompresses a zlib stream (which is what PNG's IDAT chunks contain).
+			// If the size of the decompressed data is known it can be passed as a hint to avoid reallocating
+			bool Inflate( const uint8_t* const i_data, const size_t i_dataSize, std::vector<uint8_t>& o_data,
+				const size_t i_expectedSize, std::string* const o_errorMessage );
+
+			// Every decoder reports errors the same way
+			inline bool ReportError( const char* const i_errorMessage, std::string* const o_errorMessage )
+			{
+				if ( o_errorMessage )
+				{
+					*o_errorMessage = i_errorMessage;
+				}
+				return false;
+			}
+			// Images bigger than this are rejected before their pixels are allocated
+			// (which also keeps every byte offset within 32 bits)
+			const size_t s_maxPixelCount = 1 << 28;
+		}
+	}
+}
+
+#endif
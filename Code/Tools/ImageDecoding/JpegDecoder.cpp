@@ -0,0 +1,889 @@
+#include "Internal.h"
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	namespace Markers
+	{
+		enum eMarker
+		{
+			Sof0 = 0xc0,
+			Sof1 = 0xc1,
+			Dht = 0xc4,
+			Rst0 = 0xd0,
+			Rst7 = 0xd7,
+			Soi = 0xd8,
+			Eoi = 0xd9,
+			Sos = 0xda,
+			Dqt = 0xdb,
+			Dri = 0xdd,
+			App14 = 0xee,
+		};
+	}
+
+	// Coefficients are stored from the lowest frequency to the highest,
+	// and this is where each one goes in an 8x8 block
+	const uint8_t s_zigZagToNatural[64] =
+	{
+		0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+		12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+		35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+		58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+	};
+
+	const unsigned int s_fastHuffmanBitCount = 9;
+
+	struct sHuffmanTable
+	{
+		// Codes that are at most s_fastHuffmanBitCount bits long are decoded with a single lookup
+		// (each entry is the length of the code in the upper bits and the symbol in the lower 8, or 0 for longer codes)
+		uint16_t fastLookup[1 << s_fastHuffmanBitCount];
+		// Longer codes are decoded by comparing against the largest code of each length
+		int32_t maxCodes[17];
+		int32_t valueOffsets[17];
+		uint8_t values[256];
+		bool isDefined;
+	};
+
+	struct sComponent
+	{
+		unsigned int id;
+		unsigned int horizontalSamplingFactor, verticalSamplingFactor;
+		unsigned int quantizationTableIndex;
+		unsigned int dcTableIndex, acTableIndex;
+		int dcPrediction;
+		// The size of the component itself (which is smaller than the image if it is subsampled)
+		size_t width, height;
+		// The decoded samples are padded to a whole number of MCUs
+		std::vector<uint8_t> samples;
+		size_t samplesWidth, samplesHeight;
+	};
+
+	struct sFrame
+	{
+		size_t width, height;
+		sComponent components[3];
+		unsigned int componentCount;
+		unsigned int maxHorizontalSamplingFactor, maxVerticalSamplingFactor;
+		size_t mcuCountX, mcuCountY;
+	};
+
+	// Reads the bits of entropy-coded data, removing the zeros that are stuffed after 0xff bytes.
+	// When a marker is reached it reads zeros instead of going past it
+	class cEntropyReader
+	{
+	public:
+		void Refill()
+		{
+			while ( m_bitCount <= 56 )
+			{
+				uint64_t byte = 0;
+				if ( !m_wasMarkerReached )
+				{
+					if ( m_position >= m_dataSize )
+					{
+						m_wasMarkerReached = true;
+					}
+					else if ( m_data[m_position] != 0xff )
+					{
+						byte = m_data[m_position++];
+					}
+					else if ( ( ( m_position + 1 ) < m_dataSize ) && ( m_data[m_position + 1] == 0 ) )
+					{
+						byte = 0xff;
+						m_position += 2;
+					}
+					else
+					{
+						m_wasMarkerReached = true;
+					}
+				}
+				m_bits |= byte << ( 56 - m_bitCount );
+				m_bitCount += 8;
+			}
+		}
+		uint32_t Peek( const unsigned int i_bitCount ) const { return static_cast<uint32_t>( m_bits >> ( 64 - i_bitCount ) ); }
+		void Consume( const unsigned int i_bitCount ) { m_bits <<= i_bitCount; m_bitCount -= i_bitCount; }
+		uint32_t Read( const unsigned int i_bitCount )
+		{
+			if ( i_bitCount == 0 )
+			{
+				return 0;
+			}
+			if ( m_bitCount < i_bitCount )
+			{
+				Refill();
+			}
+			const uint32_t bits = Peek( i_bitCount );
+			Consume( i_bitCount );
+			return bits;
+		}
+		// Reads a value and sign-extends it the way that JPEG encodes coefficients
+		int ReadSigned( const unsigned int i_bitCount )
+		{
+			const int value = static_cast<int>( Read( i_bitCount ) );
+			return ( ( i_bitCount > 0 ) && ( value < ( 1 << ( i_bitCount - 1 ) ) ) ) ? ( value - ( 1 << i_bitCount ) + 1 ) : value;
+		}
+		bool DecodeSymbol( const sHuffmanTable& i_table, unsigned int& o_symbol )
+		{
+			if ( m_bitCount < 16 )
+			{
+				Refill();
+			}
+			const uint16_t entry = i_table.fastLookup[Peek( s_fastHuffmanBitCount )];
+			if ( entry != 0 )
+			{
+				Consume( entry >> 8 );
+				o_symbol = entry & 0xff;
+				return true;
+			}
+			const int32_t code = static_cast<int32_t>( Peek( 16 ) );
+			for ( unsigned int length = s_fastHuffmanBitCount + 1; length <= 16; ++length )
+			{
+				const int32_t lengthCode = code >> ( 16 - length );
+				if ( lengthCode <= i_table.maxCodes[length] )
+				{
+					Consume( length );
+					o_symbol = i_table.values[i_table.valueOffsets[length] + lengthCode];
+					return true;
+				}
+			}
+			return false;
+		}
+		// Discards the buffered bits and skips the restart marker that should be next
+		bool SkipRestartMarker()
+		{
+			m_bits = 0;
+			m_bitCount = 0;
+			m_wasMarkerReached = false;
+			for ( ; ( m_position + 1 ) < m_dataSize; ++m_position )
+			{
+				if ( m_data[m_position] == 0xff )
+				{
+					const uint8_t marker = m_data[m_position + 1];
+					if ( ( marker >= Markers::Rst0 ) && ( marker <= Markers::Rst7 ) )
+					{
+						m_position += 2;
+						return true;
+					}
+					else if ( ( marker != 0 ) && ( marker != 0xff ) )
+					{
+						return false;
+					}
+				}
+			}
+			return false;
+		}
+		// Returns the position of the marker that follows the entropy-coded data
+		size_t FindNextMarker() const
+		{
+			size_t position = m_position;
+			for ( ; ( position + 1 ) < m_dataSize; ++position )
+			{
+				if ( m_data[position] == 0xff )
+				{
+					const uint8_t marker = m_data[position + 1];
+					if ( ( marker != 0 ) && ( marker != 0xff ) && ( ( marker < Markers::Rst0 ) || ( marker > Markers::Rst7 ) ) )
+					{
+						break;
+					}
+				}
+			}
+			return position;
+		}
+
+		cEntropyReader( const uint8_t* const i_data, const size_t i_dataSize, const size_t i_position )
+			: m_data( i_data ), m_dataSize( i_dataSize ), m_position( i_position ), m_bits( 0 ), m_bitCount( 0 ), m_wasMarkerReached( false ) {}
+
+	private:
+		const uint8_t* m_data;
+		size_t m_dataSize;
+		size_t m_position;
+		// Bits are read starting with the most significant one
+		uint64_t m_bits;
+		unsigned int m_bitCount;
+		bool m_wasMarkerReached;
+	};
+
+	inline unsigned int ReadBigEndian16( const uint8_t* const i_data )
+	{
+		return ( static_cast<unsigned int>( i_data[0] ) << 8 ) | i_data[1];
+	}
+
+	bool BuildHuffmanTable( const uint8_t* const i_codeCounts, const uint8_t* const i_values, const size_t i_valueCount, sHuffmanTable& o_table );
+	void ConvertYCbCrRow( const uint8_t* const i_y, const uint8_t* const i_cb, const uint8_t* const i_cr, const size_t i_width, uint8_t* const o_pixels );
+	bool DecodeBlock( cEntropyReader& io_reader, const sHuffmanTable& i_dcTable, const sHuffmanTable& i_acTable, const uint16_t* const i_quantizationTable,
+		int& io_dcPrediction, uint8_t* const o_samples, const size_t i_stride );
+	bool DecodeScan( const uint8_t* const i_data, const size_t i_dataSize, size_t& io_position, sFrame& io_frame,
+		sComponent* const* const i_scanComponents, const unsigned int i_scanComponentCount,
+		const sHuffmanTable* const i_dcTables, const sHuffmanTable* const i_acTables, const uint16_t ( * const i_quantizationTables )[64],
+		const unsigned int i_restartInterval, std::string* const o_errorMessage );
+	void InverseDct( const float* const i_coefficients, const unsigned int i_nonZeroRowMask, uint8_t* const o_samples, const size_t i_stride );
+	void Upsample( const sComponent& i_component, const unsigned int i_horizontalFactor, const unsigned int i_verticalFactor,
+		const size_t i_width, const size_t i_height, uint8_t* const o_samples );
+}
+
+bool Engine::AssetBuild::ImageDecoding::DecodeJpeg( const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image,
+	std::string* const o_errorMessage )
+{
+	if ( ( i_dataSize < 2 ) || ( i_data[0] != 0xff ) || ( i_data[1] != Markers::Soi ) )
+	{
+		return ReportError( "The JPEG file doesn't start with a start of image marker", o_errorMessage );
+	}
+
+	// The tables are stored in natural order rather than zig-zag order
+	uint16_t quantizationTables[4][64] = {};
+	std::vector<sHuffmanTable> huffmanTables( 8 );
+	sHuffmanTable* const dcTables = &huffmanTables[0];
+	sHuffmanTable* const acTables = &huffmanTables[4];
+	for ( size_t i = 0; i < huffmanTables.size(); ++i )
+	{
+		huffmanTables[i].isDefined = false;
+	}
+	sFrame frame = {};
+	bool wasFrameFound = false;
+	bool wasScanFound = false;
+	unsigned int restartInterval = 0;
+	// -1 means that there is no Adobe marker
+	int adobeTransform = -1;
+	size_t offset = 2;
+	while ( true )
+	{
+		if ( ( offset + 1 ) >= i_dataSize )
+		{
+			// Some files are truncated after the last scan, and the image can still be used
+			if ( wasScanFound )
+			{
+				break;
+			}
+			return ReportError( "The JPEG file ends before its image data", o_errorMessage );
+		}
+		if ( i_data[offset] != 0xff )
+		{
+			return ReportError( "The JPEG file has data where a marker was expected", o_errorMessage );
+		}
+		const unsigned int marker = i_data[offset + 1];
+		if ( marker == 0xff )
+		{
+			// Markers can be preceded by any number of fill bytes
+			++offset;
+			continue;
+		}
+		offset += 2;
+		if ( marker == Markers::Eoi )
+		{
+			break;
+		}
+		if ( ( ( marker >= Markers::Rst0 ) && ( marker <= Markers::Rst7 ) ) || ( marker == 0x01 ) )
+		{
+			// These markers don't have a segment
+			continue;
+		}
+		if ( ( ( offset + 2 ) > i_dataSize ) || ( ReadBigEndian16( i_data + offset ) < 2 )
+			|| ( ReadBigEndian16( i_data + offset ) > ( i_dataSize - offset ) ) )
+		{
+			return ReportError( "The JPEG file ends in the middle of a segment", o_errorMessage );
+		}
+		const uint8_t* const segment = i_data + offset + 2;
+		const size_t segmentSize = ReadBigEndian16( i_data + offset ) - 2;
+		size_t nextOffset = offset + 2 + segmentSize;
+
+		switch ( marker )
+		{
+			case Markers::Dqt:
+				for ( size_t i = 0; i < segmentSize; )
+				{
+					const unsigned int precision = segment[i] >> 4;
+					const unsigned int tableIndex = segment[i] & 0xf;
+					const size_t tableSize = ( precision == 0 ) ? 64 : 128;
+					if ( ( precision > 1 ) || ( tableIndex > 3 ) || ( ( segmentSize - i - 1 ) < tableSize ) )
+					{
+						return ReportError( "The JPEG file has an invalid quantization table", o_errorMessage );
+					}
+					const uint8_t* const values = segment + i + 1;
+					for ( unsigned int j = 0; j < 64; ++j )
+					{
+						quantizationTables[tableIndex][s_zigZagToNatural[j]] =
+							static_cast<uint16_t>( ( precision == 0 ) ? values[j] : ReadBigEndian16( values + ( j * 2 ) ) );
+					}
+					i += 1 + tableSize;
+				}
+				break;
+			case Markers::Dht:
+				for ( size_t i = 0; i < segmentSize; )
+				{
+					if ( ( segmentSize - i ) < 17 )
+					{
+						return ReportError( "The JPEG file has an invalid Huffman table", o_errorMessage );
+					}
+					const unsigned int tableClass = segment[i] >> 4;
+					const unsigned int tableIndex = segment[i] & 0xf;
+					const uint8_t* const codeCounts = segment + i + 1;
+					size_t valueCount = 0;
+					for ( unsigned int j = 0; j < 16; ++j )
+					{
+						valueCount += codeCounts[j];
+					}
+					if ( ( tableClass > 1 ) || ( tableIndex > 3 ) || ( valueCount > 256 ) || ( ( segmentSize - i - 17 ) < valueCount )
+						|| !BuildHuffmanTable( codeCounts, segment + i + 17, valueCount, ( ( tableClass == 0 ) ? dcTables : acTables )[tableIndex] ) )
+					{
+						return ReportError( "The JPEG file has an invalid Huffman table", o_errorMessage );
+					}
+					i += 17 + valueCount;
+				}
+				break;
+			case Markers::Sof0:
+			case Markers::Sof1:
+				{
+					if ( wasFrameFound )
+					{
+						return ReportError( "The JPEG file has more than one frame", o_errorMessage );
+					}
+					if ( segmentSize < 6 )
+					{
+						return ReportError( "The JPEG file's frame header is too small", o_errorMessage );
+					}
+					const unsigned int precision = segment[0];
+					frame.height = ReadBigEndian16( segment + 1 );
+					frame.width = ReadBigEndian16( segment + 3 );
+					frame.componentCount = segment[5];
+					if ( precision != 8 )
+					{
+						return ReportError( "Only JPEG files with 8 bits per sample are supported", o_errorMessage );
+					}
+					if ( ( frame.width == 0 ) || ( frame.height == 0 ) || ( ( frame.width * frame.height ) > s_maxPixelCount ) )
+					{
+						return ReportError( "The JPEG file's dimensions are invalid or too big", o_errorMessage );
+					}
+					if ( ( frame.componentCount != 1 ) && ( frame.componentCount != 3 ) )
+					{
+						return ReportError( "Only grayscale and color JPEG files are supported (not CMYK)", o_errorMessage );
+					}
+					if ( segmentSize < ( 6 + ( frame.componentCount * 3 ) ) )
+					{
+						return ReportError( "The JPEG file's frame header is too small", o_errorMessage );
+					}
+					frame.maxHorizontalSamplingFactor = frame.maxVerticalSamplingFactor = 1;
+					for ( unsigned int i = 0; i < frame.componentCount; ++i )
+					{
+						sComponent& component = frame.components[i];
+						const uint8_t* const componentData = segment + 6 + ( i * 3 );
+						component.id = componentData[0];
+						component.horizontalSamplingFactor = componentData[1] >> 4;
+						component.verticalSamplingFactor = componentData[1] & 0xf;
+						component.quantizationTableIndex = componentData[2];
+						if ( ( component.horizontalSamplingFactor < 1 ) || ( component.horizontalSamplingFactor > 4 )
+							|| ( component.verticalSamplingFactor < 1 ) || ( component.verticalSamplingFactor > 4 )
+							|| ( component.quantizationTableIndex > 3 ) )
+						{
+							return ReportError( "The JPEG file has an invalid component", o_errorMessage );
+						}
+						frame.maxHorizontalSamplingFactor = ( component.horizontalSamplingFactor > frame.maxHorizontalSamplingFactor ) ?
+							component.horizontalSamplingFactor : frame.maxHorizontalSamplingFactor;
+						frame.maxVerticalSamplingFactor = ( component.verticalSamplingFactor > frame.maxVerticalSamplingFactor ) ?
+							component.verticalSamplingFactor : frame.maxVerticalSamplingFactor;
+					}
+					frame.mcuCountX = ( frame.width + ( frame.maxHorizontalSamplingFactor * 8 ) - 1 ) / ( frame.maxHorizontalSamplingFactor * 8 );
+					frame.mcuCountY = ( frame.height + ( frame.maxVerticalSamplingFactor * 8 ) - 1 ) / ( frame.maxVerticalSamplingFactor * 8 );
+					for ( unsigned int i = 0; i < frame.componentCount; ++i )
+					{
+						sComponent& component = frame.components[i];
+						// Upsampling is only done by whole numbers
+						if ( ( ( frame.maxHorizontalSamplingFactor % component.horizontalSamplingFactor ) != 0 )
+							|| ( ( frame.maxVerticalSamplingFactor % component.verticalSamplingFactor ) != 0 ) )
+						{
+							return ReportError( "The JPEG file's sampling factors aren't supported", o_errorMessage );
+						}
+						component.width = ( ( frame.width * component.horizontalSamplingFactor ) + frame.maxHorizontalSamplingFactor - 1 )
+							/ frame.maxHorizontalSamplingFactor;
+						component.height = ( ( frame.height * component.verticalSamplingFactor ) + frame.maxVerticalSamplingFactor - 1 )
+							/ frame.maxVerticalSamplingFactor;
+						component.samplesWidth = frame.mcuCountX * component.horizontalSamplingFactor * 8;
+						component.samplesHeight = frame.mcuCountY * component.verticalSamplingFactor * 8;
+						component.samples.resize( component.samplesWidth * component.samplesHeight );
+					}
+					wasFrameFound = true;
+				}
+				break;
+			case Markers::Dri:
+				if ( segmentSize < 2 )
+				{
+					return ReportError( "The JPEG file's restart interval is invalid", o_errorMessage );
+				}
+				restartInterval = ReadBigEndian16( segment );
+				break;
+			case Markers::App14:
+				if ( ( segmentSize >= 12 ) && ( memcmp( segment, "Adobe", 5 ) == 0 ) )
+				{
+					adobeTransform = segment[11];
+				}
+				break;
+			case Markers::Sos:
+				{
+					if ( !wasFrameFound )
+					{
+						return ReportError( "The JPEG file has a scan before its frame header", o_errorMessage );
+					}
+					const unsigned int scanComponentCount = ( segmentSize > 0 ) ? segment[0] : 0;
+					if ( ( scanComponentCount < 1 ) || ( scanComponentCount > frame.componentCount )
+						|| ( segmentSize < ( 4 + ( scanComponentCount * 2 ) ) ) )
+					{
+						return ReportError( "The JPEG file has an invalid scan header", o_errorMessage );
+					}
+					sComponent* scanComponents[3];
+					for ( unsigned int i = 0; i < scanComponentCount; ++i )
+					{
+						const unsigned int id = segment[1 + ( i * 2 )];
+						const unsigned int tableIndices = segment[2 + ( i * 2 )];
+						scanComponents[i] = NULL;
+						for ( unsigned int j = 0; j < frame.componentCount; ++j )
+						{
+							if ( frame.components[j].id == id )
+							{
+								scanComponents[i] = &frame.components[j];
+							}
+						}
+						if ( !scanComponents[i] || ( ( tableIndices >> 4 ) > 3 ) || ( ( tableIndices & 0xf ) > 3 ) )
+						{
+							return ReportError( "The JPEG file has an invalid scan header", o_errorMessage );
+						}
+						scanComponents[i]->dcTableIndex = tableIndices >> 4;
+						scanComponents[i]->acTableIndex = tableIndices & 0xf;
+						if ( !dcTables[scanComponents[i]->dcTableIndex].isDefined || !acTables[scanComponents[i]->acTableIndex].isDefined )
+						{
+							return ReportError( "The JPEG file's scan uses a Huffman table that wasn't defined", o_errorMessage );
+						}
+					}
+					{
+						const uint8_t* const spectralSelection = segment + 1 + ( scanComponentCount * 2 );
+						if ( ( spectralSelection[0] != 0 ) || ( spectralSelection[1] != 63 ) || ( spectralSelection[2] != 0 ) )
+						{
+							return ReportError( "The JPEG file's scan isn't sequential", o_errorMessage );
+						}
+					}
+					if ( !DecodeScan( i_data, i_dataSize, nextOffset, frame, scanComponents, scanComponentCount,
+						dcTables, acTables, quantizationTables, restartInterval, o_errorMessage ) )
+					{
+						return false;
+					}
+					wasScanFound = true;
+				}
+				break;
+			default:
+				if ( ( ( marker >= 0xc2 ) && ( marker <= 0xcf ) ) && ( marker != 0xc4 ) && ( marker != 0xc8 ) && ( marker != 0xcc ) )
+				{
+					return ReportError( "Only baseline JPEG files are supported (not progressive, lossless, or arithmetic-coded ones)", o_errorMessage );
+				}
+				// Other segments (like APPn and comments) don't affect decoding
+				break;
+		}
+		offset = nextOffset;
+	}
+	if ( !wasScanFound )
+	{
+		return ReportError( "The JPEG file has no image data", o_errorMessage );
+	}
+
+	// Subsampled components are upsampled to the size of the image
+	const uint8_t* planes[3];
+	size_t planeStrides[3];
+	std::vector<uint8_t> upsampledPlanes[3];
+	for ( unsigned int i = 0; i < frame.componentCount; ++i )
+	{
+		const sComponent& component = frame.components[i];
+		const unsigned int horizontalFactor = frame.maxHorizontalSamplingFactor / component.horizontalSamplingFactor;
+		const unsigned int verticalFactor = frame.maxVerticalSamplingFactor / component.verticalSamplingFactor;
+		if ( ( horizontalFactor == 1 ) && ( verticalFactor == 1 ) )
+		{
+			planes[i] = component.samples.data();
+			planeStrides[i] = component.samplesWidth;
+		}
+		else
+		{
+			upsampledPlanes[i].resize( frame.width * frame.height );
+			Upsample( component, horizontalFactor, verticalFactor, frame.width, frame.height, upsampledPlanes[i].data() );
+			planes[i] = upsampledPlanes[i].data();
+			planeStrides[i] = frame.width;
+		}
+	}
+
+	o_image.width = frame.width;
+	o_image.height = frame.height;
+	o_image.hasAlpha = false;
+	o_image.pixels.resize( o_image.GetSlicePitch() );
+	// Three components are YCbCr unless an Adobe marker or the component IDs say that they're RGB
+	const bool isRgb = ( frame.componentCount == 3 ) && ( ( adobeTransform == 0 )
+		|| ( ( frame.components[0].id == 'R' ) && ( frame.components[1].id == 'G' ) && ( frame.components[2].id == 'B' ) ) );
+	for ( size_t y = 0; y < frame.height; ++y )
+	{
+		uint8_t* const pixels = &o_image.pixels[y * o_image.GetRowPitch()];
+		if ( frame.componentCount == 1 )
+		{
+			const uint8_t* const grays = planes[0] + ( y * planeStrides[0] );
+			for ( size_t x = 0; x < frame.width; ++x )
+			{
+				pixels[( x * 4 ) + 0] = pixels[( x * 4 ) + 1] = pixels[( x * 4 ) + 2] = grays[x];
+				pixels[( x * 4 ) + 3] = 0xff;
+			}
+		}
+		else if ( isRgb )
+		{
+			const uint8_t* const reds = planes[0] + ( y * planeStrides[0] );
+			const uint8_t* const greens = planes[1] + ( y * planeStrides[1] );
+			const uint8_t* const blues = planes[2] + ( y * planeStrides[2] );
+			for ( size_t x = 0; x < frame.width; ++x )
+			{
+				pixels[( x * 4 ) + 0] = reds[x];
+				pixels[( x * 4 ) + 1] = greens[x];
+				pixels[( x * 4 ) + 2] = blues[x];
+				pixels[( x * 4 ) + 3] = 0xff;
+			}
+		}
+		else
+		{
+			ConvertYCbCrRow( planes[0] + ( y * planeStrides[0] ), planes[1] + ( y * planeStrides[1] ), planes[2] + ( y * planeStrides[2] ),
+				frame.width, pixels );
+		}
+	}
+	return true;
+}
+
+namespace
+{
+	bool BuildHuffmanTable( const uint8_t* const i_codeCounts, const uint8_t* const i_values, const size_t i_valueCount, sHuffmanTable& o_table )
+	{
+		// Codes are assigned in order of length and then of value (ITU T.81 annex C)
+		memset( o_table.fastLookup, 0, sizeof( o_table.fastLookup ) );
+		memcpy( o_table.values, i_values, i_valueCount );
+		int32_t code = 0;
+		int32_t valueIndex = 0;
+		for ( unsigned int length = 1; length <= 16; ++length )
+		{
+			const unsigned int codeCount = i_codeCounts[length - 1];
+			o_table.valueOffsets[length] = valueIndex - code;
+			for ( unsigned int i = 0; i < codeCount; ++i, ++code, ++valueIndex )
+			{
+				if ( length <= s_fastHuffmanBitCount )
+				{
+					const unsigned int shift = s_fastHuffmanBitCount - length;
+					const uint16_t entry = static_cast<uint16_t>( ( length << 8 ) | i_values[valueIndex] );
+					for ( unsigned int j = 0; j < ( 1u << shift ); ++j )
+					{
+						o_table.fastLookup[( code << shift ) | j] = entry;
+					}
+				}
+			}
+			o_table.maxCodes[length] = ( codeCount > 0 ) ? ( code - 1 ) : -1;
+			if ( code > ( 1 << length ) )
+			{
+				// There are more codes of this length than can fit
+				return false;
+			}
+			code <<= 1;
+		}
+		o_table.isDefined = true;
+		return true;
+	}
+
+	void ConvertYCbCrRow( const uint8_t* const i_y, const uint8_t* const i_cb, const uint8_t* const i_cr, const size_t i_width, uint8_t* const o_pixels )
+	{
+		// The coefficients are the ones from JFIF scaled by 2^13,
+		// and the chroma is scaled by 2^4 so that the high half of each product is twice the result (which is then rounded)
+		const int16_t crToRed = 11485, cbToGreen = -2819, crToGreen = -5850, cbToBlue = 14516;
+		size_t x = 0;
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i chromaOffset = _mm_set1_epi16( 128 );
+			const __m128i one = _mm_set1_epi16( 1 );
+			const __m128i opaque = _mm_set1_epi8( -1 );
+			for ( ; ( x + 8 ) <= i_width; x += 8 )
+			{
+				const __m128i y = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( i_y + x ) ), zero );
+				const __m128i cb = _mm_slli_epi16( _mm_sub_epi16(
+					_mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( i_cb + x ) ), zero ), chromaOffset ), 4 );
+				const __m128i cr = _mm_slli_epi16( _mm_sub_epi16(
+					_mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( i_cr + x ) ), zero ), chromaOffset ), 4 );
+				const __m128i redOffset = _mm_mulhi_epi16( cr, _mm_set1_epi16( crToRed ) );
+				const __m128i greenOffset = _mm_add_epi16( _mm_mulhi_epi16( cb, _mm_set1_epi16( cbToGreen ) ), _mm_mulhi_epi16( cr, _mm_set1_epi16( crToGreen ) ) );
+				const __m128i blueOffset = _mm_mulhi_epi16( cb, _mm_set1_epi16( cbToBlue ) );
+				const __m128i red = _mm_add_epi16( y, _mm_srai_epi16( _mm_add_epi16( redOffset, one ), 1 ) );
+				const __m128i green = _mm_add_epi16( y, _mm_srai_epi16( _mm_add_epi16( greenOffset, one ), 1 ) );
+				const __m128i blue = _mm_add_epi16( y, _mm_srai_epi16( _mm_add_epi16( blueOffset, one ), 1 ) );
+				// Saturating when packing clamps to [0,255]
+				const __m128i redGreen = _mm_unpacklo_epi8( _mm_packus_epi16( red, zero ), _mm_packus_epi16( green, zero ) );
+				const __m128i blueAlpha = _mm_unpacklo_epi8( _mm_packus_epi16( blue, zero ), opaque );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( o_pixels + ( x * 4 ) ), _mm_unpacklo_epi16( redGreen, blueAlpha ) );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( o_pixels + ( x * 4 ) + 16 ), _mm_unpackhi_epi16( redGreen, blueAlpha ) );
+			}
+		}
+		for ( ; x < i_width; ++x )
+		{
+			const int y = i_y[x];
+			const int cb = ( i_cb[x] - 128 ) * 16;
+			const int cr = ( i_cr[x] - 128 ) * 16;
+			const int values[] =
+			{
+				y + ( ( ( ( cr * crToRed ) >> 16 ) + 1 ) >> 1 ),
+				y + ( ( ( ( cb * cbToGreen ) >> 16 ) + ( ( cr * crToGreen ) >> 16 ) + 1 ) >> 1 ),
+				y + ( ( ( ( cb * cbToBlue ) >> 16 ) + 1 ) >> 1 ),
+			};
+			for ( unsigned int i = 0; i < 3; ++i )
+			{
+				o_pixels[( x * 4 ) + i] = static_cast<uint8_t>( ( values[i] < 0 ) ? 0 : ( ( values[i] > 255 ) ? 255 : values[i] ) );
+			}
+			o_pixels[( x * 4 ) + 3] = 0xff;
+		}
+	}
+
+	bool DecodeBlock( cEntropyReader& io_reader, const sHuffmanTable& i_dcTable, const sHuffmanTable& i_acTable, const uint16_t* const i_quantizationTable,
+		int& io_dcPrediction, uint8_t* const o_samples, const size_t i_stride )
+	{
+		// Storing the coefficients as vectors keeps them aligned
+		__m128 coefficientVectors[16];
+		float* const coefficients = reinterpret_cast<float*>( coefficientVectors );
+		memset( coefficients, 0, sizeof( coefficientVectors ) );
+		unsigned int nonZeroRowMask = 1;
+		bool areThereAcCoefficients = false;
+		{
+			unsigned int bitCount;
+			if ( !io_reader.DecodeSymbol( i_dcTable, bitCount ) || ( bitCount > 16 ) )
+			{
+				return false;
+			}
+			io_dcPrediction += io_reader.ReadSigned( bitCount );
+			coefficients[0] = static_cast<float>( io_dcPrediction * static_cast<int>( i_quantizationTable[0] ) );
+		}
+		for ( unsigned int i = 1; i < 64; )
+		{
+			unsigned int symbol;
+			if ( !io_reader.DecodeSymbol( i_acTable, symbol ) )
+			{
+				return false;
+			}
+			const unsigned int zeroCount = symbol >> 4;
+			const unsigned int bitCount = symbol & 0xf;
+			if ( bitCount == 0 )
+			{
+				if ( zeroCount == 15 )
+				{
+					i += 16;
+					continue;
+				}
+				// The rest of the block is zeros
+				break;
+			}
+			i += zeroCount;
+			if ( i > 63 )
+			{
+				return false;
+			}
+			const unsigned int index = s_zigZagToNatural[i];
+			coefficients[index] = static_cast<float>( io_reader.ReadSigned( bitCount ) * static_cast<int>( i_quantizationTable[index] ) );
+			nonZeroRowMask |= 1u << ( index / 8 );
+			areThereAcCoefficients = true;
+			++i;
+		}
+
+		if ( areThereAcCoefficients )
+		{
+			InverseDct( coefficients, nonZeroRowMask, o_samples, i_stride );
+		}
+		else
+		{
+			// The most common block is a single color
+			const float value = ( coefficients[0] * 0.125f ) + 128.0f;
+			const int roundedValue = static_cast<int>( floorf( value + 0.5f ) );
+			const uint8_t sample = static_cast<uint8_t>( ( roundedValue < 0 ) ? 0 : ( ( roundedValue > 255 ) ? 255 : roundedValue ) );
+			for ( unsigned int y = 0; y < 8; ++y )
+			{
+				memset( o_samples + ( y * i_stride ), sample, 8 );
+			}
+		}
+		return true;
+	}
+
+	bool DecodeScan( const uint8_t* const i_data, const size_t i_dataSize, size_t& io_position, sFrame& io_frame,
+		sComponent* const* const i_scanComponents, const unsigned int i_scanComponentCount,
+		const sHuffmanTable* const i_dcTables, const sHuffmanTable* const i_acTables, const uint16_t ( * const i_quantizationTables )[64],
+		const unsigned int i_restartInterval, std::string* const o_errorMessage )
+	{
+		using Engine::AssetBuild::ImageDecoding::ReportError;
+
+		for ( unsigned int i = 0; i < i_scanComponentCount; ++i )
+		{
+			i_scanComponents[i]->dcPrediction = 0;
+		}
+		cEntropyReader reader( i_data, i_dataSize, io_position );
+		// A scan with a single component isn't interleaved, and each of its MCUs is a single block
+		// (that covers only the component's own size rather than whole MCUs of the frame)
+		const bool isInterleaved = i_scanComponentCount > 1;
+		const size_t mcuCountX = isInterleaved ? io_frame.mcuCountX : ( ( i_scanComponents[0]->width + 7 ) / 8 );
+		const size_t mcuCountY = isInterleaved ? io_frame.mcuCountY : ( ( i_scanComponents[0]->height + 7 ) / 8 );
+		size_t mcuIndex = 0;
+		for ( size_t mcuY = 0; mcuY < mcuCountY; ++mcuY )
+		{
+			for ( size_t mcuX = 0; mcuX < mcuCountX; ++mcuX, ++mcuIndex )
+			{
+				if ( ( i_restartInterval > 0 ) && ( mcuIndex > 0 ) && ( ( mcuIndex % i_restartInterval ) == 0 ) )
+				{
+					if ( !reader.SkipRestartMarker() )
+					{
+						return ReportError( "The JPEG file is missing a restart marker", o_errorMessage );
+					}
+					for ( unsigned int i = 0; i < i_scanComponentCount; ++i )
+					{
+						i_scanComponents[i]->dcPrediction = 0;
+					}
+				}
+				for ( unsigned int i = 0; i < i_scanComponentCount; ++i )
+				{
+					sComponent& component = *i_scanComponents[i];
+					const unsigned int blockCountX = isInterleaved ? component.horizontalSamplingFactor : 1;
+					const unsigned int blockCountY = isInterleaved ? component.verticalSamplingFactor : 1;
+					for ( unsigned int blockY = 0; blockY < blockCountY; ++blockY )
+					{
+						for ( unsigned int blockX = 0; blockX < blockCountX; ++blockX )
+						{
+							const size_t x = ( ( mcuX * blockCountX ) + blockX ) * 8;
+							const size_t y = ( ( mcuY * blockCountY ) + blockY ) * 8;
+							if ( !DecodeBlock( reader, i_dcTables[component.dcTableIndex], i_acTables[component.acTableIndex],
+								i_quantizationTables[component.quantizationTableIndex], component.dcPrediction,
+								&component.samples[( y * component.samplesWidth ) + x], component.samplesWidth ) )
+							{
+								return ReportError( "The JPEG file's image data is corrupt", o_errorMessage );
+							}
+						}
+					}
+				}
+			}
+		}
+		io_position = reader.FindNextMarker();
+		return true;
+	}
+
+	void InverseDct( const float* const i_coefficients, const unsigned int i_nonZeroRowMask, uint8_t* const o_samples, const size_t i_stride )
+	{
+		// The 2D IDCT is separable into 1D IDCTs of the rows and then of the columns,
+		// and each one is a multiplication by the same matrix:
+		//	basis[k][n] = C(k)/2 * cos( (2n+1) * k * pi/16 ), where C(0) = 1/sqrt(2) and C(k) = 1 otherwise
+		struct sBasis
+		{
+			// Each row of the matrix as two vectors
+			__m128 rows[8][2];
+			// Each element of the matrix in all four lanes
+			__m128 elements[8][8];
+
+			sBasis()
+			{
+				const double pi = 3.14159265358979323846;
+				for ( unsigned int k = 0; k < 8; ++k )
+				{
+					float row[8];
+					for ( unsigned int n = 0; n < 8; ++n )
+					{
+						const double scale = ( k == 0 ) ? ( 0.5 / sqrt( 2.0 ) ) : 0.5;
+						row[n] = static_cast<float>( scale * cos( ( ( 2 * n ) + 1 ) * k * pi / 16.0 ) );
+						elements[k][n] = _mm_set1_ps( row[n] );
+					}
+					rows[k][0] = _mm_loadu_ps( row );
+					rows[k][1] = _mm_loadu_ps( row + 4 );
+				}
+			}
+		};
+		static const sBasis s_basis;
+
+		// Rows of coefficients that are all zero stay zero, and so they are skipped in both passes
+		__m128 rows[8][2];
+		for ( unsigned int v = 0; v < 8; ++v )
+		{
+			__m128 left = _mm_setzero_ps(), right = _mm_setzero_ps();
+			if ( ( i_nonZeroRowMask & ( 1u << v ) ) != 0 )
+			{
+				for ( unsigned int u = 0; u < 8; ++u )
+				{
+					const __m128 coefficient = _mm_set1_ps( i_coefficients[( v * 8 ) + u] );
+					left = _mm_add_ps( left, _mm_mul_ps( coefficient, s_basis.rows[u][0] ) );
+					right = _mm_add_ps( right, _mm_mul_ps( coefficient, s_basis.rows[u][1] ) );
+				}
+			}
+			rows[v][0] = left;
+			rows[v][1] = right;
+		}
+		const __m128 levelShift = _mm_set1_ps( 128.0f );
+		for ( unsigned int y = 0; y < 8; ++y )
+		{
+			__m128 left = levelShift, right = levelShift;
+			for ( unsigned int v = 0; v < 8; ++v )
+			{
+				if ( ( i_nonZeroRowMask & ( 1u << v ) ) != 0 )
+				{
+					left = _mm_add_ps( left, _mm_mul_ps( s_basis.elements[v][y], rows[v][0] ) );
+					right = _mm_add_ps( right, _mm_mul_ps( s_basis.elements[v][y], rows[v][1] ) );
+				}
+			}
+			// Rounding to integers and then saturating when packing clamps to [0,255]
+			const __m128i words = _mm_packs_epi32( _mm_cvtps_epi32( left ), _mm_cvtps_epi32( right ) );
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( o_samples + ( y * i_stride ) ), _mm_packus_epi16( words, words ) );
+		}
+	}
+
+	void Upsample( const sComponent& i_component, const unsigned int i_horizontalFactor, const unsigned int i_verticalFactor,
+		const size_t i_width, const size_t i_height, uint8_t* const o_samples )
+	{
+		const size_t lastX = i_component.width - 1;
+		const size_t lastY = i_component.height - 1;
+		if ( ( i_horizontalFactor == 2 ) && ( i_verticalFactor <= 2 ) )
+		{
+			// 4:2:2 and 4:2:0 are interpolated like libjpeg's "fancy" upsampling does
+			// (each output sample is 3/4 of the nearest input sample and 1/4 of the next nearest one in each direction)
+			std::vector<int> columnSums( i_component.width );
+			std::vector<uint8_t> row( i_component.width * 2 );
+			for ( size_t y = 0; y < i_height; ++y )
+			{
+				const size_t nearestY = y / i_verticalFactor;
+				const uint8_t* const nearestRow = &i_component.samples[nearestY * i_component.samplesWidth];
+				if ( i_verticalFactor == 2 )
+				{
+					const size_t neighborY = ( ( y % 2 ) == 0 ) ? ( ( nearestY > 0 ) ? ( nearestY - 1 ) : 0 ) : ( ( nearestY < lastY ) ? ( nearestY + 1 ) : lastY );
+					const uint8_t* const neighborRow = &i_component.samples[neighborY * i_component.samplesWidth];
+					for ( size_t x = 0; x <= lastX; ++x )
+					{
+						columnSums[x] = ( 3 * nearestRow[x] ) + neighborRow[x];
+					}
+					for ( size_t x = 0; x <= lastX; ++x )
+					{
+						const int sum = 3 * columnSums[x];
+						row[x * 2] = static_cast<uint8_t>( ( sum + columnSums[( x > 0 ) ? ( x - 1 ) : 0] + 8 ) >> 4 );
+						row[( x * 2 ) + 1] = static_cast<uint8_t>( ( sum + columnSums[( x < lastX ) ? ( x + 1 ) : lastX] + 7 ) >> 4 );
+					}
+				}
+				else
+				{
+					for ( size_t x = 0; x <= lastX; ++x )
+					{
+						const int sum = 3 * nearestRow[x];
+						row[x * 2] = static_cast<uint8_t>( ( sum + nearestRow[( x > 0 ) ? ( x - 1 ) : 0] + 1 ) >> 2 );
+						row[( x * 2 ) + 1] = static_cast<uint8_t>( ( sum + nearestRow[( x < lastX ) ? ( x + 1 ) : lastX] + 2 ) >> 2 );
+					}
+				}
+				memcpy( o_samples + ( y * i_width ), row.data(), i_width );
+			}
+		}
+		else
+		{
+			// Other factors just replicate samples
+			for ( size_t y = 0; y < i_height; ++y )
+			{
+				const uint8_t* const inputRow = &i_component.samples[( y / i_verticalFactor ) * i_component.samplesWidth];
+				uint8_t* const outputRow = o_samples + ( y * i_width );
+				for ( size_t x = 0; x < i_width; ++x )
+				{
+					outputRow[x] = inputRow[x / i_horizontalFactor];
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,600 @@
+#include "Internal.h"
+
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	namespace ColorTypes
+	{
+		enum eColorType
+		{
+			Gray = 0,
+			Rgb = 2,
+			Palette = 3,
+			GrayAlpha = 4,
+			RgbAlpha = 6,
+		};
+	}
+	namespace FilterTypes
+	{
+		enum eFilterType
+		{
+			None = 0,
+			Sub = 1,
+			Up = 2,
+			Average = 3,
+			Paeth = 4,
+		};
+	}
+
+	struct sHeader
+	{
+		size_t width, height;
+		unsigned int bitDepth;
+		ColorTypes::eColorType colorType;
+		bool isInterlaced;
+	};
+
+	struct sTransparency
+	{
+		// Palette images have an alpha for each palette entry
+		uint8_t paletteAlphas[256];
+		// Gray and RGB images have a single color that is transparent
+		uint16_t key[3];
+		bool isPresent;
+	};
+
+	// The 7 passes of Adam7 interlacing (the first one is a single pixel in every 8x8 block)
+	const unsigned int s_adam7StartX[] = { 0, 4, 0, 2, 0, 1, 0 };
+	const unsigned int s_adam7StartY[] = { 0, 0, 4, 0, 2, 0, 1 };
+	const unsigned int s_adam7StepX[] = { 8, 8, 4, 4, 2, 2, 1 };
+	const unsigned int s_adam7StepY[] = { 8, 8, 8, 4, 4, 2, 2 };
+
+	inline uint32_t ReadBigEndian32( const uint8_t* const i_data )
+	{
+		return ( static_cast<uint32_t>( i_data[0] ) << 24 ) | ( static_cast<uint32_t>( i_data[1] ) << 16 )
+			| ( static_cast<uint32_t>( i_data[2] ) << 8 ) | i_data[3];
+	}
+
+	unsigned int GetChannelCount( const ColorTypes::eColorType i_colorType );
+	void ConvertRow( const uint8_t* const i_row, const sHeader& i_header, const uint8_t* const i_palette, const sTransparency& i_transparency,
+		const size_t i_pixelCount, uint8_t* o_pixels, const size_t i_pixelStride );
+	bool Unfilter( uint8_t* const io_rows, const size_t i_rowSize, const size_t i_rowCount, const size_t i_bytesPerPixel );
+}
+
+bool Engine::AssetBuild::ImageDecoding::DecodePng( const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image,
+	std::string* const o_errorMessage )
+{
+	const size_t signatureSize = 8;
+	if ( i_dataSize < signatureSize )
+	{
+		return ReportError( "The PNG file is missing its signature", o_errorMessage );
+	}
+
+	// Read the chunks that matter for decoding and concatenate the compressed image data
+	sHeader header = {};
+	bool wasHeaderFound = false;
+	uint8_t palette[256 * 3] = { 0 };
+	size_t paletteEntryCount = 0;
+	sTransparency transparency;
+	memset( &transparency, 0, sizeof( transparency ) );
+	memset( transparency.paletteAlphas, 0xff, sizeof( transparency.paletteAlphas ) );
+	std::vector<uint8_t> compressedData;
+	{
+		bool wasEndFound = false;
+		size_t offset = signatureSize;
+		while ( !wasEndFound )
+		{
+			if ( ( i_dataSize - offset ) < 12 )
+			{
+				return ReportError( "The PNG file ends in the middle of a chunk", o_errorMessage );
+			}
+			const size_t chunkSize = ReadBigEndian32( i_data + offset );
+			const uint8_t* const chunkType = i_data + offset + 4;
+			const uint8_t* const chunkData = i_data + offset + 8;
+			if ( chunkSize > ( i_dataSize - offset - 12 ) )
+			{
+				return ReportError( "The PNG file ends in the middle of a chunk", o_errorMessage );
+			}
+			// CRCs aren't verified
+			offset += 12 + chunkSize;
+
+			if ( memcmp( chunkType, "IHDR", 4 ) == 0 )
+			{
+				if ( chunkSize < 13 )
+				{
+					return ReportError( "The PNG file's header is too small", o_errorMessage );
+				}
+				header.width = ReadBigEndian32( chunkData );
+				header.height = ReadBigEndian32( chunkData + 4 );
+				header.bitDepth = chunkData[8];
+				const unsigned int colorType = chunkData[9];
+				const unsigned int compressionMethod = chunkData[10];
+				const unsigned int filterMethod = chunkData[11];
+				const unsigned int interlaceMethod = chunkData[12];
+				header.isInterlaced = interlaceMethod == 1;
+				if ( ( header.width == 0 ) || ( header.height == 0 ) || ( header.width > s_maxPixelCount )
+					|| ( header.height > ( s_maxPixelCount / header.width ) ) )
+				{
+					return ReportError( "The PNG file's dimensions are invalid or too big", o_errorMessage );
+				}
+				if ( ( compressionMethod != 0 ) || ( filterMethod != 0 ) || ( interlaceMethod > 1 ) )
+				{
+					return ReportError( "The PNG file uses an unknown compression, filter, or interlace method", o_errorMessage );
+				}
+				bool isBitDepthValid;
+				switch ( colorType )
+				{
+					case ColorTypes::Gray:
+						isBitDepthValid = ( header.bitDepth == 1 ) || ( header.bitDepth == 2 ) || ( header.bitDepth == 4 )
+							|| ( header.bitDepth == 8 ) || ( header.bitDepth == 16 );
+						break;
+					case ColorTypes::Palette:
+						isBitDepthValid = ( header.bitDepth == 1 ) || ( header.bitDepth == 2 ) || ( header.bitDepth == 4 ) || ( header.bitDepth == 8 );
+						break;
+					case ColorTypes::Rgb:
+					case ColorTypes::GrayAlpha:
+					case ColorTypes::RgbAlpha:
+						isBitDepthValid = ( header.bitDepth == 8 ) || ( header.bitDepth == 16 );
+						break;
+					default:
+						return ReportError( "The PNG file has an unknown color type", o_errorMessage );
+				}
+				if ( !isBitDepthValid )
+				{
+					return ReportError( "The PNG file's bit depth isn't valid for its color type", o_errorMessage );
+				}
+				header.colorType = static_cast<ColorTypes::eColorType>( colorType );
+				wasHeaderFound = true;
+			}
+			else if ( !wasHeaderFound )
+			{
+				return ReportError( "The PNG file doesn't start with a header chunk", o_errorMessage );
+			}
+			else if ( memcmp( chunkType, "PLTE", 4 ) == 0 )
+			{
+				paletteEntryCount = chunkSize / 3;
+				if ( ( ( chunkSize % 3 ) != 0 ) || ( paletteEntryCount > 256 ) )
+				{
+					return ReportError( "The PNG file's palette is invalid", o_errorMessage );
+				}
+				memcpy( palette, chunkData, chunkSize );
+			}
+			else if ( memcmp( chunkType, "tRNS", 4 ) == 0 )
+			{
+				if ( header.colorType == ColorTypes::Palette )
+				{
+					const size_t alphaCount = ( chunkSize < 256 ) ? chunkSize : 256;
+					memcpy( transparency.paletteAlphas, chunkData, alphaCount );
+					transparency.isPresent = true;
+				}
+				else if ( ( header.colorType == ColorTypes::Gray ) && ( chunkSize >= 2 ) )
+				{
+					transparency.key[0] = static_cast<uint16_t>( ( chunkData[0] << 8 ) | chunkData[1] );
+					transparency.isPresent = true;
+				}
+				else if ( ( header.colorType == ColorTypes::Rgb ) && ( chunkSize >= 6 ) )
+				{
+					for ( unsigned int i = 0; i < 3; ++i )
+					{
+						transparency.key[i] = static_cast<uint16_t>( ( chunkData[i * 2] << 8 ) | chunkData[( i * 2 ) + 1] );
+					}
+					transparency.isPresent = true;
+				}
+			}
+			else if ( memcmp( chunkType, "IDAT", 4 ) == 0 )
+			{
+				compressedData.insert( compressedData.end(), chunkData, chunkData + chunkSize );
+			}
+			else if ( memcmp( chunkType, "IEND", 4 ) == 0 )
+			{
+				wasEndFound = true;
+			}
+			else if ( ( chunkType[0] & 0x20 ) == 0 )
+			{
+				// Chunks whose type starts with an upper case letter are critical and can't be ignored
+				return ReportError( "The PNG file has an unknown critical chunk", o_errorMessage );
+			}
+		}
+	}
+	if ( compressedData.empty() )
+	{
+		return ReportError( "The PNG file has no image data", o_errorMessage );
+	}
+	if ( ( header.colorType == ColorTypes::Palette ) && ( paletteEntryCount == 0 ) )
+	{
+		return ReportError( "The PNG file uses a palette but doesn't have one", o_errorMessage );
+	}
+
+	// Each pass of an interlaced image is stored as its own smaller image
+	const size_t bitsPerPixel = GetChannelCount( header.colorType ) * header.bitDepth;
+	const size_t bytesPerPixel = ( bitsPerPixel + 7 ) / 8;
+	const unsigned int passCount = header.isInterlaced ? 7 : 1;
+	size_t passWidths[7], passHeights[7], passOffsets[7];
+	size_t filteredSize = 0;
+	for ( unsigned int i = 0; i < passCount; ++i )
+	{
+		if ( header.isInterlaced )
+		{
+			passWidths[i] = ( header.width > s_adam7StartX[i] ) ? ( ( header.width - s_adam7StartX[i] + s_adam7StepX[i] - 1 ) / s_adam7StepX[i] ) : 0;
+			passHeights[i] = ( header.height > s_adam7StartY[i] ) ? ( ( header.height - s_adam7StartY[i] + s_adam7StepY[i] - 1 ) / s_adam7StepY[i] ) : 0;
+		}
+		else
+		{
+			passWidths[i] = header.width;
+			passHeights[i] = header.height;
+		}
+		passOffsets[i] = filteredSize;
+		if ( ( passWidths[i] > 0 ) && ( passHeights[i] > 0 ) )
+		{
+			// Every row starts with a byte that says how it was filtered
+			filteredSize += ( 1 + ( ( ( passWidths[i] * bitsPerPixel ) + 7 ) / 8 ) ) * passHeights[i];
+		}
+	}
+	std::vector<uint8_t> filteredData;
+	if ( !Inflate( compressedData.data(), compressedData.size(), filteredData, filteredSize, o_errorMessage ) )
+	{
+		return false;
+	}
+	if ( filteredData.size() < filteredSize )
+	{
+		return ReportError( "The PNG file doesn't have enough image data", o_errorMessage );
+	}
+
+	o_image.width = header.width;
+	o_image.height = header.height;
+	o_image.hasAlpha = ( header.colorType == ColorTypes::GrayAlpha ) || ( header.colorType == ColorTypes::RgbAlpha ) || transparency.isPresent;
+	o_image.pixels.resize( o_image.GetSlicePitch() );
+	for ( unsigned int i = 0; i < passCount; ++i )
+	{
+		if ( ( passWidths[i] == 0 ) || ( passHeights[i] == 0 ) )
+		{
+			continue;
+		}
+		const size_t rowSize = ( ( passWidths[i] * bitsPerPixel ) + 7 ) / 8;
+		uint8_t* const rows = &filteredData[passOffsets[i]];
+		if ( !Unfilter( rows, rowSize, passHeights[i], bytesPerPixel ) )
+		{
+			return ReportError( "The PNG file has a row with an unknown filter type", o_errorMessage );
+		}
+		const size_t startX = header.isInterlaced ? s_adam7StartX[i] : 0;
+		const size_t startY = header.isInterlaced ? s_adam7StartY[i] : 0;
+		const size_t stepX = header.isInterlaced ? s_adam7StepX[i] : 1;
+		const size_t stepY = header.isInterlaced ? s_adam7StepY[i] : 1;
+		for ( size_t y = 0; y < passHeights[i]; ++y )
+		{
+			const uint8_t* const row = rows + ( y * ( rowSize + 1 ) ) + 1;
+			uint8_t* const pixels = &o_image.pixels[( ( ( startY + ( y * stepY ) ) * header.width ) + startX ) * 4];
+			ConvertRow( row, header, palette, transparency, passWidths[i], pixels, stepX * 4 );
+		}
+	}
+	return true;
+}
+
+namespace
+{
+	unsigned int GetChannelCount( const ColorTypes::eColorType i_colorType )
+	{
+		switch ( i_colorType )
+		{
+			case ColorTypes::Gray: return 1;
+			case ColorTypes::Rgb: return 3;
+			case ColorTypes::Palette: return 1;
+			case ColorTypes::GrayAlpha: return 2;
+			case ColorTypes::RgbAlpha: return 4;
+		}
+		return 0;
+	}
+
+	void ConvertRow( const uint8_t* const i_row, const sHeader& i_header, const uint8_t* const i_palette, const sTransparency& i_transparency,
+		const size_t i_pixelCount, uint8_t* o_pixels, const size_t i_pixelStride )
+	{
+		const size_t pixelCount = i_pixelCount;
+		if ( i_header.bitDepth < 8 )
+		{
+			// Pixels are packed starting with the most significant bits,
+			// and gray is scaled so that the largest value is white
+			const unsigned int bitDepth = i_header.bitDepth;
+			const unsigned int mask = ( 1u << bitDepth ) - 1;
+			const unsigned int grayScale = 255 / mask;
+			const bool isPalette = i_header.colorType == ColorTypes::Palette;
+			for ( size_t x = 0; x < pixelCount; ++x, o_pixels += i_pixelStride )
+			{
+				const size_t bitOffset = x * bitDepth;
+				const unsigned int value = ( i_row[bitOffset / 8] >> ( 8 - bitDepth - ( bitOffset % 8 ) ) ) & mask;
+				if ( isPalette )
+				{
+					o_pixels[0] = i_palette[( value * 3 ) + 0];
+					o_pixels[1] = i_palette[( value * 3 ) + 1];
+					o_pixels[2] = i_palette[( value * 3 ) + 2];
+					o_pixels[3] = i_transparency.paletteAlphas[value];
+				}
+				else
+				{
+					const uint8_t gray = static_cast<uint8_t>( value * grayScale );
+					o_pixels[0] = o_pixels[1] = o_pixels[2] = gray;
+					o_pixels[3] = ( i_transparency.isPresent && ( value == i_transparency.key[0] ) ) ? 0 : 0xff;
+				}
+			}
+			return;
+		}
+
+		if ( i_header.bitDepth == 16 )
+		{
+			// 16 bit channels are rounded to 8 bits, but transparent colors are compared at full precision
+			const unsigned int channelCount = GetChannelCount( i_header.colorType );
+			for ( size_t x = 0; x < pixelCount; ++x, o_pixels += i_pixelStride )
+			{
+				uint16_t values[4];
+				for ( unsigned int i = 0; i < channelCount; ++i )
+				{
+					const uint8_t* const value = i_row + ( ( ( x * channelCount ) + i ) * 2 );
+					values[i] = static_cast<uint16_t>( ( value[0] << 8 ) | value[1] );
+				}
+				uint8_t converted[4];
+				for ( unsigned int i = 0; i < channelCount; ++i )
+				{
+					converted[i] = static_cast<uint8_t>( ( ( values[i] * 255u ) + 32895u ) >> 16 );
+				}
+				switch ( i_header.colorType )
+				{
+					case ColorTypes::Gray:
+						o_pixels[0] = o_pixels[1] = o_pixels[2] = converted[0];
+						o_pixels[3] = ( i_transparency.isPresent && ( values[0] == i_transparency.key[0] ) ) ? 0 : 0xff;
+						break;
+					case ColorTypes::GrayAlpha:
+						o_pixels[0] = o_pixels[1] = o_pixels[2] = converted[0];
+						o_pixels[3] = converted[1];
+						break;
+					case ColorTypes::Rgb:
+						o_pixels[0] = converted[0];
+						o_pixels[1] = converted[1];
+						o_pixels[2] = converted[2];
+						o_pixels[3] = ( i_transparency.isPresent && ( values[0] == i_transparency.key[0] )
+							&& ( values[1] == i_transparency.key[1] ) && ( values[2] == i_transparency.key[2] ) ) ? 0 : 0xff;
+						break;
+					default:
+						memcpy( o_pixels, converted, 4 );
+						break;
+				}
+			}
+			return;
+		}
+
+		switch ( i_header.colorType )
+		{
+			case ColorTypes::RgbAlpha:
+				if ( i_pixelStride == 4 )
+				{
+					memcpy( o_pixels, i_row, pixelCount * 4 );
+				}
+				else
+				{
+					for ( size_t x = 0; x < pixelCount; ++x, o_pixels += i_pixelStride )
+					{
+						memcpy( o_pixels, i_row + ( x * 4 ), 4 );
+					}
+				}
+				break;
+			case ColorTypes::Rgb:
+				for ( size_t x = 0; x < pixelCount; ++x, o_pixels += i_pixelStride )
+				{
+					const uint8_t* const source = i_row + ( x * 3 );
+					o_pixels[0] = source[0];
+					o_pixels[1] = source[1];
+					o_pixels[2] = source[2];
+					o_pixels[3] = ( i_transparency.isPresent && ( source[0] == i_transparency.key[0] )
+						&& ( source[1] == i_transparency.key[1] ) && ( source[2] == i_transparency.key[2] ) ) ? 0 : 0xff;
+				}
+				break;
+			case ColorTypes::GrayAlpha:
+				for ( size_t x = 0; x < pixelCount; ++x, o_pixels += i_pixelStride )
+				{
+					o_pixels[0] = o_pixels[1] = o_pixels[2] = i_row[x * 2];
+					o_pixels[3] = i_row[( x * 2 ) + 1];
+				}
+				break;
+			case ColorTypes::Gray:
+				for ( size_t x = 0; x < pixelCount; ++x, o_pixels += i_pixelStride )
+				{
+					o_pixels[0] = o_pixels[1] = o_pixels[2] = i_row[x];
+					o_pixels[3] = ( i_transparency.isPresent && ( i_row[x] == i_transparency.key[0] ) ) ? 0 : 0xff;
+				}
+				break;
+			case ColorTypes::Palette:
+				for ( size_t x = 0; x < pixelCount; ++x, o_pixels += i_pixelStride )
+				{
+					const unsigned int index = i_row[x];
+					o_pixels[0] = i_palette[( index * 3 ) + 0];
+					o_pixels[1] = i_palette[( index * 3 ) + 1];
+					o_pixels[2] = i_palette[( index * 3 ) + 2];
+					o_pixels[3] = i_transparency.paletteAlphas[index];
+				}
+				break;
+		}
+	}
+
+	// SIMD helpers for unfiltering a single pixel of 3 or 4 bytes at a time
+	// (each filter depends on the already unfiltered pixel to the left, and so only the channels of a pixel can be done in parallel)
+
+	inline __m128i LoadPixel( const uint8_t* const i_pixel, const size_t i_bytesPerPixel )
+	{
+		if ( i_bytesPerPixel == 4 )
+		{
+			int value;
+			memcpy( &value, i_pixel, 4 );
+			return _mm_cvtsi32_si128( value );
+		}
+		else
+		{
+			const int value = i_pixel[0] | ( i_pixel[1] << 8 ) | ( i_pixel[2] << 16 );
+			return _mm_cvtsi32_si128( value );
+		}
+	}
+
+	inline void StorePixel( uint8_t* const o_pixel, const __m128i i_value, const size_t i_bytesPerPixel )
+	{
+		const int value = _mm_cvtsi128_si32( i_value );
+		if ( i_bytesPerPixel == 4 )
+		{
+			memcpy( o_pixel, &value, 4 );
+		}
+		else
+		{
+			o_pixel[0] = static_cast<uint8_t>( value );
+			o_pixel[1] = static_cast<uint8_t>( value >> 8 );
+			o_pixel[2] = static_cast<uint8_t>( value >> 16 );
+		}
+	}
+
+	void UnfilterSubSimd( uint8_t* const io_row, const size_t i_rowSize, const size_t i_bytesPerPixel )
+	{
+		__m128i left = _mm_setzero_si128();
+		for ( size_t x = 0; x < i_rowSize; x += i_bytesPerPixel )
+		{
+			left = _mm_add_epi8( LoadPixel( io_row + x, i_bytesPerPixel ), left );
+			StorePixel( io_row + x, left, i_bytesPerPixel );
+		}
+	}
+
+	void UnfilterAverageSimd( uint8_t* const io_row, const uint8_t* const i_previousRow, const size_t i_rowSize, const size_t i_bytesPerPixel )
+	{
+		// The average rounds down, but _mm_avg_epu8() rounds up and so the rounding has to be undone
+		const __m128i one = _mm_set1_epi8( 1 );
+		__m128i left = _mm_setzero_si128();
+		for ( size_t x = 0; x < i_rowSize; x += i_bytesPerPixel )
+		{
+			const __m128i above = LoadPixel( i_previousRow + x, i_bytesPerPixel );
+			const __m128i roundedAverage = _mm_avg_epu8( left, above );
+			const __m128i average = _mm_sub_epi8( roundedAverage, _mm_and_si128( _mm_xor_si128( left, above ), one ) );
+			left = _mm_add_epi8( LoadPixel( io_row + x, i_bytesPerPixel ), average );
+			StorePixel( io_row + x, left, i_bytesPerPixel );
+		}
+	}
+
+	void UnfilterPaethSimd( uint8_t* const io_row, const uint8_t* const i_previousRow, const size_t i_rowSize, const size_t i_bytesPerPixel )
+	{
+		// The predictor is computed with 16 bit lanes so that the differences don't overflow
+		const __m128i zero = _mm_setzero_si128();
+		__m128i left = zero, upperLeft = zero;
+		for ( size_t x = 0; x < i_rowSize; x += i_bytesPerPixel )
+		{
+			const __m128i above = _mm_unpacklo_epi8( LoadPixel( i_previousRow + x, i_bytesPerPixel ), zero );
+			// p = left + above - upperLeft, and the distances to it are:
+			// pa = |p - left| = |above - upperLeft|
+			// pb = |p - above| = |left - upperLeft|
+			// pc = |p - upperLeft| = |above - upperLeft + left - upperLeft|
+			const __m128i aboveDelta = _mm_sub_epi16( above, upperLeft );
+			const __m128i leftDelta = _mm_sub_epi16( left, upperLeft );
+			const __m128i sumDelta = _mm_add_epi16( aboveDelta, leftDelta );
+			const __m128i pa = _mm_max_epi16( aboveDelta, _mm_sub_epi16( zero, aboveDelta ) );
+			const __m128i pb = _mm_max_epi16( leftDelta, _mm_sub_epi16( zero, leftDelta ) );
+			const __m128i pc = _mm_max_epi16( sumDelta, _mm_sub_epi16( zero, sumDelta ) );
+			// Left wins ties, then above, then upper left
+			const __m128i isLeftChosen = _mm_and_si128( _mm_cmpgt_epi16( _mm_add_epi16( pb, _mm_set1_epi16( 1 ) ), pa ),
+				_mm_cmpgt_epi16( _mm_add_epi16( pc, _mm_set1_epi16( 1 ) ), pa ) );
+			const __m128i isAboveChosen = _mm_cmpgt_epi16( _mm_add_epi16( pc, _mm_set1_epi16( 1 ) ), pb );
+			const __m128i aboveOrUpperLeft = _mm_or_si128( _mm_and_si128( isAboveChosen, above ), _mm_andnot_si128( isAboveChosen, upperLeft ) );
+			const __m128i predictor = _mm_or_si128( _mm_and_si128( isLeftChosen, left ), _mm_andnot_si128( isLeftChosen, aboveOrUpperLeft ) );
+			const __m128i value = _mm_add_epi8( LoadPixel( io_row + x, i_bytesPerPixel ), _mm_packus_epi16( predictor, zero ) );
+			StorePixel( io_row + x, value, i_bytesPerPixel );
+			left = _mm_unpacklo_epi8( value, zero );
+			upperLeft = above;
+		}
+	}
+
+	inline uint8_t PaethPredictor( const int i_left, const int i_above, const int i_upperLeft )
+	{
+		const int p = i_left + i_above - i_upperLeft;
+		const int pa = ( p > i_left ) ? ( p - i_left ) : ( i_left - p );
+		const int pb = ( p > i_above ) ? ( p - i_above ) : ( i_above - p );
+		const int pc = ( p > i_upperLeft ) ? ( p - i_upperLeft ) : ( i_upperLeft - p );
+		if ( ( pa <= pb ) && ( pa <= pc ) )
+		{
+			return static_cast<uint8_t>( i_left );
+		}
+		return static_cast<uint8_t>( ( pb <= pc ) ? i_above : i_upperLeft );
+	}
+
+	bool Unfilter( uint8_t* const io_rows, const size_t i_rowSize, const size_t i_rowCount, const size_t i_bytesPerPixel )
+	{
+		// The row before the first one is treated as zeros
+		std::vector<uint8_t> zeroRow( i_rowSize, 0 );
+		const uint8_t* previousRow = zeroRow.data();
+		const bool canUseSimd = ( i_bytesPerPixel == 3 ) || ( i_bytesPerPixel == 4 );
+		for ( size_t y = 0; y < i_rowCount; ++y )
+		{
+			uint8_t* const filterTypeAndRow = io_rows + ( y * ( i_rowSize + 1 ) );
+			uint8_t* const row = filterTypeAndRow + 1;
+			const size_t bpp = i_bytesPerPixel;
+			switch ( *filterTypeAndRow )
+			{
+				case FilterTypes::None:
+					break;
+				case FilterTypes::Sub:
+					if ( canUseSimd )
+					{
+						UnfilterSubSimd( row, i_rowSize, bpp );
+					}
+					else
+					{
+						for ( size_t x = bpp; x < i_rowSize; ++x )
+						{
+							row[x] = static_cast<uint8_t>( row[x] + row[x - bpp] );
+						}
+					}
+					break;
+				case FilterTypes::Up:
+					{
+						// This is the only filter where every byte is independent
+						size_t x = 0;
+						for ( ; ( x + 16 ) <= i_rowSize; x += 16 )
+						{
+							const __m128i value = _mm_add_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( row + x ) ),
+								_mm_loadu_si128( reinterpret_cast<const __m128i*>( previousRow + x ) ) );
+							_mm_storeu_si128( reinterpret_cast<__m128i*>( row + x ), value );
+						}
+						for ( ; x < i_rowSize; ++x )
+						{
+							row[x] = static_cast<uint8_t>( row[x] + previousRow[x] );
+						}
+					}
+					break;
+				case FilterTypes::Average:
+					if ( canUseSimd )
+					{
+						UnfilterAverageSimd( row, previousRow, i_rowSize, bpp );
+					}
+					else
+					{
+						for ( size_t x = 0; x < i_rowSize; ++x )
+						{
+							const unsigned int left = ( x >= bpp ) ? row[x - bpp] : 0;
+							row[x] = static_cast<uint8_t>( row[x] + ( ( left + previousRow[x] ) >> 1 ) );
+						}
+					}
+					break;
+				case FilterTypes::Paeth:
+					if ( canUseSimd )
+					{
+						UnfilterPaethSimd( row, previousRow, i_rowSize, bpp );
+					}
+					else
+					{
+						for ( size_t x = 0; x < i_rowSize; ++x )
+						{
+							const int left = ( x >= bpp ) ? row[x - bpp] : 0;
+							const int upperLeft = ( x >= bpp ) ? previousRow[x - bpp] : 0;
+							row[x] = static_cast<uint8_t>( row[x] + PaethPredictor( left, previousRow[x], upperLeft ) );
+						}
+					}
+					break;
+				default:
+					return false;
+			}
+			previousRow = row;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,253 @@
+#include "Internal.h"
+
+#include <cstring>
+
+namespace
+{
+	namespace ImageTypes
+	{
+		enum eImageType
+		{
+			ColorMapped = 1,
+			TrueColor = 2,
+			Gray = 3,
+			RleColorMapped = 9,
+			RleTrueColor = 10,
+			RleGray = 11,
+		};
+	}
+
+	const size_t s_headerSize = 18;
+
+	inline unsigned int ReadLittleEndian16( const uint8_t* const i_data )
+	{
+		return i_data[0] | ( static_cast<unsigned int>( i_data[1] ) << 8 );
+	}
+
+	// Converts a single stored pixel (or color map entry) to RGBA
+	void ConvertPixel( const uint8_t* const i_pixel, const unsigned int i_bitsPerPixel, const bool i_isGray, uint8_t* const o_pixel );
+}
+
+bool Engine::AssetBuild::ImageDecoding::DecodeTga( const uint8_t* const i_data, const size_t i_dataSize, sImage& o_image,
+	std::string* const o_errorMessage )
+{
+	if ( i_dataSize < s_headerSize )
+	{
+		return ReportError( "The TGA file is too small to have a header", o_errorMessage );
+	}
+	const size_t idSize = i_data[0];
+	const bool hasColorMap = i_data[1] == 1;
+	const unsigned int imageType = i_data[2];
+	const size_t colorMapStart = ReadLittleEndian16( i_data + 3 );
+	const size_t colorMapLength = ReadLittleEndian16( i_data + 5 );
+	const unsigned int colorMapBitsPerEntry = i_data[7];
+	const size_t width = ReadLittleEndian16( i_data + 12 );
+	const size_t height = ReadLittleEndian16( i_data + 14 );
+	const unsigned int bitsPerPixel = i_data[16];
+	const unsigned int descriptor = i_data[17];
+	const unsigned int alphaBitCount = descriptor & 0xf;
+	const bool isRightToLeft = ( descriptor & 0x10 ) != 0;
+	const bool isTopToBottom = ( descriptor & 0x20 ) != 0;
+
+	const bool isRle = imageType >= ImageTypes::RleColorMapped;
+	const unsigned int baseImageType = isRle ? ( imageType - 8 ) : imageType;
+	const bool isColorMapped = baseImageType == ImageTypes::ColorMapped;
+	const bool isGray = baseImageType == ImageTypes::Gray;
+	if ( ( baseImageType < ImageTypes::ColorMapped ) || ( baseImageType > ImageTypes::Gray ) || ( isRle && ( imageType > ImageTypes::RleGray ) ) )
+	{
+		return ReportError( "The TGA file's image type isn't supported", o_errorMessage );
+	}
+	if ( ( width == 0 ) || ( height == 0 ) || ( ( width * height ) > s_maxPixelCount ) )
+	{
+		return ReportError( "The TGA file's dimensions are invalid or too big", o_errorMessage );
+	}
+	{
+		bool isBitDepthValid;
+		if ( isColorMapped )
+		{
+			isBitDepthValid = hasColorMap && ( ( bitsPerPixel == 8 ) || ( bitsPerPixel == 16 ) )
+				&& ( ( colorMapBitsPerEntry == 15 ) || ( colorMapBitsPerEntry == 16 ) || ( colorMapBitsPerEntry == 24 ) || ( colorMapBitsPerEntry == 32 ) );
+		}
+		else if ( isGray )
+		{
+			isBitDepthValid = ( bitsPerPixel == 8 ) || ( bitsPerPixel == 16 );
+		}
+		else
+		{
+			isBitDepthValid = ( bitsPerPixel == 15 ) || ( bitsPerPixel == 16 ) || ( bitsPerPixel == 24 ) || ( bitsPerPixel == 32 );
+		}
+		if ( !isBitDepthValid )
+		{
+			return ReportError( "The TGA file's bit depth isn't supported", o_errorMessage );
+		}
+	}
+
+	// The color map (if there is one) is converted up front
+	size_t offset = s_headerSize + idSize;
+	std::vector<uint8_t> colorMap;
+	if ( hasColorMap )
+	{
+		const size_t bytesPerEntry = ( colorMapBitsPerEntry + 7 ) / 8;
+		const size_t colorMapSize = colorMapLength * bytesPerEntry;
+		if ( ( offset > i_dataSize ) || ( colorMapSize > ( i_dataSize - offset ) ) )
+		{
+			return ReportError( "The TGA file ends in the middle of its color map", o_errorMessage );
+		}
+		if ( isColorMapped )
+		{
+			colorMap.resize( ( colorMapStart + colorMapLength ) * 4, 0 );
+			for ( size_t i = 0; i < colorMapLength; ++i )
+			{
+				ConvertPixel( i_data + offset + ( i * bytesPerEntry ), colorMapBitsPerEntry, false, &colorMap[( colorMapStart + i ) * 4] );
+			}
+		}
+		offset += colorMapSize;
+	}
+	if ( offset > i_dataSize )
+	{
+		return ReportError( "The TGA file ends before its image data", o_errorMessage );
+	}
+
+	// The pixels are decoded in the order they're stored, and then flipped if the origin isn't the top left
+	const size_t bytesPerPixel = ( bitsPerPixel + 7 ) / 8;
+	const size_t pixelCount = width * height;
+	std::vector<uint8_t> pixels( pixelCount * 4 );
+	{
+		const uint8_t* source = i_data + offset;
+		const uint8_t* const sourceEnd = i_data + i_dataSize;
+		for ( size_t i = 0; i < pixelCount; )
+		{
+			// RLE data is packets of either a repeated pixel or of raw pixels,
+			// and uncompressed data is treated as a single raw packet
+			size_t packetPixelCount = pixelCount - i;
+			bool isRepeated = false;
+			if ( isRle )
+			{
+				if ( source >= sourceEnd )
+				{
+					return ReportError( "The TGA file ends in the middle of its image data", o_errorMessage );
+				}
+				isRepeated = ( *source & 0x80 ) != 0;
+				packetPixelCount = ( *source & 0x7f ) + 1;
+				++source;
+				if ( packetPixelCount > ( pixelCount - i ) )
+				{
+					packetPixelCount = pixelCount - i;
+				}
+			}
+			const size_t packetSize = isRepeated ? bytesPerPixel : ( packetPixelCount * bytesPerPixel );
+			if ( packetSize > static_cast<size_t>( sourceEnd - source ) )
+			{
+				return ReportError( "The TGA file ends in the middle of its image data", o_errorMessage );
+			}
+			for ( size_t j = 0; j < packetPixelCount; ++j, ++i )
+			{
+				const uint8_t* const sourcePixel = isRepeated ? source : ( source + ( j * bytesPerPixel ) );
+				uint8_t* const pixel = &pixels[i * 4];
+				if ( isColorMapped )
+				{
+					const size_t index = ( bytesPerPixel == 1 ) ? sourcePixel[0] : ReadLittleEndian16( sourcePixel );
+					if ( ( index * 4 ) < colorMap.size() )
+					{
+						memcpy( pixel, &colorMap[index * 4], 4 );
+					}
+					else
+					{
+						memset( pixel, 0, 4 );
+						pixel[3] = 0xff;
+					}
+				}
+				else
+				{
+					ConvertPixel( sourcePixel, bitsPerPixel, isGray, pixel );
+				}
+			}
+			source += packetSize;
+		}
+	}
+
+	// Many tools write 32 bit images with an alpha that is all zeros (and say that there are no alpha bits),
+	// and those are treated as opaque
+	bool hasAlpha = ( ( bitsPerPixel == 32 ) || ( bitsPerPixel == 16 ) || ( isColorMapped && ( colorMapBitsPerEntry == 32 ) ) ) && !isGray;
+	if ( hasAlpha )
+	{
+		bool isAlphaAllZero = true;
+		for ( size_t i = 0; isAlphaAllZero && ( i < pixelCount ); ++i )
+		{
+			isAlphaAllZero = pixels[( i * 4 ) + 3] == 0;
+		}
+		if ( isAlphaAllZero || ( ( alphaBitCount == 0 ) && ( bitsPerPixel != 32 ) && !isColorMapped ) )
+		{
+			hasAlpha = false;
+			for ( size_t i = 0; i < pixelCount; ++i )
+			{
+				pixels[( i * 4 ) + 3] = 0xff;
+			}
+		}
+	}
+
+	o_image.width = width;
+	o_image.height = height;
+	o_image.hasAlpha = hasAlpha;
+	o_image.pixels.resize( o_image.GetSlicePitch() );
+	for ( size_t y = 0; y < height; ++y )
+	{
+		const uint8_t* const sourceRow = &pixels[( isTopToBottom ? y : ( height - 1 - y ) ) * width * 4];
+		uint8_t* const row = &o_image.pixels[y * o_image.GetRowPitch()];
+		if ( !isRightToLeft )
+		{
+			memcpy( row, sourceRow, width * 4 );
+		}
+		else
+		{
+			for ( size_t x = 0; x < width; ++x )
+			{
+				memcpy( row + ( x * 4 ), sourceRow + ( ( width - 1 - x ) * 4 ), 4 );
+			}
+		}
+	}
+	return true;
+}
+
+namespace
+{
+	void ConvertPixel( const uint8_t* const i_pixel, const unsigned int i_bitsPerPixel, const bool i_isGray, uint8_t* const o_pixel )
+	{
+		if ( i_isGray )
+		{
+			// 16 bit gray is gray and alpha
+			o_pixel[0] = o_pixel[1] = o_pixel[2] = i_pixel[0];
+			o_pixel[3] = ( i_bitsPerPixel == 16 ) ? i_pixel[1] : 0xff;
+			return;
+		}
+		switch ( i_bitsPerPixel )
+		{
+			case 15:
+			case 16:
+				{
+					// ARRRRRGG GGGBBBBB, with 5 bit channels scaled so that the largest value is white
+					const unsigned int value = ReadLittleEndian16( i_pixel );
+					const unsigned int red = ( value >> 10 ) & 0x1f;
+					const unsigned int green = ( value >> 5 ) & 0x1f;
+					const unsigned int blue = value & 0x1f;
+					o_pixel[0] = static_cast<uint8_t>( ( red << 3 ) | ( red >> 2 ) );
+					o_pixel[1] = static_cast<uint8_t>( ( green << 3 ) | ( green >> 2 ) );
+					o_pixel[2] = static_cast<uint8_t>( ( blue << 3 ) | ( blue >> 2 ) );
+					o_pixel[3] = ( ( i_bitsPerPixel == 15 ) || ( ( value & 0x8000 ) != 0 ) ) ? 0xff : 0;
+				}
+				break;
+			case 24:
+				o_pixel[0] = i_pixel[2];
+				o_pixel[1] = i_pixel[1];
+				o_pixel[2] = i_pixel[0];
+				o_pixel[3] = 0xff;
+				break;
+			case 32:
+				o_pixel[0] = i_pixel[2];
+				o_pixel[1] = i_pixel[1];
+				o_pixel[2] = i_pixel[0];
+				o_pixel[3] = i_pixel[3];
+				break;
+		}
+	}
+}
@@ -0,0 +1,238 @@
+// Compares the speed of the in-tree image decoders against WIC (or DirectXTex's TGA loader),
+// which is what TextureBuilder used to load every source image with,
+// and reports the largest difference between the pixels that each one decodes.
+// Files are read into memory first so that only decoding is timed, and everything runs on a single thread.
+// Without arguments every image in $(AuthoredAssetDir)Textures is used.
+// Usage: ImageDecodingBenchmark [imagePath...]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../../External/DirectXTex/Includes.h"
+#include "../ImageDecoding/ImageDecoding.h"
+
+namespace
+{
+	// Each decoder is run this many times and the fastest time is used
+	const unsigned int s_repetitionCount = 5;
+
+	bool FindTextures( std::vector<std::string>& o_paths );
+	bool ReadImageFile( const char* const i_path, std::vector<uint8_t>& o_data );
+	double DecodeWithImageDecoding( const std::vector<uint8_t>& i_data, const Engine::AssetBuild::ImageDecoding::eFileType i_fileType,
+		Engine::AssetBuild::ImageDecoding::sImage& o_image, std::string& o_errorMessage );
+	double DecodeWithWic( const std::vector<uint8_t>& i_data, const Engine::AssetBuild::ImageDecoding::eFileType i_fileType,
+		DirectX::ScratchImage& o_image );
+	unsigned int GetMaxDifference( const Engine::AssetBuild::ImageDecoding::sImage& i_image, const DirectX::ScratchImage& i_wicImage );
+}
+
+int main( int i_argumentCount, char** i_arguments )
+{
+	if ( FAILED( CoInitialize( NULL ) ) )
+	{
+		fprintf( stderr, "COM couldn't be initialized\n" );
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::string> paths;
+	if ( i_argumentCount > 1 )
+	{
+		paths.assign( i_arguments + 1, i_arguments + i_argumentCount );
+	}
+	else if ( !FindTextures( paths ) )
+	{
+		CoUninitialize();
+		return EXIT_FAILURE;
+	}
+
+	bool wereThereErrors = false;
+	double totalMegapixelCount = 0.0, totalSeconds_imageDecoding = 0.0, totalSeconds_wic = 0.0;
+	for ( size_t i = 0; i < paths.size(); ++i )
+	{
+		const char* const path = paths[i].c_str();
+		std::vector<uint8_t> data;
+		if ( !ReadImageFile( path, data ) )
+		{
+			fprintf( stderr, "%s couldn't be read\n", path );
+			wereThereErrors = true;
+			continue;
+		}
+		const Engine::AssetBuild::ImageDecoding::eFileType fileType =
+			Engine::AssetBuild::ImageDecoding::DetectFileType( data.data(), data.size(), path );
+		if ( fileType == Engine::AssetBuild::ImageDecoding::Unknown )
+		{
+			// Other files (like DDS textures) are skipped
+			continue;
+		}
+
+		Engine::AssetBuild::ImageDecoding::sImage image;
+		std::string errorMessage;
+		const double seconds_imageDecoding = DecodeWithImageDecoding( data, fileType, image, errorMessage );
+		if ( seconds_imageDecoding < 0.0 )
+		{
+			fprintf( stderr, "%s couldn't be decoded: %s\n", path, errorMessage.c_str() );
+			wereThereErrors = true;
+			continue;
+		}
+		DirectX::ScratchImage wicImage;
+		const double seconds_wic = DecodeWithWic( data, fileType, wicImage );
+		if ( seconds_wic < 0.0 )
+		{
+			fprintf( stderr, "WIC couldn't decode %s\n", path );
+			wereThereErrors = true;
+			continue;
+		}
+		const unsigned int maxDifference = GetMaxDifference( image, wicImage );
+		if ( maxDifference > 255 )
+		{
+			fprintf( stderr, "%s was decoded with different dimensions by WIC\n", path );
+			wereThereErrors = true;
+			continue;
+		}
+
+		const double megapixelCount = static_cast<double>( image.width * image.height ) / 1.0e6;
+		printf( "%s (%u x %u):\n", path, static_cast<unsigned int>( image.width ), static_cast<unsigned int>( image.height ) );
+		printf( "  WIC:            %8.2f MP/s\n", megapixelCount / seconds_wic );
+		printf( "  ImageDecoding:  %8.2f MP/s, %.1fx faster, largest difference %u\n",
+			megapixelCount / seconds_imageDecoding, seconds_wic / seconds_imageDecoding, maxDifference );
+		totalMegapixelCount += megapixelCount;
+		totalSeconds_imageDecoding += seconds_imageDecoding;
+		totalSeconds_wic += seconds_wic;
+	}
+	if ( totalMegapixelCount > 0.0 )
+	{
+		printf( "Overall: WIC %.2f MP/s, ImageDecoding %.2f MP/s (%.1fx faster)\n", totalMegapixelCount / totalSeconds_wic,
+			totalMegapixelCount / totalSeconds_imageDecoding, totalSeconds_wic / totalSeconds_imageDecoding );
+	}
+
+	CoUninitialize();
+	return wereThereErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+namespace
+{
+	bool FindTextures( std::vector<std::string>& o_paths )
+	{
+		char assetDirectory[MAX_PATH];
+		{
+			const DWORD characterCount = GetEnvironmentVariableA( "AuthoredAssetDir", assetDirectory, MAX_PATH );
+			if ( ( characterCount == 0 ) || ( characterCount >= MAX_PATH ) )
+			{
+				fprintf( stderr, "Either give the images to decode as arguments or set the AuthoredAssetDir environment variable\n" );
+				return false;
+			}
+		}
+		const std::string textureDirectory = std::string( assetDirectory ) + "Textures\\";
+		WIN32_FIND_DATAA findData;
+		const HANDLE findHandle = FindFirstFileA( ( textureDirectory + "*" ).c_str(), &findData );
+		if ( findHandle == INVALID_HANDLE_VALUE )
+		{
+			fprintf( stderr, "%s couldn't be searched for images\n", textureDirectory.c_str() );
+			return false;
+		}
+		do
+		{
+			if ( ( findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) == 0 )
+			{
+				o_paths.push_back( textureDirectory + findData.cFileName );
+			}
+		} while ( FindNextFileA( findHandle, &findData ) );
+		FindClose( findHandle );
+		return true;
+	}
+
+	bool ReadImageFile( const char* const i_path, std::vector<uint8_t>& o_data )
+	{
+		FILE* const file = fopen( i_path, "rb" );
+		if ( !file )
+		{
+			return false;
+		}
+		bool wasReadSuccessful = false;
+		if ( fseek( file, 0, SEEK_END ) == 0 )
+		{
+			const long fileSize = ftell( file );
+			if ( ( fileSize > 0 ) && ( fseek( file, 0, SEEK_SET ) == 0 ) )
+			{
+				o_data.resize( static_cast<size_t>( fileSize ) );
+				wasReadSuccessful = fread( o_data.data(), 1, o_data.size(), file ) == o_data.size();
+			}
+		}
+		fclose( file );
+		return wasReadSuccessful;
+	}
+
+	double DecodeWithImageDecoding( const std::vector<uint8_t>& i_data, const Engine::AssetBuild::ImageDecoding::eFileType i_fileType,
+		Engine::AssetBuild::ImageDecoding::sImage& o_image, std::string& o_errorMessage )
+	{
+		double fastestSeconds = -1.0;
+		for ( unsigned int i = 0; i < s_repetitionCount; ++i )
+		{
+			const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+			if ( !Engine::AssetBuild::ImageDecoding::Decode( i_fileType, i_data.data(), i_data.size(), o_image, &o_errorMessage ) )
+			{
+				return -1.0;
+			}
+			const double seconds = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+			fastestSeconds = ( ( fastestSeconds < 0.0 ) || ( seconds < fastestSeconds ) ) ? seconds : fastestSeconds;
+		}
+		return fastestSeconds;
+	}
+
+	double DecodeWithWic( const std::vector<uint8_t>& i_data, const Engine::AssetBuild::ImageDecoding::eFileType i_fileType,
+		DirectX::ScratchImage& o_image )
+	{
+		double fastestSeconds = -1.0;
+		for ( unsigned int i = 0; i < s_repetitionCount; ++i )
+		{
+			// The ScratchImage is released before timing so that freeing the previous image isn't included
+			o_image.Release();
+			const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+			const HRESULT result = ( i_fileType == Engine::AssetBuild::ImageDecoding::Tga ) ?
+				DirectX::LoadFromTGAMemory( i_data.data(), i_data.size(), NULL, o_image ) :
+				DirectX::LoadFromWICMemory( i_data.data(), i_data.size(), DirectX::WIC_FLAGS_IGNORE_SRGB, NULL, o_image );
+			if ( FAILED( result ) )
+			{
+				return -1.0;
+			}
+			const double seconds = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+			fastestSeconds = ( ( fastestSeconds < 0.0 ) || ( seconds < fastestSeconds ) ) ? seconds : fastestSeconds;
+		}
+		return fastestSeconds;
+	}
+
+	unsigned int GetMaxDifference( const Engine::AssetBuild::ImageDecoding::sImage& i_image, const DirectX::ScratchImage& i_wicImage )
+	{
+		// WIC decodes to whichever format is closest to the file's, and so its pixels are converted to 8 bit RGBA to compare them
+		const DirectX::Image& wicImage = *i_wicImage.GetImage( 0, 0, 0 );
+		if ( ( wicImage.width != i_image.width ) || ( wicImage.height != i_image.height ) )
+		{
+			return 256;
+		}
+		DirectX::ScratchImage convertedImage;
+		const DirectX::Image* comparedImage = &wicImage;
+		if ( wicImage.format != DXGI_FORMAT_R8G8B8A8_UNORM )
+		{
+			if ( FAILED( DirectX::Convert( wicImage, DXGI_FORMAT_R8G8B8A8_UNORM, DirectX::TEX_FILTER_DEFAULT, DirectX::TEX_THRESHOLD_DEFAULT,
+				convertedImage ) ) )
+			{
+				return 256;
+			}
+			comparedImage = convertedImage.GetImage( 0, 0, 0 );
+		}
+		unsigned int maxDifference = 0;
+		for ( size_t y = 0; y < i_image.height; ++y )
+		{
+			const uint8_t* const row = &i_image.pixels[y * i_image.GetRowPitch()];
+			const uint8_t* const wicRow = comparedImage->pixels + ( y * comparedImage->rowPitch );
+			for ( size_t x = 0; x < i_image.GetRowPitch(); ++x )
+			{
+				const unsigned int difference = ( row[x] > wicRow[x] ) ? ( row[x] - wicRow[x] ) : ( wicRow[x] - row[x] );
+				maxDifference = ( difference > maxDifference ) ? difference : maxDifference;
+			}
+		}
+		return maxDifference;
+	}
+}
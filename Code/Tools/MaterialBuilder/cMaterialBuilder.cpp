@@ -155,7 +155,12 @@ namespace
 				std::string texpath = "";
 				std::string errormsg = " ";
 
-				Engine::AssetBuild::ConvertSourceRelativePathToBuiltRelativePath(value, "textures", texpath, &errormsg);
+				// A texture array is built into a single texture too, which the material binds in the same way
+				const std::string sourcepath(value);
+				const std::string arrayextension = ".texarray";
+				const bool isarray = (sourcepath.size() > arrayextension.size())
+					&& (sourcepath.compare(sourcepath.size() - arrayextension.size(), arrayextension.size(), arrayextension) == 0);
+				Engine::AssetBuild::ConvertSourceRelativePathToBuiltRelativePath(value, isarray ? "texturearrays" : "textures", texpath, &errormsg);
 
 				texpath = "data/" + texpath + "\0";
 
@@ -19,9 +19,12 @@
 #include <maya/MPoint.h>
 #include <maya/MPointArray.h>
 #include <maya/MSelectionList.h>
-#include <sstream>
+#include <numeric>
 #include <string>
 #include <vector>
+#include "../AssetBuildLibrary/Parallel.h"
+#include "../MeshBuilder/MeshSourceFormat.h"
+#include "../VertexWelding/cVertexWelder.h"
 
 namespace
 {
@@ -34,17 +37,17 @@ namespace
 		float u, v;
 		float r, g, b, a;
 
-		sVertex_maya( const MPoint& i_position, const MFloatVector& i_normal,
-			const MFloatVector& i_tangent, const MFloatVector& i_bitangent,
+		sVertex_maya( const float* const i_position, const float* const i_normal,
+			const float* const i_tangent, const float* const i_bitangent,
 			const float i_texcoordU, const float i_texcoordV,
-			const MColor& i_vertexColor )
+			const float* const i_vertexColor )
 			:
-			x( static_cast<float>( i_position.x ) ), y( static_cast<float>( i_position.y ) ), z( static_cast<float>( i_position.z ) ),
-			nx( i_normal.x ), ny( i_normal.y ), nz( i_normal.z ),
-			tx( i_tangent.x ), ty( i_tangent.y ), tz( i_tangent.z ),
-			btx( i_bitangent.x ), bty( i_bitangent.y ), btz( i_bitangent.z ),
+			x( i_position[0] ), y( i_position[1] ), z( i_position[2] ),
+			nx( i_normal[0] ), ny( i_normal[1] ), nz( i_normal[2] ),
+			tx( i_tangent[0] ), ty( i_tangent[1] ), tz( i_tangent[2] ),
+			btx( i_bitangent[0] ), bty( i_bitangent[1] ), btz( i_bitangent[2] ),
 			u( i_texcoordU ), v( i_texcoordV ),
-			r( i_vertexColor.r ), g( i_vertexColor.g ), b( i_vertexColor.b ), a( i_vertexColor.a )
+			r( i_vertexColor[0] ), g( i_vertexColor[1] ), b( i_vertexColor[2] ), a( i_vertexColor[3] )
 		{
 
 		}
@@ -54,18 +57,15 @@ namespace
 	{
 		sVertex_maya vertex;
 		size_t shadingGroup;
-		const std::string uniqueKey;
 
-		sVertexInfo( const MPoint& i_position, const MFloatVector& i_normal,
-			const MFloatVector& i_tangent, const MFloatVector& i_bitangent,
+		sVertexInfo( const float* const i_position, const float* const i_normal,
+			const float* const i_tangent, const float* const i_bitangent,
 			const float i_texcoordU, const float i_texcoordV,
-			const MColor& i_vertexColor,
-			const size_t i_shadingGroup,
-			const std::string& i_uniqueKey )
+			const float* const i_vertexColor,
+			const size_t i_shadingGroup )
 			:
 			vertex( i_position, i_normal, i_tangent, i_bitangent, i_texcoordU, i_texcoordV, i_vertexColor ),
-			shadingGroup( i_shadingGroup ),
-			uniqueKey( i_uniqueKey )
+			shadingGroup( i_shadingGroup )
 		{
 
 		}
@@ -76,9 +76,23 @@ namespace
 {
 	const size_t s_vertexCountPerTriangle = 3;
 
+	// A vertex is unique if any of these are different
+	// (the shading group is first so that sorting the keys groups the vertices by material)
+	enum eVertexKey
+	{
+		VERTEXKEY_SHADINGGROUP,
+		VERTEXKEY_DAGNODE,
+		VERTEXKEY_POSITION,
+		VERTEXKEY_NORMAL,
+		VERTEXKEY_TANGENT,
+		VERTEXKEY_TEXCOORD,
+		VERTEXKEY_VERTEXCOLOR,
+		VERTEXKEY_COUNT
+	};
+
 	struct sTriangle
 	{
-		std::string vertexKeys[s_vertexCountPerTriangle];
+		uint32_t vertexIndices[s_vertexCountPerTriangle];
 		size_t shadingGroup;
 
 		static bool CompareTriangles( const sTriangle& i_lhs, const sTriangle& i_rhs )
@@ -91,9 +105,9 @@ namespace
 			{
 				for ( size_t i = 0; i < s_vertexCountPerTriangle; ++i )
 				{
-					if ( i_lhs.vertexKeys[i] != i_rhs.vertexKeys[i] )
+					if ( i_lhs.vertexIndices[i] != i_rhs.vertexIndices[i] )
 					{
-						return i_lhs.vertexKeys[i] < i_rhs.vertexKeys[i];
+						return i_lhs.vertexIndices[i] < i_rhs.vertexIndices[i];
 					}
 				}
 			}
@@ -101,6 +115,27 @@ namespace
 		}
 	};
 
+	// Everything that the exporter needs from a single mesh DAG node.
+	// It is copied out of Maya on the main thread (the Maya API isn't thread-safe)
+	// and then each node's corners are welded on a worker thread
+	struct sDagNodeMesh
+	{
+		std::vector<float> positions;	// xyz
+		std::vector<float> normals;	// xyz
+		std::vector<float> tangents;	// xyz
+		std::vector<float> bitangents;	// xyz
+		std::vector<float> texcoordUs, texcoordVs;
+		std::vector<float> vertexColors;	// rgba
+		// VERTEXKEY_COUNT integers for every corner of every polygon
+		std::vector<uint32_t> cornerKeys;
+		// Until the corners are welded the triangles' vertex indices are corner indices
+		std::vector<sTriangle> triangles;
+
+		// The results of welding
+		std::vector<sVertexInfo> uniqueVertices;
+		std::vector<uint32_t> uniqueVertexKeys;
+	};
+
 	struct sMaterialInfo
 	{
 		MString nodeName;
@@ -123,33 +158,35 @@ namespace
 
 namespace
 {
-	std::string CreateUniqueVertexKey( const int i_positionIndex, const int i_normalIndex, const int i_tangentIndex,
-		const int i_texcoordIndex, const int i_vertexColorIndex, const size_t i_shadingGroupIndex, const char* i_transformName );
-	MStatus FillVertexAndIndexBuffer( const std::map<std::string, sVertexInfo>& i_uniqueVertices, const std::vector<MObject>& i_shadingGroups,
-		std::vector<sTriangle>& io_triangles,
+	template<class tVectorArray> void CopyVectors( const tVectorArray& i_vectors, std::vector<float>& o_floats );
+	MStatus FillVertexAndIndexBuffer( const std::vector<uint32_t>& i_uniqueVertexKeys, const std::vector<sVertexInfo>& i_uniqueVertices,
+		const std::vector<MObject>& i_shadingGroups, std::vector<sTriangle>& io_triangles,
 		std::vector<sVertexInfo>& o_vertexBuffer, std::vector<size_t>& o_indexBuffer,
 		std::vector<sMaterialInfo>& o_materialInfo );
-	MStatus ProcessAllMeshes( std::map<std::string, sVertexInfo>& o_uniqueVertices, std::vector<sTriangle>& o_triangles,
-		std::vector<MObject>& o_shadingGroups );
-	MStatus ProcessSelectedMeshes( std::map<std::string, sVertexInfo>& o_uniqueVertices, std::vector<sTriangle>& o_triangles,
-		std::vector<MObject>& o_shadingGroups );
-	MStatus ProcessSingleDagNode( const MDagPath& i_dagPath,
-		std::map<std::string, sVertexInfo>& io_uniqueVertices, std::vector<sTriangle>& io_triangles,
+	void MergeDagNodeMeshes( std::vector<sDagNodeMesh>& io_dagNodeMeshes,
+		std::vector<sVertexInfo>& o_uniqueVertices, std::vector<uint32_t>& o_uniqueVertexKeys, std::vector<sTriangle>& o_triangles );
+	MStatus ProcessAllMeshes( std::vector<sDagNodeMesh>& o_dagNodeMeshes, std::vector<MObject>& o_shadingGroups );
+	MStatus ProcessSelectedMeshes( std::vector<sDagNodeMesh>& o_dagNodeMeshes, std::vector<MObject>& o_shadingGroups );
+	MStatus ProcessSingleDagNode( const MDagPath& i_dagPath, const uint32_t i_dagNodeIndex, sDagNodeMesh& o_dagNodeMesh,
 		std::vector<MObject>& io_shadingGroups, std::map<std::string, size_t>& io_map_shadingGroupNamesToIndices );
+	void WeldDagNodeMesh( sDagNodeMesh& io_dagNodeMesh );
 	MStatus WriteMeshToFile( const MString& i_fileName, const std::vector<sVertexInfo>& i_vertexBuffer, const std::vector<size_t>& i_indexBuffer,
 		const std::vector<sMaterialInfo>& i_materialInfo );
+	MStatus WriteMeshToLuaFile( const MString& i_fileName, const std::vector<sVertexInfo>& i_vertexBuffer, const std::vector<size_t>& i_indexBuffer,
+		const std::vector<sMaterialInfo>& i_materialInfo );
+	MStatus WriteMeshToBinaryFile( const MString& i_fileName, const std::vector<sVertexInfo>& i_vertexBuffer, const std::vector<size_t>& i_indexBuffer,
+		const std::vector<sMaterialInfo>& i_materialInfo );
 }
 
 MStatus Engine::cMayaMeshExporter::writer( const MFileObject& i_file, const MString& i_options, FileAccessMode i_mode )
 {
 	MStatus status;
-	std::map<std::string, sVertexInfo> uniqueVertices;
-	std::vector<sTriangle> triangles;
+	std::vector<sDagNodeMesh> dagNodeMeshes;
 	std::vector<MObject> shadingGroups;
 	{
 		if ( i_mode == MPxFileTranslator::kExportAccessMode )
 		{
-			status = ProcessAllMeshes( uniqueVertices, triangles, shadingGroups );
+			status = ProcessAllMeshes( dagNodeMeshes, shadingGroups );
 			if ( !status )
 			{
 				return status;
@@ -157,7 +194,7 @@ MStatus Engine::cMayaMeshExporter::writer( const MFileObject& i_file, const MStr
 		}
 		else if ( i_mode == MPxFileTranslator::kExportActiveAccessMode )
 		{
-			status = ProcessSelectedMeshes( uniqueVertices, triangles, shadingGroups );
+			status = ProcessSelectedMeshes( dagNodeMeshes, shadingGroups );
 			if ( !status )
 			{
 				return status;
@@ -170,11 +207,23 @@ MStatus Engine::cMayaMeshExporter::writer( const MFileObject& i_file, const MStr
 		}
 	}
 
+	// The DAG node is part of every vertex's key, and so vertices from different nodes are never welded together
+	// and each node can be welded independently.
+	// The nodes are then merged in the order that they were found, which (because the vertices are sorted by key afterwards)
+	// makes the output the same as if everything had been welded on one thread
+	std::vector<sVertexInfo> uniqueVertices;
+	std::vector<uint32_t> uniqueVertexKeys;
+	std::vector<sTriangle> triangles;
+	{
+		Engine::AssetBuild::ParallelFor( dagNodeMeshes.size(), [&dagNodeMeshes]( const size_t i_index ) { WeldDagNodeMesh( dagNodeMeshes[i_index] ); } );
+		MergeDagNodeMeshes( dagNodeMeshes, uniqueVertices, uniqueVertexKeys, triangles );
+	}
+
 	std::vector<sVertexInfo> vertexBuffer;
 	std::vector<size_t> indexBuffer;
 	std::vector<sMaterialInfo> materialInfo;
 	{
-		status = FillVertexAndIndexBuffer( uniqueVertices, shadingGroups, triangles, vertexBuffer, indexBuffer, materialInfo );
+		status = FillVertexAndIndexBuffer( uniqueVertexKeys, uniqueVertices, shadingGroups, triangles, vertexBuffer, indexBuffer, materialInfo );
 		if ( !status )
 		{
 			return status;
@@ -189,21 +238,20 @@ MStatus Engine::cMayaMeshExporter::writer( const MFileObject& i_file, const MStr
 
 namespace
 {
-	std::string CreateUniqueVertexKey( const int i_positionIndex, const int i_normalIndex, const int i_tangentIndex,
-		const int i_texcoordIndex, const int i_vertexColorIndex, const size_t i_shadingGroupIndex, const char* i_transformName )
+	template<class tVectorArray> void CopyVectors( const tVectorArray& i_vectors, std::vector<float>& o_floats )
 	{
-		std::ostringstream vertexKey;
-		vertexKey << i_positionIndex << "_" << i_normalIndex << "_" << i_tangentIndex
-			<< "_" << i_texcoordIndex << "_" << i_vertexColorIndex << "_" << i_shadingGroupIndex;
-		if ( i_transformName )
+		const unsigned int vectorCount = i_vectors.length();
+		o_floats.resize( static_cast<size_t>( vectorCount ) * 3 );
+		for ( unsigned int i = 0; i < vectorCount; ++i )
 		{
-			vertexKey << "_" << i_transformName;
+			o_floats[( i * 3 ) + 0] = static_cast<float>( i_vectors[i].x );
+			o_floats[( i * 3 ) + 1] = static_cast<float>( i_vectors[i].y );
+			o_floats[( i * 3 ) + 2] = static_cast<float>( i_vectors[i].z );
 		}
-		return vertexKey.str();
 	}
 
-	MStatus FillVertexAndIndexBuffer( const std::map<std::string, sVertexInfo>& i_uniqueVertices, const std::vector<MObject>& i_shadingGroups,
-		std::vector<sTriangle>& io_triangles,
+	MStatus FillVertexAndIndexBuffer( const std::vector<uint32_t>& i_uniqueVertexKeys, const std::vector<sVertexInfo>& i_uniqueVertices,
+		const std::vector<MObject>& i_shadingGroups, std::vector<sTriangle>& io_triangles,
 		std::vector<sVertexInfo>& o_vertexBuffer, std::vector<size_t>& o_indexBuffer,
 		std::vector<sMaterialInfo>& o_materialInfo )
 	{
@@ -252,34 +300,32 @@ namespace
 			}
 		}
 
-		std::map<std::string, size_t> vertexKeyToIndexMap;
+		// The vertices are sorted by their keys (which groups them by shading group)
+		// so that the output doesn't depend on the order that the corners were welded in
+		std::vector<uint32_t> weldedIndicesToVertexIndices( i_uniqueVertices.size() );
 		{
 			struct CompareVertices
 			{
-				bool operator()( const sVertexInfo& i_lhs, const sVertexInfo& i_rhs )
+				const uint32_t* keys;
+
+				CompareVertices( const uint32_t* const i_keys ) : keys( i_keys ) {}
+				bool operator()( const uint32_t i_lhs, const uint32_t i_rhs ) const
 				{
-					if ( i_lhs.shadingGroup != i_rhs.shadingGroup )
-					{
-						return i_lhs.shadingGroup < i_rhs.shadingGroup;
-					}
-					else
-					{
-						return i_lhs.uniqueKey < i_rhs.uniqueKey;
-					}
+					const uint32_t* const lhs = keys + ( i_lhs * VERTEXKEY_COUNT );
+					const uint32_t* const rhs = keys + ( i_rhs * VERTEXKEY_COUNT );
+					return std::lexicographical_compare( lhs, lhs + VERTEXKEY_COUNT, rhs, rhs + VERTEXKEY_COUNT );
 				}
 			};
-			std::map<sVertexInfo, std::string, CompareVertices> sortedVertices;
-			for ( std::map<std::string, sVertexInfo>::const_iterator i = i_uniqueVertices.begin(); i != i_uniqueVertices.end(); ++i )
-			{
-				sortedVertices.insert( std::make_pair( i->second, i->first ) );
-			}
-			
-			size_t vertexIndex = 0;
-			for ( std::map<sVertexInfo, std::string>::iterator i = sortedVertices.begin(); i != sortedVertices.end(); ++i, ++vertexIndex )
+			std::vector<uint32_t> sortedVertices( i_uniqueVertices.size() );
+			std::iota( sortedVertices.begin(), sortedVertices.end(), 0 );
+			std::sort( sortedVertices.begin(), sortedVertices.end(), CompareVertices( i_uniqueVertexKeys.data() ) );
+
+			o_vertexBuffer.reserve( sortedVertices.size() );
+			for ( size_t vertexIndex = 0; vertexIndex < sortedVertices.size(); ++vertexIndex )
 			{
-				const sVertexInfo& vertex = i->first;
+				const sVertexInfo& vertex = i_uniqueVertices[sortedVertices[vertexIndex]];
 				o_vertexBuffer.push_back( vertex );
-				vertexKeyToIndexMap.insert( std::make_pair( i->second, vertexIndex ) );
+				weldedIndicesToVertexIndices[sortedVertices[vertexIndex]] = static_cast<uint32_t>( vertexIndex );
 				if ( vertex.shadingGroup < o_materialInfo.size() )
 				{
 					sMaterialInfo& materialInfo = o_materialInfo[vertex.shadingGroup];
@@ -290,6 +336,13 @@ namespace
 		}
 
 		{
+			for ( std::vector<sTriangle>::iterator i = io_triangles.begin(); i != io_triangles.end(); ++i )
+			{
+				for ( size_t j = 0; j < s_vertexCountPerTriangle; ++j )
+				{
+					i->vertexIndices[j] = weldedIndicesToVertexIndices[i->vertexIndices[j]];
+				}
+			}
 			std::sort( io_triangles.begin(), io_triangles.end(), sTriangle::CompareTriangles );
 			const size_t triangleCount = io_triangles.size();
 			const size_t indexCount = triangleCount * s_vertexCountPerTriangle;
@@ -299,10 +352,8 @@ namespace
 				const sTriangle& triangle = io_triangles[i];
 				for ( size_t j = 0; j < s_vertexCountPerTriangle; ++j )
 				{
-					const std::string& vertexKey = triangle.vertexKeys[j];
-					const size_t triangleIndex = vertexKeyToIndexMap.find( vertexKey )->second;
 					const size_t indexBufferIndex = ( i * s_vertexCountPerTriangle ) + j;
-					o_indexBuffer[indexBufferIndex] = triangleIndex;
+					o_indexBuffer[indexBufferIndex] = triangle.vertexIndices[j];
 					if ( triangle.shadingGroup < o_materialInfo.size() )
 					{
 						sMaterialInfo& materialInfo = o_materialInfo[triangle.shadingGroup];
@@ -316,15 +367,38 @@ namespace
 		return MStatus::kSuccess;
 	}
 
-	MStatus ProcessAllMeshes( std::map<std::string, sVertexInfo>& o_uniqueVertices, std::vector<sTriangle>& o_triangles,
-		std::vector<MObject>& o_shadingGroups )
+	void MergeDagNodeMeshes( std::vector<sDagNodeMesh>& io_dagNodeMeshes,
+		std::vector<sVertexInfo>& o_uniqueVertices, std::vector<uint32_t>& o_uniqueVertexKeys, std::vector<sTriangle>& o_triangles )
+	{
+		for ( std::vector<sDagNodeMesh>::iterator i = io_dagNodeMeshes.begin(); i != io_dagNodeMeshes.end(); ++i )
+		{
+			const uint32_t vertexOffset = static_cast<uint32_t>( o_uniqueVertices.size() );
+			o_uniqueVertices.insert( o_uniqueVertices.end(), i->uniqueVertices.begin(), i->uniqueVertices.end() );
+			o_uniqueVertexKeys.insert( o_uniqueVertexKeys.end(), i->uniqueVertexKeys.begin(), i->uniqueVertexKeys.end() );
+			for ( std::vector<sTriangle>::const_iterator j = i->triangles.begin(); j != i->triangles.end(); ++j )
+			{
+				sTriangle triangle = *j;
+				for ( size_t k = 0; k < s_vertexCountPerTriangle; ++k )
+				{
+					triangle.vertexIndices[k] += vertexOffset;
+				}
+				o_triangles.push_back( triangle );
+			}
+			// Each node's data isn't needed once it has been merged
+			*i = sDagNodeMesh();
+		}
+	}
+
+	MStatus ProcessAllMeshes( std::vector<sDagNodeMesh>& o_dagNodeMeshes, std::vector<MObject>& o_shadingGroups )
 	{
 		std::map<std::string, size_t> map_shadingGroupNamesToIndices;
-		for ( MItDag i( MItDag::kDepthFirst, MFn::kMesh ); !i.isDone(); i.next() )
+		uint32_t dagNodeIndex = 0;
+		for ( MItDag i( MItDag::kDepthFirst, MFn::kMesh ); !i.isDone(); i.next(), ++dagNodeIndex )
 		{
 			MDagPath dagPath;
 			i.getPath( dagPath );
-			if ( !ProcessSingleDagNode( dagPath, o_uniqueVertices, o_triangles, o_shadingGroups, map_shadingGroupNamesToIndices ) )
+			o_dagNodeMeshes.push_back( sDagNodeMesh() );
+			if ( !ProcessSingleDagNode( dagPath, dagNodeIndex, o_dagNodeMeshes.back(), o_shadingGroups, map_shadingGroupNamesToIndices ) )
 			{
 				return MStatus::kFailure;
 			}
@@ -333,19 +407,20 @@ namespace
 		return MStatus::kSuccess;
 	}
 
-	MStatus ProcessSelectedMeshes( std::map<std::string, sVertexInfo>& o_uniqueVertices, std::vector<sTriangle>& o_triangles,
-		std::vector<MObject>& o_shadingGroups )
+	MStatus ProcessSelectedMeshes( std::vector<sDagNodeMesh>& o_dagNodeMeshes, std::vector<MObject>& o_shadingGroups )
 	{
 		MSelectionList selectionList;
 		MStatus status = MGlobal::getActiveSelectionList( selectionList );
 		if ( status )
 		{
 			std::map<std::string, size_t> map_shadingGroupNamesToIndices;
-			for ( MItSelectionList i( selectionList, MFn::kMesh ); !i.isDone(); i.next() )
+			uint32_t dagNodeIndex = 0;
+			for ( MItSelectionList i( selectionList, MFn::kMesh ); !i.isDone(); i.next(), ++dagNodeIndex )
 			{
 				MDagPath dagPath;
 				i.getDagPath( dagPath );
-				if ( !ProcessSingleDagNode( dagPath, o_uniqueVertices, o_triangles, o_shadingGroups, map_shadingGroupNamesToIndices ) )
+				o_dagNodeMeshes.push_back( sDagNodeMesh() );
+				if ( !ProcessSingleDagNode( dagPath, dagNodeIndex, o_dagNodeMeshes.back(), o_shadingGroups, map_shadingGroupNamesToIndices ) )
 				{
 					return MStatus::kFailure;
 				}
@@ -360,8 +435,7 @@ namespace
 		return MStatus::kSuccess;
 	}
 
-	MStatus ProcessSingleDagNode( const MDagPath& i_dagPath,
-		std::map<std::string, sVertexInfo>& io_uniqueVertices, std::vector<sTriangle>& io_triangles,
+	MStatus ProcessSingleDagNode( const MDagPath& i_dagPath, const uint32_t i_dagNodeIndex, sDagNodeMesh& o_dagNodeMesh,
 		std::vector<MObject>& io_shadingGroups, std::map<std::string, size_t>& io_map_shadingGroupNamesToIndices )
 	{
 		MStatus status;
@@ -379,6 +453,7 @@ namespace
 				MGlobal::displayError( status.errorString() );
 				return status;
 			}
+			CopyVectors( positions, o_dagNodeMesh.positions );
 		}
 
 		MFloatVectorArray normals;
@@ -389,6 +464,7 @@ namespace
 				MGlobal::displayError( status.errorString() );
 				return status;
 			}
+			CopyVectors( normals, o_dagNodeMesh.normals );
 		}
 
 		MFloatVectorArray tangents;
@@ -399,6 +475,7 @@ namespace
 				MGlobal::displayError( status.errorString() );
 				return status;
 			}
+			CopyVectors( tangents, o_dagNodeMesh.tangents );
 		}
 
 		MFloatVectorArray bitangents;
@@ -409,6 +486,7 @@ namespace
 				MGlobal::displayError( status.errorString() );
 				return status;
 			}
+			CopyVectors( bitangents, o_dagNodeMesh.bitangents );
 		}
 
 		MFloatArray texcoordUs, texcoordVs;
@@ -419,6 +497,16 @@ namespace
 				MGlobal::displayError( status.errorString() );
 				return status;
 			}
+			o_dagNodeMesh.texcoordUs.resize( texcoordUs.length() );
+			o_dagNodeMesh.texcoordVs.resize( texcoordVs.length() );
+			for ( unsigned int i = 0; i < texcoordUs.length(); ++i )
+			{
+				o_dagNodeMesh.texcoordUs[i] = texcoordUs[i];
+			}
+			for ( unsigned int i = 0; i < texcoordVs.length(); ++i )
+			{
+				o_dagNodeMesh.texcoordVs[i] = texcoordVs[i];
+			}
 		}
 
 		MColorArray vertexColors;
@@ -434,6 +522,14 @@ namespace
 					MGlobal::displayError( status.errorString() );
 					return status;
 				}
+				o_dagNodeMesh.vertexColors.resize( static_cast<size_t>( vertexColors.length() ) * 4 );
+				for ( unsigned int i = 0; i < vertexColors.length(); ++i )
+				{
+					o_dagNodeMesh.vertexColors[( i * 4 ) + 0] = vertexColors[i].r;
+					o_dagNodeMesh.vertexColors[( i * 4 ) + 1] = vertexColors[i].g;
+					o_dagNodeMesh.vertexColors[( i * 4 ) + 2] = vertexColors[i].b;
+					o_dagNodeMesh.vertexColors[( i * 4 ) + 3] = vertexColors[i].a;
+				}
 			}
 		}
 
@@ -514,11 +610,6 @@ namespace
 		}
 
 		{
-			const char* transformName = NULL;
-			{
-				transformName = MFnDependencyNode( mesh.parent( instanceId ) ).name().asChar();
-			}
-
 			MPointArray trianglePositions;
 			MIntArray positionIndices;
 			size_t polygonIndex = 0;
@@ -527,7 +618,8 @@ namespace
 				if ( i.hasValidTriangulation() )
 				{
 					const size_t shadingGroup = polygonShadingGroupIndices[polygonIndex];
-					std::map<int, const std::string> indexToKeyMap;
+					// Polygons only have a few vertices, and so they are searched linearly
+					std::vector<std::pair<int, uint32_t> > positionIndicesToCornerIndices;
 					{
 						MIntArray vertices;
 						status = i.getVertices( vertices );
@@ -548,36 +640,30 @@ namespace
 									}
 								}
 								int vertexColorIndex = -1;
-								MColor vertexColor( 1.0f, 1.0f, 1.0f, 1.0f );
 								{
 									int colorSetCount = mesh.numColorSets();
 									if ( colorSetCount > 0 )
 									{
 										status = i.getColorIndex( j, vertexColorIndex );
-										if ( status )
-										{
-											if ( vertexColorIndex >= 0 )
-											{
-												vertexColor = vertexColors[vertexColorIndex];
-											}
-										}
-										else
+										if ( !status )
 										{
 											MGlobal::displayError( status.errorString() );
 											return status;
 										}
 									}
 								}
-								const std::string vertexKey = CreateUniqueVertexKey( positionIndex, normalIndex, tangentIndex,
-									texcoordIndex, vertexColorIndex, shadingGroup, transformName );
-								indexToKeyMap.insert( std::make_pair( positionIndex, vertexKey ) );
-								io_uniqueVertices.insert( std::make_pair( vertexKey,
-									sVertexInfo( positions[positionIndex], normals[normalIndex],
-										tangents[tangentIndex], bitangents[tangentIndex],
-										texcoordUs[texcoordIndex], texcoordVs[texcoordIndex],
-										vertexColor,
-										shadingGroup, vertexKey )
-									) );
+								// The corner is welded later (along with the attributes that the key refers to)
+								const uint32_t cornerIndex = static_cast<uint32_t>( o_dagNodeMesh.cornerKeys.size() / VERTEXKEY_COUNT );
+								uint32_t vertexKey[VERTEXKEY_COUNT];
+								vertexKey[VERTEXKEY_SHADINGGROUP] = static_cast<uint32_t>( shadingGroup );
+								vertexKey[VERTEXKEY_DAGNODE] = i_dagNodeIndex;
+								vertexKey[VERTEXKEY_POSITION] = static_cast<uint32_t>( positionIndex );
+								vertexKey[VERTEXKEY_NORMAL] = static_cast<uint32_t>( normalIndex );
+								vertexKey[VERTEXKEY_TANGENT] = static_cast<uint32_t>( tangentIndex );
+								vertexKey[VERTEXKEY_TEXCOORD] = static_cast<uint32_t>( texcoordIndex );
+								vertexKey[VERTEXKEY_VERTEXCOLOR] = static_cast<uint32_t>( vertexColorIndex );
+								o_dagNodeMesh.cornerKeys.insert( o_dagNodeMesh.cornerKeys.end(), vertexKey, vertexKey + VERTEXKEY_COUNT );
+								positionIndicesToCornerIndices.push_back( std::make_pair( positionIndex, cornerIndex ) );
 							}
 						}
 						else
@@ -598,10 +684,14 @@ namespace
 								for ( unsigned int k = 0; k < static_cast<unsigned int>( s_vertexCountPerTriangle ); ++k )
 								{
 									const int positionIndex = positionIndices[k];
-									std::map<int, const std::string>::iterator mapLookUp = indexToKeyMap.find( positionIndex );
-									if ( mapLookUp != indexToKeyMap.end() )
+									std::vector<std::pair<int, uint32_t> >::const_iterator lookUp = positionIndicesToCornerIndices.begin();
+									while ( ( lookUp != positionIndicesToCornerIndices.end() ) && ( lookUp->first != positionIndex ) )
 									{
-										triangle.vertexKeys[k] = mapLookUp->second;
+										++lookUp;
+									}
+									if ( lookUp != positionIndicesToCornerIndices.end() )
+									{
+										triangle.vertexIndices[k] = lookUp->second;
 									}
 									else
 									{
@@ -610,7 +700,7 @@ namespace
 									}
 								}
 								triangle.shadingGroup = shadingGroup;
-								io_triangles.push_back( triangle );
+								o_dagNodeMesh.triangles.push_back( triangle );
 							}
 							else
 							{
@@ -632,8 +722,70 @@ namespace
 		return MStatus::kSuccess;
 	}
 
+	void WeldDagNodeMesh( sDagNodeMesh& io_dagNodeMesh )
+	{
+		// This runs on a worker thread, and so it must only use the node's own data (and nothing from Maya)
+		static const float s_defaultVertexColor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		const size_t cornerCount = io_dagNodeMesh.cornerKeys.size() / VERTEXKEY_COUNT;
+		Engine::AssetBuild::cVertexWelder welder( VERTEXKEY_COUNT, cornerCount / 2 );
+		std::vector<uint32_t> cornerIndicesToVertexIndices( cornerCount );
+		for ( size_t i = 0; i < cornerCount; ++i )
+		{
+			const uint32_t* const vertexKey = &io_dagNodeMesh.cornerKeys[i * VERTEXKEY_COUNT];
+			bool isNewVertex;
+			cornerIndicesToVertexIndices[i] = welder.Weld( vertexKey, &isNewVertex );
+			if ( isNewVertex )
+			{
+				const size_t positionIndex = vertexKey[VERTEXKEY_POSITION];
+				const size_t normalIndex = vertexKey[VERTEXKEY_NORMAL];
+				const size_t tangentIndex = vertexKey[VERTEXKEY_TANGENT];
+				const size_t texcoordIndex = vertexKey[VERTEXKEY_TEXCOORD];
+				const int vertexColorIndex = static_cast<int>( vertexKey[VERTEXKEY_VERTEXCOLOR] );
+				const float* const vertexColor = ( vertexColorIndex >= 0 ) ?
+					&io_dagNodeMesh.vertexColors[static_cast<size_t>( vertexColorIndex ) * 4] : s_defaultVertexColor;
+				// Polygons without a shading group have an index of -1
+				const size_t shadingGroup = static_cast<size_t>( static_cast<int>( vertexKey[VERTEXKEY_SHADINGGROUP] ) );
+				io_dagNodeMesh.uniqueVertices.push_back( sVertexInfo( &io_dagNodeMesh.positions[positionIndex * 3], &io_dagNodeMesh.normals[normalIndex * 3],
+					&io_dagNodeMesh.tangents[tangentIndex * 3], &io_dagNodeMesh.bitangents[tangentIndex * 3],
+					io_dagNodeMesh.texcoordUs[texcoordIndex], io_dagNodeMesh.texcoordVs[texcoordIndex],
+					vertexColor,
+					shadingGroup ) );
+			}
+		}
+		if ( welder.GetVertexCount() > 0 )
+		{
+			io_dagNodeMesh.uniqueVertexKeys.assign( welder.GetKey( 0 ), welder.GetKey( 0 ) + ( welder.GetVertexCount() * VERTEXKEY_COUNT ) );
+		}
+
+		for ( std::vector<sTriangle>::iterator i = io_dagNodeMesh.triangles.begin(); i != io_dagNodeMesh.triangles.end(); ++i )
+		{
+			for ( size_t j = 0; j < s_vertexCountPerTriangle; ++j )
+			{
+				i->vertexIndices[j] = cornerIndicesToVertexIndices[i->vertexIndices[j]];
+			}
+		}
+	}
+
 	MStatus WriteMeshToFile( const MString& i_fileName, const std::vector<sVertexInfo>& i_vertexBuffer, const std::vector<size_t>& i_indexBuffer,
 		const std::vector<sMaterialInfo>& i_materialInfo )
+	{
+		// Exporting to a ".mesh" file writes a binary mesh source, which MeshBuilder can read without parsing
+		// (and without the precision that printing floats as text loses)
+		const std::string fileName( i_fileName.asChar() );
+		const std::string binaryExtension( ".mesh" );
+		if ( ( fileName.size() >= binaryExtension.size() )
+			&& ( fileName.compare( fileName.size() - binaryExtension.size(), binaryExtension.size(), binaryExtension ) == 0 ) )
+		{
+			return WriteMeshToBinaryFile( i_fileName, i_vertexBuffer, i_indexBuffer, i_materialInfo );
+		}
+		else
+		{
+			return WriteMeshToLuaFile( i_fileName, i_vertexBuffer, i_indexBuffer, i_materialInfo );
+		}
+	}
+
+	MStatus WriteMeshToLuaFile( const MString& i_fileName, const std::vector<sVertexInfo>& i_vertexBuffer, const std::vector<size_t>& i_indexBuffer,
+		const std::vector<sMaterialInfo>& i_materialInfo )
 	{
 		std::ofstream fout( i_fileName.asChar() );
 		if ( fout.is_open() )
@@ -667,6 +819,21 @@ namespace
 				}
 				fout << "},\n";
 			}
+			{
+				// The triangles are sorted by shading group, and so each material's triangles are a single range of the index buffer
+				fout << "submeshes =\n"
+					"{\n";
+				for (std::vector<sMaterialInfo>::const_iterator it = i_materialInfo.begin(); it != i_materialInfo.end(); it++)
+				{
+					if (it->indexRange.first == SIZE_MAX)
+					{
+						continue;
+					}
+					fout << "    { material = \"" << it->nodeName.asChar() << "\", firstIndex = " << it->indexRange.first
+						<< ", indexCount = " << ((it->indexRange.last - it->indexRange.first) + 1) << " },\n";
+				}
+				fout << "},\n";
+			}
 			fout << "}\n";
 			fout.close();
 
@@ -678,4 +845,90 @@ namespace
 			return MStatus::kFailure;
 		}
 	}
+
+	MStatus WriteMeshToBinaryFile( const MString& i_fileName, const std::vector<sVertexInfo>& i_vertexBuffer, const std::vector<size_t>& i_indexBuffer,
+		const std::vector<sMaterialInfo>& i_materialInfo )
+	{
+		if ( ( i_vertexBuffer.size() > UINT_MAX ) || ( i_indexBuffer.size() > UINT_MAX ) )
+		{
+			MGlobal::displayError( "The mesh has too many vertices or indices" );
+			return MStatus::kFailure;
+		}
+
+		// The vertices are converted the same way that MeshBuilder converts the ones in a Lua file
+		std::vector<Engine::AssetBuild::sVertex> vertices( i_vertexBuffer.size() );
+		for ( size_t i = 0; i < i_vertexBuffer.size(); ++i )
+		{
+			const sVertex_maya& vertex_maya = i_vertexBuffer[i].vertex;
+			Engine::AssetBuild::sVertex& vertex = vertices[i];
+			vertex.x = vertex_maya.x;
+			vertex.y = vertex_maya.y;
+			vertex.z = vertex_maya.z;
+			vertex.u = vertex_maya.u;
+			vertex.v = vertex_maya.v;
+			vertex.r = static_cast<uint8_t>( vertex_maya.r * 255.0f );
+			vertex.g = static_cast<uint8_t>( vertex_maya.g * 255.0f );
+			vertex.b = static_cast<uint8_t>( vertex_maya.b * 255.0f );
+			vertex.a = 255;
+		}
+		std::vector<uint32_t> indices( i_indexBuffer.begin(), i_indexBuffer.end() );
+
+		// Materials that more than one shading group use share a slot
+		std::vector<Engine::AssetBuild::MeshSource::sSubmesh> submeshes;
+		std::string materialNames;
+		uint32_t materialSlotCount = 0;
+		{
+			std::map<std::string, uint32_t> materialNamesToSlots;
+			for ( std::vector<sMaterialInfo>::const_iterator i = i_materialInfo.begin(); i != i_materialInfo.end(); ++i )
+			{
+				if ( i->indexRange.first == SIZE_MAX )
+				{
+					continue;
+				}
+				const std::string name( i->nodeName.asChar() );
+				std::map<std::string, uint32_t>::const_iterator slot = materialNamesToSlots.find( name );
+				if ( slot == materialNamesToSlots.end() )
+				{
+					slot = materialNamesToSlots.insert( std::make_pair( name, materialSlotCount++ ) ).first;
+					materialNames.append( name.c_str(), name.size() + 1 );
+				}
+				Engine::AssetBuild::MeshSource::sSubmesh submesh;
+				submesh.firstIndex = static_cast<uint32_t>( i->indexRange.first );
+				submesh.indexCount = static_cast<uint32_t>( ( i->indexRange.last - i->indexRange.first ) + 1 );
+				submesh.materialSlot = slot->second;
+				submeshes.push_back( submesh );
+			}
+		}
+
+		std::ofstream fout( i_fileName.asChar(), std::ofstream::binary );
+		if ( fout.is_open() )
+		{
+			Engine::AssetBuild::MeshSource::sFileHeader header;
+			header.magic = Engine::AssetBuild::MeshSource::s_fileMagic;
+			header.version = Engine::AssetBuild::MeshSource::s_fileVersion;
+			header.vertexCount = static_cast<uint32_t>( vertices.size() );
+			header.indexCount = static_cast<uint32_t>( indices.size() );
+			header.submeshCount = static_cast<uint32_t>( submeshes.size() );
+			header.materialSlotCount = materialSlotCount;
+			header.materialNamesSize = static_cast<uint32_t>( materialNames.size() );
+			fout.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+			fout.write( reinterpret_cast<const char*>( vertices.data() ), vertices.size() * sizeof( Engine::AssetBuild::sVertex ) );
+			fout.write( reinterpret_cast<const char*>( indices.data() ), indices.size() * sizeof( uint32_t ) );
+			fout.write( reinterpret_cast<const char*>( submeshes.data() ), submeshes.size() * sizeof( Engine::AssetBuild::MeshSource::sSubmesh ) );
+			fout.write( materialNames.data(), materialNames.size() );
+			fout.close();
+			if ( fout.fail() )
+			{
+				MGlobal::displayError( MString( "Couldn't write " ) + i_fileName );
+				return MStatus::kFailure;
+			}
+
+			return MStatus::kSuccess;
+		}
+		else
+		{
+			MGlobal::displayError( MString( "Couldn't open " ) + i_fileName + " for writing" );
+			return MStatus::kFailure;
+		}
+	}
 }
@@ -0,0 +1,141 @@
+#include "MeshBounds.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	float GetDistanceSquared( const Engine::AssetBuild::sVertex& i_vertex, const float i_point[3] )
+	{
+		const float dx = i_vertex.x - i_point[0], dy = i_vertex.y - i_point[1], dz = i_vertex.z - i_point[2];
+		return ( dx * dx ) + ( dy * dy ) + ( dz * dz );
+	}
+}
+
+void Engine::AssetBuild::MeshBounds::CalculateBoundingSphere( const std::vector<sVertex>& i_vertices, const std::vector<uint32_t>& i_vertexIndices,
+	float o_sphere[4] )
+{
+	o_sphere[0] = o_sphere[1] = o_sphere[2] = o_sphere[3] = 0.0f;
+	if ( i_vertexIndices.empty() )
+	{
+		return;
+	}
+
+	// Find the points with the smallest and largest coordinate on each axis
+	size_t extremes_min[3] = { 0, 0, 0 };
+	size_t extremes_max[3] = { 0, 0, 0 };
+	for ( size_t i = 1; i < i_vertexIndices.size(); ++i )
+	{
+		const sVertex& vertex = i_vertices[i_vertexIndices[i]];
+		const float position[3] = { vertex.x, vertex.y, vertex.z };
+		for ( size_t axis = 0; axis < 3; ++axis )
+		{
+			const sVertex& minimum = i_vertices[i_vertexIndices[extremes_min[axis]]];
+			const sVertex& maximum = i_vertices[i_vertexIndices[extremes_max[axis]]];
+			const float minimumPosition[3] = { minimum.x, minimum.y, minimum.z };
+			const float maximumPosition[3] = { maximum.x, maximum.y, maximum.z };
+			if ( position[axis] < minimumPosition[axis] )
+			{
+				extremes_min[axis] = i;
+			}
+			if ( position[axis] > maximumPosition[axis] )
+			{
+				extremes_max[axis] = i;
+			}
+		}
+	}
+
+	// Start with the sphere spanned by the most distant pair
+	{
+		size_t widestAxis = 0;
+		float widestDistanceSquared = -1.0f;
+		for ( size_t axis = 0; axis < 3; ++axis )
+		{
+			const sVertex& maximum = i_vertices[i_vertexIndices[extremes_max[axis]]];
+			const float maximumPosition[3] = { maximum.x, maximum.y, maximum.z };
+			const float distanceSquared = GetDistanceSquared( i_vertices[i_vertexIndices[extremes_min[axis]]], maximumPosition );
+			if ( distanceSquared > widestDistanceSquared )
+			{
+				widestDistanceSquared = distanceSquared;
+				widestAxis = axis;
+			}
+		}
+		const sVertex& a = i_vertices[i_vertexIndices[extremes_min[widestAxis]]];
+		const sVertex& b = i_vertices[i_vertexIndices[extremes_max[widestAxis]]];
+		o_sphere[0] = ( a.x + b.x ) * 0.5f;
+		o_sphere[1] = ( a.y + b.y ) * 0.5f;
+		o_sphere[2] = ( a.z + b.z ) * 0.5f;
+		o_sphere[3] = std::sqrt( widestDistanceSquared ) * 0.5f;
+	}
+
+	// Grow the sphere just enough to include every point that is outside of it
+	for ( size_t i = 0; i < i_vertexIndices.size(); ++i )
+	{
+		const sVertex& vertex = i_vertices[i_vertexIndices[i]];
+		const float distanceSquared = GetDistanceSquared( vertex, o_sphere );
+		if ( distanceSquared > ( o_sphere[3] * o_sphere[3] ) )
+		{
+			const float distance = std::sqrt( distanceSquared );
+			const float newRadius = ( o_sphere[3] + distance ) * 0.5f;
+			const float shift = ( newRadius - o_sphere[3] ) / distance;
+			o_sphere[0] += ( vertex.x - o_sphere[0] ) * shift;
+			o_sphere[1] += ( vertex.y - o_sphere[1] ) * shift;
+			o_sphere[2] += ( vertex.z - o_sphere[2] ) * shift;
+			o_sphere[3] = newRadius;
+		}
+	}
+	// Floating point error can leave points a tiny bit outside
+	o_sphere[3] *= 1.0f + 1e-5f;
+}
+
+void Engine::AssetBuild::MeshBounds::CalculateBounds( const std::vector<sVertex>& i_vertices, const std::vector<uint32_t>& i_vertexIndices,
+	Engine::Mesh::sBounds& o_bounds )
+{
+	for ( size_t axis = 0; axis < 3; ++axis )
+	{
+		o_bounds.aabbMin[axis] = o_bounds.aabbMax[axis] = 0.0f;
+	}
+	CalculateBoundingSphere( i_vertices, i_vertexIndices, o_bounds.sphere );
+	if ( i_vertexIndices.empty() )
+	{
+		return;
+	}
+
+	{
+		const sVertex& first = i_vertices[i_vertexIndices[0]];
+		o_bounds.aabbMin[0] = o_bounds.aabbMax[0] = first.x;
+		o_bounds.aabbMin[1] = o_bounds.aabbMax[1] = first.y;
+		o_bounds.aabbMin[2] = o_bounds.aabbMax[2] = first.z;
+	}
+	for ( size_t i = 1; i < i_vertexIndices.size(); ++i )
+	{
+		const sVertex& vertex = i_vertices[i_vertexIndices[i]];
+		const float position[3] = { vertex.x, vertex.y, vertex.z };
+		for ( size_t axis = 0; axis < 3; ++axis )
+		{
+			o_bounds.aabbMin[axis] = std::min( o_bounds.aabbMin[axis], position[axis] );
+			o_bounds.aabbMax[axis] = std::max( o_bounds.aabbMax[axis], position[axis] );
+		}
+	}
+
+	// Ritter's sphere is usually the tighter one, but not for every shape (e.g. boxes)
+	const float boxCenter[3] =
+	{
+		( o_bounds.aabbMin[0] + o_bounds.aabbMax[0] ) * 0.5f,
+		( o_bounds.aabbMin[1] + o_bounds.aabbMax[1] ) * 0.5f,
+		( o_bounds.aabbMin[2] + o_bounds.aabbMax[2] ) * 0.5f,
+	};
+	float boxSphereRadiusSquared = 0.0f;
+	for ( size_t i = 0; i < i_vertexIndices.size(); ++i )
+	{
+		boxSphereRadiusSquared = std::max( boxSphereRadiusSquared, GetDistanceSquared( i_vertices[i_vertexIndices[i]], boxCenter ) );
+	}
+	const float boxSphereRadius = std::sqrt( boxSphereRadiusSquared ) * ( 1.0f + 1e-5f );
+	if ( boxSphereRadius < o_bounds.sphere[3] )
+	{
+		o_bounds.sphere[0] = boxCenter[0];
+		o_bounds.sphere[1] = boxCenter[1];
+		o_bounds.sphere[2] = boxCenter[2];
+		o_bounds.sphere[3] = boxSphereRadius;
+	}
+}
@@ -0,0 +1,23 @@
+#ifndef MESHBUILDER_MESHBOUNDS_H
+#define MESHBUILDER_MESHBOUNDS_H
+
+#include "MeshData.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace MeshBounds
+		{
+			// Calculates a bounding sphere (center xyz and radius) of the given vertices using Ritter's algorithm:
+			// an initial sphere is spanned by the most distant pair of axis extremes and then grown to include every outlier
+			void CalculateBoundingSphere( const std::vector<sVertex>& i_vertices, const std::vector<uint32_t>& i_vertexIndices,
+				float o_sphere[4] );
+			// Calculates the axis-aligned bounding box and the tighter of the Ritter sphere and the sphere around the box's center
+			void CalculateBounds( const std::vector<sVertex>& i_vertices, const std::vector<uint32_t>& i_vertexIndices,
+				Engine::Mesh::sBounds& o_bounds );
+		}
+	}
+}
+
+#endif
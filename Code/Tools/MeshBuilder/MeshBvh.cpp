@@ -0,0 +1,325 @@
+#include "MeshBvh.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace
+{
+	using Engine::AssetBuild::sVertex;
+	using Engine::AssetBuild::sSubmesh;
+	using Engine::Mesh::sBvhNode;
+	using Engine::Mesh::sBvhTrianglePacket;
+
+	const unsigned int s_binCount = 16;
+	const unsigned int s_packetSize = 4;
+	// Leaves with more triangles than this are always split, even if the heuristic says that they would be cheaper as they are
+	const uint32_t s_maxLeafTriangleCount = 16;
+	// The relative costs of testing a ray against a node's box and against a packet of triangles
+	const float s_nodeCost = 1.0f;
+	const float s_packetCost = 1.5f;
+
+	struct sAabb
+	{
+		float min[3];
+		float max[3];
+
+		sAabb()
+		{
+			for ( unsigned int axis = 0; axis < 3; ++axis )
+			{
+				min[axis] = FLT_MAX;
+				max[axis] = -FLT_MAX;
+			}
+		}
+		void Grow( const float i_point[3] )
+		{
+			for ( unsigned int axis = 0; axis < 3; ++axis )
+			{
+				min[axis] = std::min( min[axis], i_point[axis] );
+				max[axis] = std::max( max[axis], i_point[axis] );
+			}
+		}
+		void Grow( const sAabb& i_aabb )
+		{
+			Grow( i_aabb.min );
+			Grow( i_aabb.max );
+		}
+		// Half of the surface area is enough, because only ratios of areas are ever used
+		float GetHalfArea() const
+		{
+			const float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+			return ( x * y ) + ( y * z ) + ( z * x );
+		}
+	};
+
+	struct sTriangleInfo
+	{
+		sAabb bounds;
+		float centroid[3];
+	};
+
+	struct sBuildTask
+	{
+		uint32_t nodeIndex;
+		uint32_t begin;
+		uint32_t end;
+		unsigned int depth;
+	};
+
+	struct sSplit
+	{
+		unsigned int axis;
+		unsigned int bin;	// Triangles in this bin and the ones before it go to the first child
+		float cost;
+	};
+
+	uint32_t GetPacketCount( const uint32_t i_triangleCount )
+	{
+		return ( i_triangleCount + s_packetSize - 1 ) / s_packetSize;
+	}
+
+	unsigned int GetBin( const float i_centroid, const float i_centroidMin, const float i_binScale )
+	{
+		const int bin = static_cast<int>( ( i_centroid - i_centroidMin ) * i_binScale );
+		return static_cast<unsigned int>( std::min( std::max( bin, 0 ), static_cast<int>( s_binCount - 1 ) ) );
+	}
+
+	float GetBinScale( const sAabb& i_centroidBounds, const unsigned int i_axis )
+	{
+		const float extent = i_centroidBounds.max[i_axis] - i_centroidBounds.min[i_axis];
+		return ( extent > 0.0f ) ? ( s_binCount / extent ) : 0.0f;
+	}
+
+	bool FindBestSplit( const std::vector<sTriangleInfo>& i_triangleInfos, const std::vector<uint32_t>& i_order,
+		const uint32_t i_begin, const uint32_t i_end, const sAabb& i_bounds, const sAabb& i_centroidBounds, sSplit& o_split );
+	void WriteLeaf( const Engine::AssetBuild::sMesh& i_mesh, const std::vector<uint32_t>& i_triangleIndices, const std::vector<uint32_t>& i_order,
+		const uint32_t i_begin, const uint32_t i_end, std::vector<sBvhTrianglePacket>& io_packets );
+}
+
+void Engine::AssetBuild::MeshBvh::BuildBvh( sMesh& io_mesh )
+{
+	io_mesh.bvhNodes.clear();
+	io_mesh.bvhTrianglePackets.clear();
+
+	// Only LOD 0 is used for queries, and it's the first range of each submesh
+	std::vector<uint32_t> triangleIndices;
+	for ( std::vector<sSubmesh>::const_iterator it = io_mesh.submeshes.begin(); it != io_mesh.submeshes.end(); ++it )
+	{
+		for ( uint32_t i = 0; ( i + 2 ) < it->indexCount; i += 3 )
+		{
+			triangleIndices.push_back( ( it->firstIndex + i ) / 3 );
+		}
+	}
+	const uint32_t triangleCount = static_cast<uint32_t>( triangleIndices.size() );
+	if ( triangleCount == 0 )
+	{
+		return;
+	}
+	std::vector<sTriangleInfo> triangleInfos( triangleCount );
+	for ( uint32_t i = 0; i < triangleCount; ++i )
+	{
+		sTriangleInfo& info = triangleInfos[i];
+		for ( unsigned int corner = 0; corner < 3; ++corner )
+		{
+			const sVertex& vertex = io_mesh.vertices[io_mesh.indices[( triangleIndices[i] * 3 ) + corner]];
+			const float position[3] = { vertex.x, vertex.y, vertex.z };
+			info.bounds.Grow( position );
+		}
+		for ( unsigned int axis = 0; axis < 3; ++axis )
+		{
+			info.centroid[axis] = ( info.bounds.min[axis] + info.bounds.max[axis] ) * 0.5f;
+		}
+	}
+
+	// Nodes are split depth first, and each split reorders its range of triangles so that every child is a contiguous range
+	std::vector<uint32_t> order( triangleCount );
+	for ( uint32_t i = 0; i < triangleCount; ++i )
+	{
+		order[i] = i;
+	}
+	io_mesh.bvhNodes.resize( 1 );
+	std::vector<sBuildTask> tasks;
+	{
+		const sBuildTask root = { 0, 0, triangleCount, 0 };
+		tasks.push_back( root );
+	}
+	while ( !tasks.empty() )
+	{
+		const sBuildTask task = tasks.back();
+		tasks.pop_back();
+
+		sAabb bounds, centroidBounds;
+		for ( uint32_t i = task.begin; i < task.end; ++i )
+		{
+			const sTriangleInfo& info = triangleInfos[order[i]];
+			bounds.Grow( info.bounds );
+			centroidBounds.Grow( info.centroid );
+		}
+		{
+			sBvhNode& node = io_mesh.bvhNodes[task.nodeIndex];
+			for ( unsigned int axis = 0; axis < 3; ++axis )
+			{
+				node.aabbMin[axis] = bounds.min[axis];
+				node.aabbMax[axis] = bounds.max[axis];
+			}
+		}
+
+		const uint32_t triangleCount_node = task.end - task.begin;
+		uint32_t middle = task.begin;
+		if ( ( triangleCount_node > s_packetSize ) && ( ( task.depth + 1 ) < Engine::Mesh::s_maxBvhDepth ) )
+		{
+			const bool mustSplit = triangleCount_node > s_maxLeafTriangleCount;
+			sSplit split = {};
+			if ( FindBestSplit( triangleInfos, order, task.begin, task.end, bounds, centroidBounds, split )
+				&& ( mustSplit || ( split.cost < ( GetPacketCount( triangleCount_node ) * s_packetCost ) ) ) )
+			{
+				const float binScale = GetBinScale( centroidBounds, split.axis );
+				middle = static_cast<uint32_t>( std::partition( order.begin() + task.begin, order.begin() + task.end,
+					[&]( const uint32_t i_triangle )
+					{
+						return GetBin( triangleInfos[i_triangle].centroid[split.axis], centroidBounds.min[split.axis], binScale ) <= split.bin;
+					} ) - order.begin() );
+			}
+			else if ( mustSplit )
+			{
+				// The centroids are all in the same place, and so the only way to split them is in half
+				middle = task.begin + ( triangleCount_node / 2 );
+			}
+		}
+
+		if ( middle > task.begin )
+		{
+			const uint32_t childIndex = static_cast<uint32_t>( io_mesh.bvhNodes.size() );
+			io_mesh.bvhNodes.resize( childIndex + 2 );
+			sBvhNode& node = io_mesh.bvhNodes[task.nodeIndex];
+			node.offset = childIndex;
+			node.packetCount = 0;
+			// The second child is pushed first so that the first one is split next
+			const sBuildTask children[2] =
+			{
+				{ childIndex, task.begin, middle, task.depth + 1 },
+				{ childIndex + 1, middle, task.end, task.depth + 1 },
+			};
+			tasks.push_back( children[1] );
+			tasks.push_back( children[0] );
+		}
+		else
+		{
+			sBvhNode& node = io_mesh.bvhNodes[task.nodeIndex];
+			node.offset = static_cast<uint32_t>( io_mesh.bvhTrianglePackets.size() );
+			node.packetCount = GetPacketCount( triangleCount_node );
+			WriteLeaf( io_mesh, triangleIndices, order, task.begin, task.end, io_mesh.bvhTrianglePackets );
+		}
+	}
+}
+
+namespace
+{
+	bool FindBestSplit( const std::vector<sTriangleInfo>& i_triangleInfos, const std::vector<uint32_t>& i_order,
+		const uint32_t i_begin, const uint32_t i_end, const sAabb& i_bounds, const sAabb& i_centroidBounds, sSplit& o_split )
+	{
+		const float parentArea = i_bounds.GetHalfArea();
+		bool wasSplitFound = false;
+		o_split.cost = FLT_MAX;
+		for ( unsigned int axis = 0; axis < 3; ++axis )
+		{
+			const float binScale = GetBinScale( i_centroidBounds, axis );
+			if ( binScale <= 0.0f )
+			{
+				continue;
+			}
+			sAabb binBounds[s_binCount];
+			uint32_t binCounts[s_binCount] = {};
+			for ( uint32_t i = i_begin; i < i_end; ++i )
+			{
+				const sTriangleInfo& info = i_triangleInfos[i_order[i]];
+				const unsigned int bin = GetBin( info.centroid[axis], i_centroidBounds.min[axis], binScale );
+				binBounds[bin].Grow( info.bounds );
+				++binCounts[bin];
+			}
+
+			// The cost of the triangles on the first side of every boundary is accumulated from the left,
+			// and then the other side is accumulated from the right while the boundaries are compared
+			float costs_left[s_binCount - 1];
+			uint32_t counts_left[s_binCount - 1];
+			{
+				sAabb bounds;
+				uint32_t count = 0;
+				for ( unsigned int i = 0; i < ( s_binCount - 1 ); ++i )
+				{
+					if ( binCounts[i] > 0 )
+					{
+						bounds.Grow( binBounds[i] );
+						count += binCounts[i];
+					}
+					counts_left[i] = count;
+					costs_left[i] = ( count > 0 ) ? ( bounds.GetHalfArea() * GetPacketCount( count ) ) : 0.0f;
+				}
+			}
+			{
+				sAabb bounds;
+				uint32_t count = 0;
+				for ( unsigned int i = s_binCount - 1; i > 0; --i )
+				{
+					if ( binCounts[i] > 0 )
+					{
+						bounds.Grow( binBounds[i] );
+						count += binCounts[i];
+					}
+					const unsigned int boundary = i - 1;
+					if ( ( count == 0 ) || ( counts_left[boundary] == 0 ) )
+					{
+						continue;
+					}
+					const float cost_right = bounds.GetHalfArea() * GetPacketCount( count );
+					const float cost = s_nodeCost
+						+ ( ( parentArea > 0.0f ) ? ( ( ( costs_left[boundary] + cost_right ) / parentArea ) * s_packetCost ) : 0.0f );
+					if ( cost < o_split.cost )
+					{
+						o_split.axis = axis;
+						o_split.bin = boundary;
+						o_split.cost = cost;
+						wasSplitFound = true;
+					}
+				}
+			}
+		}
+		return wasSplitFound;
+	}
+
+	void WriteLeaf( const Engine::AssetBuild::sMesh& i_mesh, const std::vector<uint32_t>& i_triangleIndices, const std::vector<uint32_t>& i_order,
+		const uint32_t i_begin, const uint32_t i_end, std::vector<sBvhTrianglePacket>& io_packets )
+	{
+		for ( uint32_t packetBegin = i_begin; packetBegin < i_end; packetBegin += s_packetSize )
+		{
+			sBvhTrianglePacket packet = {};
+			for ( unsigned int lane = 0; lane < s_packetSize; ++lane )
+			{
+				const uint32_t i = packetBegin + lane;
+				if ( i >= i_end )
+				{
+					packet.triangleIndices[lane] = UINT32_MAX;
+					continue;
+				}
+				const uint32_t triangleIndex = i_triangleIndices[i_order[i]];
+				const sVertex& vertex0 = i_mesh.vertices[i_mesh.indices[( triangleIndex * 3 ) + 0]];
+				const sVertex& vertex1 = i_mesh.vertices[i_mesh.indices[( triangleIndex * 3 ) + 1]];
+				const sVertex& vertex2 = i_mesh.vertices[i_mesh.indices[( triangleIndex * 3 ) + 2]];
+				const float positions[3][3] =
+				{
+					{ vertex0.x, vertex0.y, vertex0.z },
+					{ vertex1.x, vertex1.y, vertex1.z },
+					{ vertex2.x, vertex2.y, vertex2.z },
+				};
+				for ( unsigned int axis = 0; axis < 3; ++axis )
+				{
+					packet.vertex0[axis][lane] = positions[0][axis];
+					packet.edge1[axis][lane] = positions[1][axis] - positions[0][axis];
+					packet.edge2[axis][lane] = positions[2][axis] - positions[0][axis];
+				}
+				packet.triangleIndices[lane] = triangleIndex;
+			}
+			io_packets.push_back( packet );
+		}
+	}
+}
@@ -0,0 +1,23 @@
+#ifndef MESHBUILDER_MESHBVH_H
+#define MESHBUILDER_MESHBVH_H
+
+#include "MeshData.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace MeshBvh
+		{
+			// Builds a bounding volume hierarchy over the triangles of LOD 0 of every submesh
+			// and fills io_mesh.bvhNodes and io_mesh.bvhTrianglePackets.
+			// The submeshes and the index buffer must already be final, because the leaves refer to triangles by where they are in it.
+			// Each node is split where the surface area heuristic estimates that rays are cheapest to trace
+			// (evaluated at the boundaries of a fixed number of bins along each axis),
+			// and leaves are kept small enough that their triangles fit in a few 4-wide packets
+			void BuildBvh( sMesh& io_mesh );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,241 @@
+#include "MeshClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "MeshBounds.h"
+
+namespace
+{
+	using Engine::AssetBuild::sVertex;
+	using Engine::AssetBuild::sCluster;
+
+	const uint32_t s_invalidIndex = std::numeric_limits<uint32_t>::max();
+
+	struct sVector
+	{
+		float x, y, z;
+
+		sVector() : x( 0.0f ), y( 0.0f ), z( 0.0f ) {}
+		sVector( const float i_x, const float i_y, const float i_z ) : x( i_x ), y( i_y ), z( i_z ) {}
+		explicit sVector( const sVertex& i_vertex ) : x( i_vertex.x ), y( i_vertex.y ), z( i_vertex.z ) {}
+
+		sVector operator +( const sVector& i_rhs ) const { return sVector( x + i_rhs.x, y + i_rhs.y, z + i_rhs.z ); }
+		sVector operator -( const sVector& i_rhs ) const { return sVector( x - i_rhs.x, y - i_rhs.y, z - i_rhs.z ); }
+		sVector operator *( const float i_rhs ) const { return sVector( x * i_rhs, y * i_rhs, z * i_rhs ); }
+		float Dot( const sVector& i_rhs ) const { return ( x * i_rhs.x ) + ( y * i_rhs.y ) + ( z * i_rhs.z ); }
+		sVector Cross( const sVector& i_rhs ) const
+		{
+			return sVector( ( y * i_rhs.z ) - ( z * i_rhs.y ), ( z * i_rhs.x ) - ( x * i_rhs.z ), ( x * i_rhs.y ) - ( y * i_rhs.x ) );
+		}
+		float GetLength() const { return std::sqrt( Dot( *this ) ); }
+	};
+
+	void CalculateClusterBounds( const std::vector<sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_clusterVertices, sCluster& io_cluster );
+}
+
+void Engine::AssetBuild::MeshClusters::GenerateClusters( sMesh& io_mesh,
+	const unsigned int i_maxVertexCount, const unsigned int i_maxTriangleCount )
+{
+	io_mesh.clusters.clear();
+	if ( io_mesh.lods.empty() || ( i_maxVertexCount < 3 ) || ( i_maxTriangleCount < 1 ) )
+	{
+		return;
+	}
+	const uint32_t triangleCount = io_mesh.lods[0].indexCount / 3;
+	const uint32_t* const triangles = io_mesh.indices.data() + io_mesh.lods[0].firstIndex;
+	const uint32_t vertexCount = static_cast<uint32_t>( io_mesh.vertices.size() );
+
+	// Build the vertex-to-triangle adjacency
+	std::vector<uint32_t> adjacencyOffsets( vertexCount + 1, 0 );
+	std::vector<uint32_t> adjacentTriangles( triangleCount * 3 );
+	{
+		for ( uint32_t i = 0; i < triangleCount * 3; ++i )
+		{
+			++adjacencyOffsets[triangles[i] + 1];
+		}
+		for ( uint32_t i = 0; i < vertexCount; ++i )
+		{
+			adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+		}
+		std::vector<uint32_t> fillCounts( adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 );
+		for ( uint32_t i = 0; i < triangleCount * 3; ++i )
+		{
+			adjacentTriangles[fillCounts[triangles[i]]++] = i / 3;
+		}
+	}
+
+	// Grow clusters greedily: starting from the first unassigned triangle,
+	// keep adding the neighboring triangle that brings in the fewest new vertices until a limit is reached
+	std::vector<bool> isTriangleAssigned( triangleCount, false );
+	std::vector<uint32_t> vertexClusterIds( vertexCount, s_invalidIndex );
+	std::vector<uint32_t> reorderedIndices;
+	reorderedIndices.reserve( triangleCount * 3 );
+	std::vector<uint32_t> clusterVertices;
+	std::vector<uint32_t> candidates;
+	for ( uint32_t seed = 0; seed < triangleCount; ++seed )
+	{
+		if ( isTriangleAssigned[seed] )
+		{
+			continue;
+		}
+		const uint32_t clusterId = static_cast<uint32_t>( io_mesh.clusters.size() );
+		sCluster cluster;
+		cluster.firstIndex = io_mesh.lods[0].firstIndex + static_cast<uint32_t>( reorderedIndices.size() );
+		cluster.indexCount = 0;
+		clusterVertices.clear();
+		candidates.clear();
+
+		uint32_t triangle = seed;
+		while ( triangle != s_invalidIndex )
+		{
+			isTriangleAssigned[triangle] = true;
+			for ( uint32_t corner = 0; corner < 3; ++corner )
+			{
+				const uint32_t vertex = triangles[( triangle * 3 ) + corner];
+				reorderedIndices.push_back( vertex );
+				if ( vertexClusterIds[vertex] != clusterId )
+				{
+					vertexClusterIds[vertex] = clusterId;
+					clusterVertices.push_back( vertex );
+					for ( uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i )
+					{
+						if ( !isTriangleAssigned[adjacentTriangles[i]] )
+						{
+							candidates.push_back( adjacentTriangles[i] );
+						}
+					}
+				}
+			}
+			cluster.indexCount += 3;
+			if ( ( cluster.indexCount / 3 ) >= i_maxTriangleCount )
+			{
+				break;
+			}
+
+			// Choose the next triangle
+			triangle = s_invalidIndex;
+			uint32_t bestNewVertexCount = 4;
+			size_t candidatesKept = 0;
+			for ( size_t i = 0; i < candidates.size(); ++i )
+			{
+				const uint32_t candidate = candidates[i];
+				if ( isTriangleAssigned[candidate] )
+				{
+					continue;
+				}
+				candidates[candidatesKept++] = candidate;
+				uint32_t newVertexCount = 0;
+				for ( uint32_t corner = 0; corner < 3; ++corner )
+				{
+					newVertexCount += ( vertexClusterIds[triangles[( candidate * 3 ) + corner]] != clusterId ) ? 1 : 0;
+				}
+				const bool doesFit = ( clusterVertices.size() + newVertexCount ) <= i_maxVertexCount;
+				if ( doesFit && ( ( newVertexCount < bestNewVertexCount )
+					|| ( ( newVertexCount == bestNewVertexCount ) && ( candidate < triangle ) ) ) )
+				{
+					bestNewVertexCount = newVertexCount;
+					triangle = candidate;
+				}
+			}
+			candidates.resize( candidatesKept );
+		}
+
+		CalculateClusterBounds( io_mesh.vertices, reorderedIndices, clusterVertices, cluster );
+		io_mesh.clusters.push_back( cluster );
+	}
+
+	std::copy( reorderedIndices.begin(), reorderedIndices.end(), io_mesh.indices.begin() + io_mesh.lods[0].firstIndex );
+}
+
+namespace
+{
+	void CalculateClusterBounds( const std::vector<sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_clusterVertices, sCluster& io_cluster )
+	{
+		Engine::AssetBuild::MeshBounds::CalculateBoundingSphere( i_vertices, i_clusterVertices, io_cluster.boundingSphere );
+		const sVector center( io_cluster.boundingSphere[0], io_cluster.boundingSphere[1], io_cluster.boundingSphere[2] );
+
+		// The normals of the triangles in the cluster
+		// (built meshes are always counter-clockwise)
+		const uint32_t firstLocalIndex = static_cast<uint32_t>( i_indices.size() ) - io_cluster.indexCount;
+		std::vector<sVector> normals;
+		normals.reserve( io_cluster.indexCount / 3 );
+		for ( uint32_t i = firstLocalIndex; i < i_indices.size(); i += 3 )
+		{
+			const sVector a( i_vertices[i_indices[i]] );
+			const sVector b( i_vertices[i_indices[i + 1]] );
+			const sVector c( i_vertices[i_indices[i + 2]] );
+			sVector normal = ( b - a ).Cross( c - a );
+			const float length = normal.GetLength();
+			if ( length > 0.0f )
+			{
+				normals.push_back( normal * ( 1.0f / length ) );
+			}
+		}
+
+		// The cone axis is the average normal,
+		// and the cutoff comes from the normal that deviates the most from it
+		sVector axis;
+		for ( size_t i = 0; i < normals.size(); ++i )
+		{
+			axis = axis + normals[i];
+		}
+		const float axisLength = axis.GetLength();
+		float minimumDot = 1.0f;
+		if ( axisLength > 0.0f )
+		{
+			axis = axis * ( 1.0f / axisLength );
+			for ( size_t i = 0; i < normals.size(); ++i )
+			{
+				minimumDot = std::min( minimumDot, normals[i].Dot( axis ) );
+			}
+		}
+		else
+		{
+			minimumDot = -1.0f;
+		}
+
+		io_cluster.coneAxis[0] = axis.x;
+		io_cluster.coneAxis[1] = axis.y;
+		io_cluster.coneAxis[2] = axis.z;
+		// A cone that is (nearly) as wide as a hemisphere can never be culled
+		if ( ( minimumDot <= 0.1f ) || normals.empty() )
+		{
+			io_cluster.coneApex[0] = center.x;
+			io_cluster.coneApex[1] = center.y;
+			io_cluster.coneApex[2] = center.z;
+			io_cluster.coneCutoff = 1.0f;
+			return;
+		}
+
+		// The apex is moved back along the axis far enough that every triangle's plane is in front of it,
+		// which makes the cone test conservative for the whole cluster rather than only for its center
+		float maximumDistance = 0.0f;
+		for ( uint32_t i = firstLocalIndex; i < i_indices.size(); i += 3 )
+		{
+			const sVector a( i_vertices[i_indices[i]] );
+			const sVector b( i_vertices[i_indices[i + 1]] );
+			const sVector c( i_vertices[i_indices[i + 2]] );
+			sVector normal = ( b - a ).Cross( c - a );
+			const float length = normal.GetLength();
+			if ( length <= 0.0f )
+			{
+				continue;
+			}
+			normal = normal * ( 1.0f / length );
+			const float denominator = normal.Dot( axis );
+			if ( denominator > 0.0f )
+			{
+				const float distance = normal.Dot( center - a ) / denominator;
+				maximumDistance = std::max( maximumDistance, distance );
+			}
+		}
+		const sVector apex = center - ( axis * maximumDistance );
+		io_cluster.coneApex[0] = apex.x;
+		io_cluster.coneApex[1] = apex.y;
+		io_cluster.coneApex[2] = apex.z;
+		io_cluster.coneCutoff = std::sqrt( 1.0f - ( minimumDot * minimumDot ) );
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef MESHBUILDER_MESHCLUSTERS_H
+#define MESHBUILDER_MESHCLUSTERS_H
+
+#include "MeshData.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace MeshClusters
+		{
+			// Splits the triangles of LOD 0 into clusters of neighboring triangles
+			// and fills io_mesh.clusters with their bounds.
+			// The indices of LOD 0 are reordered so that every cluster is a contiguous range of the index buffer
+			// (the other levels of detail aren't touched)
+			void GenerateClusters( sMesh& io_mesh,
+				const unsigned int i_maxVertexCount = 64, const unsigned int i_maxTriangleCount = 124 );
+		}
+	}
+}
+
+#endif
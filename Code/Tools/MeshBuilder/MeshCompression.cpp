@@ -0,0 +1,142 @@
+#include "MeshCompression.h"
+
+#include <algorithm>
+#include "../../Engine/Graphics/MeshCodec.h"
+
+namespace
+{
+	uint8_t ZigZag( const uint8_t i_delta )
+	{
+		const int8_t delta = static_cast<int8_t>( i_delta );
+		return static_cast<uint8_t>( ( delta << 1 ) ^ ( delta >> 7 ) );
+	}
+	uint32_t ZigZag( const uint32_t i_delta )
+	{
+		const int32_t delta = static_cast<int32_t>( i_delta );
+		return static_cast<uint32_t>( delta << 1 ) ^ static_cast<uint32_t>( delta >> 31 );
+	}
+
+	unsigned int GetByteCount( const uint32_t i_value )
+	{
+		return ( i_value < ( 1u << 8 ) ) ? 1 : ( ( i_value < ( 1u << 16 ) ) ? 2 : ( ( i_value < ( 1u << 24 ) ) ? 3 : 4 ) );
+	}
+}
+
+void Engine::AssetBuild::MeshCompression::EncodeVertices( const uint8_t* const i_vertices, const uint32_t i_vertexCount, const size_t i_vertexSize,
+	std::vector<uint8_t>& o_encodedData )
+{
+	const unsigned int blockSize = Engine::Mesh::Codec::s_vertexBlockSize;
+	const size_t headerSize = ( i_vertexSize + 3 ) / 4;
+	std::vector<uint8_t> previous( i_vertexSize, 0 );
+	o_encodedData.clear();
+	for ( uint32_t firstVertex = 0; firstVertex < i_vertexCount; firstVertex += blockSize )
+	{
+		const size_t headerOffset = o_encodedData.size();
+		o_encodedData.resize( headerOffset + headerSize, 0 );
+
+		for ( size_t plane = 0; plane < i_vertexSize; ++plane )
+		{
+			// The last block is padded by repeating its last vertex, which costs nothing
+			uint8_t values[16];
+			uint8_t largestValue = 0;
+			for ( unsigned int i = 0; i < blockSize; ++i )
+			{
+				const uint32_t vertex = std::min( firstVertex + i, i_vertexCount - 1 );
+				const uint8_t value = i_vertices[( vertex * i_vertexSize ) + plane];
+				values[i] = ZigZag( static_cast<uint8_t>( value - previous[plane] ) );
+				largestValue = std::max( largestValue, values[i] );
+				previous[plane] = value;
+			}
+
+			unsigned int widthCode;
+			if ( largestValue == 0 )
+			{
+				widthCode = 0;
+			}
+			else if ( largestValue < 4 )
+			{
+				widthCode = 1;
+				for ( unsigned int i = 0; i < blockSize; i += 4 )
+				{
+					o_encodedData.push_back( static_cast<uint8_t>( values[i] | ( values[i + 1] << 2 ) | ( values[i + 2] << 4 ) | ( values[i + 3] << 6 ) ) );
+				}
+			}
+			else if ( largestValue < 16 )
+			{
+				widthCode = 2;
+				for ( unsigned int i = 0; i < blockSize; i += 2 )
+				{
+					o_encodedData.push_back( static_cast<uint8_t>( values[i] | ( values[i + 1] << 4 ) ) );
+				}
+			}
+			else
+			{
+				widthCode = 3;
+				o_encodedData.insert( o_encodedData.end(), values, values + blockSize );
+			}
+			o_encodedData[headerOffset + ( plane / 4 )] |= static_cast<uint8_t>( widthCode << ( ( plane % 4 ) * 2 ) );
+		}
+	}
+}
+
+void Engine::AssetBuild::MeshCompression::RotateTriangles( std::vector<uint32_t>& io_indices )
+{
+	// When consecutive triangles share an edge (like in a strip) the shared vertex can usually come first.
+	// The encoded indices of each submesh are relative to its first vertex,
+	// but that only changes the first delta of each submesh and so the absolute indices are good enough to choose with
+	uint32_t previous = 0;
+	for ( size_t i = 0; ( i + 3 ) <= io_indices.size(); i += 3 )
+	{
+		const uint32_t triangle[3] = { io_indices[i], io_indices[i + 1], io_indices[i + 2] };
+		unsigned int bestRotation = 0;
+		unsigned int bestCost = ~0u;
+		for ( unsigned int rotation = 0; rotation < 3; ++rotation )
+		{
+			uint32_t last = previous;
+			unsigned int cost = 0;
+			for ( unsigned int corner = 0; corner < 3; ++corner )
+			{
+				const uint32_t index = triangle[( rotation + corner ) % 3];
+				cost += GetByteCount( ZigZag( index - last ) );
+				last = index;
+			}
+			if ( cost < bestCost )
+			{
+				bestCost = cost;
+				bestRotation = rotation;
+			}
+		}
+		for ( unsigned int corner = 0; corner < 3; ++corner )
+		{
+			io_indices[i + corner] = triangle[( bestRotation + corner ) % 3];
+		}
+		previous = io_indices[i + 2];
+	}
+}
+
+void Engine::AssetBuild::MeshCompression::EncodeIndices( const std::vector<uint32_t>& i_indices, std::vector<uint8_t>& o_encodedData )
+{
+	const size_t indexCount = i_indices.size();
+
+	std::vector<uint32_t> deltas( indexCount );
+	{
+		uint32_t previous = 0;
+		for ( size_t i = 0; i < indexCount; ++i )
+		{
+			deltas[i] = ZigZag( i_indices[i] - previous );
+			previous = i_indices[i];
+		}
+	}
+
+	const size_t controlSize = ( indexCount + 3 ) / 4;
+	o_encodedData.assign( controlSize, 0 );
+	for ( size_t i = 0; i < indexCount; ++i )
+	{
+		const unsigned int byteCount = GetByteCount( deltas[i] );
+		o_encodedData[i / 4] |= static_cast<uint8_t>( ( byteCount - 1 ) << ( ( i % 4 ) * 2 ) );
+		for ( unsigned int byte = 0; byte < byteCount; ++byte )
+		{
+			o_encodedData.push_back( static_cast<uint8_t>( deltas[i] >> ( byte * 8 ) ) );
+		}
+	}
+}
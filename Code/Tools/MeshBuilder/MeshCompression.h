@@ -0,0 +1,25 @@
+#ifndef MESHBUILDER_MESHCOMPRESSION_H
+#define MESHBUILDER_MESHCOMPRESSION_H
+
+#include <cstddef>
+#include "MeshData.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace MeshCompression
+		{
+			// Encoders for the format that Engine/Graphics/MeshCodec.h decodes
+			void EncodeVertices( const uint8_t* const i_vertices, const uint32_t i_vertexCount, const size_t i_vertexSize,
+				std::vector<uint8_t>& o_encodedData );
+			// Rotates each triangle (which doesn't change its winding) to whichever starting corner makes its deltas the cheapest to encode.
+			// This is done to the mesh's indices before anything else depends on the order of the corners (like the BVH),
+			// so that the encoded indices decode to exactly the index buffer that everything else saw
+			void RotateTriangles( std::vector<uint32_t>& io_indices );
+			void EncodeIndices( const std::vector<uint32_t>& i_indices, std::vector<uint8_t>& o_encodedData );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef MESHBUILDER_MESHDATA_H
+#define MESHBUILDER_MESHDATA_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../../Engine/Graphics/MeshFormat.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		// The records that are stored in built meshes are the ones that the runtime reads (see MeshFormat.h)
+		typedef Engine::Mesh::sVertex sVertex;
+		typedef Engine::Mesh::sVertexAttributes sVertexAttributes;
+		typedef Engine::Mesh::sLod sLod;
+		typedef Engine::Mesh::sCluster sCluster;
+		typedef Engine::Mesh::sSubmesh sSubmesh;
+
+		struct sMesh
+		{
+			std::vector<sVertex> vertices;
+			std::vector<uint32_t> indices;
+			std::vector<sLod> lods;
+			std::vector<sCluster> clusters;
+			std::vector<sSubmesh> submeshes;
+			// The names of the materials that the submeshes refer to by index
+			std::vector<std::string> materialSlots;
+			Engine::Mesh::sBounds bounds;
+			// Only filled in when a BVH is built for ray queries
+			std::vector<Engine::Mesh::sBvhNode> bvhNodes;
+			std::vector<Engine::Mesh::sBvhTrianglePacket> bvhTrianglePackets;
+		};
+	}
+}
+
+#endif
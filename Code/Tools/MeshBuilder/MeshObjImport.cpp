@@ -0,0 +1,733 @@
+#include "MeshObjImport.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+#include "../AssetBuildLibrary/Parallel.h"
+#include "../AssetBuildLibrary/UtilityFunctions.h"
+#include "../VertexWelding/cVertexWelder.h"
+#include "../../Engine/Platform/Platform.h"
+
+namespace
+{
+	using Engine::AssetBuild::sVertex;
+	using Engine::AssetBuild::sSubmesh;
+	using Engine::AssetBuild::sMesh;
+
+	// Chunks smaller than this aren't worth handing to another thread
+	const size_t s_minimumChunkSize = 256 * 1024;
+	// Faces before a chunk's first "usemtl" use whichever material was current at the end of the previous chunk
+	const uint32_t s_inheritedMaterial = UINT_MAX;
+	const uint32_t s_noTexcoord = UINT_MAX;
+
+	// An index as it was written in the file. Negative OBJ indices are relative to the elements read so far,
+	// which a chunk only knows about for itself, and so they are stored relative to the start of the chunk
+	// (which can still be negative) and fixed up when the chunks are merged
+	struct sCorner
+	{
+		int32_t position;
+		int32_t texcoord;
+		uint8_t flags;
+	};
+	enum eCornerFlags : uint8_t
+	{
+		CORNER_POSITIONRELATIVE = 1 << 0,
+		CORNER_TEXCOORDRELATIVE = 1 << 1,
+		CORNER_HASTEXCOORD = 1 << 2,
+	};
+
+	struct sChunk
+	{
+		const char* begin;
+		const char* end;
+
+		std::vector<float> positions;	// xyz
+		std::vector<uint8_t> colors;	// rgba for every position
+		std::vector<float> texcoords;	// uv
+		std::vector<sCorner> corners;	// 3 for every triangle
+		std::vector<uint32_t> triangleMaterials;	// an index into materialNames, or s_inheritedMaterial
+		std::vector<std::string> materialNames;
+		std::vector<std::string> materialLibraries;
+		uint32_t finalMaterial;
+		uint32_t lineCount;
+
+		// The merged, absolute position and texcoord indices of every corner
+		std::vector<uint32_t> resolvedPositions;
+		std::vector<uint32_t> resolvedTexcoords;
+
+		const char* errorMessage;
+		uint32_t errorLine;	// counted from the start of the chunk
+
+		sChunk() : begin( NULL ), end( NULL ), finalMaterial( s_inheritedMaterial ), lineCount( 0 ), errorMessage( NULL ), errorLine( 0 ) {}
+	};
+
+	bool IsSpace( const char i_character ) { return ( i_character == ' ' ) || ( i_character == '\t' ) || ( i_character == '\r' ); }
+	const char* SkipSpaces( const char* i_position, const char* const i_lineEnd );
+	bool IsKeyword( const char* const i_begin, const char* const i_end, const char* const i_keyword );
+	bool ParseFloat( const char*& io_position, const char* const i_lineEnd, float& o_value );
+	bool ParseInteger( const char*& io_position, const char* const i_lineEnd, int64_t& o_value );
+	bool ParseIndex( const char*& io_position, const char* const i_lineEnd, const size_t i_countSoFar, int32_t& o_index, bool& o_isRelative );
+	bool ParseCorner( const char*& io_position, const char* const i_lineEnd, const sChunk& i_chunk, sCorner& o_corner );
+	std::string GetRestOfLine( const char* const i_position, const char* const i_lineEnd );
+	void ParseChunk( sChunk& io_chunk );
+	bool ParseLine( const char* i_position, const char* const i_lineEnd, sChunk& io_chunk, uint32_t& io_currentMaterial,
+		std::vector<sCorner>& io_faceCorners );
+	bool ResolveChunkIndices( sChunk& io_chunk, const uint32_t i_positionOffset, const uint32_t i_texcoordOffset,
+		const uint32_t i_positionCount, const uint32_t i_texcoordCount );
+	bool LoadMaterialNames( const std::string& i_path, std::vector<std::string>& io_materialNames );
+}
+
+bool Engine::AssetBuild::MeshObjImport::LoadFile( const char* const i_path, sMesh& o_mesh )
+{
+	Engine::Platform::sDataFromFile fileData;
+	{
+		std::string errorMessage;
+		if ( !Engine::Platform::LoadBinaryFile( i_path, fileData, &errorMessage ) )
+		{
+			Engine::AssetBuild::OutputErrorMessage( errorMessage.c_str(), i_path );
+			return false;
+		}
+	}
+
+	bool wereThereErrors = false;
+	const char* const fileBegin = reinterpret_cast<const char*>( fileData.data );
+	const char* const fileEnd = fileBegin + fileData.size;
+
+	// Split the file into chunks that each start at the beginning of a line
+	std::vector<sChunk> chunks;
+	{
+		const size_t maxChunkCount = static_cast<size_t>( Engine::AssetBuild::GetWorkerThreadCount() ) * 4;
+		const size_t chunkCount = std::max<size_t>( std::min( fileData.size / s_minimumChunkSize, maxChunkCount ), 1 );
+		chunks.resize( chunkCount );
+		const char* chunkBegin = fileBegin;
+		for ( size_t i = 0; i < chunkCount; ++i )
+		{
+			const char* chunkEnd = fileEnd;
+			if ( ( i + 1 ) < chunkCount )
+			{
+				chunkEnd = std::max( fileBegin + ( ( fileData.size * ( i + 1 ) ) / chunkCount ), chunkBegin );
+				const void* const newline = memchr( chunkEnd, '\n', fileEnd - chunkEnd );
+				chunkEnd = newline ? ( reinterpret_cast<const char*>( newline ) + 1 ) : fileEnd;
+			}
+			chunks[i].begin = chunkBegin;
+			chunks[i].end = chunkEnd;
+			chunkBegin = chunkEnd;
+		}
+	}
+	Engine::AssetBuild::ParallelFor( chunks.size(), [&chunks]( const size_t i_index ) { ParseChunk( chunks[i_index] ); } );
+
+	// Every chunk's relative indices are fixed up with the number of elements in the chunks before it
+	std::vector<uint32_t> positionOffsets( chunks.size() ), texcoordOffsets( chunks.size() );
+	uint32_t positionCount = 0, texcoordCount = 0, triangleCount = 0;
+	{
+		uint32_t lineOffset = 0;
+		for ( size_t i = 0; i < chunks.size(); ++i )
+		{
+			const sChunk& chunk = chunks[i];
+			if ( chunk.errorMessage )
+			{
+				std::ostringstream errorMessage;
+				errorMessage << "Line " << ( lineOffset + chunk.errorLine ) << ": " << chunk.errorMessage;
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path );
+				wereThereErrors = true;
+				goto OnExit;
+			}
+			positionOffsets[i] = positionCount;
+			texcoordOffsets[i] = texcoordCount;
+			positionCount += static_cast<uint32_t>( chunk.positions.size() / 3 );
+			texcoordCount += static_cast<uint32_t>( chunk.texcoords.size() / 2 );
+			triangleCount += static_cast<uint32_t>( chunk.triangleMaterials.size() );
+			lineOffset += chunk.lineCount;
+		}
+	}
+	{
+		std::vector<uint8_t> areChunkIndicesValid( chunks.size() );
+		Engine::AssetBuild::ParallelFor( chunks.size(), [&]( const size_t i_index )
+			{
+				areChunkIndicesValid[i_index] = ResolveChunkIndices( chunks[i_index], positionOffsets[i_index], texcoordOffsets[i_index],
+					positionCount, texcoordCount );
+			} );
+		if ( std::find( areChunkIndicesValid.begin(), areChunkIndicesValid.end(), 0 ) != areChunkIndicesValid.end() )
+		{
+			Engine::AssetBuild::OutputErrorMessage( "A face refers to a vertex position or texture coordinate that doesn't exist", i_path );
+			wereThereErrors = true;
+			goto OnExit;
+		}
+	}
+
+	{
+		// Each material becomes a slot (in the order that they are first used by a face)
+		std::vector<uint32_t> triangleSlots;
+		triangleSlots.reserve( triangleCount );
+		{
+			std::unordered_map<std::string, uint32_t> materialNamesToSlots;
+			uint32_t currentSlot = UINT_MAX;
+			for ( std::vector<sChunk>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk )
+			{
+				const uint32_t inheritedSlot = currentSlot;
+				std::vector<uint32_t> localMaterialsToSlots( chunk->materialNames.size(), UINT_MAX );
+				for ( std::vector<uint32_t>::const_iterator material = chunk->triangleMaterials.begin(); material != chunk->triangleMaterials.end(); ++material )
+				{
+					uint32_t slot = ( *material == s_inheritedMaterial ) ? inheritedSlot : localMaterialsToSlots[*material];
+					if ( slot == UINT_MAX )
+					{
+						// Faces before the first "usemtl" don't have a material name
+						const std::string name = ( *material == s_inheritedMaterial ) ? std::string() : chunk->materialNames[*material];
+						const std::unordered_map<std::string, uint32_t>::const_iterator existingSlot = materialNamesToSlots.find( name );
+						if ( existingSlot != materialNamesToSlots.end() )
+						{
+							slot = existingSlot->second;
+						}
+						else
+						{
+							slot = static_cast<uint32_t>( o_mesh.materialSlots.size() );
+							materialNamesToSlots.insert( std::make_pair( name, slot ) );
+							o_mesh.materialSlots.push_back( name );
+						}
+						if ( *material != s_inheritedMaterial )
+						{
+							localMaterialsToSlots[*material] = slot;
+						}
+					}
+					triangleSlots.push_back( slot );
+				}
+				if ( chunk->finalMaterial != s_inheritedMaterial )
+				{
+					// A material that was selected but not used by any of the chunk's faces doesn't have a slot yet
+					currentSlot = localMaterialsToSlots[chunk->finalMaterial];
+					if ( currentSlot == UINT_MAX )
+					{
+						const std::string& name = chunk->materialNames[chunk->finalMaterial];
+						const std::unordered_map<std::string, uint32_t>::const_iterator existingSlot = materialNamesToSlots.find( name );
+						if ( existingSlot != materialNamesToSlots.end() )
+						{
+							currentSlot = existingSlot->second;
+						}
+						else
+						{
+							currentSlot = static_cast<uint32_t>( o_mesh.materialSlots.size() );
+							materialNamesToSlots.insert( std::make_pair( name, currentSlot ) );
+							o_mesh.materialSlots.push_back( name );
+						}
+					}
+				}
+			}
+		}
+
+		// Materials that are used must be defined by the file's material libraries (if it has any)
+		{
+			std::vector<std::string> libraries;
+			for ( std::vector<sChunk>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk )
+			{
+				for ( std::vector<std::string>::const_iterator library = chunk->materialLibraries.begin(); library != chunk->materialLibraries.end(); ++library )
+				{
+					if ( std::find( libraries.begin(), libraries.end(), *library ) == libraries.end() )
+					{
+						libraries.push_back( *library );
+					}
+				}
+			}
+			if ( !libraries.empty() )
+			{
+				const std::string sourcePath( i_path );
+				const size_t directoryEnd = sourcePath.find_last_of( "/\\" );
+				const std::string directory = ( directoryEnd != std::string::npos ) ? sourcePath.substr( 0, directoryEnd + 1 ) : std::string();
+				std::vector<std::string> definedMaterials;
+				for ( std::vector<std::string>::const_iterator library = libraries.begin(); library != libraries.end(); ++library )
+				{
+					if ( !LoadMaterialNames( directory + *library, definedMaterials ) )
+					{
+						wereThereErrors = true;
+						goto OnExit;
+					}
+				}
+				std::vector<uint8_t> isSlotUsed( o_mesh.materialSlots.size(), 0 );
+				for ( std::vector<uint32_t>::const_iterator slot = triangleSlots.begin(); slot != triangleSlots.end(); ++slot )
+				{
+					isSlotUsed[*slot] = 1;
+				}
+				for ( size_t i = 0; i < o_mesh.materialSlots.size(); ++i )
+				{
+					const std::string& name = o_mesh.materialSlots[i];
+					if ( isSlotUsed[i] && !name.empty() && ( std::find( definedMaterials.begin(), definedMaterials.end(), name ) == definedMaterials.end() ) )
+					{
+						std::ostringstream errorMessage;
+						errorMessage << "The material \"" << name << "\" isn't defined in any of the mesh's material libraries";
+						Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path );
+						wereThereErrors = true;
+						goto OnExit;
+					}
+				}
+			}
+		}
+
+		// The triangles are grouped by slot (keeping their order within each one) so that every submesh is a single range
+		std::vector<uint32_t> slotTriangleOffsets( o_mesh.materialSlots.size() + 1, 0 );
+		for ( std::vector<uint32_t>::const_iterator slot = triangleSlots.begin(); slot != triangleSlots.end(); ++slot )
+		{
+			++slotTriangleOffsets[*slot + 1];
+		}
+		for ( size_t i = 1; i < slotTriangleOffsets.size(); ++i )
+		{
+			slotTriangleOffsets[i] += slotTriangleOffsets[i - 1];
+		}
+		for ( size_t i = 0; ( i + 1 ) < slotTriangleOffsets.size(); ++i )
+		{
+			if ( slotTriangleOffsets[i + 1] > slotTriangleOffsets[i] )
+			{
+				sSubmesh submesh = {};
+				submesh.firstIndex = slotTriangleOffsets[i] * 3;
+				submesh.indexCount = ( slotTriangleOffsets[i + 1] - slotTriangleOffsets[i] ) * 3;
+				submesh.materialSlot = static_cast<uint32_t>( i );
+				o_mesh.submeshes.push_back( submesh );
+			}
+		}
+
+		// Corners that have the same position and texture coordinate become a single vertex
+		o_mesh.indices.resize( static_cast<size_t>( triangleCount ) * 3 );
+		Engine::AssetBuild::cVertexWelder welder( 2, positionCount );
+		size_t triangleIndex = 0;
+		for ( std::vector<sChunk>::const_iterator chunk = chunks.begin(); chunk != chunks.end(); ++chunk )
+		{
+			for ( size_t i = 0; i < chunk->triangleMaterials.size(); ++i, ++triangleIndex )
+			{
+				const uint32_t outputIndex = slotTriangleOffsets[triangleSlots[triangleIndex]]++ * 3;
+				for ( size_t j = 0; j < 3; ++j )
+				{
+					const uint32_t position = chunk->resolvedPositions[( i * 3 ) + j];
+					const uint32_t texcoord = chunk->resolvedTexcoords[( i * 3 ) + j];
+					const uint32_t key[] = { position, texcoord };
+					bool isNewVertex;
+					const uint32_t vertexIndex = welder.Weld( key, &isNewVertex );
+					if ( isNewVertex )
+					{
+						// The position and color live in whichever chunk defined them
+						const size_t positionChunk = static_cast<size_t>(
+							std::upper_bound( positionOffsets.begin(), positionOffsets.end(), position ) - positionOffsets.begin() ) - 1;
+						const size_t localPosition = position - positionOffsets[positionChunk];
+						const sChunk& positionSource = chunks[positionChunk];
+						sVertex vertex;
+						vertex.x = positionSource.positions[( localPosition * 3 ) + 0];
+						vertex.y = positionSource.positions[( localPosition * 3 ) + 1];
+						vertex.z = positionSource.positions[( localPosition * 3 ) + 2];
+						vertex.r = positionSource.colors[( localPosition * 4 ) + 0];
+						vertex.g = positionSource.colors[( localPosition * 4 ) + 1];
+						vertex.b = positionSource.colors[( localPosition * 4 ) + 2];
+						vertex.a = positionSource.colors[( localPosition * 4 ) + 3];
+						vertex.u = vertex.v = 0.0f;
+						if ( texcoord != s_noTexcoord )
+						{
+							const size_t texcoordChunk = static_cast<size_t>(
+								std::upper_bound( texcoordOffsets.begin(), texcoordOffsets.end(), texcoord ) - texcoordOffsets.begin() ) - 1;
+							const size_t localTexcoord = texcoord - texcoordOffsets[texcoordChunk];
+							vertex.u = chunks[texcoordChunk].texcoords[( localTexcoord * 2 ) + 0];
+							vertex.v = chunks[texcoordChunk].texcoords[( localTexcoord * 2 ) + 1];
+						}
+						o_mesh.vertices.push_back( vertex );
+					}
+					o_mesh.indices[outputIndex + j] = vertexIndex;
+				}
+			}
+		}
+	}
+
+	// A mesh without any materials is a single submesh, which MeshBuilder creates for itself
+	if ( ( o_mesh.materialSlots.size() == 1 ) && o_mesh.materialSlots[0].empty() )
+	{
+		o_mesh.submeshes.clear();
+		o_mesh.materialSlots.clear();
+	}
+	if ( o_mesh.indices.empty() )
+	{
+		Engine::AssetBuild::OutputErrorMessage( "The mesh doesn't have any faces", i_path );
+		wereThereErrors = true;
+	}
+
+OnExit:
+
+	fileData.Free();
+	return !wereThereErrors;
+}
+
+namespace
+{
+	const char* SkipSpaces( const char* i_position, const char* const i_lineEnd )
+	{
+		while ( ( i_position < i_lineEnd ) && IsSpace( *i_position ) )
+		{
+			++i_position;
+		}
+		return i_position;
+	}
+
+	bool IsKeyword( const char* const i_begin, const char* const i_end, const char* const i_keyword )
+	{
+		const size_t length = strlen( i_keyword );
+		return ( static_cast<size_t>( i_end - i_begin ) == length ) && ( memcmp( i_begin, i_keyword, length ) == 0 );
+	}
+
+	bool ParseFloat( const char*& io_position, const char* const i_lineEnd, float& o_value )
+	{
+		// Parsing by hand is much faster than strtof() (which also depends on the locale).
+		// Up to 19 significant digits are accumulated exactly and then scaled once by a power of 10
+		static const double s_powersOf10[] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+		};
+		const char* position = SkipSpaces( io_position, i_lineEnd );
+		bool isNegative = false;
+		if ( ( position < i_lineEnd ) && ( ( *position == '-' ) || ( *position == '+' ) ) )
+		{
+			isNegative = *position == '-';
+			++position;
+		}
+		uint64_t mantissa = 0;
+		int digitCount = 0, exponent = 0;
+		bool wereThereDigits = false;
+		for ( ; ( position < i_lineEnd ) && ( *position >= '0' ) && ( *position <= '9' ); ++position, wereThereDigits = true )
+		{
+			if ( digitCount < 19 )
+			{
+				mantissa = ( mantissa * 10 ) + ( *position - '0' );
+				digitCount += ( mantissa != 0 ) ? 1 : 0;
+			}
+			else
+			{
+				++exponent;
+			}
+		}
+		if ( ( position < i_lineEnd ) && ( *position == '.' ) )
+		{
+			for ( ++position; ( position < i_lineEnd ) && ( *position >= '0' ) && ( *position <= '9' ); ++position, wereThereDigits = true )
+			{
+				if ( digitCount < 19 )
+				{
+					mantissa = ( mantissa * 10 ) + ( *position - '0' );
+					digitCount += ( mantissa != 0 ) ? 1 : 0;
+					--exponent;
+				}
+			}
+		}
+		if ( !wereThereDigits )
+		{
+			return false;
+		}
+		if ( ( position < i_lineEnd ) && ( ( *position == 'e' ) || ( *position == 'E' ) ) )
+		{
+			++position;
+			int64_t explicitExponent;
+			if ( !ParseInteger( position, i_lineEnd, explicitExponent ) )
+			{
+				return false;
+			}
+			exponent += static_cast<int>( std::max<int64_t>( std::min<int64_t>( explicitExponent, 1000 ), -1000 ) );
+		}
+
+		double value = static_cast<double>( mantissa );
+		if ( ( exponent >= 0 ) && ( exponent <= 22 ) )
+		{
+			value *= s_powersOf10[exponent];
+		}
+		else if ( ( exponent < 0 ) && ( exponent >= -22 ) )
+		{
+			value /= s_powersOf10[-exponent];
+		}
+		else if ( mantissa != 0 )
+		{
+			value *= std::pow( 10.0, exponent );
+		}
+		o_value = static_cast<float>( isNegative ? -value : value );
+		io_position = position;
+		return true;
+	}
+
+	bool ParseInteger( const char*& io_position, const char* const i_lineEnd, int64_t& o_value )
+	{
+		const char* position = io_position;
+		bool isNegative = false;
+		if ( ( position < i_lineEnd ) && ( ( *position == '-' ) || ( *position == '+' ) ) )
+		{
+			isNegative = *position == '-';
+			++position;
+		}
+		const char* const digitsBegin = position;
+		int64_t value = 0;
+		for ( ; ( position < i_lineEnd ) && ( *position >= '0' ) && ( *position <= '9' ); ++position )
+		{
+			// Anything this large is an error anyway
+			value = std::min<int64_t>( ( value * 10 ) + ( *position - '0' ), INT64_C( 1 ) << 40 );
+		}
+		if ( position == digitsBegin )
+		{
+			return false;
+		}
+		o_value = isNegative ? -value : value;
+		io_position = position;
+		return true;
+	}
+
+	bool ParseIndex( const char*& io_position, const char* const i_lineEnd, const size_t i_countSoFar, int32_t& o_index, bool& o_isRelative )
+	{
+		int64_t index;
+		if ( !ParseInteger( io_position, i_lineEnd, index ) || ( index == 0 ) )
+		{
+			return false;
+		}
+		// Positive indices start at 1, and negative ones count back from the most recent element
+		o_isRelative = index < 0;
+		const int64_t resolvedIndex = o_isRelative ? ( static_cast<int64_t>( i_countSoFar ) + index ) : ( index - 1 );
+		if ( ( resolvedIndex > INT_MAX ) || ( resolvedIndex < INT_MIN ) )
+		{
+			return false;
+		}
+		o_index = static_cast<int32_t>( resolvedIndex );
+		return true;
+	}
+
+	bool ParseCorner( const char*& io_position, const char* const i_lineEnd, const sChunk& i_chunk, sCorner& o_corner )
+	{
+		// v, v/vt, v//vn, or v/vt/vn
+		const char* position = io_position;
+		o_corner.flags = 0;
+		o_corner.texcoord = -1;
+		bool isRelative;
+		if ( !ParseIndex( position, i_lineEnd, i_chunk.positions.size() / 3, o_corner.position, isRelative ) )
+		{
+			return false;
+		}
+		o_corner.flags |= isRelative ? CORNER_POSITIONRELATIVE : 0;
+		if ( ( position < i_lineEnd ) && ( *position == '/' ) )
+		{
+			++position;
+			if ( ( position < i_lineEnd ) && ( *position != '/' ) )
+			{
+				if ( !ParseIndex( position, i_lineEnd, i_chunk.texcoords.size() / 2, o_corner.texcoord, isRelative ) )
+				{
+					return false;
+				}
+				o_corner.flags |= CORNER_HASTEXCOORD | ( isRelative ? CORNER_TEXCOORDRELATIVE : 0 );
+			}
+			if ( ( position < i_lineEnd ) && ( *position == '/' ) )
+			{
+				// Normals aren't used
+				++position;
+				int64_t normal;
+				if ( !ParseInteger( position, i_lineEnd, normal ) )
+				{
+					return false;
+				}
+			}
+		}
+		if ( ( position < i_lineEnd ) && !IsSpace( *position ) )
+		{
+			return false;
+		}
+		io_position = position;
+		return true;
+	}
+
+	std::string GetRestOfLine( const char* const i_position, const char* const i_lineEnd )
+	{
+		const char* const begin = SkipSpaces( i_position, i_lineEnd );
+		const char* end = i_lineEnd;
+		while ( ( end > begin ) && IsSpace( *( end - 1 ) ) )
+		{
+			--end;
+		}
+		return std::string( begin, end );
+	}
+
+	void ParseChunk( sChunk& io_chunk )
+	{
+		// Roughly one vertex per 40 bytes and two triangles per vertex, to avoid most reallocations
+		const size_t estimatedVertexCount = ( io_chunk.end - io_chunk.begin ) / 40;
+		io_chunk.positions.reserve( estimatedVertexCount * 3 );
+		io_chunk.corners.reserve( estimatedVertexCount * 6 );
+
+		uint32_t currentMaterial = s_inheritedMaterial;
+		std::vector<sCorner> faceCorners;
+		const char* position = io_chunk.begin;
+		while ( position < io_chunk.end )
+		{
+			const void* const newline = memchr( position, '\n', io_chunk.end - position );
+			const char* const lineEnd = newline ? reinterpret_cast<const char*>( newline ) : io_chunk.end;
+			++io_chunk.lineCount;
+			if ( !ParseLine( position, lineEnd, io_chunk, currentMaterial, faceCorners ) )
+			{
+				io_chunk.errorLine = io_chunk.lineCount;
+				return;
+			}
+			position = lineEnd + 1;
+		}
+		io_chunk.finalMaterial = currentMaterial;
+	}
+
+	bool ParseLine( const char* i_position, const char* const i_lineEnd, sChunk& io_chunk, uint32_t& io_currentMaterial,
+		std::vector<sCorner>& io_faceCorners )
+	{
+		const char* const keyword = SkipSpaces( i_position, i_lineEnd );
+		if ( ( keyword == i_lineEnd ) || ( *keyword == '#' ) )
+		{
+			return true;
+		}
+		const char* keywordEnd = keyword;
+		while ( ( keywordEnd < i_lineEnd ) && !IsSpace( *keywordEnd ) )
+		{
+			++keywordEnd;
+		}
+		const char* position = keywordEnd;
+
+		if ( IsKeyword( keyword, keywordEnd, "v" ) )
+		{
+			float values[6];
+			unsigned int valueCount = 0;
+			while ( ( valueCount < 6 ) && ParseFloat( position, i_lineEnd, values[valueCount] ) )
+			{
+				++valueCount;
+			}
+			if ( valueCount < 3 )
+			{
+				io_chunk.errorMessage = "A vertex position must have x, y, and z coordinates";
+				return false;
+			}
+			io_chunk.positions.insert( io_chunk.positions.end(), values, values + 3 );
+			// Six values are a position and a color (four would be a position and a w, which is ignored)
+			uint8_t color[4] = { 255, 255, 255, 255 };
+			if ( valueCount == 6 )
+			{
+				for ( unsigned int i = 0; i < 3; ++i )
+				{
+					color[i] = static_cast<uint8_t>( ( std::max( std::min( values[3 + i], 1.0f ), 0.0f ) * 255.0f ) + 0.5f );
+				}
+			}
+			io_chunk.colors.insert( io_chunk.colors.end(), color, color + 4 );
+		}
+		else if ( IsKeyword( keyword, keywordEnd, "vt" ) )
+		{
+			float u, v = 0.0f;
+			if ( !ParseFloat( position, i_lineEnd, u ) )
+			{
+				io_chunk.errorMessage = "A texture coordinate must have at least a u coordinate";
+				return false;
+			}
+			ParseFloat( position, i_lineEnd, v );
+			io_chunk.texcoords.push_back( u );
+			io_chunk.texcoords.push_back( v );
+		}
+		else if ( IsKeyword( keyword, keywordEnd, "f" ) )
+		{
+			io_faceCorners.clear();
+			for ( position = SkipSpaces( position, i_lineEnd ); position < i_lineEnd; position = SkipSpaces( position, i_lineEnd ) )
+			{
+				sCorner corner;
+				if ( !ParseCorner( position, i_lineEnd, io_chunk, corner ) )
+				{
+					io_chunk.errorMessage = "A face has an invalid vertex (which must be v, v/vt, v//vn, or v/vt/vn)";
+					return false;
+				}
+				io_faceCorners.push_back( corner );
+			}
+			if ( io_faceCorners.size() < 3 )
+			{
+				io_chunk.errorMessage = "A face must have at least 3 vertices";
+				return false;
+			}
+			// Polygons are triangulated as fans
+			for ( size_t i = 2; i < io_faceCorners.size(); ++i )
+			{
+				io_chunk.corners.push_back( io_faceCorners[0] );
+				io_chunk.corners.push_back( io_faceCorners[i - 1] );
+				io_chunk.corners.push_back( io_faceCorners[i] );
+				io_chunk.triangleMaterials.push_back( io_currentMaterial );
+			}
+		}
+		else if ( IsKeyword( keyword, keywordEnd, "usemtl" ) )
+		{
+			const std::string name = GetRestOfLine( position, i_lineEnd );
+			const std::vector<std::string>::const_iterator existingName = std::find( io_chunk.materialNames.begin(), io_chunk.materialNames.end(), name );
+			io_currentMaterial = static_cast<uint32_t>( existingName - io_chunk.materialNames.begin() );
+			if ( existingName == io_chunk.materialNames.end() )
+			{
+				io_chunk.materialNames.push_back( name );
+			}
+		}
+		else if ( IsKeyword( keyword, keywordEnd, "mtllib" ) )
+		{
+			std::istringstream libraries( GetRestOfLine( position, i_lineEnd ) );
+			std::string library;
+			while ( libraries >> library )
+			{
+				io_chunk.materialLibraries.push_back( library );
+			}
+		}
+		// Everything else (normals, groups, smoothing groups, lines, etc.) isn't needed
+		return true;
+	}
+
+	bool ResolveChunkIndices( sChunk& io_chunk, const uint32_t i_positionOffset, const uint32_t i_texcoordOffset,
+		const uint32_t i_positionCount, const uint32_t i_texcoordCount )
+	{
+		io_chunk.resolvedPositions.resize( io_chunk.corners.size() );
+		io_chunk.resolvedTexcoords.resize( io_chunk.corners.size() );
+		for ( size_t i = 0; i < io_chunk.corners.size(); ++i )
+		{
+			const sCorner& corner = io_chunk.corners[i];
+			const int64_t position = corner.position + ( ( corner.flags & CORNER_POSITIONRELATIVE ) ? static_cast<int64_t>( i_positionOffset ) : 0 );
+			if ( ( position < 0 ) || ( position >= i_positionCount ) )
+			{
+				return false;
+			}
+			io_chunk.resolvedPositions[i] = static_cast<uint32_t>( position );
+			io_chunk.resolvedTexcoords[i] = s_noTexcoord;
+			if ( corner.flags & CORNER_HASTEXCOORD )
+			{
+				const int64_t texcoord = corner.texcoord + ( ( corner.flags & CORNER_TEXCOORDRELATIVE ) ? static_cast<int64_t>( i_texcoordOffset ) : 0 );
+				if ( ( texcoord < 0 ) || ( texcoord >= i_texcoordCount ) )
+				{
+					return false;
+				}
+				io_chunk.resolvedTexcoords[i] = static_cast<uint32_t>( texcoord );
+			}
+		}
+		// The unresolved corners aren't needed anymore
+		std::vector<sCorner>().swap( io_chunk.corners );
+		return true;
+	}
+
+	bool LoadMaterialNames( const std::string& i_path, std::vector<std::string>& io_materialNames )
+	{
+		Engine::Platform::sDataFromFile fileData;
+		{
+			std::string errorMessage;
+			if ( !Engine::Platform::LoadBinaryFile( i_path.c_str(), fileData, &errorMessage ) )
+			{
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.c_str(), i_path.c_str() );
+				return false;
+			}
+		}
+		const char* position = reinterpret_cast<const char*>( fileData.data );
+		const char* const fileEnd = position + fileData.size;
+		while ( position < fileEnd )
+		{
+			const void* const newline = memchr( position, '\n', fileEnd - position );
+			const char* const lineEnd = newline ? reinterpret_cast<const char*>( newline ) : fileEnd;
+			const char* const keyword = SkipSpaces( position, lineEnd );
+			const char* keywordEnd = keyword;
+			while ( ( keywordEnd < lineEnd ) && !IsSpace( *keywordEnd ) )
+			{
+				++keywordEnd;
+			}
+			if ( IsKeyword( keyword, keywordEnd, "newmtl" ) )
+			{
+				io_materialNames.push_back( GetRestOfLine( keywordEnd, lineEnd ) );
+			}
+			position = lineEnd + 1;
+		}
+		fileData.Free();
+		return true;
+	}
+}
@@ -0,0 +1,23 @@
+#ifndef MESHBUILDER_MESHOBJIMPORT_H
+#define MESHBUILDER_MESHOBJIMPORT_H
+
+#include "MeshData.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace MeshObjImport
+		{
+			// Loads the vertices, triangles, and submeshes of a Wavefront OBJ file.
+			// The file is split into chunks on line boundaries that are parsed in parallel,
+			// and the chunks' indices are then fixed up (relative indices are relative to the chunk) while they are merged.
+			// Polygons are triangulated as fans, normals are ignored, and "v x y z r g b" vertex colors are supported.
+			// Faces are grouped into one submesh per "usemtl" material, and if the file names any "mtllib"s
+			// then every material that it uses must be defined in one of them
+			bool LoadFile( const char* const i_path, sMesh& o_mesh );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,617 @@
+#include "MeshSimplification.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+namespace
+{
+	// A symmetric 4x4 matrix (stored as its upper triangle) that accumulates squared distances to planes,
+	// along with the total weight of the planes so that the error can be normalized
+	struct sQuadric
+	{
+		double a2, ab, ac, ad;
+		double b2, bc, bd;
+		double c2, cd;
+		double d2;
+		double weight;
+
+		sQuadric()
+			:
+			a2( 0.0 ), ab( 0.0 ), ac( 0.0 ), ad( 0.0 ),
+			b2( 0.0 ), bc( 0.0 ), bd( 0.0 ),
+			c2( 0.0 ), cd( 0.0 ),
+			d2( 0.0 ),
+			weight( 0.0 )
+		{
+
+		}
+
+		void AddPlane( const double i_a, const double i_b, const double i_c, const double i_d, const double i_weight )
+		{
+			a2 += i_a * i_a * i_weight; ab += i_a * i_b * i_weight; ac += i_a * i_c * i_weight; ad += i_a * i_d * i_weight;
+			b2 += i_b * i_b * i_weight; bc += i_b * i_c * i_weight; bd += i_b * i_d * i_weight;
+			c2 += i_c * i_c * i_weight; cd += i_c * i_d * i_weight;
+			d2 += i_d * i_d * i_weight;
+			weight += i_weight;
+		}
+
+		sQuadric& operator +=( const sQuadric& i_rhs )
+		{
+			a2 += i_rhs.a2; ab += i_rhs.ab; ac += i_rhs.ac; ad += i_rhs.ad;
+			b2 += i_rhs.b2; bc += i_rhs.bc; bd += i_rhs.bd;
+			c2 += i_rhs.c2; cd += i_rhs.cd;
+			d2 += i_rhs.d2;
+			weight += i_rhs.weight;
+			return *this;
+		}
+
+		// Returns the weighted mean squared distance from the given point to the accumulated planes
+		double Evaluate( const double i_x, const double i_y, const double i_z ) const
+		{
+			const double error =
+				( a2 * i_x * i_x ) + ( 2.0 * ab * i_x * i_y ) + ( 2.0 * ac * i_x * i_z ) + ( 2.0 * ad * i_x )
+				+ ( b2 * i_y * i_y ) + ( 2.0 * bc * i_y * i_z ) + ( 2.0 * bd * i_y )
+				+ ( c2 * i_z * i_z ) + ( 2.0 * cd * i_z )
+				+ d2;
+			return ( weight > 0.0 ) ? std::max( error / weight, 0.0 ) : 0.0;
+		}
+	};
+
+	struct sCollapse
+	{
+		uint32_t from, to;
+		double cost;
+		double geometricError;
+
+		bool operator <( const sCollapse& i_rhs ) const
+		{
+			if ( cost != i_rhs.cost )
+			{
+				return cost < i_rhs.cost;
+			}
+			// Ties are broken by vertex index so that the output doesn't depend on the sort implementation
+			return ( from != i_rhs.from ) ? ( from < i_rhs.from ) : ( to < i_rhs.to );
+		}
+	};
+
+	struct sPositionKey
+	{
+		uint32_t x, y, z;
+
+		bool operator ==( const sPositionKey& i_rhs ) const
+		{
+			return ( x == i_rhs.x ) && ( y == i_rhs.y ) && ( z == i_rhs.z );
+		}
+	};
+	struct sPositionKeyHasher
+	{
+		size_t operator ()( const sPositionKey& i_key ) const
+		{
+			return ( i_key.x * 73856093u ) ^ ( i_key.y * 19349663u ) ^ ( i_key.z * 83492791u );
+		}
+	};
+
+	// How much attribute differences (UV distance and normalized color distance)
+	// cost relative to the squared diagonal of the mesh's bounding box
+	const double s_attributeWeight = 0.01;
+	// A level of detail is only kept if it removes at least this fraction of the previous level's triangles
+	const float s_minimumReduction = 0.1f;
+
+	void CalculatePositionIds( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, std::vector<uint32_t>& o_positionIds );
+	void CalculateNextCopies( const std::vector<uint32_t>& i_positionIds, std::vector<uint32_t>& o_nextCopies );
+	void CalculateLockedVertices( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_positionIds, std::vector<bool>& o_isLocked );
+	void CalculateQuadrics( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_positionIds, std::vector<sQuadric>& o_quadrics );
+	void CalculateTriangleAdjacency( const size_t i_vertexCount, const std::vector<uint32_t>& i_indices,
+		std::vector<uint32_t>& o_offsets, std::vector<uint32_t>& o_triangles );
+	double CalculateAttributeDistanceSquared( const Engine::AssetBuild::sVertex& i_a, const Engine::AssetBuild::sVertex& i_b );
+	bool FindCollapsePairs( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_positionIds, const std::vector<uint32_t>& i_nextCopies,
+		const std::vector<uint32_t>& i_adjacencyOffsets, const std::vector<uint32_t>& i_adjacentTriangles,
+		const uint32_t i_from, const uint32_t i_to, std::vector<std::pair<uint32_t, uint32_t> >& o_pairs );
+	bool DoesCollapsePinchSurface( const std::vector<uint32_t>& i_indices, const std::vector<uint32_t>& i_positionIds,
+		const std::vector<uint32_t>& i_nextCopies, const std::vector<uint32_t>& i_adjacencyOffsets, const std::vector<uint32_t>& i_adjacentTriangles,
+		const uint32_t i_from, const uint32_t i_to );
+	bool DoesCollapseFlipTriangles( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_positionIds, const uint32_t* const i_trianglesAroundFrom, const uint32_t i_triangleCount,
+		const uint32_t i_from, const uint32_t i_to );
+	float SimplifyLevel( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_positionIds,
+		const std::vector<uint32_t>& i_nextCopies, const std::vector<bool>& i_isLocked, const double i_attributeScale,
+		std::vector<sQuadric>& io_quadrics, const size_t i_targetIndexCount, std::vector<uint32_t>& io_indices );
+}
+
+void Engine::AssetBuild::MeshSimplification::GenerateLods( sMesh& io_mesh, const unsigned int i_maxLodCount, const float i_reductionPerLod )
+{
+	const uint32_t lod0IndexCount = static_cast<uint32_t>( io_mesh.indices.size() );
+	io_mesh.lods.clear();
+	{
+		sLod lod0;
+		lod0.firstIndex = 0;
+		lod0.indexCount = lod0IndexCount;
+		lod0.geometricError = 0.0f;
+		io_mesh.lods.push_back( lod0 );
+	}
+	if ( ( i_maxLodCount <= 1 ) || ( lod0IndexCount == 0 ) )
+	{
+		return;
+	}
+
+	std::vector<uint32_t> positionIds;
+	CalculatePositionIds( io_mesh.vertices, positionIds );
+	std::vector<uint32_t> nextCopies;
+	CalculateNextCopies( positionIds, nextCopies );
+	std::vector<bool> isLocked;
+	CalculateLockedVertices( io_mesh.vertices, io_mesh.indices, positionIds, isLocked );
+	std::vector<sQuadric> quadrics;
+	CalculateQuadrics( io_mesh.vertices, io_mesh.indices, positionIds, quadrics );
+	double attributeScale;
+	{
+		float minimum[3] = { io_mesh.vertices[0].x, io_mesh.vertices[0].y, io_mesh.vertices[0].z };
+		float maximum[3] = { minimum[0], minimum[1], minimum[2] };
+		for ( std::vector<sVertex>::const_iterator i = io_mesh.vertices.begin(); i != io_mesh.vertices.end(); ++i )
+		{
+			minimum[0] = std::min( minimum[0], i->x ); maximum[0] = std::max( maximum[0], i->x );
+			minimum[1] = std::min( minimum[1], i->y ); maximum[1] = std::max( maximum[1], i->y );
+			minimum[2] = std::min( minimum[2], i->z ); maximum[2] = std::max( maximum[2], i->z );
+		}
+		const double dx = maximum[0] - minimum[0], dy = maximum[1] - minimum[1], dz = maximum[2] - minimum[2];
+		attributeScale = s_attributeWeight * ( ( dx * dx ) + ( dy * dy ) + ( dz * dz ) );
+	}
+
+	std::vector<uint32_t> currentIndices( io_mesh.indices );
+	float currentError = 0.0f;
+	for ( unsigned int i = 1; i < i_maxLodCount; ++i )
+	{
+		const size_t previousIndexCount = currentIndices.size();
+		const size_t targetIndexCount = static_cast<size_t>( static_cast<float>( previousIndexCount ) * i_reductionPerLod ) / 3 * 3;
+		const float levelError = SimplifyLevel( io_mesh.vertices, positionIds, nextCopies, isLocked, attributeScale, quadrics,
+			targetIndexCount, currentIndices );
+		if ( static_cast<float>( currentIndices.size() ) > ( static_cast<float>( previousIndexCount ) * ( 1.0f - s_minimumReduction ) ) )
+		{
+			break;
+		}
+		currentError = std::max( currentError, levelError );
+
+		sLod lod;
+		lod.firstIndex = static_cast<uint32_t>( io_mesh.indices.size() );
+		lod.indexCount = static_cast<uint32_t>( currentIndices.size() );
+		lod.geometricError = currentError;
+		io_mesh.indices.insert( io_mesh.indices.end(), currentIndices.begin(), currentIndices.end() );
+		io_mesh.lods.push_back( lod );
+	}
+}
+
+namespace
+{
+	void CalculatePositionIds( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, std::vector<uint32_t>& o_positionIds )
+	{
+		std::unordered_map<sPositionKey, uint32_t, sPositionKeyHasher> positionToId;
+		o_positionIds.resize( i_vertices.size() );
+		for ( size_t i = 0; i < i_vertices.size(); ++i )
+		{
+			sPositionKey key;
+			{
+				// +0.0 and -0.0 must map to the same key
+				const float x = i_vertices[i].x + 0.0f, y = i_vertices[i].y + 0.0f, z = i_vertices[i].z + 0.0f;
+				memcpy( &key.x, &x, sizeof( float ) );
+				memcpy( &key.y, &y, sizeof( float ) );
+				memcpy( &key.z, &z, sizeof( float ) );
+			}
+			o_positionIds[i] = positionToId.insert( std::make_pair( key, static_cast<uint32_t>( i ) ) ).first->second;
+		}
+	}
+
+	void CalculateNextCopies( const std::vector<uint32_t>& i_positionIds, std::vector<uint32_t>& o_nextCopies )
+	{
+		// The vertices that share a position are linked in a ring
+		// (a vertex that isn't on a seam is its own next copy)
+		const size_t vertexCount = i_positionIds.size();
+		o_nextCopies.resize( vertexCount );
+		std::vector<uint32_t> lastCopies( vertexCount );
+		for ( size_t i = 0; i < vertexCount; ++i )
+		{
+			const uint32_t positionId = i_positionIds[i];
+			if ( positionId == i )
+			{
+				o_nextCopies[i] = static_cast<uint32_t>( i );
+			}
+			else
+			{
+				o_nextCopies[i] = positionId;
+				o_nextCopies[lastCopies[positionId]] = static_cast<uint32_t>( i );
+			}
+			lastCopies[positionId] = static_cast<uint32_t>( i );
+		}
+	}
+
+	void CalculateLockedVertices( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_positionIds, std::vector<bool>& o_isLocked )
+	{
+		o_isLocked.assign( i_vertices.size(), false );
+
+		// Borders: a (position space) edge that only one triangle uses
+		{
+			std::unordered_map<uint64_t, int> edgeUseCounts;
+			const size_t triangleCount = i_indices.size() / 3;
+			for ( size_t i = 0; i < triangleCount; ++i )
+			{
+				for ( size_t j = 0; j < 3; ++j )
+				{
+					const uint32_t a = i_positionIds[i_indices[( i * 3 ) + j]];
+					const uint32_t b = i_positionIds[i_indices[( i * 3 ) + ( ( j + 1 ) % 3 )]];
+					const uint64_t edgeKey = ( static_cast<uint64_t>( std::min( a, b ) ) << 32 ) | std::max( a, b );
+					++edgeUseCounts[edgeKey];
+				}
+			}
+			for ( size_t i = 0; i < triangleCount; ++i )
+			{
+				for ( size_t j = 0; j < 3; ++j )
+				{
+					const uint32_t vertexA = i_indices[( i * 3 ) + j];
+					const uint32_t vertexB = i_indices[( i * 3 ) + ( ( j + 1 ) % 3 )];
+					const uint32_t a = i_positionIds[vertexA];
+					const uint32_t b = i_positionIds[vertexB];
+					const uint64_t edgeKey = ( static_cast<uint64_t>( std::min( a, b ) ) << 32 ) | std::max( a, b );
+					if ( edgeUseCounts[edgeKey] != 2 )
+					{
+						o_isLocked[vertexA] = true;
+						o_isLocked[vertexB] = true;
+					}
+				}
+			}
+		}
+	}
+
+	void CalculateQuadrics( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_positionIds, std::vector<sQuadric>& o_quadrics )
+	{
+		o_quadrics.assign( i_vertices.size(), sQuadric() );
+		const size_t triangleCount = i_indices.size() / 3;
+		for ( size_t i = 0; i < triangleCount; ++i )
+		{
+			const Engine::AssetBuild::sVertex& v0 = i_vertices[i_indices[( i * 3 ) + 0]];
+			const Engine::AssetBuild::sVertex& v1 = i_vertices[i_indices[( i * 3 ) + 1]];
+			const Engine::AssetBuild::sVertex& v2 = i_vertices[i_indices[( i * 3 ) + 2]];
+			const double e1[3] = { v1.x - v0.x, v1.y - v0.y, v1.z - v0.z };
+			const double e2[3] = { v2.x - v0.x, v2.y - v0.y, v2.z - v0.z };
+			double normal[3] =
+			{
+				( e1[1] * e2[2] ) - ( e1[2] * e2[1] ),
+				( e1[2] * e2[0] ) - ( e1[0] * e2[2] ),
+				( e1[0] * e2[1] ) - ( e1[1] * e2[0] ),
+			};
+			const double length = std::sqrt( ( normal[0] * normal[0] ) + ( normal[1] * normal[1] ) + ( normal[2] * normal[2] ) );
+			if ( length <= 0.0 )
+			{
+				continue;
+			}
+			normal[0] /= length; normal[1] /= length; normal[2] /= length;
+			const double d = -( ( normal[0] * v0.x ) + ( normal[1] * v0.y ) + ( normal[2] * v0.z ) );
+			const double area = length * 0.5;
+			for ( size_t j = 0; j < 3; ++j )
+			{
+				o_quadrics[i_positionIds[i_indices[( i * 3 ) + j]]].AddPlane( normal[0], normal[1], normal[2], d, area );
+			}
+		}
+	}
+
+	void CalculateTriangleAdjacency( const size_t i_vertexCount, const std::vector<uint32_t>& i_indices,
+		std::vector<uint32_t>& o_offsets, std::vector<uint32_t>& o_triangles )
+	{
+		o_offsets.assign( i_vertexCount + 1, 0 );
+		for ( std::vector<uint32_t>::const_iterator i = i_indices.begin(); i != i_indices.end(); ++i )
+		{
+			++o_offsets[*i + 1];
+		}
+		for ( size_t i = 0; i < i_vertexCount; ++i )
+		{
+			o_offsets[i + 1] += o_offsets[i];
+		}
+		o_triangles.resize( i_indices.size() );
+		std::vector<uint32_t> writePositions( o_offsets.begin(), o_offsets.end() - 1 );
+		for ( size_t i = 0; i < i_indices.size(); ++i )
+		{
+			o_triangles[writePositions[i_indices[i]]++] = static_cast<uint32_t>( i / 3 );
+		}
+	}
+
+	double CalculateAttributeDistanceSquared( const Engine::AssetBuild::sVertex& i_a, const Engine::AssetBuild::sVertex& i_b )
+	{
+		const double du = i_b.u - i_a.u, dv = i_b.v - i_a.v;
+		const double dr = ( i_b.r - i_a.r ) / 255.0, dg = ( i_b.g - i_a.g ) / 255.0, db = ( i_b.b - i_a.b ) / 255.0, da = ( i_b.a - i_a.a ) / 255.0;
+		return ( du * du ) + ( dv * dv ) + ( dr * dr ) + ( dg * dg ) + ( db * db ) + ( da * da );
+	}
+
+	bool FindCollapsePairs( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_positionIds, const std::vector<uint32_t>& i_nextCopies,
+		const std::vector<uint32_t>& i_adjacencyOffsets, const std::vector<uint32_t>& i_adjacentTriangles,
+		const uint32_t i_from, const uint32_t i_to, std::vector<std::pair<uint32_t, uint32_t> >& o_pairs )
+	{
+		// Every copy of the position that is still used must be collapsed at the same time as the others, or else the seam would tear.
+		// A copy whose own triangles use a copy of the target position is collapsed onto that one (which keeps the seam where it was),
+		// and any other copy is collapsed onto whichever copy of the target position has the closest attributes
+		// (which is where the cost of the attribute changes comes from).
+		// A copy whose triangles use more than one copy of the target position can't be collapsed without tearing one of them
+		o_pairs.clear();
+		const uint32_t positionId_to = i_positionIds[i_to];
+		uint32_t from = i_from;
+		do
+		{
+			const uint32_t triangleCount = i_adjacencyOffsets[from + 1] - i_adjacencyOffsets[from];
+			if ( triangleCount > 0 )
+			{
+				uint32_t to = UINT32_MAX;
+				for ( uint32_t i = 0; i < triangleCount; ++i )
+				{
+					const uint32_t* const triangle = &i_indices[i_adjacentTriangles[i_adjacencyOffsets[from] + i] * 3];
+					for ( size_t j = 0; j < 3; ++j )
+					{
+						if ( i_positionIds[triangle[j]] == positionId_to )
+						{
+							if ( ( to != UINT32_MAX ) && ( to != triangle[j] ) )
+							{
+								return false;
+							}
+							to = triangle[j];
+						}
+					}
+				}
+				if ( to == UINT32_MAX )
+				{
+					double closestDistanceSquared = 0.0;
+					uint32_t copy = i_to;
+					do
+					{
+						const double distanceSquared = CalculateAttributeDistanceSquared( i_vertices[from], i_vertices[copy] );
+						if ( ( to == UINT32_MAX ) || ( distanceSquared < closestDistanceSquared ) )
+						{
+							closestDistanceSquared = distanceSquared;
+							to = copy;
+						}
+						copy = i_nextCopies[copy];
+					} while ( copy != i_to );
+				}
+				if ( ( from == i_from ) && ( to != i_to ) )
+				{
+					return false;
+				}
+				o_pairs.push_back( std::make_pair( from, to ) );
+			}
+			from = i_nextCopies[from];
+		} while ( from != i_from );
+		return true;
+	}
+
+	bool DoesCollapsePinchSurface( const std::vector<uint32_t>& i_indices, const std::vector<uint32_t>& i_positionIds,
+		const std::vector<uint32_t>& i_nextCopies, const std::vector<uint32_t>& i_adjacencyOffsets, const std::vector<uint32_t>& i_adjacentTriangles,
+		const uint32_t i_from, const uint32_t i_to )
+	{
+		// The two positions of an edge between two triangles can only share the neighbors that are opposite of the edge;
+		// if they share any other neighbor then merging them would make an edge that more than two triangles use
+		std::vector<uint32_t> neighbors[2];
+		const uint32_t vertices[2] = { i_from, i_to };
+		for ( size_t i = 0; i < 2; ++i )
+		{
+			const uint32_t positionId = i_positionIds[vertices[i]];
+			uint32_t copy = vertices[i];
+			do
+			{
+				for ( uint32_t j = i_adjacencyOffsets[copy]; j < i_adjacencyOffsets[copy + 1]; ++j )
+				{
+					const uint32_t* const triangle = &i_indices[i_adjacentTriangles[j] * 3];
+					for ( size_t k = 0; k < 3; ++k )
+					{
+						if ( i_positionIds[triangle[k]] != positionId )
+						{
+							neighbors[i].push_back( i_positionIds[triangle[k]] );
+						}
+					}
+				}
+				copy = i_nextCopies[copy];
+			} while ( copy != vertices[i] );
+			std::sort( neighbors[i].begin(), neighbors[i].end() );
+			neighbors[i].erase( std::unique( neighbors[i].begin(), neighbors[i].end() ), neighbors[i].end() );
+		}
+		std::vector<uint32_t> sharedNeighbors;
+		std::set_intersection( neighbors[0].begin(), neighbors[0].end(), neighbors[1].begin(), neighbors[1].end(),
+			std::back_inserter( sharedNeighbors ) );
+		return sharedNeighbors.size() > 2;
+	}
+
+	bool DoesCollapseFlipTriangles( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_indices,
+		const std::vector<uint32_t>& i_positionIds, const uint32_t* const i_trianglesAroundFrom, const uint32_t i_triangleCount,
+		const uint32_t i_from, const uint32_t i_to )
+	{
+		const Engine::AssetBuild::sVertex& to = i_vertices[i_to];
+		for ( uint32_t i = 0; i < i_triangleCount; ++i )
+		{
+			const uint32_t* const triangle = &i_indices[i_trianglesAroundFrom[i] * 3];
+			bool willBecomeDegenerate = false;
+			for ( size_t j = 0; j < 3; ++j )
+			{
+				if ( i_positionIds[triangle[j]] == i_positionIds[i_to] )
+				{
+					if ( triangle[j] != i_to )
+					{
+						// The triangle touches a different copy of the target position,
+						// and collapsing onto this copy would tear the seam
+						return true;
+					}
+					willBecomeDegenerate = true;
+				}
+			}
+			if ( willBecomeDegenerate )
+			{
+				continue;
+			}
+
+			double before[3], after[3];
+			{
+				const Engine::AssetBuild::sVertex* corners[3] =
+				{
+					&i_vertices[triangle[0]], &i_vertices[triangle[1]], &i_vertices[triangle[2]]
+				};
+				for ( int pass = 0; pass < 2; ++pass )
+				{
+					const Engine::AssetBuild::sVertex* p[3] = { corners[0], corners[1], corners[2] };
+					if ( pass == 1 )
+					{
+						for ( size_t j = 0; j < 3; ++j )
+						{
+							if ( triangle[j] == i_from )
+							{
+								p[j] = &to;
+							}
+						}
+					}
+					const double e1[3] = { p[1]->x - p[0]->x, p[1]->y - p[0]->y, p[1]->z - p[0]->z };
+					const double e2[3] = { p[2]->x - p[0]->x, p[2]->y - p[0]->y, p[2]->z - p[0]->z };
+					double* const normal = ( pass == 0 ) ? before : after;
+					normal[0] = ( e1[1] * e2[2] ) - ( e1[2] * e2[1] );
+					normal[1] = ( e1[2] * e2[0] ) - ( e1[0] * e2[2] );
+					normal[2] = ( e1[0] * e2[1] ) - ( e1[1] * e2[0] );
+				}
+			}
+			const double dot = ( before[0] * after[0] ) + ( before[1] * after[1] ) + ( before[2] * after[2] );
+			if ( dot <= 0.0 )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	float SimplifyLevel( const std::vector<Engine::AssetBuild::sVertex>& i_vertices, const std::vector<uint32_t>& i_positionIds,
+		const std::vector<uint32_t>& i_nextCopies, const std::vector<bool>& i_isLocked, const double i_attributeScale,
+		std::vector<sQuadric>& io_quadrics, const size_t i_targetIndexCount, std::vector<uint32_t>& io_indices )
+	{
+		const size_t vertexCount = i_vertices.size();
+		double maxError = 0.0;
+		std::vector<uint32_t> adjacencyOffsets, adjacentTriangles;
+		std::vector<sCollapse> collapses;
+		std::vector<uint32_t> remap( vertexCount );
+		std::vector<bool> wasTouched;
+		std::vector<std::pair<uint32_t, uint32_t> > pairs;
+
+		while ( io_indices.size() > i_targetIndexCount )
+		{
+			CalculateTriangleAdjacency( vertexCount, io_indices, adjacencyOffsets, adjacentTriangles );
+
+			collapses.clear();
+			for ( size_t i = 0; i < io_indices.size(); i += 3 )
+			{
+				for ( size_t j = 0; j < 3; ++j )
+				{
+					const uint32_t a = io_indices[i + j];
+					const uint32_t b = io_indices[i + ( ( j + 1 ) % 3 )];
+					for ( int direction = 0; direction < 2; ++direction )
+					{
+						const uint32_t from = ( direction == 0 ) ? a : b;
+						const uint32_t to = ( direction == 0 ) ? b : a;
+						if ( i_isLocked[from] || ( i_positionIds[from] == i_positionIds[to] )
+							|| !FindCollapsePairs( i_vertices, io_indices, i_positionIds, i_nextCopies, adjacencyOffsets, adjacentTriangles, from, to, pairs ) )
+						{
+							continue;
+						}
+						sQuadric quadric = io_quadrics[i_positionIds[from]];
+						quadric += io_quadrics[i_positionIds[to]];
+						sCollapse collapse;
+						collapse.from = from;
+						collapse.to = to;
+						collapse.geometricError = quadric.Evaluate( i_vertices[to].x, i_vertices[to].y, i_vertices[to].z );
+						// A seam collapse costs as much as the copy whose attributes change the most
+						double attributeDistanceSquared = 0.0;
+						bool isAnyCopyLocked = false;
+						for ( std::vector<std::pair<uint32_t, uint32_t> >::const_iterator k = pairs.begin(); k != pairs.end(); ++k )
+						{
+							attributeDistanceSquared = std::max( attributeDistanceSquared,
+								CalculateAttributeDistanceSquared( i_vertices[k->first], i_vertices[k->second] ) );
+							isAnyCopyLocked = isAnyCopyLocked || i_isLocked[k->first];
+						}
+						if ( isAnyCopyLocked )
+						{
+							continue;
+						}
+						collapse.cost = collapse.geometricError + ( attributeDistanceSquared * i_attributeScale );
+						collapses.push_back( collapse );
+					}
+				}
+			}
+			if ( collapses.empty() )
+			{
+				break;
+			}
+			std::sort( collapses.begin(), collapses.end() );
+
+			// Every collapse removes (roughly) two triangles,
+			// and vertices touched by one collapse can't take part in another until the next pass
+			const size_t triangleCountToRemove = ( io_indices.size() - i_targetIndexCount ) / 3;
+			const size_t maxCollapseCount = std::max<size_t>( triangleCountToRemove / 2, 1 );
+			size_t collapseCount = 0;
+			for ( size_t i = 0; i < vertexCount; ++i )
+			{
+				remap[i] = static_cast<uint32_t>( i );
+			}
+			wasTouched.assign( vertexCount, false );
+			for ( std::vector<sCollapse>::const_iterator i = collapses.begin(); ( i != collapses.end() ) && ( collapseCount < maxCollapseCount ); ++i )
+			{
+				// The index buffer isn't changed until after this loop, and so the pairs are the same as when the collapse was found
+				FindCollapsePairs( i_vertices, io_indices, i_positionIds, i_nextCopies, adjacencyOffsets, adjacentTriangles, i->from, i->to, pairs );
+				bool canCollapse = !DoesCollapsePinchSurface( io_indices, i_positionIds, i_nextCopies, adjacencyOffsets, adjacentTriangles, i->from, i->to );
+				for ( std::vector<std::pair<uint32_t, uint32_t> >::const_iterator k = pairs.begin(); ( k != pairs.end() ) && canCollapse; ++k )
+				{
+					const uint32_t* const trianglesAroundFrom = &adjacentTriangles[adjacencyOffsets[k->first]];
+					const uint32_t triangleCountAroundFrom = adjacencyOffsets[k->first + 1] - adjacencyOffsets[k->first];
+					canCollapse = !wasTouched[k->first] && !wasTouched[k->second]
+						&& !DoesCollapseFlipTriangles( i_vertices, io_indices, i_positionIds, trianglesAroundFrom, triangleCountAroundFrom, k->first, k->second );
+				}
+				if ( !canCollapse )
+				{
+					continue;
+				}
+
+				io_quadrics[i_positionIds[i->to]] += io_quadrics[i_positionIds[i->from]];
+				maxError = std::max( maxError, i->geometricError );
+				for ( std::vector<std::pair<uint32_t, uint32_t> >::const_iterator k = pairs.begin(); k != pairs.end(); ++k )
+				{
+					remap[k->first] = k->second;
+					const uint32_t* const trianglesAroundFrom = &adjacentTriangles[adjacencyOffsets[k->first]];
+					const uint32_t triangleCountAroundFrom = adjacencyOffsets[k->first + 1] - adjacencyOffsets[k->first];
+					for ( uint32_t j = 0; j < triangleCountAroundFrom; ++j )
+					{
+						const uint32_t* const triangle = &io_indices[trianglesAroundFrom[j] * 3];
+						wasTouched[triangle[0]] = wasTouched[triangle[1]] = wasTouched[triangle[2]] = true;
+					}
+				}
+				++collapseCount;
+			}
+			if ( collapseCount == 0 )
+			{
+				break;
+			}
+
+			size_t writeIndex = 0;
+			for ( size_t i = 0; i < io_indices.size(); i += 3 )
+			{
+				const uint32_t a = remap[io_indices[i + 0]];
+				const uint32_t b = remap[io_indices[i + 1]];
+				const uint32_t c = remap[io_indices[i + 2]];
+				const uint32_t pa = i_positionIds[a], pb = i_positionIds[b], pc = i_positionIds[c];
+				if ( ( pa != pb ) && ( pb != pc ) && ( pa != pc ) )
+				{
+					io_indices[writeIndex + 0] = a;
+					io_indices[writeIndex + 1] = b;
+					io_indices[writeIndex + 2] = c;
+					writeIndex += 3;
+				}
+			}
+			io_indices.resize( writeIndex );
+		}
+
+		return static_cast<float>( std::sqrt( maxError ) );
+	}
+}
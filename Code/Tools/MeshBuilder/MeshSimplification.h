@@ -0,0 +1,24 @@
+#ifndef MESHBUILDER_MESHSIMPLIFICATION_H
+#define MESHBUILDER_MESHSIMPLIFICATION_H
+
+#include "MeshData.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace MeshSimplification
+		{
+			// Fills io_mesh.lods with up to i_maxLodCount levels of detail.
+			// LOD 0 is the original index buffer; every following level is simplified from the previous one
+			// with quadric error metric half-edge collapses, so all of the levels share the original vertex buffer.
+			// Vertices on open borders are never moved. Vertices on attribute seams (the same position with different UVs/colors)
+			// are only moved when every copy of the position can be collapsed onto a copy of the same target together,
+			// which keeps the seam closed.
+			// Generation stops early once a level can't remove a meaningful number of triangles
+			void GenerateLods( sMesh& io_mesh, const unsigned int i_maxLodCount, const float i_reductionPerLod = 0.5f );
+		}
+	}
+}
+
+#endif
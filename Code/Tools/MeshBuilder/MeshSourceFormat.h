@@ -0,0 +1,51 @@
+#ifndef MESHBUILDER_MESHSOURCEFORMAT_H
+#define MESHBUILDER_MESHSOURCEFORMAT_H
+
+// This file is shared by MayaMeshExporter (which can write binary mesh sources) and MeshBuilder (which reads them).
+//
+// A binary mesh source (".mesh") holds the same data as a Lua mesh source in the form that MeshBuilder uses,
+// and so it can be read without any parsing and its floats are exactly the ones that were exported:
+//	sFileHeader
+//	sVertex[vertexCount]
+//	uint32_t[indexCount]
+//	sSubmesh[submeshCount]
+//	The NUL-terminated name of each of the materialSlotCount material slots (materialNamesSize bytes in total)
+
+#include <cstdint>
+#include "MeshData.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace MeshSource
+		{
+			// "MSRC" when read as bytes
+			const uint32_t s_fileMagic = 0x4352534d;
+			const uint32_t s_fileVersion = 1;
+
+			struct sFileHeader
+			{
+				uint32_t magic;
+				uint32_t version;
+				uint32_t vertexCount;
+				uint32_t indexCount;
+				uint32_t submeshCount;
+				uint32_t materialSlotCount;
+				uint32_t materialNamesSize;
+			};
+
+			// Only the part of each submesh that comes from the source (MeshBuilder calculates the rest)
+			struct sSubmesh
+			{
+				uint32_t firstIndex;
+				uint32_t indexCount;
+				uint32_t materialSlot;
+			};
+
+			static_assert( sizeof( sVertex ) == 24, "Binary mesh sources store sVertex as it is" );
+		}
+	}
+}
+
+#endif
@@ -1,51 +1,189 @@
 #include "cMeshBuilder.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 #include <sstream>
 #include <fstream>
+#include <vector>
+#include "MeshBounds.h"
+#include "MeshBvh.h"
+#include "MeshClusters.h"
+#include "MeshCompression.h"
+#include "MeshData.h"
+#include "MeshObjImport.h"
+#include "MeshSourceFormat.h"
+#include "MeshSimplification.h"
 #include "../AssetBuildLibrary/UtilityFunctions.h"
+#include "../../Engine/Graphics/MeshFormat.h"
 #include "../../Engine/Platform/Platform.h"
 
 namespace
 {
-	struct sVertex
+	using Engine::AssetBuild::sVertex;
+	using Engine::AssetBuild::sVertexAttributes;
+	using Engine::AssetBuild::sLod;
+	using Engine::AssetBuild::sCluster;
+	using Engine::AssetBuild::sSubmesh;
+	using Engine::AssetBuild::sMesh;
+
+	struct sBuildOptions
 	{
-		float x, y, z;
-		float u, v;
-		uint8_t r, g, b, a;
+		unsigned int lodCount;
+		bool shouldGenerateClusters;
+		bool shouldCompress;
+		bool shouldSplitStreams;
+		bool shouldWritePositions_soa;
+		bool shouldBuildBvh;
+
+		sBuildOptions() : lodCount( 1 ), shouldGenerateClusters( false ), shouldCompress( false ), shouldSplitStreams( false ),
+			shouldWritePositions_soa( false ), shouldBuildBvh( false ) {}
 	};
 	
-	bool LoadFile(const char* i_path, std::ofstream& i_binFile);
-	bool LoadTableValues(lua_State& io_luaState, std::ofstream& i_binFile);
-	bool LoadTableValues_vertices(lua_State& io_luaState, std::ofstream& i_binFile);
-	bool LoadTableValues_textures(lua_State& io_luaState, std::ofstream& i_binFile);
-	bool LoadTableValues_indices(lua_State& io_luaState, std::ofstream& i_binFile);
-	bool LoadTableValues_colors(lua_State& io_luaState, std::ofstream& i_binFile);
-	bool LoadTableValues_vertices_values(lua_State& io_luaState, std::ofstream& i_binFile);
-	bool LoadTableValues_textures_values(lua_State& io_luaState, std::ofstream& i_binFile);
-	bool LoadTableValues_indices_values(lua_State& io_luaState, std::ofstream& i_binFile);
-	bool LoadTableValues_color_values(lua_State& io_luaState, std::ofstream& i_binFile);
-
-	sVertex* vertexbuffer = NULL;
+	bool ParseBuildOptions(const std::vector<std::string>& i_arguments, sBuildOptions& o_options);
+	bool LoadFile(const char* i_path, sMesh& o_mesh);
+	bool LoadLegacyBinaryFile(const char* i_path, sMesh& o_mesh);
+	bool LoadSourceBinaryFile(const char* i_path, sMesh& o_mesh);
+	bool LoadTableValues(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_vertices(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_textures(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_indices(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_colors(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_submeshes(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_vertices_values(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_textures_values(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_indices_values(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_color_values(lua_State& io_luaState, sMesh& o_mesh);
+	bool LoadTableValues_submeshes_values(lua_State& io_luaState, sMesh& o_mesh);
+	bool BuildSubmeshes(sMesh& io_mesh, const sBuildOptions& i_options);
+	void LayOutIndices(const sMesh& i_mesh, std::vector<sSubmesh>& o_submeshes, std::vector<uint32_t>& o_relativeIndices,
+		std::vector<uint8_t>& o_indexData);
+	void AppendVertexStream(const Engine::Mesh::eSectionType i_type, const void* i_stream, const uint32_t i_vertexCount, const size_t i_stride,
+		const bool i_shouldCompress, std::vector<uint8_t>& io_file, std::vector<Engine::Mesh::sSection>& io_sections);
+	bool WriteMeshToFile(const sMesh& i_mesh, const sBuildOptions& i_options, std::ofstream& i_binFile);
+	void AppendSection(const Engine::Mesh::eSectionType i_type, const void* i_data, const size_t i_size, const uint32_t i_alignment,
+		std::vector<uint8_t>& io_file, std::vector<Engine::Mesh::sSection>& io_sections);
 }
 
 
-bool Engine::AssetBuild::cMeshBuilder::Build( const std::vector<std::string>& )
+bool Engine::AssetBuild::cMeshBuilder::Build( const std::vector<std::string>& i_arguments )
 {
 	bool wereThereErrors = false;
 	{
 		std::string errorMessage;
 
-		std::ofstream binFile(m_path_target, std::ofstream::binary);
+		sBuildOptions options;
+		if (!ParseBuildOptions(i_arguments, options))
+		{
+			wereThereErrors = true;
+			goto OnExit;
+		}
 
-		if (!LoadFile(m_path_source, binFile))
+		// Meshes that were built before the current format existed can be upgraded by using them as the source,
+		// and binary mesh sources and Wavefront OBJ files can be used instead of Lua ones
+		sMesh mesh;
+		const std::string sourcePath(m_path_source);
+		const size_t extensionOffset = sourcePath.find_last_of('.');
+		const std::string sourceExtension = (extensionOffset != std::string::npos) ? sourcePath.substr(extensionOffset) : std::string();
+		bool wasSourceLoaded;
+		if (sourceExtension == ".bin")
+			wasSourceLoaded = LoadLegacyBinaryFile(m_path_source, mesh);
+		else if (sourceExtension == ".mesh")
+			wasSourceLoaded = LoadSourceBinaryFile(m_path_source, mesh);
+		else if (sourceExtension == ".obj")
+			wasSourceLoaded = MeshObjImport::LoadFile(m_path_source, mesh);
+		else
+			wasSourceLoaded = LoadFile(m_path_source, mesh);
+		if (!wasSourceLoaded)
+		{
+			wereThereErrors = true;
+			goto OnExit;
+		}
+		{
+			std::vector<uint32_t> vertexIndices(mesh.vertices.size());
+			std::iota(vertexIndices.begin(), vertexIndices.end(), 0);
+			MeshBounds::CalculateBounds(mesh.vertices, vertexIndices, mesh.bounds);
+		}
+		if (!BuildSubmeshes(mesh, options))
+		{
+			wereThereErrors = true;
+			goto OnExit;
+		}
+		// The BVH's triangles must have their corners in the same order as the index buffer that is drawn
+		if (options.shouldCompress)
+			Engine::AssetBuild::MeshCompression::RotateTriangles(mesh.indices);
+		if (options.shouldBuildBvh)
+			Engine::AssetBuild::MeshBvh::BuildBvh(mesh);
+
+		std::ofstream binFile(m_path_target, std::ofstream::binary);
+		if (!WriteMeshToFile(mesh, options, binFile))
 			wereThereErrors = true;
 	}
 
+OnExit:
+
 	return !wereThereErrors;
 }
 
 namespace
 {
-	bool LoadFile(const char* i_path, std::ofstream& i_binFile)
+	bool ParseBuildOptions(const std::vector<std::string>& i_arguments, sBuildOptions& o_options)
+	{
+		for (std::vector<std::string>::const_iterator it = i_arguments.begin(); it != i_arguments.end(); ++it)
+		{
+			const std::string& argument = *it;
+			const size_t separator = argument.find('=');
+			const std::string key = argument.substr(0, separator);
+			const std::string value = (separator != std::string::npos) ? argument.substr(separator + 1) : std::string();
+			if (key == "lods")
+			{
+				const int lodCount = atoi(value.c_str());
+				if (lodCount < 1)
+				{
+					Engine::AssetBuild::OutputErrorMessage("The lods argument must be a positive number of levels of detail");
+					return false;
+				}
+				o_options.lodCount = static_cast<unsigned int>(lodCount);
+			}
+			else if (key == "clusters")
+			{
+				o_options.shouldGenerateClusters = true;
+			}
+			else if (key == "compress")
+			{
+				o_options.shouldCompress = true;
+			}
+			else if (key == "streams")
+			{
+				if (value == "split")
+				{
+					o_options.shouldSplitStreams = true;
+				}
+				else if (value != "interleaved")
+				{
+					Engine::AssetBuild::OutputErrorMessage("The streams argument must be either \"interleaved\" or \"split\"");
+					return false;
+				}
+			}
+			else if (key == "soapositions")
+			{
+				o_options.shouldWritePositions_soa = true;
+			}
+			else if (key == "bvh")
+			{
+				o_options.shouldBuildBvh = true;
+			}
+			else
+			{
+				std::ostringstream errorMessage;
+				errorMessage << "Unknown mesh build argument \"" << argument << "\"";
+				Engine::AssetBuild::OutputErrorMessage(errorMessage.str().c_str());
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool LoadFile(const char* i_path, sMesh& o_mesh)
 	{
 		bool wereThereErrors = false;
 
@@ -107,7 +245,7 @@ namespace
 			}
 		}
 
-		if (!LoadTableValues(*luaState, i_binFile))
+		if (!LoadTableValues(*luaState, o_mesh))
 		{
 			wereThereErrors = true;
 		}
@@ -125,30 +263,29 @@ namespace
 		return !wereThereErrors;
 	}
 
-	bool LoadTableValues(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues(lua_State& io_luaState, sMesh& o_mesh)
 	{
-		sVertex* vertexbuffer = NULL;
-		
-		if (!LoadTableValues_vertices(io_luaState, i_binFile))
+		if (!LoadTableValues_vertices(io_luaState, o_mesh))
 		{
 			return false;
 		}
-		if (!LoadTableValues_textures(io_luaState, i_binFile))
+		if (!LoadTableValues_textures(io_luaState, o_mesh))
 		{
 			return false;
 		}
-		if (!LoadTableValues_indices(io_luaState, i_binFile))
+		if (!LoadTableValues_indices(io_luaState, o_mesh))
+		{
+			return false;
+		}
+		if (!LoadTableValues_submeshes(io_luaState, o_mesh))
 		{
 			return false;
 		}
-
-		if (vertexbuffer)
-			delete vertexbuffer;
 
 		return true;
 	}
 
-	bool LoadTableValues_vertices(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues_vertices(lua_State& io_luaState, sMesh& o_mesh)
 	{
 		bool wereThereErrors = false;
 		const char* const key = "vertices";
@@ -156,7 +293,7 @@ namespace
 		lua_gettable(&io_luaState, -2);
 		if (lua_istable(&io_luaState, -1))
 		{
-			if (!LoadTableValues_vertices_values(io_luaState, i_binFile))
+			if (!LoadTableValues_vertices_values(io_luaState, o_mesh))
 			{
 				wereThereErrors = true;
 				goto OnExit;
@@ -176,7 +313,7 @@ namespace
 		return !wereThereErrors;
 	}
 
-	bool LoadTableValues_textures(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues_textures(lua_State& io_luaState, sMesh& o_mesh)
 	{
 		bool wereThereErrors = false;
 		const char* const key = "texturecoordinates";
@@ -184,7 +321,7 @@ namespace
 		lua_gettable(&io_luaState, -2);
 		if (lua_istable(&io_luaState, -1))
 		{
-			if (!LoadTableValues_textures_values(io_luaState, i_binFile))
+			if (!LoadTableValues_textures_values(io_luaState, o_mesh))
 			{
 				wereThereErrors = true;
 				goto OnExit;
@@ -204,7 +341,7 @@ namespace
 		return !wereThereErrors;
 	}
 
-	bool LoadTableValues_indices(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues_indices(lua_State& io_luaState, sMesh& o_mesh)
 	{
 		bool wereThereErrors = false;
 		const char* const key = "indices";
@@ -212,7 +349,7 @@ namespace
 		lua_gettable(&io_luaState, -2);
 		if (lua_istable(&io_luaState, -1))
 		{
-			if (!LoadTableValues_indices_values(io_luaState, i_binFile))
+			if (!LoadTableValues_indices_values(io_luaState, o_mesh))
 			{
 				wereThereErrors = true;
 				goto OnExit;
@@ -232,14 +369,13 @@ namespace
 		return !wereThereErrors;
 	}
 
-	bool LoadTableValues_vertices_values(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues_vertices_values(lua_State& io_luaState, sMesh& o_mesh)
 	{
-		uint16_t verticeCount = luaL_len(&io_luaState, -1);
-		char* vertexcountbuf = reinterpret_cast<char*>(&verticeCount);
-		i_binFile.write(vertexcountbuf, sizeof(uint16_t));
+		const uint32_t verticeCount = static_cast<uint32_t>(luaL_len(&io_luaState, -1));
+		o_mesh.vertices.resize(verticeCount);
+		sVertex* vertexbuffer = o_mesh.vertices.data();
 
-		vertexbuffer = new sVertex[verticeCount];
-		for (int i = 1; i <= verticeCount; ++i)
+		for (uint32_t i = 1; i <= verticeCount; ++i)
 		{
 			lua_pushinteger(&io_luaState, i);
 			lua_gettable(&io_luaState, -2);
@@ -280,29 +416,22 @@ namespace
 		return true;
 	}
 
-	bool LoadTableValues_textures_values(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues_textures_values(lua_State& io_luaState, sMesh& o_mesh)
 	{
-		uint16_t verticeCount = luaL_len(&io_luaState, -1);
-		char* vertexcountbuf = reinterpret_cast<char*>(&verticeCount);
+		const uint32_t verticeCount = static_cast<uint32_t>(luaL_len(&io_luaState, -1));
+		if (verticeCount != o_mesh.vertices.size())
+		{
+			Engine::AssetBuild::OutputErrorMessage("The number of texture coordinates must match the number of vertices");
+			return false;
+		}
+		sVertex* vertexbuffer = o_mesh.vertices.data();
 
-		for (int i = 1; i <= verticeCount; ++i)
+		for (uint32_t i = 1; i <= verticeCount; ++i)
 		{
 			lua_pushinteger(&io_luaState, i);
 			lua_gettable(&io_luaState, -2);
 			if (lua_istable(&io_luaState, -1))
 			{
-#if defined( PLATFORM_D3D )
-				lua_pushinteger(&io_luaState, 1);
-				lua_gettable(&io_luaState, -2);
-				vertexbuffer[i - 1].u = static_cast<float>(lua_tonumber(&io_luaState, -1));
-				vertexbuffer[i - 1].u -= 1.0f;
-				lua_pop(&io_luaState, 1);
-				lua_pushinteger(&io_luaState, 2);
-				lua_gettable(&io_luaState, -2);
-				vertexbuffer[i - 1].v = static_cast<float>(lua_tonumber(&io_luaState, -1));
-				vertexbuffer[i - 1].v -= 1.0f;
-				lua_pop(&io_luaState, 1);
-#elif defined( PLATFORM_GL )
 				lua_pushinteger(&io_luaState, 1);
 				lua_gettable(&io_luaState, -2);
 				vertexbuffer[i - 1].u = static_cast<float>(lua_tonumber(&io_luaState, -1));
@@ -311,50 +440,39 @@ namespace
 				lua_gettable(&io_luaState, -2);
 				vertexbuffer[i - 1].v = static_cast<float>(lua_tonumber(&io_luaState, -1));
 				lua_pop(&io_luaState, 1);
-#endif
 			}
 			lua_pop(&io_luaState, 1);
 		}
 
-		char* buffer = reinterpret_cast<char*>(vertexbuffer);
-		i_binFile.write(buffer, sizeof(sVertex) * verticeCount);
-
 		return true;
 	}
 
-	bool LoadTableValues_indices_values(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues_indices_values(lua_State& io_luaState, sMesh& o_mesh)
 	{
-		uint16_t indiceCount = luaL_len(&io_luaState, -1);
-		char* indexcountbuf = reinterpret_cast<char*>(&indiceCount);
-		i_binFile.write(indexcountbuf, sizeof(uint16_t));
-
-		uint16_t* indexbuffer = new uint16_t[indiceCount];
-		int j = 0;
-#if defined( PLATFORM_D3D )
-		for (int i = indiceCount; i >= 1; --i)
+		const uint32_t indiceCount = static_cast<uint32_t>(luaL_len(&io_luaState, -1));
+		o_mesh.indices.resize(indiceCount);
+		uint32_t* indexbuffer = o_mesh.indices.data();
+		const uint32_t vertexCount = static_cast<uint32_t>(o_mesh.vertices.size());
+		for (uint32_t i = 1; i <= indiceCount; ++i)
 		{
 			lua_pushinteger(&io_luaState, i);
 			lua_gettable(&io_luaState, -2);
-			indexbuffer[indiceCount - i] = static_cast<uint16_t>(lua_tonumber(&io_luaState, -1));
+			indexbuffer[i - 1] = static_cast<uint32_t>(lua_tonumber(&io_luaState, -1));
 			lua_pop(&io_luaState, 1);
 		}
-#elif defined( PLATFORM_GL )
-		for (int i = 1; i <= indiceCount; ++i)
+		for (uint32_t i = 0; i < indiceCount; ++i)
 		{
-			lua_pushinteger(&io_luaState, i);
-			lua_gettable(&io_luaState, -2);
-			indexbuffer[i - 1] = static_cast<uint16_t>(lua_tonumber(&io_luaState, -1));
-			lua_pop(&io_luaState, 1);
+			if (indexbuffer[i] >= vertexCount)
+			{
+				Engine::AssetBuild::OutputErrorMessage("An index refers to a vertex that doesn't exist");
+				return false;
+			}
 		}
-#endif
-
-		char* buf = reinterpret_cast<char*>(indexbuffer);
-		i_binFile.write(buf, indiceCount * sizeof(uint16_t));
 
 		return true;
 	}
 
-	bool LoadTableValues_colors(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues_colors(lua_State& io_luaState, sMesh& o_mesh)
 	{
 		bool wereThereErrors = false;
 		const char* const key = "color";
@@ -362,7 +480,7 @@ namespace
 		lua_gettable(&io_luaState, -2);
 		if (lua_istable(&io_luaState, -1))
 		{
-			if (!LoadTableValues_color_values(io_luaState, i_binFile))
+			if (!LoadTableValues_color_values(io_luaState, o_mesh))
 			{
 				wereThereErrors = true;
 				goto OnExit;
@@ -382,15 +500,22 @@ namespace
 		return !wereThereErrors;
 	}
 
-	bool LoadTableValues_color_values(lua_State& io_luaState, std::ofstream& i_binFile)
+	bool LoadTableValues_color_values(lua_State& io_luaState, sMesh& o_mesh)
 	{
-		uint16_t colorCount = luaL_len(&io_luaState, -1);
-		char* colorcountbuf = reinterpret_cast<char*>(&colorCount);
-		i_binFile.write(colorcountbuf, sizeof(uint16_t));
-
-		uint8_t* colorbuffer = new uint8_t[colorCount * 4];
-		int j = 0;
-		for (int i = 1; i <= colorCount; ++i)
+		const uint32_t colorCount = static_cast<uint32_t>(luaL_len(&io_luaState, -1));
+		if (colorCount != o_mesh.vertices.size())
+		{
+			Engine::AssetBuild::OutputErrorMessage("The number of colors must match the number of vertices");
+			return false;
+		}
+		if (colorCount == 0)
+		{
+			return true;
+		}
+		uint8_t* colorbuffer = &o_mesh.vertices[0].r;
+		const size_t j_stride = sizeof(sVertex);
+		size_t j = 0;
+		for (uint32_t i = 1; i <= colorCount; ++i)
 		{
 			lua_pushinteger(&io_luaState, i);
 			lua_gettable(&io_luaState, -2);
@@ -414,12 +539,530 @@ namespace
 				colorbuffer[j + 3] = static_cast<uint8_t>(255.0f);
 			}
 			lua_pop(&io_luaState, 1);
-			j += 4;
+			j += j_stride;
+		}
+
+		return true;
+	}
+
+	bool LoadTableValues_submeshes(lua_State& io_luaState, sMesh& o_mesh)
+	{
+		bool wereThereErrors = false;
+		const char* const key = "submeshes";
+		lua_pushstring(&io_luaState, key);
+		lua_gettable(&io_luaState, -2);
+		// Meshes without submeshes are drawn with a single material
+		if (lua_istable(&io_luaState, -1))
+		{
+			if (!LoadTableValues_submeshes_values(io_luaState, o_mesh))
+			{
+				wereThereErrors = true;
+				goto OnExit;
+			}
+		}
+		else if (!lua_isnil(&io_luaState, -1))
+		{
+			wereThereErrors = true;
+			Engine::AssetBuild::OutputErrorMessage("The value at \"submeshes\" must be a table");
+			goto OnExit;
+		}
+
+	OnExit:
+
+		lua_pop(&io_luaState, 1);
+
+		return !wereThereErrors;
+	}
+
+	bool LoadTableValues_submeshes_values(lua_State& io_luaState, sMesh& o_mesh)
+	{
+		const uint32_t submeshCount = static_cast<uint32_t>(luaL_len(&io_luaState, -1));
+		for (uint32_t i = 1; i <= submeshCount; ++i)
+		{
+			lua_pushinteger(&io_luaState, i);
+			lua_gettable(&io_luaState, -2);
+			if (!lua_istable(&io_luaState, -1))
+			{
+				lua_pop(&io_luaState, 1);
+				Engine::AssetBuild::OutputErrorMessage("Every submesh must be a table");
+				return false;
+			}
+
+			sSubmesh submesh = {};
+			{
+				lua_pushstring(&io_luaState, "material");
+				lua_gettable(&io_luaState, -2);
+				lua_pushstring(&io_luaState, "firstIndex");
+				lua_gettable(&io_luaState, -3);
+				lua_pushstring(&io_luaState, "indexCount");
+				lua_gettable(&io_luaState, -4);
+				const bool areValuesValid = lua_isstring(&io_luaState, -3) && lua_isnumber(&io_luaState, -2) && lua_isnumber(&io_luaState, -1);
+				if (areValuesValid)
+				{
+					const std::string material(lua_tostring(&io_luaState, -3));
+					submesh.firstIndex = static_cast<uint32_t>(lua_tointeger(&io_luaState, -2));
+					submesh.indexCount = static_cast<uint32_t>(lua_tointeger(&io_luaState, -1));
+					// Submeshes that use the same material share a slot
+					const std::vector<std::string>::const_iterator slot = std::find(o_mesh.materialSlots.begin(), o_mesh.materialSlots.end(), material);
+					submesh.materialSlot = static_cast<uint32_t>(slot - o_mesh.materialSlots.begin());
+					if (slot == o_mesh.materialSlots.end())
+					{
+						o_mesh.materialSlots.push_back(material);
+					}
+				}
+				lua_pop(&io_luaState, 4);
+				if (!areValuesValid)
+				{
+					Engine::AssetBuild::OutputErrorMessage("Every submesh must have a material name, a firstIndex, and an indexCount");
+					return false;
+				}
+			}
+			o_mesh.submeshes.push_back(submesh);
+		}
+
+		return true;
+	}
+
+	bool BuildSubmeshes(sMesh& io_mesh, const sBuildOptions& i_options)
+	{
+		const uint32_t sourceIndexCount = static_cast<uint32_t>(io_mesh.indices.size());
+		if (io_mesh.submeshes.empty())
+		{
+			sSubmesh submesh = {};
+			submesh.indexCount = sourceIndexCount;
+			io_mesh.submeshes.push_back(submesh);
+			io_mesh.materialSlots.push_back(std::string());
+		}
+
+		// The submeshes must split the source index buffer into whole triangles, in order
+		{
+			uint32_t expectedFirstIndex = 0;
+			for (std::vector<sSubmesh>::const_iterator it = io_mesh.submeshes.begin(); it != io_mesh.submeshes.end(); ++it)
+			{
+				if ((it->firstIndex != expectedFirstIndex) || (it->indexCount == 0) || ((it->indexCount % 3) != 0)
+					|| (it->indexCount > (sourceIndexCount - it->firstIndex)))
+				{
+					Engine::AssetBuild::OutputErrorMessage("Submeshes must be non-empty whole triangles that follow each other in the index buffer");
+					return false;
+				}
+				expectedFirstIndex += it->indexCount;
+			}
+			if (expectedFirstIndex != sourceIndexCount)
+			{
+				Engine::AssetBuild::OutputErrorMessage("The submeshes must include every index");
+				return false;
+			}
+		}
+
+		// Each submesh is simplified and clustered on its own
+		// (and the vertices are moved rather than copied into each part)
+		std::vector<uint32_t> sourceIndices;
+		sourceIndices.swap(io_mesh.indices);
+		io_mesh.lods.clear();
+		io_mesh.clusters.clear();
+		for (std::vector<sSubmesh>::iterator it = io_mesh.submeshes.begin(); it != io_mesh.submeshes.end(); ++it)
+		{
+			sMesh part;
+			part.vertices.swap(io_mesh.vertices);
+			part.indices.assign(sourceIndices.begin() + it->firstIndex, sourceIndices.begin() + it->firstIndex + it->indexCount);
+			Engine::AssetBuild::MeshSimplification::GenerateLods(part, i_options.lodCount);
+			if (i_options.shouldGenerateClusters)
+				Engine::AssetBuild::MeshClusters::GenerateClusters(part);
+			part.vertices.swap(io_mesh.vertices);
+
+			const uint32_t indexOffset = static_cast<uint32_t>(io_mesh.indices.size());
+			it->firstLod = static_cast<uint32_t>(io_mesh.lods.size());
+			it->lodCount = static_cast<uint32_t>(part.lods.size());
+			for (std::vector<sLod>::iterator lod = part.lods.begin(); lod != part.lods.end(); ++lod)
+			{
+				lod->firstIndex += indexOffset;
+				io_mesh.lods.push_back(*lod);
+			}
+			it->firstCluster = static_cast<uint32_t>(io_mesh.clusters.size());
+			it->clusterCount = static_cast<uint32_t>(part.clusters.size());
+			for (std::vector<sCluster>::iterator cluster = part.clusters.begin(); cluster != part.clusters.end(); ++cluster)
+			{
+				cluster->firstIndex += indexOffset;
+				io_mesh.clusters.push_back(*cluster);
+			}
+			io_mesh.indices.insert(io_mesh.indices.end(), part.indices.begin(), part.indices.end());
+
+			const sLod& lod0 = io_mesh.lods[it->firstLod];
+			it->firstIndex = lod0.firstIndex;
+			it->indexCount = lod0.indexCount;
+			// The simplified levels of detail only use vertices of LOD 0, but all of them have to be in the range that the indices are relative to
+			std::vector<uint32_t> vertexIndices(io_mesh.indices.begin() + indexOffset, io_mesh.indices.end());
+			std::sort(vertexIndices.begin(), vertexIndices.end());
+			vertexIndices.erase(std::unique(vertexIndices.begin(), vertexIndices.end()), vertexIndices.end());
+			it->firstVertex = vertexIndices.front();
+			it->vertexCount = (vertexIndices.back() - vertexIndices.front()) + 1;
+			Engine::AssetBuild::MeshBounds::CalculateBounds(io_mesh.vertices, vertexIndices, it->bounds);
+		}
+
+		return true;
+	}
+
+	void LayOutIndices(const sMesh& i_mesh, std::vector<sSubmesh>& o_submeshes, std::vector<uint32_t>& o_relativeIndices,
+		std::vector<uint8_t>& o_indexData)
+	{
+		// Each submesh's indices (for all of its levels of detail) follow each other in the index buffer,
+		// and so a submesh's indices end where the next one's start
+		o_submeshes = i_mesh.submeshes;
+		o_relativeIndices.resize(i_mesh.indices.size());
+		o_indexData.clear();
+		for (size_t i = 0; i < o_submeshes.size(); ++i)
+		{
+			sSubmesh& submesh = o_submeshes[i];
+			const uint32_t endIndex = ((i + 1) < o_submeshes.size()) ? o_submeshes[i + 1].firstIndex : static_cast<uint32_t>(i_mesh.indices.size());
+			for (uint32_t j = submesh.firstIndex; j < endIndex; ++j)
+			{
+				o_relativeIndices[j] = i_mesh.indices[j] - submesh.firstVertex;
+			}
+
+			// 32-bit indices are aligned so that they can be read directly
+			submesh.indexSize = (submesh.vertexCount <= 0x10000) ? sizeof(uint16_t) : sizeof(uint32_t);
+			submesh.indexOffset = static_cast<uint32_t>((o_indexData.size() + (submesh.indexSize - 1)) & ~static_cast<size_t>(submesh.indexSize - 1));
+			o_indexData.resize(submesh.indexOffset + ((endIndex - submesh.firstIndex) * submesh.indexSize), 0);
+			uint8_t* const indexData = o_indexData.data() + submesh.indexOffset;
+			if (submesh.indexSize == sizeof(uint16_t))
+			{
+				for (uint32_t j = submesh.firstIndex; j < endIndex; ++j)
+				{
+					const uint16_t index = static_cast<uint16_t>(o_relativeIndices[j]);
+					memcpy(indexData + ((j - submesh.firstIndex) * sizeof(uint16_t)), &index, sizeof(uint16_t));
+				}
+			}
+			else
+			{
+				memcpy(indexData, o_relativeIndices.data() + submesh.firstIndex, (endIndex - submesh.firstIndex) * sizeof(uint32_t));
+			}
+		}
+	}
+
+	bool LoadLegacyBinaryFile(const char* i_path, sMesh& o_mesh)
+	{
+		// The original format was [u16 vertexCount][sVertex...][u16 indexCount][u16 index...].
+		// Its indices and UVs are used as they are on every platform, like the ones of every other source,
+		// and so only the OpenGL versions of the old files (which didn't have their winding or UVs changed) upgrade correctly
+		Engine::Platform::sDataFromFile fileData;
+		{
+			std::string errorMessage;
+			if (!Engine::Platform::LoadBinaryFile(i_path, fileData, &errorMessage))
+			{
+				Engine::AssetBuild::OutputErrorMessage(errorMessage.c_str(), i_path);
+				return false;
+			}
+		}
+
+		const char* errorMessage = NULL;
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(fileData.data);
+		const uint8_t* const dataEnd = data + fileData.size;
+		uint16_t vertexCount = 0, indexCount = 0;
+		if ((fileData.size >= sizeof(uint32_t)) && (*reinterpret_cast<const uint32_t*>(data) == Engine::Mesh::s_fileMagic))
+		{
+			errorMessage = "The mesh is already in the current format and should be rebuilt from its source instead";
+			goto OnExit;
+		}
+		if (static_cast<size_t>(dataEnd - data) < sizeof(uint16_t))
+		{
+			errorMessage = "The mesh is too small to be a built mesh";
+			goto OnExit;
+		}
+		memcpy(&vertexCount, data, sizeof(uint16_t));
+		data += sizeof(uint16_t);
+		if (static_cast<size_t>(dataEnd - data) < ((vertexCount * sizeof(sVertex)) + sizeof(uint16_t)))
+		{
+			errorMessage = "The mesh's vertex data is truncated";
+			goto OnExit;
+		}
+		o_mesh.vertices.resize(vertexCount);
+		memcpy(o_mesh.vertices.data(), data, vertexCount * sizeof(sVertex));
+		data += vertexCount * sizeof(sVertex);
+		memcpy(&indexCount, data, sizeof(uint16_t));
+		data += sizeof(uint16_t);
+		if (static_cast<size_t>(dataEnd - data) != (indexCount * sizeof(uint16_t)))
+		{
+			errorMessage = "The mesh's index data doesn't match its index count";
+			goto OnExit;
+		}
+		for (uint16_t i = 0; i < indexCount; ++i)
+		{
+			uint16_t index;
+			memcpy(&index, data + (i * sizeof(uint16_t)), sizeof(uint16_t));
+			if (index >= vertexCount)
+			{
+				errorMessage = "An index refers to a vertex that doesn't exist";
+				goto OnExit;
+			}
+			o_mesh.indices.push_back(index);
+		}
+
+	OnExit:
+
+		fileData.Free();
+		if (errorMessage)
+		{
+			Engine::AssetBuild::OutputErrorMessage(errorMessage, i_path);
+			return false;
+		}
+		return true;
+	}
+
+	bool LoadSourceBinaryFile(const char* i_path, sMesh& o_mesh)
+	{
+		Engine::Platform::sDataFromFile fileData;
+		{
+			std::string errorMessage;
+			if (!Engine::Platform::LoadBinaryFile(i_path, fileData, &errorMessage))
+			{
+				Engine::AssetBuild::OutputErrorMessage(errorMessage.c_str(), i_path);
+				return false;
+			}
+		}
+
+		const char* errorMessage = NULL;
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(fileData.data);
+		const uint8_t* const dataEnd = data + fileData.size;
+		Engine::AssetBuild::MeshSource::sFileHeader header;
+		if (fileData.size < sizeof(header))
+		{
+			errorMessage = "The file is too small to be a binary mesh source";
+			goto OnExit;
+		}
+		memcpy(&header, data, sizeof(header));
+		data += sizeof(header);
+		if (header.magic != Engine::AssetBuild::MeshSource::s_fileMagic)
+		{
+			errorMessage = "The file isn't a binary mesh source";
+			goto OnExit;
+		}
+		if (header.version != Engine::AssetBuild::MeshSource::s_fileVersion)
+		{
+			errorMessage = "The binary mesh source was written by a different version of the exporter and must be exported again";
+			goto OnExit;
+		}
+		if (static_cast<uint64_t>(dataEnd - data) != ((static_cast<uint64_t>(header.vertexCount) * sizeof(sVertex))
+			+ (static_cast<uint64_t>(header.indexCount) * sizeof(uint32_t))
+			+ (static_cast<uint64_t>(header.submeshCount) * sizeof(Engine::AssetBuild::MeshSource::sSubmesh))
+			+ header.materialNamesSize))
+		{
+			errorMessage = "The binary mesh source's size doesn't match its header";
+			goto OnExit;
+		}
+
+		// Everything except the material names can be copied as it is
+		o_mesh.vertices.resize(header.vertexCount);
+		memcpy(o_mesh.vertices.data(), data, header.vertexCount * sizeof(sVertex));
+		data += header.vertexCount * sizeof(sVertex);
+		o_mesh.indices.resize(header.indexCount);
+		memcpy(o_mesh.indices.data(), data, header.indexCount * sizeof(uint32_t));
+		data += header.indexCount * sizeof(uint32_t);
+		for (std::vector<uint32_t>::const_iterator it = o_mesh.indices.begin(); it != o_mesh.indices.end(); ++it)
+		{
+			if (*it >= header.vertexCount)
+			{
+				errorMessage = "An index refers to a vertex that doesn't exist";
+				goto OnExit;
+			}
+		}
+		o_mesh.submeshes.resize(header.submeshCount);
+		for (uint32_t i = 0; i < header.submeshCount; ++i)
+		{
+			Engine::AssetBuild::MeshSource::sSubmesh submesh;
+			memcpy(&submesh, data, sizeof(submesh));
+			data += sizeof(submesh);
+			if (submesh.materialSlot >= header.materialSlotCount)
+			{
+				errorMessage = "A submesh refers to a material slot that doesn't exist";
+				goto OnExit;
+			}
+			sSubmesh& o_submesh = o_mesh.submeshes[i];
+			o_submesh = sSubmesh();
+			o_submesh.firstIndex = submesh.firstIndex;
+			o_submesh.indexCount = submesh.indexCount;
+			o_submesh.materialSlot = submesh.materialSlot;
+		}
+		while (data < dataEnd)
+		{
+			const uint8_t* const nameEnd = reinterpret_cast<const uint8_t*>(memchr(data, '\0', dataEnd - data));
+			if (!nameEnd)
+			{
+				errorMessage = "A material slot's name isn't terminated";
+				goto OnExit;
+			}
+			o_mesh.materialSlots.push_back(std::string(reinterpret_cast<const char*>(data), reinterpret_cast<const char*>(nameEnd)));
+			data = nameEnd + 1;
+		}
+		if (o_mesh.materialSlots.size() != header.materialSlotCount)
+		{
+			errorMessage = "The binary mesh source has a different number of material slot names than its header";
+			goto OnExit;
 		}
 
-		char* buf = reinterpret_cast<char*>(colorbuffer);
-		i_binFile.write(buf, colorCount * 4 * sizeof(uint8_t));
+	OnExit:
 
+		fileData.Free();
+		if (errorMessage)
+		{
+			Engine::AssetBuild::OutputErrorMessage(errorMessage, i_path);
+			return false;
+		}
 		return true;
 	}
+
+	bool WriteMeshToFile(const sMesh& i_mesh, const sBuildOptions& i_options, std::ofstream& i_binFile)
+	{
+		const uint32_t vertexCount = static_cast<uint32_t>(i_mesh.vertices.size());
+		const uint32_t indexCount = static_cast<uint32_t>(i_mesh.indices.size());
+		std::vector<sSubmesh> submeshes;
+		std::vector<uint32_t> relativeIndices;
+		std::vector<uint8_t> indexData;
+		LayOutIndices(i_mesh, submeshes, relativeIndices, indexData);
+
+		// The directory is filled in once the offsets of all of the sections are known
+		const uint32_t sectionCount = (i_options.shouldSplitStreams ? 6 : 5) + (i_mesh.clusters.empty() ? 0 : 1)
+			+ (i_options.shouldWritePositions_soa ? 1 : 0) + (i_mesh.bvhNodes.empty() ? 0 : 2);
+		std::vector<uint8_t> file(sizeof(Engine::Mesh::sFileHeader) + (sectionCount * sizeof(Engine::Mesh::sSection)), 0);
+		std::vector<Engine::Mesh::sSection> sections;
+
+		if (i_options.shouldSplitStreams)
+		{
+			// Passes that only need positions (like depth passes) then don't have to fetch the other attributes
+			std::vector<float> positions(vertexCount * 3);
+			std::vector<sVertexAttributes> attributes(vertexCount);
+			for (uint32_t i = 0; i < vertexCount; ++i)
+			{
+				const sVertex& vertex = i_mesh.vertices[i];
+				positions[(i * 3) + 0] = vertex.x;
+				positions[(i * 3) + 1] = vertex.y;
+				positions[(i * 3) + 2] = vertex.z;
+				sVertexAttributes& attribute = attributes[i];
+				attribute.u = vertex.u;
+				attribute.v = vertex.v;
+				attribute.r = vertex.r;
+				attribute.g = vertex.g;
+				attribute.b = vertex.b;
+				attribute.a = vertex.a;
+			}
+			AppendVertexStream(Engine::Mesh::SECTION_POSITIONS, positions.data(), vertexCount, sizeof(float) * 3, i_options.shouldCompress, file, sections);
+			AppendVertexStream(Engine::Mesh::SECTION_ATTRIBUTES, attributes.data(), vertexCount, sizeof(sVertexAttributes), i_options.shouldCompress,
+				file, sections);
+		}
+		else
+		{
+			AppendVertexStream(Engine::Mesh::SECTION_VERTICES, i_mesh.vertices.data(), vertexCount, sizeof(sVertex), i_options.shouldCompress,
+				file, sections);
+		}
+		if (i_options.shouldCompress)
+		{
+			std::vector<uint8_t> encodedIndices;
+			Engine::AssetBuild::MeshCompression::EncodeIndices(relativeIndices, encodedIndices);
+			AppendSection(Engine::Mesh::SECTION_INDICES, encodedIndices.data(), encodedIndices.size(), Engine::Mesh::s_sectionAlignment, file, sections);
+		}
+		else
+		{
+			AppendSection(Engine::Mesh::SECTION_INDICES, indexData.data(), indexData.size(), Engine::Mesh::s_bufferSectionAlignment, file, sections);
+		}
+		AppendSection(Engine::Mesh::SECTION_LODS, i_mesh.lods.data(), i_mesh.lods.size() * sizeof(sLod), Engine::Mesh::s_sectionAlignment,
+			file, sections);
+		if (!i_mesh.clusters.empty())
+		{
+			AppendSection(Engine::Mesh::SECTION_CLUSTERS, i_mesh.clusters.data(), i_mesh.clusters.size() * sizeof(sCluster), Engine::Mesh::s_sectionAlignment,
+				file, sections);
+		}
+		AppendSection(Engine::Mesh::SECTION_SUBMESHES, submeshes.data(), submeshes.size() * sizeof(sSubmesh),
+			Engine::Mesh::s_sectionAlignment, file, sections);
+		{
+			std::vector<char> materialSlots;
+			for (std::vector<std::string>::const_iterator it = i_mesh.materialSlots.begin(); it != i_mesh.materialSlots.end(); ++it)
+			{
+				materialSlots.insert(materialSlots.end(), it->c_str(), it->c_str() + it->size() + 1);
+			}
+			AppendSection(Engine::Mesh::SECTION_MATERIALSLOTS, materialSlots.data(), materialSlots.size(), Engine::Mesh::s_sectionAlignment,
+				file, sections);
+		}
+		if (i_options.shouldWritePositions_soa)
+		{
+			// Each array is padded (by repeating the last position) to a whole number of 4-wide SIMD registers
+			const uint32_t paddedCount = Engine::Mesh::GetPaddedCount_soa(vertexCount);
+			std::vector<float> positions(paddedCount * 3);
+			for (uint32_t i = 0; i < paddedCount; ++i)
+			{
+				const sVertex& vertex = i_mesh.vertices[std::min(i, vertexCount - 1)];
+				positions[i] = vertex.x;
+				positions[paddedCount + i] = vertex.y;
+				positions[(paddedCount * 2) + i] = vertex.z;
+			}
+			AppendSection(Engine::Mesh::SECTION_POSITIONS_SOA, positions.data(), positions.size() * sizeof(float), Engine::Mesh::s_sectionAlignment,
+				file, sections);
+		}
+		if (!i_mesh.bvhNodes.empty())
+		{
+			AppendSection(Engine::Mesh::SECTION_BVHNODES, i_mesh.bvhNodes.data(), i_mesh.bvhNodes.size() * sizeof(Engine::Mesh::sBvhNode),
+				Engine::Mesh::s_sectionAlignment, file, sections);
+			AppendSection(Engine::Mesh::SECTION_BVHTRIANGLES, i_mesh.bvhTrianglePackets.data(),
+				i_mesh.bvhTrianglePackets.size() * sizeof(Engine::Mesh::sBvhTrianglePacket), Engine::Mesh::s_sectionAlignment, file, sections);
+		}
+		if (file.size() > UINT32_MAX)
+		{
+			Engine::AssetBuild::OutputErrorMessage("The built mesh would be larger than 4 GB");
+			return false;
+		}
+
+		memcpy(file.data() + sizeof(Engine::Mesh::sFileHeader), sections.data(), sections.size() * sizeof(Engine::Mesh::sSection));
+		{
+			Engine::Mesh::sFileHeader header;
+			header.magic = Engine::Mesh::s_fileMagic;
+			header.version = Engine::Mesh::s_fileVersion;
+			header.headerSize = sizeof(header);
+			header.flags = (i_options.shouldCompress ? Engine::Mesh::FILEFLAG_COMPRESSED : 0)
+				| (i_options.shouldSplitStreams ? Engine::Mesh::FILEFLAG_SPLITSTREAMS : 0);
+			header.vertexCount = vertexCount;
+			header.vertexSize = sizeof(sVertex);
+			header.indexCount = indexCount;
+			header.indexDataSize = static_cast<uint32_t>(indexData.size());
+			header.sectionCount = static_cast<uint32_t>(sections.size());
+			header.checksum = Engine::Mesh::CalculateChecksum(file.data() + sizeof(header), file.size() - sizeof(header));
+			header.bounds = i_mesh.bounds;
+			memcpy(file.data(), &header, sizeof(header));
+		}
+		i_binFile.write(reinterpret_cast<const char*>(file.data()), file.size());
+
+		if (!i_binFile.good())
+		{
+			Engine::AssetBuild::OutputErrorMessage("Failed to write the built mesh");
+			return false;
+		}
+		return true;
+	}
+
+	void AppendVertexStream(const Engine::Mesh::eSectionType i_type, const void* i_stream, const uint32_t i_vertexCount, const size_t i_stride,
+		const bool i_shouldCompress, std::vector<uint8_t>& io_file, std::vector<Engine::Mesh::sSection>& io_sections)
+	{
+		if (i_shouldCompress)
+		{
+			std::vector<uint8_t> encodedVertices;
+			Engine::AssetBuild::MeshCompression::EncodeVertices(reinterpret_cast<const uint8_t*>(i_stream), i_vertexCount, i_stride, encodedVertices);
+			AppendSection(i_type, encodedVertices.data(), encodedVertices.size(), Engine::Mesh::s_sectionAlignment, io_file, io_sections);
+		}
+		else
+		{
+			AppendSection(i_type, i_stream, i_vertexCount * i_stride, Engine::Mesh::s_bufferSectionAlignment, io_file, io_sections);
+		}
+	}
+
+	void AppendSection(const Engine::Mesh::eSectionType i_type, const void* i_data, const size_t i_size, const uint32_t i_alignment,
+		std::vector<uint8_t>& io_file, std::vector<Engine::Mesh::sSection>& io_sections)
+	{
+		const size_t offset = ((io_file.size() + i_alignment - 1) / i_alignment) * i_alignment;
+		io_file.resize(offset, 0);
+		io_file.insert(io_file.end(), reinterpret_cast<const uint8_t*>(i_data), reinterpret_cast<const uint8_t*>(i_data) + i_size);
+
+		Engine::Mesh::sSection section;
+		section.type = i_type;
+		section.reserved = 0;
+		section.offset = static_cast<uint32_t>(offset);
+		section.size = static_cast<uint32_t>(i_size);
+		io_sections.push_back(section);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,429 @@
+// Measures how many rays per second can be traced against the BVH that MeshBuilder builds,
+// one ray at a time and 4 at a time, both for rays from a camera (which are coherent) and for random rays.
+// A synthetic mesh with about a million triangles is always used
+// (its triangles are rotated the way that MeshBuilder rotates the triangles of compressed meshes,
+// and the hits are checked against its encoded and then decoded index buffer),
+// and built meshes (built with the "bvh" argument, like the sample meshes in AssetsToBuild.lua) can be given as well.
+// Usage: MeshRaycastBenchmark [builtMesh ...]
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../MeshBuilder/MeshBvh.h"
+#include "../MeshBuilder/MeshCompression.h"
+#include "../MeshBuilder/MeshData.h"
+#include "../../Engine/Graphics/MeshCodec.h"
+#include "../../Engine/Graphics/MeshFormat.h"
+#include "../../Engine/Graphics/MeshRaycast.h"
+
+namespace
+{
+	// 2 * 708 * 708 triangles
+	const unsigned int s_syntheticQuadCountPerSide = 708;
+	const unsigned int s_imageSize = 512;
+	const unsigned int s_randomRayCount = s_imageSize * s_imageSize;
+	// Every ray is checked against both modes, and this many of each set are also checked against every triangle
+	const unsigned int s_bruteForceRayCount = 256;
+
+	using Engine::Mesh::Raycast::sBvh;
+	using Engine::Mesh::Raycast::sHit;
+	using Engine::Mesh::Raycast::sRay;
+
+	void GenerateSyntheticMesh( Engine::AssetBuild::sMesh& o_mesh );
+	bool LoadBuiltMesh( const char* const i_path, std::vector<uint8_t>& o_file, sBvh& o_bvh, float o_aabbMin[3], float o_aabbMax[3] );
+	void GenerateCameraRays( const float i_aabbMin[3], const float i_aabbMax[3], std::vector<sRay>& o_rays );
+	void GenerateRandomRays( const float i_aabbMin[3], const float i_aabbMax[3], std::vector<sRay>& o_rays );
+	bool RunBenchmark( const char* const i_name, const sBvh& i_bvh, const std::vector<sRay>& i_rays );
+	bool CheckHitsAgainstDecodedIndices( const sBvh& i_bvh, const std::vector<sRay>& i_rays, const Engine::AssetBuild::sMesh& i_mesh );
+	bool IntersectRay_bruteForce( const sBvh& i_bvh, const sRay& i_ray, sHit& o_hit );
+}
+
+int main( int i_argumentCount, char** i_arguments )
+{
+	bool wereThereErrors = false;
+
+	{
+		Engine::AssetBuild::sMesh mesh;
+		GenerateSyntheticMesh( mesh );
+		Engine::AssetBuild::MeshCompression::RotateTriangles( mesh.indices );
+		const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		Engine::AssetBuild::MeshBvh::BuildBvh( mesh );
+		const double seconds = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+		printf( "Synthetic mesh: %u triangles, BVH built in %.2f s (%u nodes, %u triangle packets)\n",
+			static_cast<unsigned int>( mesh.indices.size() / 3 ), seconds,
+			static_cast<unsigned int>( mesh.bvhNodes.size() ), static_cast<unsigned int>( mesh.bvhTrianglePackets.size() ) );
+
+		const sBvh bvh = { mesh.bvhNodes.data(), static_cast<uint32_t>( mesh.bvhNodes.size() ),
+			mesh.bvhTrianglePackets.data(), static_cast<uint32_t>( mesh.bvhTrianglePackets.size() ) };
+		std::vector<sRay> rays;
+		GenerateCameraRays( mesh.bounds.aabbMin, mesh.bounds.aabbMax, rays );
+		wereThereErrors = !RunBenchmark( "  camera rays", bvh, rays ) || wereThereErrors;
+		wereThereErrors = !CheckHitsAgainstDecodedIndices( bvh, rays, mesh ) || wereThereErrors;
+		GenerateRandomRays( mesh.bounds.aabbMin, mesh.bounds.aabbMax, rays );
+		wereThereErrors = !RunBenchmark( "  random rays", bvh, rays ) || wereThereErrors;
+	}
+
+	for ( int i = 1; i < i_argumentCount; ++i )
+	{
+		std::vector<uint8_t> file;
+		sBvh bvh;
+		float aabbMin[3], aabbMax[3];
+		if ( !LoadBuiltMesh( i_arguments[i], file, bvh, aabbMin, aabbMax ) )
+		{
+			wereThereErrors = true;
+			continue;
+		}
+		printf( "%s: %u nodes, %u triangle packets\n", i_arguments[i], bvh.nodeCount, bvh.packetCount );
+		std::vector<sRay> rays;
+		GenerateCameraRays( aabbMin, aabbMax, rays );
+		wereThereErrors = !RunBenchmark( "  camera rays", bvh, rays ) || wereThereErrors;
+		GenerateRandomRays( aabbMin, aabbMax, rays );
+		wereThereErrors = !RunBenchmark( "  random rays", bvh, rays ) || wereThereErrors;
+	}
+
+	return wereThereErrors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+namespace
+{
+	// Random numbers that are the same on every run (and every platform)
+	class cRandom
+	{
+	public:
+		cRandom() : m_state( 0x9e3779b9u ) {}
+		// Returns a number between 0 and 1
+		float Get()
+		{
+			m_state ^= m_state << 13;
+			m_state ^= m_state >> 17;
+			m_state ^= m_state << 5;
+			return static_cast<float>( m_state >> 8 ) / static_cast<float>( 1 << 24 );
+		}
+	private:
+		uint32_t m_state;
+	};
+
+	void GenerateSyntheticMesh( Engine::AssetBuild::sMesh& o_mesh )
+	{
+		// Rolling hills on a grid in the XZ plane, so that rays from above hit at many different depths
+		const unsigned int rowLength = s_syntheticQuadCountPerSide + 1;
+		const float size = 100.0f;
+		o_mesh.vertices.resize( rowLength * rowLength );
+		for ( unsigned int z = 0; z < rowLength; ++z )
+		{
+			for ( unsigned int x = 0; x < rowLength; ++x )
+			{
+				Engine::AssetBuild::sVertex& vertex = o_mesh.vertices[( z * rowLength ) + x];
+				vertex.x = ( ( static_cast<float>( x ) / s_syntheticQuadCountPerSide ) - 0.5f ) * size;
+				vertex.z = ( ( static_cast<float>( z ) / s_syntheticQuadCountPerSide ) - 0.5f ) * size;
+				vertex.y = ( std::sin( vertex.x * 0.3f ) * std::cos( vertex.z * 0.2f ) * 4.0f ) + ( std::sin( ( vertex.x + vertex.z ) * 1.7f ) * 0.5f );
+				vertex.u = static_cast<float>( x ) / s_syntheticQuadCountPerSide;
+				vertex.v = static_cast<float>( z ) / s_syntheticQuadCountPerSide;
+				vertex.r = vertex.g = vertex.b = vertex.a = 255;
+			}
+		}
+		o_mesh.indices.reserve( s_syntheticQuadCountPerSide * s_syntheticQuadCountPerSide * 6 );
+		for ( unsigned int z = 0; z < s_syntheticQuadCountPerSide; ++z )
+		{
+			for ( unsigned int x = 0; x < s_syntheticQuadCountPerSide; ++x )
+			{
+				const uint32_t corner = ( z * rowLength ) + x;
+				const uint32_t quad[6] = { corner, corner + rowLength, corner + 1, corner + 1, corner + rowLength, corner + rowLength + 1 };
+				o_mesh.indices.insert( o_mesh.indices.end(), quad, quad + 6 );
+			}
+		}
+		Engine::AssetBuild::sSubmesh submesh = {};
+		submesh.indexCount = static_cast<uint32_t>( o_mesh.indices.size() );
+		o_mesh.submeshes.push_back( submesh );
+		for ( unsigned int axis = 0; axis < 3; ++axis )
+		{
+			o_mesh.bounds.aabbMin[axis] = 1.0e30f;
+			o_mesh.bounds.aabbMax[axis] = -1.0e30f;
+		}
+		for ( std::vector<Engine::AssetBuild::sVertex>::const_iterator it = o_mesh.vertices.begin(); it != o_mesh.vertices.end(); ++it )
+		{
+			const float position[3] = { it->x, it->y, it->z };
+			for ( unsigned int axis = 0; axis < 3; ++axis )
+			{
+				o_mesh.bounds.aabbMin[axis] = std::fmin( o_mesh.bounds.aabbMin[axis], position[axis] );
+				o_mesh.bounds.aabbMax[axis] = std::fmax( o_mesh.bounds.aabbMax[axis], position[axis] );
+			}
+		}
+	}
+
+	bool LoadBuiltMesh( const char* const i_path, std::vector<uint8_t>& o_file, sBvh& o_bvh, float o_aabbMin[3], float o_aabbMax[3] )
+	{
+		{
+			std::ifstream file( i_path, std::ifstream::binary | std::ifstream::ate );
+			if ( !file )
+			{
+				fprintf( stderr, "%s couldn't be opened\n", i_path );
+				return false;
+			}
+			o_file.resize( static_cast<size_t>( file.tellg() ) );
+			file.seekg( 0 );
+			file.read( reinterpret_cast<char*>( o_file.data() ), o_file.size() );
+		}
+		Engine::Mesh::sFileHeader header = {};
+		if ( o_file.size() >= sizeof( header ) )
+		{
+			memcpy( &header, o_file.data(), sizeof( header ) );
+		}
+		if ( ( header.magic != Engine::Mesh::s_fileMagic ) || ( header.version != Engine::Mesh::s_fileVersion )
+			|| ( ( ( o_file.size() - sizeof( header ) ) / sizeof( Engine::Mesh::sSection ) ) < header.sectionCount ) )
+		{
+			fprintf( stderr, "%s isn't a mesh built by this version of MeshBuilder\n", i_path );
+			return false;
+		}
+
+		memset( &o_bvh, 0, sizeof( o_bvh ) );
+		for ( uint32_t i = 0; i < header.sectionCount; ++i )
+		{
+			Engine::Mesh::sSection section;
+			memcpy( &section, o_file.data() + sizeof( header ) + ( i * sizeof( section ) ), sizeof( section ) );
+			if ( ( section.offset > o_file.size() ) || ( section.size > ( o_file.size() - section.offset ) ) )
+			{
+				continue;
+			}
+			if ( section.type == Engine::Mesh::SECTION_BVHNODES )
+			{
+				o_bvh.nodes = reinterpret_cast<const Engine::Mesh::sBvhNode*>( o_file.data() + section.offset );
+				o_bvh.nodeCount = section.size / sizeof( Engine::Mesh::sBvhNode );
+			}
+			else if ( section.type == Engine::Mesh::SECTION_BVHTRIANGLES )
+			{
+				o_bvh.packets = reinterpret_cast<const Engine::Mesh::sBvhTrianglePacket*>( o_file.data() + section.offset );
+				o_bvh.packetCount = section.size / sizeof( Engine::Mesh::sBvhTrianglePacket );
+			}
+		}
+		if ( !Engine::Mesh::Raycast::IsValid( o_bvh, header.indexCount / 3 ) )
+		{
+			fprintf( stderr, "%s doesn't have a valid BVH (it must be built with the \"bvh\" argument)\n", i_path );
+			return false;
+		}
+		memcpy( o_aabbMin, header.bounds.aabbMin, sizeof( header.bounds.aabbMin ) );
+		memcpy( o_aabbMax, header.bounds.aabbMax, sizeof( header.bounds.aabbMax ) );
+		return true;
+	}
+
+	void GenerateCameraRays( const float i_aabbMin[3], const float i_aabbMax[3], std::vector<sRay>& o_rays )
+	{
+		// A camera that is up and to the side of the box looks at its center,
+		// with a field of view that is just wide enough to see all of it
+		float center[3], radius = 0.0f;
+		for ( unsigned int axis = 0; axis < 3; ++axis )
+		{
+			center[axis] = ( i_aabbMin[axis] + i_aabbMax[axis] ) * 0.5f;
+			const float halfExtent = ( i_aabbMax[axis] - i_aabbMin[axis] ) * 0.5f;
+			radius += halfExtent * halfExtent;
+		}
+		radius = std::sqrt( radius );
+		const float forward[3] = { -0.5f, -0.6f, -0.62449980f };
+		const float right[3] = { 0.78086881f, 0.0f, -0.62469505f };
+		const float up[3] =
+		{
+			( right[1] * forward[2] ) - ( right[2] * forward[1] ),
+			( right[2] * forward[0] ) - ( right[0] * forward[2] ),
+			( right[0] * forward[1] ) - ( right[1] * forward[0] ),
+		};
+		const float distance = radius * 2.5f;
+		const float halfSize = 1.0f / 2.3f;
+		o_rays.resize( s_imageSize * s_imageSize );
+		for ( unsigned int y = 0; y < s_imageSize; ++y )
+		{
+			for ( unsigned int x = 0; x < s_imageSize; ++x )
+			{
+				const float u = ( ( ( x + 0.5f ) / s_imageSize ) * 2.0f - 1.0f ) * halfSize;
+				const float v = ( ( ( y + 0.5f ) / s_imageSize ) * 2.0f - 1.0f ) * halfSize;
+				sRay& ray = o_rays[( y * s_imageSize ) + x];
+				for ( unsigned int axis = 0; axis < 3; ++axis )
+				{
+					ray.origin[axis] = center[axis] - ( forward[axis] * distance );
+					ray.direction[axis] = forward[axis] + ( right[axis] * u ) + ( up[axis] * v );
+				}
+				ray.maxDistance = distance * 2.0f;
+			}
+		}
+	}
+
+	void GenerateRandomRays( const float i_aabbMin[3], const float i_aabbMax[3], std::vector<sRay>& o_rays )
+	{
+		// Rays start at random points around the box and go through random points inside of it
+		cRandom random;
+		o_rays.resize( s_randomRayCount );
+		for ( unsigned int i = 0; i < s_randomRayCount; ++i )
+		{
+			sRay& ray = o_rays[i];
+			for ( unsigned int axis = 0; axis < 3; ++axis )
+			{
+				const float extent = std::fmax( i_aabbMax[axis] - i_aabbMin[axis], 1.0e-3f );
+				ray.origin[axis] = i_aabbMin[axis] + ( ( ( random.Get() * 3.0f ) - 1.0f ) * extent );
+				const float target = i_aabbMin[axis] + ( random.Get() * extent );
+				ray.direction[axis] = target - ray.origin[axis];
+			}
+			ray.maxDistance = 2.0f;
+		}
+	}
+
+	bool RunBenchmark( const char* const i_name, const sBvh& i_bvh, const std::vector<sRay>& i_rays )
+	{
+		const size_t rayCount = i_rays.size();
+		std::vector<sHit> hits_single( rayCount ), hits_packet( rayCount );
+		double seconds_single, seconds_packet;
+		{
+			const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+			for ( size_t i = 0; i < rayCount; ++i )
+			{
+				Engine::Mesh::Raycast::IntersectRay( i_bvh, i_rays[i], hits_single[i] );
+			}
+			seconds_single = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+		}
+		{
+			const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+			Engine::Mesh::Raycast::IntersectRays( i_bvh, i_rays.data(), rayCount, hits_packet.data() );
+			seconds_packet = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+		}
+		size_t hitCount = 0;
+		for ( size_t i = 0; i < rayCount; ++i )
+		{
+			hitCount += ( hits_single[i].triangleIndex != Engine::Mesh::Raycast::s_noHit ) ? 1 : 0;
+		}
+		printf( "%s (%u, %.0f%% hit): %7.2f Mrays/s one at a time, %7.2f Mrays/s 4 at a time\n", i_name, static_cast<unsigned int>( rayCount ),
+			( 100.0 * hitCount ) / rayCount, ( rayCount / seconds_single ) * 1.0e-6, ( rayCount / seconds_packet ) * 1.0e-6 );
+
+		// Different triangles can only be hit by the two modes (or by brute force) when they are at the same distance,
+		// like at a shared edge
+		size_t mismatchCount = 0;
+		for ( size_t i = 0; i < rayCount; ++i )
+		{
+			const sHit& single = hits_single[i];
+			const sHit& packet = hits_packet[i];
+			if ( ( single.triangleIndex != packet.triangleIndex )
+				&& ( ( ( single.triangleIndex == Engine::Mesh::Raycast::s_noHit ) != ( packet.triangleIndex == Engine::Mesh::Raycast::s_noHit ) )
+					|| ( std::fabs( single.distance - packet.distance ) > ( 1.0e-5f * std::fmax( single.distance, 1.0f ) ) ) ) )
+			{
+				++mismatchCount;
+			}
+		}
+		for ( size_t i = 0; i < rayCount; i += ( rayCount / s_bruteForceRayCount ) )
+		{
+			sHit hit;
+			IntersectRay_bruteForce( i_bvh, i_rays[i], hit );
+			const sHit& single = hits_single[i];
+			if ( ( single.triangleIndex != hit.triangleIndex )
+				&& ( ( ( single.triangleIndex == Engine::Mesh::Raycast::s_noHit ) != ( hit.triangleIndex == Engine::Mesh::Raycast::s_noHit ) )
+					|| ( std::fabs( single.distance - hit.distance ) > ( 1.0e-5f * std::fmax( single.distance, 1.0f ) ) ) ) )
+			{
+				++mismatchCount;
+			}
+		}
+		if ( mismatchCount > 0 )
+		{
+			fprintf( stderr, "%u rays hit different triangles depending on how they were traced\n", static_cast<unsigned int>( mismatchCount ) );
+			return false;
+		}
+		return true;
+	}
+
+	bool CheckHitsAgainstDecodedIndices( const sBvh& i_bvh, const std::vector<sRay>& i_rays, const Engine::AssetBuild::sMesh& i_mesh )
+	{
+		// A hit's barycentrics must be for the corners in the order of the index buffer that a compressed mesh draws,
+		// which is the one that the encoded indices decode to
+		const uint32_t indexCount = static_cast<uint32_t>( i_mesh.indices.size() );
+		std::vector<uint32_t> indices( indexCount );
+		{
+			std::vector<uint8_t> encodedIndices;
+			Engine::AssetBuild::MeshCompression::EncodeIndices( i_mesh.indices, encodedIndices );
+			if ( !Engine::Mesh::Codec::DecodeIndices( encodedIndices.data(), encodedIndices.size(), indexCount, indices.data() ) )
+			{
+				fprintf( stderr, "The encoded indices couldn't be decoded\n" );
+				return false;
+			}
+		}
+		size_t mismatchCount = 0;
+		for ( std::vector<sRay>::const_iterator it = i_rays.begin(); it != i_rays.end(); ++it )
+		{
+			sHit hit;
+			if ( !Engine::Mesh::Raycast::IntersectRay( i_bvh, *it, hit ) )
+			{
+				continue;
+			}
+			const Engine::AssetBuild::sVertex& vertex0 = i_mesh.vertices[indices[( hit.triangleIndex * 3 ) + 0]];
+			const Engine::AssetBuild::sVertex& vertex1 = i_mesh.vertices[indices[( hit.triangleIndex * 3 ) + 1]];
+			const Engine::AssetBuild::sVertex& vertex2 = i_mesh.vertices[indices[( hit.triangleIndex * 3 ) + 2]];
+			const float position0[3] = { vertex0.x, vertex0.y, vertex0.z };
+			const float position1[3] = { vertex1.x, vertex1.y, vertex1.z };
+			const float position2[3] = { vertex2.x, vertex2.y, vertex2.z };
+			// The rays start far from the mesh, and so the tolerance depends on how big the numbers are
+			float error = 0.0f, scale = 1.0f;
+			for ( unsigned int axis = 0; axis < 3; ++axis )
+			{
+				const float point = it->origin[axis] + ( it->direction[axis] * hit.distance );
+				const float point_barycentric = position0[axis] + ( ( position1[axis] - position0[axis] ) * hit.barycentrics[0] )
+					+ ( ( position2[axis] - position0[axis] ) * hit.barycentrics[1] );
+				error = std::fmax( error, std::fabs( point - point_barycentric ) );
+				scale = std::fmax( scale, std::fabs( it->origin[axis] ) + std::fabs( it->direction[axis] * hit.distance ) );
+			}
+			if ( error > ( 2.0e-5f * scale ) )
+			{
+				++mismatchCount;
+			}
+		}
+		if ( mismatchCount > 0 )
+		{
+			fprintf( stderr, "%u hits don't match the corners of their triangles in the decoded index buffer\n", static_cast<unsigned int>( mismatchCount ) );
+			return false;
+		}
+		return true;
+	}
+
+	bool IntersectRay_bruteForce( const sBvh& i_bvh, const sRay& i_ray, sHit& o_hit )
+	{
+		// Every triangle is tested (in double precision) without looking at the nodes
+		o_hit.distance = i_ray.maxDistance;
+		o_hit.triangleIndex = Engine::Mesh::Raycast::s_noHit;
+		for ( uint32_t i = 0; i < i_bvh.packetCount; ++i )
+		{
+			const Engine::Mesh::sBvhTrianglePacket& packet = i_bvh.packets[i];
+			for ( unsigned int lane = 0; lane < 4; ++lane )
+			{
+				if ( packet.triangleIndices[lane] == Engine::Mesh::Raycast::s_noHit )
+				{
+					continue;
+				}
+				double d[3], e1[3], e2[3], s[3];
+				for ( unsigned int axis = 0; axis < 3; ++axis )
+				{
+					d[axis] = i_ray.direction[axis];
+					e1[axis] = packet.edge1[axis][lane];
+					e2[axis] = packet.edge2[axis][lane];
+					s[axis] = static_cast<double>( i_ray.origin[axis] ) - packet.vertex0[axis][lane];
+				}
+				const double p[3] = { ( d[1] * e2[2] ) - ( d[2] * e2[1] ), ( d[2] * e2[0] ) - ( d[0] * e2[2] ), ( d[0] * e2[1] ) - ( d[1] * e2[0] ) };
+				const double determinant = ( e1[0] * p[0] ) + ( e1[1] * p[1] ) + ( e1[2] * p[2] );
+				if ( determinant == 0.0 )
+				{
+					continue;
+				}
+				const double u = ( ( s[0] * p[0] ) + ( s[1] * p[1] ) + ( s[2] * p[2] ) ) / determinant;
+				const double q[3] = { ( s[1] * e1[2] ) - ( s[2] * e1[1] ), ( s[2] * e1[0] ) - ( s[0] * e1[2] ), ( s[0] * e1[1] ) - ( s[1] * e1[0] ) };
+				const double v = ( ( d[0] * q[0] ) + ( d[1] * q[1] ) + ( d[2] * q[2] ) ) / determinant;
+				const double distance = ( ( e2[0] * q[0] ) + ( e2[1] * q[1] ) + ( e2[2] * q[2] ) ) / determinant;
+				if ( ( u >= 0.0 ) && ( v >= 0.0 ) && ( ( u + v ) <= 1.0 ) && ( distance >= 0.0 ) && ( distance < o_hit.distance ) )
+				{
+					o_hit.distance = static_cast<float>( distance );
+					o_hit.barycentrics[0] = static_cast<float>( u );
+					o_hit.barycentrics[1] = static_cast<float>( v );
+					o_hit.triangleIndex = packet.triangleIndices[lane];
+				}
+			}
+		}
+		return o_hit.triangleIndex != Engine::Mesh::Raycast::s_noHit;
+	}
+}
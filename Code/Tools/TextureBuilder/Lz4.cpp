@@ -0,0 +1,195 @@
+#include "Lz4.h"
+
+#include <cstring>
+
+namespace
+{
+	const size_t s_minMatchLength = 4;
+	// The last 5 bytes are always literals, and the last match must start at least 12 bytes before the end
+	const size_t s_lastLiteralCount = 5;
+	const size_t s_matchSearchEndDistance = 12;
+	const size_t s_maxOffset = 0xffff;
+	const unsigned int s_hashBitCount = 16;
+
+	uint32_t Read32( const uint8_t* const i_data )
+	{
+		uint32_t value;
+		memcpy( &value, i_data, sizeof( value ) );
+		return value;
+	}
+	uint32_t CalculateHash( const uint32_t i_sequence )
+	{
+		return ( i_sequence * 2654435761u ) >> ( 32 - s_hashBitCount );
+	}
+
+	uint8_t* WriteLength( size_t i_length, uint8_t* o_output );
+	bool ReadLength( const uint8_t*& io_input, const uint8_t* const i_inputEnd, size_t& io_length );
+}
+
+size_t Engine::AssetBuild::Lz4::GetMaxCompressedSize( const size_t i_size )
+{
+	return i_size + ( i_size / 255 ) + 16;
+}
+
+void Engine::AssetBuild::Lz4::Compress( const uint8_t* const i_data, const size_t i_size, std::vector<uint8_t>& o_compressedData )
+{
+	o_compressedData.resize( GetMaxCompressedSize( i_size ) );
+	uint8_t* output = o_compressedData.data();
+
+	size_t literalStart = 0;
+	if ( i_size > s_matchSearchEndDistance )
+	{
+		// Each entry is the last position (plus one, so that zero is empty) whose first 4 bytes had that hash
+		std::vector<uint32_t> positions( size_t( 1 ) << s_hashBitCount, 0 );
+		const size_t matchSearchEnd = i_size - s_matchSearchEndDistance;
+		const size_t matchEnd = i_size - s_lastLiteralCount;
+		size_t position = 0;
+		while ( position <= matchSearchEnd )
+		{
+			const uint32_t sequence = Read32( i_data + position );
+			uint32_t& entry = positions[CalculateHash( sequence )];
+			const size_t candidate = entry;
+			entry = static_cast<uint32_t>( position + 1 );
+			if ( ( candidate == 0 ) || ( ( position - ( candidate - 1 ) ) > s_maxOffset ) || ( Read32( i_data + ( candidate - 1 ) ) != sequence ) )
+			{
+				++position;
+				continue;
+			}
+			size_t matchPosition = candidate - 1;
+			// Matches are extended backwards into the literals before them and then forwards
+			while ( ( position > literalStart ) && ( matchPosition > 0 ) && ( i_data[position - 1] == i_data[matchPosition - 1] ) )
+			{
+				--position;
+				--matchPosition;
+			}
+			size_t matchLength = s_minMatchLength;
+			while ( ( ( position + matchLength ) < matchEnd ) && ( i_data[matchPosition + matchLength] == i_data[position + matchLength] ) )
+			{
+				++matchLength;
+			}
+
+			const size_t literalCount = position - literalStart;
+			const size_t offset = position - matchPosition;
+			uint8_t* const token = output++;
+			*token = static_cast<uint8_t>( ( ( literalCount < 15 ) ? literalCount : 15 ) << 4 );
+			if ( literalCount >= 15 )
+			{
+				output = WriteLength( literalCount - 15, output );
+			}
+			memcpy( output, i_data + literalStart, literalCount );
+			output += literalCount;
+			*output++ = static_cast<uint8_t>( offset & 0xff );
+			*output++ = static_cast<uint8_t>( offset >> 8 );
+			const size_t encodedMatchLength = matchLength - s_minMatchLength;
+			*token |= static_cast<uint8_t>( ( encodedMatchLength < 15 ) ? encodedMatchLength : 15 );
+			if ( encodedMatchLength >= 15 )
+			{
+				output = WriteLength( encodedMatchLength - 15, output );
+			}
+
+			position += matchLength;
+			literalStart = position;
+		}
+	}
+	{
+		const size_t literalCount = i_size - literalStart;
+		*output++ = static_cast<uint8_t>( ( ( literalCount < 15 ) ? literalCount : 15 ) << 4 );
+		if ( literalCount >= 15 )
+		{
+			output = WriteLength( literalCount - 15, output );
+		}
+		if ( literalCount > 0 )
+		{
+			memcpy( output, i_data + literalStart, literalCount );
+			output += literalCount;
+		}
+	}
+	o_compressedData.resize( output - o_compressedData.data() );
+}
+
+bool Engine::AssetBuild::Lz4::Decompress( const uint8_t* const i_compressedData, const size_t i_compressedSize, uint8_t* const o_data, const size_t i_size )
+{
+	const uint8_t* input = i_compressedData;
+	const uint8_t* const inputEnd = i_compressedData + i_compressedSize;
+	size_t outputPosition = 0;
+	while ( input < inputEnd )
+	{
+		const uint8_t token = *input++;
+		size_t literalCount = token >> 4;
+		if ( ( literalCount == 15 ) && !ReadLength( input, inputEnd, literalCount ) )
+		{
+			return false;
+		}
+		if ( ( literalCount > static_cast<size_t>( inputEnd - input ) ) || ( literalCount > ( i_size - outputPosition ) ) )
+		{
+			return false;
+		}
+		memcpy( o_data + outputPosition, input, literalCount );
+		input += literalCount;
+		outputPosition += literalCount;
+		// The last sequence only has literals
+		if ( input == inputEnd )
+		{
+			return outputPosition == i_size;
+		}
+
+		if ( ( inputEnd - input ) < 2 )
+		{
+			return false;
+		}
+		const size_t offset = input[0] | ( static_cast<size_t>( input[1] ) << 8 );
+		input += 2;
+		if ( ( offset == 0 ) || ( offset > outputPosition ) )
+		{
+			return false;
+		}
+		size_t matchLength = token & 0xf;
+		if ( ( matchLength == 15 ) && !ReadLength( input, inputEnd, matchLength ) )
+		{
+			return false;
+		}
+		matchLength += s_minMatchLength;
+		if ( matchLength > ( i_size - outputPosition ) )
+		{
+			return false;
+		}
+		// A match can overlap the bytes that it is copying (to repeat a short pattern), and so it is copied a byte at a time
+		const uint8_t* match = o_data + ( outputPosition - offset );
+		uint8_t* output = o_data + outputPosition;
+		for ( size_t i = 0; i < matchLength; ++i )
+		{
+			output[i] = match[i];
+		}
+		outputPosition += matchLength;
+	}
+	return false;
+}
+
+namespace
+{
+	uint8_t* WriteLength( size_t i_length, uint8_t* o_output )
+	{
+		while ( i_length >= 255 )
+		{
+			*o_output++ = 255;
+			i_length -= 255;
+		}
+		*o_output++ = static_cast<uint8_t>( i_length );
+		return o_output;
+	}
+
+	bool ReadLength( const uint8_t*& io_input, const uint8_t* const i_inputEnd, size_t& io_length )
+	{
+		uint8_t byte;
+		do
+		{
+			if ( io_input >= i_inputEnd )
+			{
+				return false;
+			}
+			byte = *io_input++;
+			io_length += byte;
+		} while ( byte == 255 );
+		return true;
+	}
+}
@@ -0,0 +1,32 @@
+#ifndef TEXTUREBUILDER_LZ4_H
+#define TEXTUREBUILDER_LZ4_H
+
+// A compressor and decompressor for the LZ4 block format
+// (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md),
+// which decompresses many times faster than PNG or JPEG files can be decoded
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace Lz4
+		{
+			// Blocks can't be bigger than this
+			const size_t s_maxInputSize = 0x7e000000;
+
+			size_t GetMaxCompressedSize( const size_t i_size );
+
+			// The data is compressed greedily (taking the first match that is found for each position),
+			// and o_compressedData is resized to the compressed size
+			void Compress( const uint8_t* const i_data, const size_t i_size, std::vector<uint8_t>& o_compressedData );
+			// This fails if the compressed data is corrupt or doesn't decompress to exactly i_size bytes
+			bool Decompress( const uint8_t* const i_compressedData, const size_t i_compressedSize, uint8_t* const o_data, const size_t i_size );
+		}
+	}
+}
+
+#endif
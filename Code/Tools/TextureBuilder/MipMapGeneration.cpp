@@ -0,0 +1,350 @@
+#include "MipMapGeneration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <emmintrin.h>
+#include <vector>
+#include "../AssetBuildLibrary/Parallel.h"
+
+namespace
+{
+	using Engine::AssetBuild::MipMapGeneration::eFilter;
+	using Engine::AssetBuild::MipMapGeneration::eContent;
+	using Engine::AssetBuild::MipMapGeneration::sLevel;
+
+	// Tiles of rows are big enough that the cost of handing them out doesn't matter, but small enough that every thread gets some
+	const size_t s_pixelCountPerTile = 16 * 1024;
+	const float s_kaiserRadius = 3.0f;
+	const float s_kaiserAlpha = 4.0f;
+
+	// The weights of every source pixel that contributes to each target pixel along one axis.
+	// Every target pixel has the same number of taps (with zero weights at the end for the ones that need fewer),
+	// and the source indices are already clamped to the edges
+	struct sAxisWeights
+	{
+		std::vector<uint32_t> sourceIndices;
+		std::vector<float> weights;
+		size_t tapCount;
+	};
+
+	// Converting with pow() would take longer than the filtering itself,
+	// and so both conversions interpolate between samples of the exact curves
+	// (which is accurate to much better than the 8 bits per channel that textures are compressed to)
+	const size_t s_srgbTableSize = 4096;
+	struct sSrgbTables
+	{
+		float toLinear[s_srgbTableSize + 1];
+		float toSrgb[s_srgbTableSize + 1];
+
+		sSrgbTables();
+	};
+
+	void CalculateAxisWeights( const eFilter i_filter, const size_t i_sourceSize, const size_t i_targetSize, sAxisWeights& o_weights );
+	void FilterLevel( const eFilter i_filter, const eContent i_content, const float* const i_source, const bool i_isSourceEncoded,
+		const size_t i_sourceWidth, const size_t i_sourceHeight, const sLevel& o_target, float* const o_linearTarget );
+
+	const sSrgbTables& GetSrgbTables();
+	float Interpolate( const float* const i_table, const float i_value );
+	void DecodeRow( const eContent i_content, const float* const i_pixels, const size_t i_pixelCount, float* const o_pixels );
+	float EvaluateKernel( const eFilter i_filter, const float i_x );
+	float GetKernelRadius( const eFilter i_filter );
+}
+
+void Engine::AssetBuild::MipMapGeneration::GenerateMipChain( const eFilter i_filter, const eContent i_content,
+	const sLevel* const io_levels, const size_t i_levelCount )
+{
+	// Every level is filtered from the one before it in linear space,
+	// and so (unless the content is already linear) the linear version of the previous level is kept alongside the encoded one
+	// instead of being decoded again
+	std::vector<float> linearPrevious, linearCurrent;
+	for ( size_t i = 1; i < i_levelCount; ++i )
+	{
+		const sLevel& source = io_levels[i - 1];
+		const sLevel& target = io_levels[i];
+		const bool isSourceEncoded = ( i == 1 ) && ( i_content != Linear );
+		const float* const sourcePixels = ( ( i == 1 ) || ( i_content == Linear ) ) ? source.pixels : linearPrevious.data();
+		float* linearTarget = NULL;
+		if ( i_content != Linear )
+		{
+			linearCurrent.resize( target.width * target.height * 4 );
+			linearTarget = linearCurrent.data();
+		}
+		FilterLevel( i_filter, i_content, sourcePixels, isSourceEncoded, source.width, source.height, target, linearTarget );
+		linearPrevious.swap( linearCurrent );
+	}
+}
+
+namespace
+{
+	void CalculateAxisWeights( const eFilter i_filter, const size_t i_sourceSize, const size_t i_targetSize, sAxisWeights& o_weights )
+	{
+		const double scale = static_cast<double>( i_sourceSize ) / static_cast<double>( i_targetSize );
+		const double radius = GetKernelRadius( i_filter ) * scale;
+		// The number of source pixels that the kernel can overlap
+		o_weights.tapCount = static_cast<size_t>( std::ceil( radius * 2.0 ) ) + 1;
+		o_weights.sourceIndices.assign( i_targetSize * o_weights.tapCount, 0 );
+		o_weights.weights.assign( i_targetSize * o_weights.tapCount, 0.0f );
+		for ( size_t i = 0; i < i_targetSize; ++i )
+		{
+			// Pixel centers are at half coordinates
+			const double center = ( static_cast<double>( i ) + 0.5 ) * scale;
+			const ptrdiff_t firstSourceIndex = static_cast<ptrdiff_t>( std::floor( center - radius ) );
+			uint32_t* const sourceIndices = &o_weights.sourceIndices[i * o_weights.tapCount];
+			float* const weights = &o_weights.weights[i * o_weights.tapCount];
+			double weightSum = 0.0;
+			for ( size_t j = 0; j < o_weights.tapCount; ++j )
+			{
+				const ptrdiff_t sourceIndex = firstSourceIndex + static_cast<ptrdiff_t>( j );
+				double weight;
+				if ( i_filter == Engine::AssetBuild::MipMapGeneration::Box )
+				{
+					// A box is integrated over each source pixel rather than sampled at its center,
+					// so that it is an exact average even when the source size is odd
+					const double overlapBegin = std::max( static_cast<double>( sourceIndex ), center - radius );
+					const double overlapEnd = std::min( static_cast<double>( sourceIndex + 1 ), center + radius );
+					weight = std::max( overlapEnd - overlapBegin, 0.0 );
+				}
+				else
+				{
+					weight = EvaluateKernel( i_filter, static_cast<float>( ( ( static_cast<double>( sourceIndex ) + 0.5 ) - center ) / scale ) );
+				}
+				sourceIndices[j] = static_cast<uint32_t>(
+					std::min( std::max<ptrdiff_t>( sourceIndex, 0 ), static_cast<ptrdiff_t>( i_sourceSize ) - 1 ) );
+				weights[j] = static_cast<float>( weight );
+				weightSum += weight;
+			}
+			if ( weightSum != 0.0 )
+			{
+				for ( size_t j = 0; j < o_weights.tapCount; ++j )
+				{
+					weights[j] = static_cast<float>( weights[j] / weightSum );
+				}
+			}
+		}
+	}
+
+	void FilterLevel( const eFilter i_filter, const eContent i_content, const float* const i_source, const bool i_isSourceEncoded,
+		const size_t i_sourceWidth, const size_t i_sourceHeight, const sLevel& o_target, float* const o_linearTarget )
+	{
+		sAxisWeights horizontalWeights, verticalWeights;
+		CalculateAxisWeights( i_filter, i_sourceWidth, o_target.width, horizontalWeights );
+		CalculateAxisWeights( i_filter, i_sourceHeight, o_target.height, verticalWeights );
+		const sSrgbTables& srgbTables = GetSrgbTables();
+
+		// The kernels are separable, and so every source row is first filtered horizontally
+		// and then every target row is filtered vertically from those
+		std::vector<float> horizontallyFiltered( i_sourceHeight * o_target.width * 4 );
+		{
+			const size_t rowCountPerTile = std::max<size_t>( s_pixelCountPerTile / i_sourceWidth, 1 );
+			const size_t tileCount = ( i_sourceHeight + rowCountPerTile - 1 ) / rowCountPerTile;
+			Engine::AssetBuild::ParallelFor( tileCount,
+				[&]( const size_t i_tileIndex )
+				{
+					std::vector<float> decodedRow( i_isSourceEncoded ? ( i_sourceWidth * 4 ) : 0 );
+					const size_t firstRow = i_tileIndex * rowCountPerTile;
+					const size_t endRow = std::min( firstRow + rowCountPerTile, i_sourceHeight );
+					for ( size_t y = firstRow; y < endRow; ++y )
+					{
+						const float* sourceRow = i_source + ( y * i_sourceWidth * 4 );
+						if ( i_isSourceEncoded )
+						{
+							DecodeRow( i_content, sourceRow, i_sourceWidth, decodedRow.data() );
+							sourceRow = decodedRow.data();
+						}
+						float* const targetRow = &horizontallyFiltered[y * o_target.width * 4];
+						for ( size_t x = 0; x < o_target.width; ++x )
+						{
+							const uint32_t* const sourceIndices = &horizontalWeights.sourceIndices[x * horizontalWeights.tapCount];
+							const float* const weights = &horizontalWeights.weights[x * horizontalWeights.tapCount];
+							__m128 sum = _mm_setzero_ps();
+							for ( size_t j = 0; j < horizontalWeights.tapCount; ++j )
+							{
+								sum = _mm_add_ps( sum, _mm_mul_ps( _mm_set1_ps( weights[j] ), _mm_loadu_ps( sourceRow + ( sourceIndices[j] * 4 ) ) ) );
+							}
+							_mm_storeu_ps( targetRow + ( x * 4 ), sum );
+						}
+					}
+				} );
+		}
+		{
+			const size_t rowCountPerTile = std::max<size_t>( s_pixelCountPerTile / o_target.width, 1 );
+			const size_t tileCount = ( o_target.height + rowCountPerTile - 1 ) / rowCountPerTile;
+			const size_t floatCountPerRow = o_target.width * 4;
+			Engine::AssetBuild::ParallelFor( tileCount,
+				[&]( const size_t i_tileIndex )
+				{
+					std::vector<float> sum( floatCountPerRow );
+					const size_t firstRow = i_tileIndex * rowCountPerTile;
+					const size_t endRow = std::min( firstRow + rowCountPerTile, o_target.height );
+					for ( size_t y = firstRow; y < endRow; ++y )
+					{
+						const uint32_t* const sourceIndices = &verticalWeights.sourceIndices[y * verticalWeights.tapCount];
+						const float* const weights = &verticalWeights.weights[y * verticalWeights.tapCount];
+						std::fill( sum.begin(), sum.end(), 0.0f );
+						// Whole rows are accumulated one tap at a time so that every row is read in order
+						for ( size_t j = 0; j < verticalWeights.tapCount; ++j )
+						{
+							if ( weights[j] == 0.0f )
+							{
+								continue;
+							}
+							const __m128 weight = _mm_set1_ps( weights[j] );
+							const float* const sourceRow = &horizontallyFiltered[sourceIndices[j] * floatCountPerRow];
+							for ( size_t k = 0; k < floatCountPerRow; k += 4 )
+							{
+								_mm_storeu_ps( &sum[k], _mm_add_ps( _mm_loadu_ps( &sum[k] ), _mm_mul_ps( weight, _mm_loadu_ps( sourceRow + k ) ) ) );
+							}
+						}
+						float* const targetRow = o_target.pixels + ( y * floatCountPerRow );
+						float* const linearTargetRow = o_linearTarget ? ( o_linearTarget + ( y * floatCountPerRow ) ) : NULL;
+						const __m128 zero = _mm_setzero_ps();
+						const __m128 one = _mm_set1_ps( 1.0f );
+						const __m128 half = _mm_set1_ps( 0.5f );
+						for ( size_t k = 0; k < floatCountPerRow; k += 4 )
+						{
+							__m128 pixel = _mm_loadu_ps( &sum[k] );
+							float values[4];
+							if ( i_content != Engine::AssetBuild::MipMapGeneration::NormalMap )
+							{
+								// Kaiser's negative lobes can overshoot
+								pixel = _mm_min_ps( _mm_max_ps( pixel, zero ), one );
+								if ( linearTargetRow )
+								{
+									_mm_storeu_ps( linearTargetRow + k, pixel );
+								}
+								_mm_storeu_ps( values, pixel );
+								if ( i_content == Engine::AssetBuild::MipMapGeneration::Color )
+								{
+									for ( size_t channel = 0; channel < 3; ++channel )
+									{
+										values[channel] = Interpolate( srgbTables.toSrgb, values[channel] );
+									}
+								}
+							}
+							else
+							{
+								// Averaging shortens vectors, and so they are renormalized (but alpha is left as it is)
+								_mm_storeu_ps( values, _mm_mul_ps( pixel, pixel ) );
+								const float length = std::sqrt( values[0] + values[1] + values[2] );
+								_mm_storeu_ps( values, pixel );
+								if ( length > 0.0f )
+								{
+									values[0] /= length;
+									values[1] /= length;
+									values[2] /= length;
+								}
+								else
+								{
+									values[0] = values[1] = 0.0f;
+									values[2] = 1.0f;
+								}
+								values[3] = std::min( std::max( values[3], 0.0f ), 1.0f );
+								_mm_storeu_ps( linearTargetRow + k, _mm_loadu_ps( values ) );
+								const float alpha = values[3];
+								_mm_storeu_ps( values, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( values ), half ), half ) );
+								values[3] = alpha;
+							}
+							_mm_storeu_ps( targetRow + k, _mm_loadu_ps( values ) );
+						}
+					}
+				} );
+		}
+	}
+
+	sSrgbTables::sSrgbTables()
+	{
+		for ( size_t i = 0; i <= s_srgbTableSize; ++i )
+		{
+			const double value = static_cast<double>( i ) / static_cast<double>( s_srgbTableSize );
+			toLinear[i] = static_cast<float>( ( value <= 0.04045 ) ? ( value / 12.92 ) : std::pow( ( value + 0.055 ) / 1.055, 2.4 ) );
+			toSrgb[i] = static_cast<float>( ( value <= 0.0031308 ) ? ( value * 12.92 ) : ( ( 1.055 * std::pow( value, 1.0 / 2.4 ) ) - 0.055 ) );
+		}
+	}
+
+	const sSrgbTables& GetSrgbTables()
+	{
+		static const sSrgbTables s_tables;
+		return s_tables;
+	}
+
+	float Interpolate( const float* const i_table, const float i_value )
+	{
+		const float position = std::min( std::max( i_value, 0.0f ), 1.0f ) * static_cast<float>( s_srgbTableSize );
+		const size_t index = std::min( static_cast<size_t>( position ), s_srgbTableSize - 1 );
+		const float t = position - static_cast<float>( index );
+		return i_table[index] + ( ( i_table[index + 1] - i_table[index] ) * t );
+	}
+
+	void DecodeRow( const eContent i_content, const float* const i_pixels, const size_t i_pixelCount, float* const o_pixels )
+	{
+		const sSrgbTables& srgbTables = GetSrgbTables();
+		for ( size_t i = 0; i < i_pixelCount; ++i )
+		{
+			const float* const pixel = i_pixels + ( i * 4 );
+			float* const decodedPixel = o_pixels + ( i * 4 );
+			if ( i_content == Engine::AssetBuild::MipMapGeneration::Color )
+			{
+				for ( size_t j = 0; j < 3; ++j )
+				{
+					decodedPixel[j] = Interpolate( srgbTables.toLinear, pixel[j] );
+				}
+			}
+			else
+			{
+				for ( size_t j = 0; j < 3; ++j )
+				{
+					decodedPixel[j] = ( pixel[j] * 2.0f ) - 1.0f;
+				}
+			}
+			decodedPixel[3] = pixel[3];
+		}
+	}
+
+	float EvaluateKernel( const eFilter i_filter, const float i_x )
+	{
+		const float x = std::abs( i_x );
+		switch ( i_filter )
+		{
+			case Engine::AssetBuild::MipMapGeneration::Box:
+				return ( x <= 0.5f ) ? 1.0f : 0.0f;
+			case Engine::AssetBuild::MipMapGeneration::Triangle:
+				return std::max( 1.0f - x, 0.0f );
+			case Engine::AssetBuild::MipMapGeneration::Kaiser:
+				{
+					if ( x >= s_kaiserRadius )
+					{
+						return 0.0f;
+					}
+					// The window is the zeroth-order modified Bessel function of the first kind, evaluated with its power series
+					const auto besselI0 = []( const float i_x )
+					{
+						float sum = 1.0f, term = 1.0f;
+						const float halfXSquared = ( i_x * i_x ) * 0.25f;
+						for ( int k = 1; ( k < 32 ) && ( term > ( sum * 1.0e-8f ) ); ++k )
+						{
+							term *= halfXSquared / static_cast<float>( k * k );
+							sum += term;
+						}
+						return sum;
+					};
+					const float pi = 3.14159265358979f;
+					const float sinc = ( x < 1.0e-6f ) ? 1.0f : ( std::sin( pi * x ) / ( pi * x ) );
+					const float t = x / s_kaiserRadius;
+					return sinc * ( besselI0( s_kaiserAlpha * std::sqrt( 1.0f - ( t * t ) ) ) / besselI0( s_kaiserAlpha ) );
+				}
+		}
+		return 0.0f;
+	}
+
+	float GetKernelRadius( const eFilter i_filter )
+	{
+		switch ( i_filter )
+		{
+			case Engine::AssetBuild::MipMapGeneration::Box: return 0.5f;
+			case Engine::AssetBuild::MipMapGeneration::Triangle: return 1.0f;
+			case Engine::AssetBuild::MipMapGeneration::Kaiser: return s_kaiserRadius;
+		}
+		return 0.5f;
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef TEXTUREBUILDER_MIPMAPGENERATION_H
+#define TEXTUREBUILDER_MIPMAPGENERATION_H
+
+#include <cstddef>
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace MipMapGeneration
+		{
+			enum eFilter
+			{
+				// Each pixel is the average of the area that it covers in the previous level (the fastest, but the most aliased)
+				Box,
+				// A tent twice as wide as the box, which blurs a little more but aliases much less
+				Triangle,
+				// A sinc windowed by a Kaiser window, which keeps the most detail (but can ring a little at hard edges)
+				Kaiser,
+			};
+
+			enum eContent
+			{
+				// Red, green, and blue are sRGB-encoded and are filtered after converting them to linear
+				// (alpha is always linear)
+				Color,
+				// Every channel is filtered as it is
+				Linear,
+				// Red, green, and blue are a vector encoded in [0,1] that is renormalized after filtering
+				NormalMap,
+			};
+
+			// A level of a MIP chain whose pixels are 4 floats each (in RGBA order) with no padding between rows
+			struct sLevel
+			{
+				float* pixels;
+				size_t width, height;
+			};
+
+			// Fills every level in io_levels after the first one from the level before it.
+			// Each level must be half the size of the one before it (rounded down, but never less than 1),
+			// and the first level is never changed.
+			// Every level is computed on all of the worker threads, split into tiles of rows,
+			// and the results don't depend on how many threads there are
+			void GenerateMipChain( const eFilter i_filter, const eContent i_content, const sLevel* const io_levels, const size_t i_levelCount );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,174 @@
+#include "SourceImageCache.h"
+
+#include <cstring>
+#include <vector>
+#include "../../Engine/Platform/Platform.h"
+#include "Lz4.h"
+
+namespace
+{
+	// "SIMG" when read as bytes
+	const uint32_t s_fileMagic = 0x474d4953;
+	// Entries with a different version are ignored (and replaced)
+	const uint32_t s_fileVersion = 1;
+
+	namespace Compressions
+	{
+		enum eCompression
+		{
+			// Images that LZ4 can't make smaller (like noisy photographs) are stored as they are
+			Uncompressed,
+			Lz4,
+		};
+	}
+
+	struct sFileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		// The key is stored too so that a hash collision can't return the wrong image
+		uint64_t contentHash;
+		uint64_t contentSize;
+		uint32_t width, height;
+		uint32_t hasAlpha;
+		uint32_t compression;
+		// The size of the pixel data that follows the header
+		uint64_t dataSize;
+	};
+
+	std::string GetEntryPath( const std::string& i_directory, const Engine::AssetBuild::SourceImageCache::sKey& i_key );
+}
+
+Engine::AssetBuild::SourceImageCache::sKey Engine::AssetBuild::SourceImageCache::CalculateKey( const uint8_t* const i_data, const size_t i_size )
+{
+	// 64-bit FNV-1a
+	uint64_t hash = 0xcbf29ce484222325;
+	for ( size_t i = 0; i < i_size; ++i )
+	{
+		hash ^= i_data[i];
+		hash *= 0x100000001b3;
+	}
+	sKey key;
+	key.contentHash = hash;
+	key.contentSize = i_size;
+	return key;
+}
+
+bool Engine::AssetBuild::SourceImageCache::Load( const std::string& i_directory, const sKey& i_key, ImageDecoding::sImage& o_image )
+{
+	bool wasEntryLoaded = false;
+
+	Platform::sDataFromFile dataFromFile;
+	if ( !Platform::LoadBinaryFile( GetEntryPath( i_directory, i_key ).c_str(), dataFromFile ) )
+	{
+		goto OnExit;
+	}
+	{
+		if ( dataFromFile.size < sizeof( sFileHeader ) )
+		{
+			goto OnExit;
+		}
+		sFileHeader header;
+		memcpy( &header, dataFromFile.data, sizeof( header ) );
+		if ( ( header.magic != s_fileMagic ) || ( header.version != s_fileVersion )
+			|| ( header.contentHash != i_key.contentHash ) || ( header.contentSize != i_key.contentSize )
+			|| ( header.dataSize != ( dataFromFile.size - sizeof( sFileHeader ) ) ) )
+		{
+			goto OnExit;
+		}
+		const uint8_t* const data = reinterpret_cast<const uint8_t*>( dataFromFile.data ) + sizeof( sFileHeader );
+		const size_t pixelByteCount = static_cast<size_t>( header.width ) * header.height * 4;
+		o_image.width = header.width;
+		o_image.height = header.height;
+		o_image.hasAlpha = header.hasAlpha != 0;
+		o_image.pixels.resize( pixelByteCount );
+		if ( header.compression == Compressions::Uncompressed )
+		{
+			if ( header.dataSize != pixelByteCount )
+			{
+				goto OnExit;
+			}
+			memcpy( o_image.pixels.data(), data, pixelByteCount );
+		}
+		else if ( header.compression == Compressions::Lz4 )
+		{
+			if ( !Lz4::Decompress( data, static_cast<size_t>( header.dataSize ), o_image.pixels.data(), pixelByteCount ) )
+			{
+				goto OnExit;
+			}
+		}
+		else
+		{
+			goto OnExit;
+		}
+		wasEntryLoaded = true;
+	}
+
+OnExit:
+
+	dataFromFile.Free();
+	if ( !wasEntryLoaded )
+	{
+		o_image = ImageDecoding::sImage();
+	}
+
+	return wasEntryLoaded;
+}
+
+bool Engine::AssetBuild::SourceImageCache::Save( const std::string& i_directory, const sKey& i_key, const ImageDecoding::sImage& i_image,
+	std::string* const o_errorMessage )
+{
+	const std::string path = GetEntryPath( i_directory, i_key );
+	if ( !Platform::CreateDirectoryIfNecessary( path, o_errorMessage ) )
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> compressedPixels;
+	if ( i_image.pixels.size() <= Lz4::s_maxInputSize )
+	{
+		Lz4::Compress( i_image.pixels.data(), i_image.pixels.size(), compressedPixels );
+	}
+	const bool shouldBeCompressed = !compressedPixels.empty() && ( compressedPixels.size() < i_image.pixels.size() );
+	const std::vector<uint8_t>& pixelsToWrite = shouldBeCompressed ? compressedPixels : i_image.pixels;
+
+	sFileHeader header;
+	header.magic = s_fileMagic;
+	header.version = s_fileVersion;
+	header.contentHash = i_key.contentHash;
+	header.contentSize = i_key.contentSize;
+	header.width = static_cast<uint32_t>( i_image.width );
+	header.height = static_cast<uint32_t>( i_image.height );
+	header.hasAlpha = i_image.hasAlpha ? 1 : 0;
+	header.compression = shouldBeCompressed ? Compressions::Lz4 : Compressions::Uncompressed;
+	header.dataSize = pixelsToWrite.size();
+
+	// Two builders that save the same image at once write the same bytes,
+	// and an entry that is only partly written doesn't match its header and so is ignored when it's loaded
+	std::vector<uint8_t> file( sizeof( sFileHeader ) + pixelsToWrite.size() );
+	memcpy( file.data(), &header, sizeof( header ) );
+	if ( !pixelsToWrite.empty() )
+	{
+		memcpy( file.data() + sizeof( header ), pixelsToWrite.data(), pixelsToWrite.size() );
+	}
+	return Platform::WriteBinaryFile( path.c_str(), file.data(), file.size(), o_errorMessage );
+}
+
+namespace
+{
+	std::string GetEntryPath( const std::string& i_directory, const Engine::AssetBuild::SourceImageCache::sKey& i_key )
+	{
+		static const char* const s_hexDigits = "0123456789abcdef";
+		std::string path = i_directory;
+		if ( !path.empty() && ( path.back() != '/' ) && ( path.back() != '\\' ) )
+		{
+			path += '/';
+		}
+		for ( int shift = 60; shift >= 0; shift -= 4 )
+		{
+			path += s_hexDigits[( i_key.contentHash >> shift ) & 0xf];
+		}
+		path += ".rgba";
+		return path;
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef TEXTUREBUILDER_SOURCEIMAGECACHE_H
+#define TEXTUREBUILDER_SOURCEIMAGECACHE_H
+
+// Decoded source images are kept in a directory that is shared by every platform and configuration,
+// named by a hash of the source file's contents.
+// A texture that is rebuilt because its preset changed (or that is built for the other platform)
+// then only has to read its decoded pixels back instead of decoding its source again.
+// The pixels are cached as the decoded 8-bit RGBA values and not converted to linear:
+// the same source can be built with a usage whose channels are sRGB-encoded color or with one whose channels are already linear
+// (like normal maps), the top MIP level is compressed from the encoded values,
+// and the conversion that MIP generation does is a table lookup that costs much less than decoding.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "../ImageDecoding/ImageDecoding.h"
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace SourceImageCache
+		{
+			// The cache is only used when this environment variable is set
+			const char* const s_directoryEnvironmentVariable = "SourceImageCacheDir";
+
+			struct sKey
+			{
+				uint64_t contentHash;
+				uint64_t contentSize;
+			};
+
+			sKey CalculateKey( const uint8_t* const i_data, const size_t i_size );
+
+			// These return false if the cache doesn't have the image (or if its entry is corrupt or from a different version of this code),
+			// and an image that can't be saved is just decoded again the next time
+			bool Load( const std::string& i_directory, const sKey& i_key, ImageDecoding::sImage& o_image );
+			bool Save( const std::string& i_directory, const sKey& i_key, const ImageDecoding::sImage& i_image, std::string* const o_errorMessage = NULL );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "TextureArray.h"
+
+#include <sstream>
+#include "../../External/Lua/Includes.h"
+#include "../AssetBuildLibrary/UtilityFunctions.h"
+
+namespace
+{
+	bool LoadLayers( lua_State& io_luaState, const char* const i_path, std::vector<std::string>& o_layerPaths );
+}
+
+bool Engine::AssetBuild::TextureArray::LoadDescription( const char* const i_path, sDescription& o_description )
+{
+	bool wereThereErrors = false;
+
+	lua_State* luaState = NULL;
+	if ( !LoadTableFromFile( i_path, "Texture array files must return a single table", luaState ) )
+	{
+		wereThereErrors = true;
+		goto OnExit;
+	}
+
+	if ( !LoadLayers( *luaState, i_path, o_description.layerPaths ) )
+	{
+		wereThereErrors = true;
+	}
+	lua_pop( luaState, 1 );
+
+OnExit:
+
+	if ( luaState )
+	{
+		lua_close( luaState );
+		luaState = NULL;
+	}
+
+	return !wereThereErrors;
+}
+
+namespace
+{
+	bool LoadLayers( lua_State& io_luaState, const char* const i_path, std::vector<std::string>& o_layerPaths )
+	{
+		bool wereThereErrors = false;
+
+		lua_getfield( &io_luaState, -1, "layers" );
+		if ( !lua_istable( &io_luaState, -1 ) )
+		{
+			Engine::AssetBuild::OutputErrorMessage( "Texture array files must have a table of layers", i_path );
+			lua_pop( &io_luaState, 1 );
+			return false;
+		}
+		const size_t layerCount = static_cast<size_t>( luaL_len( &io_luaState, -1 ) );
+		for ( size_t i = 1; i <= layerCount; ++i )
+		{
+			lua_rawgeti( &io_luaState, -1, static_cast<int>( i ) );
+			if ( lua_type( &io_luaState, -1 ) == LUA_TSTRING )
+			{
+				o_layerPaths.push_back( lua_tostring( &io_luaState, -1 ) );
+			}
+			else
+			{
+				wereThereErrors = true;
+				std::ostringstream errorMessage;
+				errorMessage << "Layer #" << i << " in the texture array must be a path (instead of a " << luaL_typename( &io_luaState, -1 ) << ")";
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path );
+			}
+			lua_pop( &io_luaState, 1 );
+		}
+		lua_pop( &io_luaState, 1 );
+
+		// Direct3D 11 texture arrays can't have more than 2048 layers
+		if ( !wereThereErrors && ( o_layerPaths.empty() || ( o_layerPaths.size() > 2048 ) ) )
+		{
+			wereThereErrors = true;
+			Engine::AssetBuild::OutputErrorMessage( "Texture array files must have between 1 and 2048 layers", i_path );
+		}
+		return !wereThereErrors;
+	}
+}
@@ -0,0 +1,27 @@
+#ifndef TEXTUREBUILDER_TEXTUREARRAY_H
+#define TEXTUREBUILDER_TEXTUREARRAY_H
+
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace TextureArray
+		{
+			// A texture array source file is a Lua table with the images to build into the array's layers
+			// (see Assets/TextureArrays/cement_wall.texarray)
+			struct sDescription
+			{
+				// Relative to the authored asset directory, in the order of the layers.
+				// Every image must be the same size, and every layer is compressed to the same format
+				std::vector<std::string> layerPaths;
+			};
+
+			bool LoadDescription( const char* const i_path, sDescription& o_description );
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,293 @@
+#include "TextureAtlas.h"
+
+#include <algorithm>
+#include <sstream>
+#include "../../External/Lua/Includes.h"
+#include "../AssetBuildLibrary/UtilityFunctions.h"
+
+namespace
+{
+	struct sRectangle
+	{
+		size_t x, y, width, height;
+
+		bool Contains( const sRectangle& i_other ) const
+		{
+			return ( i_other.x >= x ) && ( i_other.y >= y )
+				&& ( ( i_other.x + i_other.width ) <= ( x + width ) ) && ( ( i_other.y + i_other.height ) <= ( y + height ) );
+		}
+		bool Intersects( const sRectangle& i_other ) const
+		{
+			return ( i_other.x < ( x + width ) ) && ( x < ( i_other.x + i_other.width ) )
+				&& ( i_other.y < ( y + height ) ) && ( y < ( i_other.y + i_other.height ) );
+		}
+	};
+
+	// The free rectangles of a page are maximal, and so they can overlap each other
+	struct sPage
+	{
+		std::vector<sRectangle> freeRectangles;
+	};
+
+	bool LoadImages( lua_State& io_luaState, const char* const i_path, std::vector<Engine::AssetBuild::TextureAtlas::sImage>& o_images );
+	bool LoadSize( lua_State& io_luaState, const char* const i_key, const char* const i_path, size_t& io_size );
+	bool FindPosition( const sPage& i_page, const size_t i_width, const size_t i_height, sRectangle& o_position );
+	void PlaceRectangle( sPage& io_page, const sRectangle& i_rectangle );
+}
+
+bool Engine::AssetBuild::TextureAtlas::LoadDescription( const char* const i_path, sDescription& o_description )
+{
+	bool wereThereErrors = false;
+
+	lua_State* luaState = NULL;
+	if ( !LoadTableFromFile( i_path, "Atlas files must return a single table", luaState ) )
+	{
+		wereThereErrors = true;
+		goto OnExit;
+	}
+
+	if ( !LoadSize( *luaState, "pageSize", i_path, o_description.pageSize ) || !LoadSize( *luaState, "padding", i_path, o_description.padding )
+		|| !LoadImages( *luaState, i_path, o_description.images ) )
+	{
+		wereThereErrors = true;
+	}
+	else if ( ( o_description.pageSize < 4 ) || ( ( o_description.pageSize % 4 ) != 0 ) || ( o_description.pageSize > 16384 ) )
+	{
+		// Pages are block compressed, and Direct3D 11 textures can't be bigger than 16384
+		wereThereErrors = true;
+		OutputErrorMessage( "The atlas's pageSize must be a multiple of 4 that isn't bigger than 16384", i_path );
+	}
+	lua_pop( luaState, 1 );
+
+OnExit:
+
+	if ( luaState )
+	{
+		lua_close( luaState );
+		luaState = NULL;
+	}
+
+	return !wereThereErrors;
+}
+
+bool Engine::AssetBuild::TextureAtlas::Pack( const std::vector<sSize>& i_sizes, const size_t i_pageSize,
+	std::vector<sPlacement>& o_placements, size_t& o_pageCount )
+{
+	// Big rectangles are the hardest to fit, and so they are placed while there is the most room
+	std::vector<size_t> order( i_sizes.size() );
+	for ( size_t i = 0; i < order.size(); ++i )
+	{
+		order[i] = i;
+	}
+	std::stable_sort( order.begin(), order.end(),
+		[&i_sizes]( const size_t i_a, const size_t i_b )
+		{
+			const size_t longSide_a = std::max( i_sizes[i_a].width, i_sizes[i_a].height );
+			const size_t longSide_b = std::max( i_sizes[i_b].width, i_sizes[i_b].height );
+			if ( longSide_a != longSide_b )
+			{
+				return longSide_a > longSide_b;
+			}
+			return ( i_sizes[i_a].width * i_sizes[i_a].height ) > ( i_sizes[i_b].width * i_sizes[i_b].height );
+		} );
+
+	std::vector<sPage> pages;
+	o_placements.resize( i_sizes.size() );
+	for ( std::vector<size_t>::const_iterator it = order.begin(); it != order.end(); ++it )
+	{
+		const sSize& size = i_sizes[*it];
+		if ( ( size.width > i_pageSize ) || ( size.height > i_pageSize ) )
+		{
+			return false;
+		}
+		sRectangle position;
+		size_t pageIndex = 0;
+		while ( ( pageIndex < pages.size() ) && !FindPosition( pages[pageIndex], size.width, size.height, position ) )
+		{
+			++pageIndex;
+		}
+		if ( pageIndex == pages.size() )
+		{
+			sPage page;
+			const sRectangle wholePage = { 0, 0, i_pageSize, i_pageSize };
+			page.freeRectangles.push_back( wholePage );
+			pages.push_back( page );
+			FindPosition( pages.back(), size.width, size.height, position );
+		}
+		PlaceRectangle( pages[pageIndex], position );
+		o_placements[*it].pageIndex = pageIndex;
+		o_placements[*it].x = position.x;
+		o_placements[*it].y = position.y;
+	}
+	o_pageCount = pages.size();
+	return true;
+}
+
+namespace
+{
+	bool LoadImages( lua_State& io_luaState, const char* const i_path, std::vector<Engine::AssetBuild::TextureAtlas::sImage>& o_images )
+	{
+		bool wereThereErrors = false;
+
+		lua_getfield( &io_luaState, -1, "images" );
+		if ( !lua_istable( &io_luaState, -1 ) )
+		{
+			Engine::AssetBuild::OutputErrorMessage( "Atlas files must have a table of images", i_path );
+			lua_pop( &io_luaState, 1 );
+			return false;
+		}
+		const size_t imageCount = static_cast<size_t>( luaL_len( &io_luaState, -1 ) );
+		for ( size_t i = 1; i <= imageCount; ++i )
+		{
+			lua_rawgeti( &io_luaState, -1, static_cast<int>( i ) );
+			if ( lua_istable( &io_luaState, -1 ) )
+			{
+				lua_getfield( &io_luaState, -1, "name" );
+				lua_getfield( &io_luaState, -2, "path" );
+				if ( ( lua_type( &io_luaState, -2 ) == LUA_TSTRING ) && ( lua_type( &io_luaState, -1 ) == LUA_TSTRING ) )
+				{
+					Engine::AssetBuild::TextureAtlas::sImage image;
+					image.name = lua_tostring( &io_luaState, -2 );
+					image.path = lua_tostring( &io_luaState, -1 );
+					o_images.push_back( image );
+				}
+				else
+				{
+					wereThereErrors = true;
+					std::ostringstream errorMessage;
+					errorMessage << "Image #" << i << " in the atlas must have a name and a path";
+					Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path );
+				}
+				lua_pop( &io_luaState, 2 );
+			}
+			else
+			{
+				wereThereErrors = true;
+				std::ostringstream errorMessage;
+				errorMessage << "Image #" << i << " in the atlas must be a table (instead of a " << luaL_typename( &io_luaState, -1 ) << ")";
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path );
+			}
+			lua_pop( &io_luaState, 1 );
+		}
+		lua_pop( &io_luaState, 1 );
+
+		if ( !wereThereErrors && o_images.empty() )
+		{
+			wereThereErrors = true;
+			Engine::AssetBuild::OutputErrorMessage( "Atlas files must have at least one image", i_path );
+		}
+		return !wereThereErrors;
+	}
+
+	bool LoadSize( lua_State& io_luaState, const char* const i_key, const char* const i_path, size_t& io_size )
+	{
+		bool wereThereErrors = false;
+
+		// Sizes are optional, and so the default is kept if there isn't one
+		lua_getfield( &io_luaState, -1, i_key );
+		if ( !lua_isnil( &io_luaState, -1 ) )
+		{
+			int isInteger = 0;
+			const lua_Integer size = lua_tointegerx( &io_luaState, -1, &isInteger );
+			if ( isInteger && ( size >= 0 ) )
+			{
+				io_size = static_cast<size_t>( size );
+			}
+			else
+			{
+				wereThereErrors = true;
+				std::ostringstream errorMessage;
+				errorMessage << "The atlas's " << i_key << " must be a positive integer";
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path );
+			}
+		}
+		lua_pop( &io_luaState, 1 );
+
+		return !wereThereErrors;
+	}
+
+	bool FindPosition( const sPage& i_page, const size_t i_width, const size_t i_height, sRectangle& o_position )
+	{
+		// The free rectangle that leaves the smallest leftover on its shorter side is the best fit
+		// (with ties broken by the leftover on the longer side)
+		bool wasPositionFound = false;
+		size_t bestShortSide = 0, bestLongSide = 0;
+		for ( std::vector<sRectangle>::const_iterator it = i_page.freeRectangles.begin(); it != i_page.freeRectangles.end(); ++it )
+		{
+			if ( ( it->width >= i_width ) && ( it->height >= i_height ) )
+			{
+				const size_t leftover_horizontal = it->width - i_width;
+				const size_t leftover_vertical = it->height - i_height;
+				const size_t shortSide = std::min( leftover_horizontal, leftover_vertical );
+				const size_t longSide = std::max( leftover_horizontal, leftover_vertical );
+				if ( !wasPositionFound || ( shortSide < bestShortSide ) || ( ( shortSide == bestShortSide ) && ( longSide < bestLongSide ) ) )
+				{
+					wasPositionFound = true;
+					bestShortSide = shortSide;
+					bestLongSide = longSide;
+					o_position.x = it->x;
+					o_position.y = it->y;
+					o_position.width = i_width;
+					o_position.height = i_height;
+				}
+			}
+		}
+		return wasPositionFound;
+	}
+
+	void PlaceRectangle( sPage& io_page, const sRectangle& i_rectangle )
+	{
+		// Every free rectangle that the new one overlaps is replaced by the (up to 4) biggest rectangles around it
+		std::vector<sRectangle> freeRectangles;
+		for ( std::vector<sRectangle>::const_iterator it = io_page.freeRectangles.begin(); it != io_page.freeRectangles.end(); ++it )
+		{
+			const sRectangle& freeRectangle = *it;
+			if ( !freeRectangle.Intersects( i_rectangle ) )
+			{
+				freeRectangles.push_back( freeRectangle );
+				continue;
+			}
+			if ( i_rectangle.x > freeRectangle.x )
+			{
+				const sRectangle left = { freeRectangle.x, freeRectangle.y, i_rectangle.x - freeRectangle.x, freeRectangle.height };
+				freeRectangles.push_back( left );
+			}
+			if ( ( i_rectangle.x + i_rectangle.width ) < ( freeRectangle.x + freeRectangle.width ) )
+			{
+				const size_t x = i_rectangle.x + i_rectangle.width;
+				const sRectangle right = { x, freeRectangle.y, ( freeRectangle.x + freeRectangle.width ) - x, freeRectangle.height };
+				freeRectangles.push_back( right );
+			}
+			if ( i_rectangle.y > freeRectangle.y )
+			{
+				const sRectangle top = { freeRectangle.x, freeRectangle.y, freeRectangle.width, i_rectangle.y - freeRectangle.y };
+				freeRectangles.push_back( top );
+			}
+			if ( ( i_rectangle.y + i_rectangle.height ) < ( freeRectangle.y + freeRectangle.height ) )
+			{
+				const size_t y = i_rectangle.y + i_rectangle.height;
+				const sRectangle bottom = { freeRectangle.x, y, freeRectangle.width, ( freeRectangle.y + freeRectangle.height ) - y };
+				freeRectangles.push_back( bottom );
+			}
+		}
+
+		// Free rectangles that are inside of other ones are redundant
+		// (and of two identical ones only the first is kept)
+		io_page.freeRectangles.clear();
+		for ( size_t i = 0; i < freeRectangles.size(); ++i )
+		{
+			bool isRedundant = false;
+			for ( size_t j = 0; ( j < freeRectangles.size() ) && !isRedundant; ++j )
+			{
+				if ( ( i != j ) && freeRectangles[j].Contains( freeRectangles[i] ) )
+				{
+					isRedundant = !freeRectangles[i].Contains( freeRectangles[j] ) || ( j < i );
+				}
+			}
+			if ( !isRedundant )
+			{
+				io_page.freeRectangles.push_back( freeRectangles[i] );
+			}
+		}
+	}
+}
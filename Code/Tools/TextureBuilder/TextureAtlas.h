@@ -0,0 +1,57 @@
+#ifndef TEXTUREBUILDER_TEXTUREATLAS_H
+#define TEXTUREBUILDER_TEXTUREATLAS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		namespace TextureAtlas
+		{
+			struct sImage
+			{
+				// The name that sprites look the image up with
+				std::string name;
+				// Relative to the authored asset directory
+				std::string path;
+			};
+
+			// An atlas source file is a Lua table with the images to pack into it
+			// (see Assets/Atlases/UI.atlas)
+			struct sDescription
+			{
+				// Pages are square and no bigger than this, although the last one is only as big as it needs to be
+				size_t pageSize;
+				// Each image's edge pixels are repeated this many times around it so that filtering doesn't bleed into its neighbors.
+				// Every MIP level halves the padding, and so pages only have the levels that still have at least one pixel of it
+				size_t padding;
+				std::vector<sImage> images;
+
+				sDescription() : pageSize( 1024 ), padding( 2 ) {}
+			};
+
+			struct sSize
+			{
+				size_t width, height;
+			};
+
+			struct sPlacement
+			{
+				size_t pageIndex;
+				size_t x, y;
+			};
+
+			bool LoadDescription( const char* const i_path, sDescription& o_description );
+
+			// Packs rectangles into as few pages as it can with the MaxRects algorithm (choosing the free rectangle with the best short side fit).
+			// The rectangles are placed from the biggest to the smallest, and each one goes on the first page that it fits on.
+			// This fails if any rectangle is bigger than a page
+			bool Pack( const std::vector<sSize>& i_sizes, const size_t i_pageSize, std::vector<sPlacement>& o_placements, size_t& o_pageCount );
+		}
+	}
+}
+
+#endif
@@ -1,59 +1,184 @@
 #include "cTextureBuilder.h"
+#include <algorithm>
+#include <cctype>
 #include <codecvt>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <locale>
+#include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
+#include "../../Engine/Graphics/TextureAtlasFormat.h"
+#include "../../Engine/Graphics/TextureFormat.h"
 #include "../../Engine/Math/Functions.h"
+#include "../../Engine/Platform/Platform.h"
 #include "../../External/DirectXTex/Includes.h"
+#include "../../External/DirectXTex/DirectXTex/DDS.h"
+#include "../AssetBuildLibrary/Parallel.h"
 #include "../AssetBuildLibrary/UtilityFunctions.h"
+#include "../BlockCompression/BatchedBlockEncoder.h"
+#include "../ImageDecoding/ImageDecoding.h"
+#include "MipMapGeneration.h"
+#include "SourceImageCache.h"
+#include "TextureArray.h"
+#include "TextureAtlas.h"
 
 namespace
 {
-	bool BuildTexture( const char *const i_path, DirectX::ScratchImage &io_sourceImageThatMayNotBeValidAfterThisCall,
+	namespace Usages
+	{
+		// What a texture is used for decides which format it's compressed to
+		enum eUsage
+		{
+			// The usage is inferred from the file name
+			Unspecified,
+			// BC1 (or BC3 if any pixel isn't opaque), or BC7 with the production preset
+			Color,
+			// BC5, which only keeps red and green (and so the shader must reconstruct blue)
+			NormalMap,
+			// BC4, which only keeps red
+			SingleChannel,
+		};
+	}
+
+	struct sBuildOptions
+	{
+		Usages::eUsage usage;
+		// BC7 is used instead of BC1 and BC3 for color,
+		// which is the same size as BC3 but much higher quality (and much slower to compress)
+		bool shouldUseHighQualityColor;
+		// DirectXTex's encoder is used by default,
+		// but the batched encoder is much faster (at a small cost in quality)
+		bool shouldUseBatchedEncoder;
+		Engine::AssetBuild::BlockCompression::eQuality batchedEncoderQuality;
+		// These are only used by DirectXTex's encoder
+		DWORD compressionOptions;
+		Engine::AssetBuild::MipMapGeneration::eFilter mipMapFilter;
+		// The MIP chain is cut short after this many levels (0 means that every level down to 1x1 is built)
+		size_t maxMipLevelCount;
+		// The source is an atlas file that lists images to pack into pages (see TextureAtlas.h) instead of an image
+		bool isAtlas;
+		// The source is a texture array file that lists images to build into one texture's layers (see TextureArray.h)
+		bool isArray;
+
+		sBuildOptions() : usage( Usages::Unspecified ), shouldUseHighQualityColor( false ), shouldUseBatchedEncoder( false ), batchedEncoderQuality( Engine::AssetBuild::BlockCompression::Refined ),
+			compressionOptions( DirectX::TEX_COMPRESS_DEFAULT ), mipMapFilter( Engine::AssetBuild::MipMapGeneration::Triangle ), maxMipLevelCount( 0 ), isAtlas( false ), isArray( false ) {}
+	};
+
+	bool ParseBuildOptions( const std::vector<std::string>& i_arguments, sBuildOptions& o_options );
+	bool BuildAtlas( const char *const i_path_source, const char *const i_path_target, const sBuildOptions& i_options,
+		bool &io_shouldComBeUninitialized );
+	bool BuildArray( const char *const i_path_source, const char *const i_path_target, sBuildOptions& io_options,
+		bool &io_shouldComBeUninitialized );
+	bool LoadUncompressedImage( const char *const i_path, DirectX::ScratchImage &o_image, bool &io_shouldComBeUninitialized );
+	Usages::eUsage InferUsage( const char *const i_path );
+	DXGI_FORMAT ChooseFormat( const sBuildOptions& i_options, const DirectX::ScratchImage &i_image );
+	// If the CPU doesn't support the batched encoder (or it can't encode the format) DirectXTex is used instead
+	bool ShouldUseBatchedEncoder( const sBuildOptions& i_options, const DXGI_FORMAT i_format );
+	bool BuildTexture( const char *const i_path, const sBuildOptions& i_options, DirectX::ScratchImage &io_sourceImageThatMayNotBeValidAfterThisCall,
 		DirectX::ScratchImage &o_texture );
-	bool LoadSourceImage( const char *const i_path, DirectX::ScratchImage &o_image );
-	bool WriteTextureToFile( const char *const i_path, const DirectX::ScratchImage &i_texture );
+	bool GenerateMipMaps( const char *const i_path, const sBuildOptions& i_options, const DirectX::ScratchImage &i_image,
+		DirectX::ScratchImage &o_imageWithMipMaps );
+	bool CompressTexture( const char *const i_path, const sBuildOptions& i_options, const DirectX::ScratchImage &i_image, const DXGI_FORMAT i_format,
+		const DWORD i_compressionOptions, DirectX::ScratchImage &o_texture );
+	void FlipVertically( DirectX::ScratchImage &io_image );
+	bool LoadSourceImage( const char *const i_path, DirectX::ScratchImage &o_image, bool &io_shouldComBeUninitialized );
+	bool CopyDecodedImage( const char *const i_path, const Engine::AssetBuild::ImageDecoding::sImage& i_decodedImage, DirectX::ScratchImage &o_image );
+	void SaveToSourceImageCache( const std::string& i_cacheDirectory, const Engine::AssetBuild::SourceImageCache::sKey& i_key,
+		const DirectX::ScratchImage &i_image );
+	// The content key is only written if one is provided
+	bool WriteTextureToFile( const char *const i_path, const DirectX::ScratchImage &i_texture, const uint64_t* const i_contentKey );
+
+	// Textures are only built once for each content key (see TextureFormat.h),
+	// and a texture whose key is already in the cache is copied from it instead of being built.
+	// The cache is only used when this environment variable is set
+	const char* const s_builtTextureCacheEnvironmentVariable = "BuiltTextureCacheDir";
+
+	// The options must already have their usage
+	uint64_t CalculateContentKey( const sBuildOptions& i_options, const DirectX::ScratchImage &i_sourceImage, const uint64_t i_lastWriteTime_builder );
+	std::string GetBuiltTextureCachePath( const std::string& i_cacheDirectory, const uint64_t i_contentKey );
 }
 
-bool Engine::AssetBuild::cTextureBuilder::Build( const std::vector<std::string>& )
+bool Engine::AssetBuild::cTextureBuilder::Build( const std::vector<std::string>& i_arguments )
 {
 	bool wereThereErrors = false;
 
+	sBuildOptions options;
 	DirectX::ScratchImage sourceImage;
 	DirectX::ScratchImage builtTexture;
 	bool shouldComBeUninitialized = false;
 
+	if ( !ParseBuildOptions( i_arguments, options ) )
 	{
-		void* const thisMustBeNull = NULL;
-		if ( SUCCEEDED( CoInitialize( thisMustBeNull ) ) )
-		{
-			shouldComBeUninitialized = true;
-		}
-		else
+		wereThereErrors = true;
+		goto OnExit;
+	}
+	if ( options.usage == Usages::Unspecified )
+	{
+		// An array's usage is inferred from its first layer once its description has been loaded
+		if ( !options.isArray )
 		{
-			wereThereErrors = true;
-			Engine::AssetBuild::OutputErrorMessage( "DirextXTex couldn't be used because COM couldn't be initialized", m_path_source );
-			goto OnExit;
+			options.usage = options.isAtlas ? Usages::Color : InferUsage( m_path_source );
 		}
 	}
-	
-	if ( !LoadSourceImage( m_path_source, sourceImage ) )
+	if ( options.isAtlas )
 	{
-		wereThereErrors = true;
+		wereThereErrors = !BuildAtlas( m_path_source, m_path_target, options, shouldComBeUninitialized );
 		goto OnExit;
 	}
-	
-	if ( !BuildTexture( m_path_source, sourceImage, builtTexture ) )
+	if ( options.isArray )
 	{
-		wereThereErrors = true;
+		wereThereErrors = !BuildArray( m_path_source, m_path_target, options, shouldComBeUninitialized );
 		goto OnExit;
 	}
-	
-	if ( !WriteTextureToFile( m_path_target, builtTexture ) )
+
+	// COM is only initialized if WIC is needed to load the source image
+	if ( !LoadSourceImage( m_path_source, sourceImage, shouldComBeUninitialized ) )
 	{
 		wereThereErrors = true;
 		goto OnExit;
 	}
+	
+	{
+		// The cache can't be used if TextureBuilder's own version isn't known
+		uint64_t lastWriteTime_builder = 0;
+		std::string cacheDirectory;
+		const bool isCacheEnabled = Engine::Platform::GetEnvironmentVariable( s_builtTextureCacheEnvironmentVariable, cacheDirectory ) && !cacheDirectory.empty()
+			&& Engine::Platform::GetLastWriteTime( m_path_builder, lastWriteTime_builder );
+		const uint64_t contentKey = CalculateContentKey( options, sourceImage, lastWriteTime_builder );
+		const std::string path_cache = GetBuiltTextureCachePath( cacheDirectory, contentKey );
+		if ( isCacheEnabled && Engine::Platform::DoesFileExist( path_cache.c_str() ) )
+		{
+			// The target's time is updated so that the asset build system knows that it is newer than its source
+			const bool shouldFunctionFailIfTargetAlreadyExists = false;
+			const bool shouldTargetFileTimeBeModified = true;
+			if ( Engine::Platform::CopyFile( path_cache.c_str(), m_path_target, shouldFunctionFailIfTargetAlreadyExists, shouldTargetFileTimeBeModified ) )
+			{
+				goto OnExit;
+			}
+		}
+
+		if ( !BuildTexture( m_path_source, options, sourceImage, builtTexture ) )
+		{
+			wereThereErrors = true;
+			goto OnExit;
+		}
+
+		if ( !WriteTextureToFile( m_path_target, builtTexture, &contentKey ) )
+		{
+			wereThereErrors = true;
+			goto OnExit;
+		}
+
+		if ( isCacheEnabled && Engine::Platform::CreateDirectoryIfNecessary( path_cache ) )
+		{
+			// The cache only makes later builds faster, and so failing to save to it isn't an error
+			Engine::Platform::CopyFile( m_path_target, path_cache.c_str() );
+		}
+	}
 
 OnExit:
 	
@@ -67,7 +192,453 @@ OnExit:
 
 namespace
 {
-	bool BuildTexture( const char *const i_path, DirectX::ScratchImage &io_sourceImageThatMayNotBeValidAfterThisCall,
+	bool ParseBuildOptions( const std::vector<std::string>& i_arguments, sBuildOptions& o_options )
+	{
+		for ( std::vector<std::string>::const_iterator it = i_arguments.begin(); it != i_arguments.end(); ++it )
+		{
+			const std::string& argument = *it;
+			const size_t separator = argument.find( '=' );
+			const std::string key = argument.substr( 0, separator );
+			const std::string value = ( separator != std::string::npos ) ? argument.substr( separator + 1 ) : std::string();
+			// A preset chooses every compression setting at once
+			// (and an encoder argument after it can still choose a different encoder)
+			if ( key == "preset" )
+			{
+				if ( value == "fast" )
+				{
+					// For iterating on art quickly
+					o_options.shouldUseHighQualityColor = false;
+					o_options.shouldUseBatchedEncoder = true;
+					o_options.batchedEncoderQuality = Engine::AssetBuild::BlockCompression::Fast;
+					o_options.compressionOptions = DirectX::TEX_COMPRESS_DEFAULT;
+					o_options.mipMapFilter = Engine::AssetBuild::MipMapGeneration::Box;
+				}
+				else if ( value == "normal" )
+				{
+					o_options.shouldUseHighQualityColor = false;
+					o_options.shouldUseBatchedEncoder = false;
+					o_options.compressionOptions = DirectX::TEX_COMPRESS_DEFAULT;
+					o_options.mipMapFilter = Engine::AssetBuild::MipMapGeneration::Triangle;
+				}
+				else if ( value == "production" )
+				{
+					// For release builds, where color is worth BC7 (and gradients in BC1 and BC3 are worth dithering) no matter how long it takes
+					o_options.shouldUseHighQualityColor = true;
+					o_options.shouldUseBatchedEncoder = false;
+					o_options.compressionOptions = DirectX::TEX_COMPRESS_DITHER;
+					o_options.mipMapFilter = Engine::AssetBuild::MipMapGeneration::Kaiser;
+				}
+				else
+				{
+					Engine::AssetBuild::OutputErrorMessage( "The preset argument must be \"fast\", \"normal\", or \"production\"" );
+					return false;
+				}
+			}
+			else if ( key == "encoder" )
+			{
+				if ( value == "directxtex" )
+				{
+					o_options.shouldUseBatchedEncoder = false;
+				}
+				else if ( value == "fast" )
+				{
+					o_options.shouldUseBatchedEncoder = true;
+					o_options.batchedEncoderQuality = Engine::AssetBuild::BlockCompression::Fast;
+				}
+				else if ( value == "refined" )
+				{
+					o_options.shouldUseBatchedEncoder = true;
+					o_options.batchedEncoderQuality = Engine::AssetBuild::BlockCompression::Refined;
+				}
+				else
+				{
+					Engine::AssetBuild::OutputErrorMessage( "The encoder argument must be \"directxtex\", \"fast\", or \"refined\"" );
+					return false;
+				}
+			}
+			else if ( key == "mipfilter" )
+			{
+				if ( value == "box" )
+				{
+					o_options.mipMapFilter = Engine::AssetBuild::MipMapGeneration::Box;
+				}
+				else if ( value == "triangle" )
+				{
+					o_options.mipMapFilter = Engine::AssetBuild::MipMapGeneration::Triangle;
+				}
+				else if ( value == "kaiser" )
+				{
+					o_options.mipMapFilter = Engine::AssetBuild::MipMapGeneration::Kaiser;
+				}
+				else
+				{
+					Engine::AssetBuild::OutputErrorMessage( "The mipfilter argument must be \"box\", \"triangle\", or \"kaiser\"" );
+					return false;
+				}
+			}
+			else if ( key == "usage" )
+			{
+				if ( value == "color" )
+				{
+					o_options.usage = Usages::Color;
+				}
+				else if ( value == "normal" )
+				{
+					o_options.usage = Usages::NormalMap;
+				}
+				else if ( value == "single" )
+				{
+					o_options.usage = Usages::SingleChannel;
+				}
+				else
+				{
+					Engine::AssetBuild::OutputErrorMessage( "The usage argument must be \"color\", \"normal\", or \"single\"" );
+					return false;
+				}
+			}
+			else if ( key == "atlas" )
+			{
+				// The atlas asset type always passes this
+				o_options.isAtlas = true;
+			}
+			else if ( key == "array" )
+			{
+				// The texture array asset type always passes this
+				o_options.isArray = true;
+			}
+			else if ( key == "texture" )
+			{
+				// Materials register the textures that they reference with this argument, which doesn't change anything
+			}
+			else
+			{
+				std::ostringstream errorMessage;
+				errorMessage << "Unknown texture build argument \"" << argument << "\"";
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str() );
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool BuildAtlas( const char *const i_path_source, const char *const i_path_target, const sBuildOptions& i_options,
+		bool &io_shouldComBeUninitialized )
+	{
+		Engine::AssetBuild::TextureAtlas::sDescription description;
+		if ( !Engine::AssetBuild::TextureAtlas::LoadDescription( i_path_source, description ) )
+		{
+			return false;
+		}
+		std::string authoredAssetDirectory;
+		{
+			std::string errorMessage;
+			if ( !Engine::Platform::GetEnvironmentVariable( "AuthoredAssetDir", authoredAssetDirectory, &errorMessage ) )
+			{
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.c_str(), i_path_source );
+				return false;
+			}
+		}
+
+		// Every image is loaded as 8 bit RGBA, and it takes up a cell with its padding that is rounded up to whole blocks
+		// so that no compressed block has pixels from two different images
+		const size_t imageCount = description.images.size();
+		std::vector<DirectX::ScratchImage> images( imageCount );
+		std::vector<Engine::AssetBuild::TextureAtlas::sSize> cellSizes( imageCount );
+		for ( size_t i = 0; i < imageCount; ++i )
+		{
+			const std::string path = authoredAssetDirectory + description.images[i].path;
+			if ( !LoadUncompressedImage( path.c_str(), images[i], io_shouldComBeUninitialized ) )
+			{
+				return false;
+			}
+			const size_t blockSize = 4;
+			cellSizes[i].width = Engine::Math::RoundUpToMultiple_powerOf2( images[i].GetMetadata().width + ( 2 * description.padding ), blockSize );
+			cellSizes[i].height = Engine::Math::RoundUpToMultiple_powerOf2( images[i].GetMetadata().height + ( 2 * description.padding ), blockSize );
+			if ( ( cellSizes[i].width > description.pageSize ) || ( cellSizes[i].height > description.pageSize ) )
+			{
+				std::ostringstream errorMessage;
+				errorMessage << "The image \"" << description.images[i].name << "\" (with its padding) is bigger than the atlas's pages ("
+					<< description.pageSize << " x " << description.pageSize << ")";
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path_source );
+				return false;
+			}
+		}
+
+		std::vector<Engine::AssetBuild::TextureAtlas::sPlacement> placements;
+		size_t pageCount;
+		if ( !Engine::AssetBuild::TextureAtlas::Pack( cellSizes, description.pageSize, placements, pageCount ) )
+		{
+			Engine::AssetBuild::OutputErrorMessage( "The atlas's images couldn't be packed", i_path_source );
+			return false;
+		}
+
+		// Pages are only as big as the cells on them need
+		std::vector<Engine::AssetBuild::TextureAtlas::sSize> pageSizes( pageCount );
+		for ( size_t i = 0; i < imageCount; ++i )
+		{
+			Engine::AssetBuild::TextureAtlas::sSize& pageSize = pageSizes[placements[i].pageIndex];
+			pageSize.width = std::max( pageSize.width, placements[i].x + cellSizes[i].width );
+			pageSize.height = std::max( pageSize.height, placements[i].y + cellSizes[i].height );
+		}
+		// Each MIP level halves the padding, and so the pages only get the levels that still have at least a pixel of it
+		// (the smaller ones would blend images with their neighbors)
+		sBuildOptions pageOptions = i_options;
+		pageOptions.maxMipLevelCount = 1;
+		for ( size_t padding = description.padding; padding >= 2; padding /= 2 )
+		{
+			++pageOptions.maxMipLevelCount;
+		}
+		for ( size_t pageIndex = 0; pageIndex < pageCount; ++pageIndex )
+		{
+			DirectX::ScratchImage page;
+			if ( FAILED( page.Initialize2D( DXGI_FORMAT_R8G8B8A8_UNORM, pageSizes[pageIndex].width, pageSizes[pageIndex].height, 1, 1 ) ) )
+			{
+				Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to allocate an atlas page", i_path_source );
+				return false;
+			}
+			const DirectX::Image& pageImage = *page.GetImage( 0, 0, 0 );
+			memset( pageImage.pixels, 0, pageImage.slicePitch );
+			for ( size_t i = 0; i < imageCount; ++i )
+			{
+				if ( placements[i].pageIndex != pageIndex )
+				{
+					continue;
+				}
+				// The image's edges are repeated to fill its whole cell
+				const DirectX::Image& image = *images[i].GetImage( 0, 0, 0 );
+				for ( size_t y = 0; y < cellSizes[i].height; ++y )
+				{
+					const size_t sourceY = std::min( static_cast<size_t>( std::max<ptrdiff_t>(
+						static_cast<ptrdiff_t>( y ) - static_cast<ptrdiff_t>( description.padding ), 0 ) ), image.height - 1 );
+					const uint8_t* const sourceRow = image.pixels + ( sourceY * image.rowPitch );
+					uint8_t* const row = pageImage.pixels + ( ( placements[i].y + y ) * pageImage.rowPitch ) + ( placements[i].x * 4 );
+					for ( size_t x = 0; x < cellSizes[i].width; ++x )
+					{
+						const size_t sourceX = std::min( static_cast<size_t>( std::max<ptrdiff_t>(
+							static_cast<ptrdiff_t>( x ) - static_cast<ptrdiff_t>( description.padding ), 0 ) ), image.width - 1 );
+						memcpy( row + ( x * 4 ), sourceRow + ( sourceX * 4 ), 4 );
+					}
+				}
+			}
+
+			const std::string path_page = Engine::Graphics::GetAtlasPagePath( i_path_target, static_cast<uint32_t>( pageIndex ) );
+			DirectX::ScratchImage builtPage;
+			if ( !BuildTexture( i_path_source, pageOptions, page, builtPage ) || !WriteTextureToFile( path_page.c_str(), builtPage, NULL ) )
+			{
+				return false;
+			}
+		}
+
+		// The lookup table's regions are sorted by name so that they can be found with a binary search
+		std::vector<size_t> order( imageCount );
+		for ( size_t i = 0; i < imageCount; ++i )
+		{
+			order[i] = i;
+		}
+		std::sort( order.begin(), order.end(),
+			[&description]( const size_t i_a, const size_t i_b ) { return strcmp( description.images[i_a].name.c_str(), description.images[i_b].name.c_str() ) < 0; } );
+		std::vector<Engine::Graphics::sAtlasRegion> regions( imageCount );
+		std::string names;
+		for ( size_t i = 0; i < imageCount; ++i )
+		{
+			const size_t imageIndex = order[i];
+			if ( ( i > 0 ) && ( description.images[imageIndex].name == description.images[order[i - 1]].name ) )
+			{
+				std::ostringstream errorMessage;
+				errorMessage << "The atlas has more than one image named \"" << description.images[imageIndex].name << "\"";
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path_source );
+				return false;
+			}
+			const DirectX::TexMetadata& metadata = images[imageIndex].GetMetadata();
+			const Engine::AssetBuild::TextureAtlas::sSize& pageSize = pageSizes[placements[imageIndex].pageIndex];
+			const size_t left = placements[imageIndex].x + description.padding;
+			const size_t top = placements[imageIndex].y + description.padding;
+			Engine::Graphics::sAtlasRegion& region = regions[i];
+			region.nameOffset = static_cast<uint32_t>( names.size() );
+			region.pageIndex = static_cast<uint32_t>( placements[imageIndex].pageIndex );
+			region.left = static_cast<float>( left ) / static_cast<float>( pageSize.width );
+			region.right = static_cast<float>( left + metadata.width ) / static_cast<float>( pageSize.width );
+			// Sprites' texture coordinates go up from the bottom of the texture
+			region.top = 1.0f - ( static_cast<float>( top ) / static_cast<float>( pageSize.height ) );
+			region.bottom = 1.0f - ( static_cast<float>( top + metadata.height ) / static_cast<float>( pageSize.height ) );
+			names.append( description.images[imageIndex].name.c_str(), description.images[imageIndex].name.size() + 1 );
+		}
+		Engine::Graphics::sAtlasFileHeader header;
+		{
+			header.magic = Engine::Graphics::s_atlasFileMagic;
+			header.version = Engine::Graphics::s_atlasFileVersion;
+			header.pageCount = static_cast<uint32_t>( pageCount );
+			header.regionCount = static_cast<uint32_t>( imageCount );
+			header.nameByteCount = static_cast<uint32_t>( names.size() );
+		}
+		std::ofstream atlasFile( i_path_target, std::ofstream::binary );
+		atlasFile.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+		atlasFile.write( reinterpret_cast<const char*>( regions.data() ), regions.size() * sizeof( Engine::Graphics::sAtlasRegion ) );
+		atlasFile.write( names.data(), names.size() );
+		atlasFile.close();
+		if ( !atlasFile )
+		{
+			Engine::AssetBuild::OutputErrorMessage( "The atlas's lookup table couldn't be written to disk", i_path_target );
+			return false;
+		}
+		return true;
+	}
+
+	bool BuildArray( const char *const i_path_source, const char *const i_path_target, sBuildOptions& io_options,
+		bool &io_shouldComBeUninitialized )
+	{
+		Engine::AssetBuild::TextureArray::sDescription description;
+		if ( !Engine::AssetBuild::TextureArray::LoadDescription( i_path_source, description ) )
+		{
+			return false;
+		}
+		std::string authoredAssetDirectory;
+		{
+			std::string errorMessage;
+			if ( !Engine::Platform::GetEnvironmentVariable( "AuthoredAssetDir", authoredAssetDirectory, &errorMessage ) )
+			{
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.c_str(), i_path_source );
+				return false;
+			}
+		}
+		// Every layer is compressed to the same format,
+		// and so without a usage argument the first layer's file name decides it for all of them
+		if ( io_options.usage == Usages::Unspecified )
+		{
+			io_options.usage = InferUsage( description.layerPaths[0].c_str() );
+		}
+
+		const size_t layerCount = description.layerPaths.size();
+		DirectX::ScratchImage arrayImage;
+		for ( size_t i = 0; i < layerCount; ++i )
+		{
+			const std::string path = authoredAssetDirectory + description.layerPaths[i];
+			DirectX::ScratchImage layer;
+			if ( !LoadUncompressedImage( path.c_str(), layer, io_shouldComBeUninitialized ) )
+			{
+				return false;
+			}
+			const DirectX::Image& layerImage = *layer.GetImage( 0, 0, 0 );
+			if ( i == 0 )
+			{
+				const size_t mipLevelCount = 1;
+				if ( FAILED( arrayImage.Initialize2D( DXGI_FORMAT_R8G8B8A8_UNORM, layerImage.width, layerImage.height, layerCount, mipLevelCount ) ) )
+				{
+					Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to allocate the texture array", i_path_source );
+					return false;
+				}
+			}
+			const DirectX::Image& arrayLayerImage = *arrayImage.GetImage( 0, i, 0 );
+			if ( ( layerImage.width != arrayLayerImage.width ) || ( layerImage.height != arrayLayerImage.height ) )
+			{
+				std::ostringstream errorMessage;
+				errorMessage << "Every layer of a texture array must be the same size, but \"" << description.layerPaths[i] << "\" is "
+					<< layerImage.width << " x " << layerImage.height << " and the first layer is " << arrayLayerImage.width << " x " << arrayLayerImage.height;
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path_source );
+				return false;
+			}
+			for ( size_t y = 0; y < layerImage.height; ++y )
+			{
+				memcpy( arrayLayerImage.pixels + ( y * arrayLayerImage.rowPitch ), layerImage.pixels + ( y * layerImage.rowPitch ), layerImage.width * 4 );
+			}
+		}
+
+		DirectX::ScratchImage builtArray;
+		return BuildTexture( i_path_source, io_options, arrayImage, builtArray ) && WriteTextureToFile( i_path_target, builtArray, NULL );
+	}
+
+	bool LoadUncompressedImage( const char *const i_path, DirectX::ScratchImage &o_image, bool &io_shouldComBeUninitialized )
+	{
+		// Only the source's first image is used (and MIP levels are generated from it later)
+		DirectX::ScratchImage sourceImage;
+		if ( !LoadSourceImage( i_path, sourceImage, io_shouldComBeUninitialized ) )
+		{
+			return false;
+		}
+		const DirectX::TexMetadata& metadata = sourceImage.GetMetadata();
+		HRESULT result = S_OK;
+		if ( DirectX::IsCompressed( metadata.format ) )
+		{
+			result = DirectX::Decompress( *sourceImage.GetImage( 0, 0, 0 ), DXGI_FORMAT_R8G8B8A8_UNORM, o_image );
+		}
+		else if ( metadata.format != DXGI_FORMAT_R8G8B8A8_UNORM )
+		{
+			const DWORD useDefaultFilteringWithoutWic = DirectX::TEX_FILTER_DEFAULT | DirectX::TEX_FILTER_FORCE_NON_WIC;
+			result = DirectX::Convert( *sourceImage.GetImage( 0, 0, 0 ), DXGI_FORMAT_R8G8B8A8_UNORM, useDefaultFilteringWithoutWic,
+				DirectX::TEX_THRESHOLD_DEFAULT, o_image );
+		}
+		else
+		{
+			o_image = std::move( sourceImage );
+		}
+		if ( FAILED( result ) )
+		{
+			Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to convert the image to 8 bit RGBA", i_path );
+			return false;
+		}
+		return true;
+	}
+
+	Usages::eUsage InferUsage( const char *const i_path )
+	{
+		std::string fileName( i_path );
+		{
+			const size_t lastSlash = fileName.find_last_of( "/\\" );
+			if ( lastSlash != std::string::npos )
+			{
+				fileName = fileName.substr( lastSlash + 1 );
+			}
+			fileName = fileName.substr( 0, fileName.find_last_of( '.' ) );
+			std::transform( fileName.begin(), fileName.end(), fileName.begin(), ::tolower );
+		}
+		const auto hasSuffix = [&fileName]( const char* const i_suffix )
+		{
+			const size_t length = strlen( i_suffix );
+			return ( fileName.size() >= length ) && ( fileName.compare( fileName.size() - length, length, i_suffix ) == 0 );
+		};
+		// These are the suffixes that the artists' tools use
+		if ( hasSuffix( "_nrm" ) || hasSuffix( "_normal" ) )
+		{
+			return Usages::NormalMap;
+		}
+		else if ( hasSuffix( "_spec" ) || hasSuffix( "_rough" ) || hasSuffix( "_ao" ) || hasSuffix( "_mask" ) )
+		{
+			return Usages::SingleChannel;
+		}
+		else
+		{
+			return Usages::Color;
+		}
+	}
+
+	DXGI_FORMAT ChooseFormat( const sBuildOptions& i_options, const DirectX::ScratchImage &i_image )
+	{
+#if defined( PLATFORM_GL )
+		// OpenGL only allows BPTC compression for 3D textures
+		if ( i_image.GetMetadata().IsVolumemap() )
+		{
+			return DXGI_FORMAT_BC7_UNORM;
+		}
+#endif
+		switch ( i_options.usage )
+		{
+			case Usages::NormalMap: return DXGI_FORMAT_BC5_UNORM;
+			case Usages::SingleChannel: return DXGI_FORMAT_BC4_UNORM;
+		}
+		if ( i_options.shouldUseHighQualityColor )
+		{
+			return DXGI_FORMAT_BC7_UNORM;
+		}
+		return i_image.IsAlphaAllOpaque() ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
+	}
+
+	bool ShouldUseBatchedEncoder( const sBuildOptions& i_options, const DXGI_FORMAT i_format )
+	{
+		return i_options.shouldUseBatchedEncoder && Engine::AssetBuild::BlockCompression::IsSupported()
+			&& ( ( i_format == DXGI_FORMAT_BC1_UNORM ) || ( i_format == DXGI_FORMAT_BC3_UNORM ) );
+	}
+
+	bool BuildTexture( const char *const i_path, const sBuildOptions& i_options, DirectX::ScratchImage &io_sourceImageThatMayNotBeValidAfterThisCall,
 		DirectX::ScratchImage &o_texture )
 	{
 		DirectX::ScratchImage uncompressedImage;
@@ -87,20 +658,13 @@ namespace
 			uncompressedImage = std::move( io_sourceImageThatMayNotBeValidAfterThisCall );
 		}
 		
-		DirectX::ScratchImage flippedImage;
+		DirectX::ScratchImage flippedImage = std::move( uncompressedImage );
 #if defined ( PLATFORM_GL )
+		// OpenGL cube map faces start with their top row like they do in Direct3D, and so only the other textures are flipped
+		if ( !flippedImage.GetMetadata().IsCubemap() )
 		{
-			const DWORD flipVertically = DirectX::TEX_FR_FLIP_VERTICAL;
-			const HRESULT result = DirectX::FlipRotate( uncompressedImage.GetImages(), uncompressedImage.GetImageCount(),
-				uncompressedImage.GetMetadata(), flipVertically, flippedImage );
-			if ( FAILED( result ) )
-			{
-				Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to flip the source image vertically", i_path );
-				return false;
-			}
+			FlipVertically( flippedImage );
 		}
-#else
-		flippedImage = std::move( uncompressedImage );
 #endif
 		DirectX::ScratchImage resizedImage;
 		{
@@ -113,9 +677,9 @@ namespace
 			}
 			if ( ( targetWidth != flippedMetadata.width ) || ( targetHeight != flippedMetadata.height ) )
 			{
-				const DWORD useDefaultFiltering = DirectX::TEX_FILTER_DEFAULT;
+				const DWORD useDefaultFilteringWithoutWic = DirectX::TEX_FILTER_DEFAULT | DirectX::TEX_FILTER_FORCE_NON_WIC;
 				const HRESULT result = DirectX::Resize( flippedImage.GetImages(), flippedImage.GetImageCount(),
-					flippedMetadata, targetWidth, targetHeight, useDefaultFiltering, resizedImage );
+					flippedMetadata, targetWidth, targetHeight, useDefaultFilteringWithoutWic, resizedImage );
 			}
 			else
 			{
@@ -123,101 +687,510 @@ namespace
 			}
 		}
 		DirectX::ScratchImage imageWithMipMaps;
+		if ( !resizedImage.GetMetadata().IsVolumemap() )
 		{
+			if ( !GenerateMipMaps( i_path, i_options, resizedImage, imageWithMipMaps ) )
+			{
+				return false;
+			}
+		}
+		else
+		{
+			// Volume textures filter between slices too, which only DirectXTex does
 			const DWORD useDefaultFiltering = DirectX::TEX_FILTER_DEFAULT;
 			const size_t generateAllPossibleLevels = 0;
-			HRESULT result;
-			if ( !resizedImage.GetMetadata().IsVolumemap() )
+			const HRESULT result = DirectX::GenerateMipMaps3D( resizedImage.GetImages(), resizedImage.GetImageCount(),
+				resizedImage.GetMetadata(), useDefaultFiltering, generateAllPossibleLevels, imageWithMipMaps );
+			if ( FAILED( result ) )
 			{
-				result = DirectX::GenerateMipMaps( resizedImage.GetImages(), resizedImage.GetImageCount(),
-					resizedImage.GetMetadata(), useDefaultFiltering, generateAllPossibleLevels, imageWithMipMaps );
+				Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to generate MIP maps", i_path );
+				return false;
 			}
-			else
+		}
+		
+		{
+			const DXGI_FORMAT formatToCompressTo = ChooseFormat( i_options, resizedImage );
+			if ( !CompressTexture( i_path, i_options, imageWithMipMaps, formatToCompressTo, i_options.compressionOptions, o_texture ) )
 			{
-				result = DirectX::GenerateMipMaps3D( resizedImage.GetImages(), resizedImage.GetImageCount(),
-					resizedImage.GetMetadata(), useDefaultFiltering, generateAllPossibleLevels, imageWithMipMaps );
+				return false;
 			}
+		}
+
+		return true;
+	}
+
+	bool GenerateMipMaps( const char *const i_path, const sBuildOptions& i_options, const DirectX::ScratchImage &i_image,
+		DirectX::ScratchImage &o_imageWithMipMaps )
+	{
+		// The MIP levels are filtered as 32 bit floats,
+		// and they are compressed from floats too so that the filtered values aren't quantized twice
+		const DXGI_FORMAT filteringFormat = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		DirectX::ScratchImage convertedImage;
+		if ( i_image.GetMetadata().format != filteringFormat )
+		{
+			const DWORD useDefaultFilteringWithoutWic = DirectX::TEX_FILTER_DEFAULT | DirectX::TEX_FILTER_FORCE_NON_WIC;
+			const HRESULT result = DirectX::Convert( i_image.GetImages(), i_image.GetImageCount(), i_image.GetMetadata(),
+				filteringFormat, useDefaultFilteringWithoutWic, DirectX::TEX_THRESHOLD_DEFAULT, convertedImage );
 			if ( FAILED( result ) )
 			{
-				Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to generate MIP maps", i_path );
+				Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to convert the texture to floats before generating MIP maps", i_path );
 				return false;
 			}
 		}
-		
+		const DirectX::ScratchImage& imageToFilter = ( convertedImage.GetImageCount() > 0 ) ? convertedImage : i_image;
+
+		DirectX::TexMetadata metadata = imageToFilter.GetMetadata();
 		{
-			const DXGI_FORMAT formatToCompressTo = resizedImage.IsAlphaAllOpaque() ? DXGI_FORMAT_BC1_UNORM : DXGI_FORMAT_BC3_UNORM;
-			const DWORD useDefaultCompressionOptions = DirectX::TEX_COMPRESS_DEFAULT;
-			const float useDefaultThreshold = DirectX::TEX_THRESHOLD_DEFAULT;
-			const HRESULT result = DirectX::Compress( imageWithMipMaps.GetImages(), imageWithMipMaps.GetImageCount(),
-				imageWithMipMaps.GetMetadata(), formatToCompressTo, useDefaultCompressionOptions, useDefaultThreshold, o_texture );
-			if ( FAILED( result ) )
+			size_t levelCount = 1;
+			for ( size_t width = metadata.width, height = metadata.height; ( width > 1 ) || ( height > 1 ); ++levelCount )
+			{
+				width = std::max<size_t>( width / 2, 1 );
+				height = std::max<size_t>( height / 2, 1 );
+			}
+			metadata.mipLevels = ( i_options.maxMipLevelCount > 0 ) ? std::min( levelCount, i_options.maxMipLevelCount ) : levelCount;
+		}
+		if ( FAILED( o_imageWithMipMaps.Initialize( metadata ) ) )
+		{
+			Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to allocate the MIP maps", i_path );
+			return false;
+		}
+		Engine::AssetBuild::MipMapGeneration::eContent content;
+		switch ( i_options.usage )
+		{
+			case Usages::NormalMap: content = Engine::AssetBuild::MipMapGeneration::NormalMap; break;
+			case Usages::SingleChannel: content = Engine::AssetBuild::MipMapGeneration::Linear; break;
+			default: content = Engine::AssetBuild::MipMapGeneration::Color; break;
+		}
+		// Only the first level of each array slice (or cube face) is used, and any MIP levels that the source already had are regenerated
+		std::vector<Engine::AssetBuild::MipMapGeneration::sLevel> levels( metadata.mipLevels );
+		for ( size_t item = 0; item < metadata.arraySize; ++item )
+		{
+			const DirectX::Image& sourceImage = *imageToFilter.GetImage( 0, item, 0 );
+			for ( size_t level = 0; level < metadata.mipLevels; ++level )
 			{
+				const DirectX::Image& image = *o_imageWithMipMaps.GetImage( level, item, 0 );
+				levels[level].pixels = reinterpret_cast<float*>( image.pixels );
+				levels[level].width = image.width;
+				levels[level].height = image.height;
+			}
+			memcpy( levels[0].pixels, sourceImage.pixels, sourceImage.slicePitch );
+			Engine::AssetBuild::MipMapGeneration::GenerateMipChain( i_options.mipMapFilter, content, levels.data(), levels.size() );
+		}
+		return true;
+	}
+
+	bool CompressTexture( const char *const i_path, const sBuildOptions& i_options, const DirectX::ScratchImage &i_image, const DXGI_FORMAT i_format,
+		const DWORD i_compressionOptions, DirectX::ScratchImage &o_texture )
+	{
+		// DirectXTex only compresses in parallel with OpenMP,
+		// and so instead every MIP level (and array slice) is split into strips of block rows that are compressed on the tools' own threads.
+		// Every block is encoded on its own (even when dithering), and so the result is identical to compressing each image in one call
+
+		const bool shouldUseBatchedEncoder = ShouldUseBatchedEncoder( i_options, i_format );
+
+		{
+			DirectX::TexMetadata metadata = i_image.GetMetadata();
+			metadata.format = i_format;
+			if ( FAILED( o_texture.Initialize( metadata ) ) || ( o_texture.GetImageCount() != i_image.GetImageCount() ) )
+			{
+				Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to allocate the compressed texture", i_path );
+				return false;
+			}
+		}
+		struct sStrip
+		{
+			size_t imageIndex;
+			size_t firstBlockRow;
+			size_t blockRowCount;
+			HRESULT result;
+		};
+		std::vector<sStrip> strips;
+		{
+			// Strips are big enough that the cost of handing them out doesn't matter, but small enough that every thread gets some
+			const size_t blockCountPerStrip = 1024;
+			const DirectX::Image* const images = i_image.GetImages();
+			for ( size_t i = 0; i < i_image.GetImageCount(); ++i )
+			{
+				const size_t blockCountPerRow = std::max<size_t>( ( images[i].width + 3 ) / 4, 1 );
+				const size_t blockRowCount = ( images[i].height + 3 ) / 4;
+				const size_t blockRowCountPerStrip = std::max<size_t>( blockCountPerStrip / blockCountPerRow, 1 );
+				for ( size_t blockRow = 0; blockRow < blockRowCount; blockRow += blockRowCountPerStrip )
+				{
+					const sStrip strip = { i, blockRow, std::min( blockRowCountPerStrip, blockRowCount - blockRow ), S_OK };
+					strips.push_back( strip );
+				}
+			}
+		}
+		Engine::AssetBuild::ParallelFor( strips.size(),
+			[&]( const size_t i_stripIndex )
+			{
+				sStrip& strip = strips[i_stripIndex];
+				const DirectX::Image& sourceImage = i_image.GetImages()[strip.imageIndex];
+				const DirectX::Image& targetImage = o_texture.GetImages()[strip.imageIndex];
+				DirectX::Image sourceStrip = sourceImage;
+				const size_t firstRow = strip.firstBlockRow * 4;
+				sourceStrip.height = std::min( strip.blockRowCount * 4, sourceImage.height - firstRow );
+				sourceStrip.slicePitch = sourceStrip.rowPitch * sourceStrip.height;
+				sourceStrip.pixels = sourceImage.pixels + ( firstRow * sourceImage.rowPitch );
+				if ( shouldUseBatchedEncoder )
+				{
+					// The batched encoder needs 8 bit RGBA pixels, and each strip is converted on its own thread
+					DirectX::ScratchImage convertedStrip;
+					if ( sourceStrip.format != DXGI_FORMAT_R8G8B8A8_UNORM )
+					{
+						const DWORD useDefaultFilteringWithoutWic = DirectX::TEX_FILTER_DEFAULT | DirectX::TEX_FILTER_FORCE_NON_WIC;
+						strip.result = DirectX::Convert( sourceStrip, DXGI_FORMAT_R8G8B8A8_UNORM, useDefaultFilteringWithoutWic,
+							DirectX::TEX_THRESHOLD_DEFAULT, convertedStrip );
+						if ( FAILED( strip.result ) )
+						{
+							return;
+						}
+						sourceStrip = *convertedStrip.GetImage( 0, 0, 0 );
+					}
+					const Engine::AssetBuild::BlockCompression::eFormat format = ( i_format == DXGI_FORMAT_BC1_UNORM ) ?
+						Engine::AssetBuild::BlockCompression::BC1 : Engine::AssetBuild::BlockCompression::BC3;
+					for ( size_t blockRow = 0; blockRow < strip.blockRowCount; ++blockRow )
+					{
+						const size_t firstRowInStrip = blockRow * 4;
+						Engine::AssetBuild::BlockCompression::EncodeBlockRow( format, i_options.batchedEncoderQuality,
+							sourceStrip.pixels + ( firstRowInStrip * sourceStrip.rowPitch ), sourceStrip.rowPitch,
+							sourceStrip.width, std::min<size_t>( sourceStrip.height - firstRowInStrip, 4 ),
+							targetImage.pixels + ( ( strip.firstBlockRow + blockRow ) * targetImage.rowPitch ) );
+					}
+					return;
+				}
+				DirectX::ScratchImage compressedStrip;
+				const float useDefaultThreshold = DirectX::TEX_THRESHOLD_DEFAULT;
+				strip.result = DirectX::Compress( sourceStrip, i_format, i_compressionOptions, useDefaultThreshold, compressedStrip );
+				if ( SUCCEEDED( strip.result ) )
+				{
+					const DirectX::Image& compressedImage = *compressedStrip.GetImage( 0, 0, 0 );
+					if ( compressedImage.rowPitch == targetImage.rowPitch )
+					{
+						memcpy( targetImage.pixels + ( strip.firstBlockRow * targetImage.rowPitch ), compressedImage.pixels,
+							compressedImage.rowPitch * strip.blockRowCount );
+					}
+					else
+					{
+						strip.result = E_FAIL;
+					}
+				}
+			} );
+		for ( std::vector<sStrip>::const_iterator it = strips.begin(); it != strips.end(); ++it )
+		{
+			if ( FAILED( it->result ) )
+			{
+				o_texture.Release();
 				Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to compress the texture", i_path );
 				return false;
 			}
 		}
-
 		return true;
 	}
 
-	bool LoadSourceImage( const char *const i_path, DirectX::ScratchImage &o_image )
+	void FlipVertically( DirectX::ScratchImage &io_image )
+	{
+		// The image is always uncompressed by now, and so swapping whole rows works for any format
+		for ( size_t i = 0; i < io_image.GetImageCount(); ++i )
+		{
+			const DirectX::Image& image = io_image.GetImages()[i];
+			std::vector<uint8_t> temporaryRow( image.rowPitch );
+			for ( size_t y = 0; y < ( image.height / 2 ); ++y )
+			{
+				uint8_t* const topRow = image.pixels + ( y * image.rowPitch );
+				uint8_t* const bottomRow = image.pixels + ( ( image.height - 1 - y ) * image.rowPitch );
+				memcpy( temporaryRow.data(), topRow, image.rowPitch );
+				memcpy( topRow, bottomRow, image.rowPitch );
+				memcpy( bottomRow, temporaryRow.data(), image.rowPitch );
+			}
+		}
+	}
+
+	bool LoadSourceImage( const char *const i_path, DirectX::ScratchImage &o_image, bool &io_shouldComBeUninitialized )
 	{
 		std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> stringConverter;
 		const std::wstring path( stringConverter.from_bytes( i_path ) );
+		const std::wstring extension = path.substr( path.find_last_of( L'.' ) + 1 );
+		DirectX::TexMetadata* const dontReturnMetadata = NULL;
 
-		HRESULT result = E_UNEXPECTED;
+		if ( extension == L"dds" )
 		{
-			const std::wstring extension = path.substr( path.find_last_of( L'.' ) + 1 );
-			DirectX::TexMetadata* const dontReturnMetadata = NULL;
-			if ( extension == L"dds" )
+			const DWORD useDefaultBehavior = DirectX::DDS_FLAGS_NONE
+				| DirectX::DDS_FLAGS_EXPAND_LUMINANCE
+				;
+			const HRESULT result = DirectX::LoadFromDDSFile( path.c_str(), useDefaultBehavior, dontReturnMetadata, o_image );
+			if ( FAILED( result ) )
 			{
-				const DWORD useDefaultBehavior = DirectX::DDS_FLAGS_NONE
-					| DirectX::DDS_FLAGS_EXPAND_LUMINANCE
-					;
-				result = DirectX::LoadFromDDSFile( path.c_str(), useDefaultBehavior, dontReturnMetadata, o_image );
-				if ( FAILED( result ) )
+				Engine::AssetBuild::OutputErrorMessage( "DirectXTex couldn't load the DDS file", i_path );
+				return false;
+			}
+			return true;
+		}
+
+		// Decoded images are cached by the contents of their source,
+		// and so a source that hasn't changed is only decoded again if the cache has been deleted
+		std::string cacheDirectory;
+		const bool isCacheEnabled = Engine::Platform::GetEnvironmentVariable( Engine::AssetBuild::SourceImageCache::s_directoryEnvironmentVariable, cacheDirectory )
+			&& !cacheDirectory.empty();
+		Engine::AssetBuild::SourceImageCache::sKey cacheKey;
+		Engine::AssetBuild::ImageDecoding::sImage decodedImage;
+		std::string errorMessage_imageDecoding;
+		{
+			Engine::Platform::sDataFromFile sourceFile;
+			{
+				std::string errorMessage;
+				if ( !Engine::Platform::LoadBinaryFile( i_path, sourceFile, &errorMessage ) )
 				{
-					Engine::AssetBuild::OutputErrorMessage( "DirectXTex couldn't load the DDS file", i_path );
+					Engine::AssetBuild::OutputErrorMessage( errorMessage.c_str(), i_path );
+					return false;
 				}
 			}
-			else if ( extension == L"tga" )
+			const uint8_t* const sourceData = reinterpret_cast<const uint8_t*>( sourceFile.data );
+			if ( isCacheEnabled )
 			{
-				result = DirectX::LoadFromTGAFile( path.c_str(), dontReturnMetadata, o_image );
-				if ( FAILED( result ) )
+				cacheKey = Engine::AssetBuild::SourceImageCache::CalculateKey( sourceData, sourceFile.size );
+				if ( Engine::AssetBuild::SourceImageCache::Load( cacheDirectory, cacheKey, decodedImage ) )
 				{
-					Engine::AssetBuild::OutputErrorMessage( "DirectXTex couldn't load the TGA file", i_path );
+					sourceFile.Free();
+					return CopyDecodedImage( i_path, decodedImage, o_image );
 				}
 			}
-			else
+
+			// PNG, JPEG, TGA, and BMP files are decoded without WIC (or COM)
+			const Engine::AssetBuild::ImageDecoding::eFileType fileType = Engine::AssetBuild::ImageDecoding::DetectFileType( sourceData, sourceFile.size, i_path );
+			const bool wasImageDecoded = Engine::AssetBuild::ImageDecoding::Decode( fileType, sourceData, sourceFile.size, decodedImage, &errorMessage_imageDecoding );
+			sourceFile.Free();
+			if ( wasImageDecoded )
 			{
-				const DWORD useDefaultBehavior = DirectX::WIC_FLAGS_NONE
-					| DirectX::WIC_FLAGS_IGNORE_SRGB
-					;
-				result = DirectX::LoadFromWICFile( path.c_str(), useDefaultBehavior, dontReturnMetadata, o_image );
-				if ( FAILED( result ) )
+				if ( isCacheEnabled )
 				{
-					Engine::AssetBuild::OutputErrorMessage( "WIC couldn't load the source image", i_path );
+					// The cache only makes later builds faster, and so failing to save to it isn't an error
+					Engine::AssetBuild::SourceImageCache::Save( cacheDirectory, cacheKey, decodedImage );
 				}
+				return CopyDecodedImage( i_path, decodedImage, o_image );
 			}
 		}
 
-		return SUCCEEDED( result );
+		// Anything else (like a progressive JPEG or a format that isn't decoded in-tree) falls back to DirectXTex and WIC
+		if ( !io_shouldComBeUninitialized )
+		{
+			void* const thisMustBeNull = NULL;
+			if ( FAILED( CoInitialize( thisMustBeNull ) ) )
+			{
+				std::ostringstream errorMessage;
+				errorMessage << "The source image couldn't be decoded (" << errorMessage_imageDecoding
+					<< ") and WIC couldn't be used because COM couldn't be initialized";
+				Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path );
+				return false;
+			}
+			io_shouldComBeUninitialized = true;
+		}
+		HRESULT result;
+		if ( extension == L"tga" )
+		{
+			result = DirectX::LoadFromTGAFile( path.c_str(), dontReturnMetadata, o_image );
+		}
+		else
+		{
+			const DWORD useDefaultBehavior = DirectX::WIC_FLAGS_NONE
+				| DirectX::WIC_FLAGS_IGNORE_SRGB
+				;
+			result = DirectX::LoadFromWICFile( path.c_str(), useDefaultBehavior, dontReturnMetadata, o_image );
+		}
+		if ( FAILED( result ) )
+		{
+			std::ostringstream errorMessage;
+			errorMessage << "The source image couldn't be decoded (" << errorMessage_imageDecoding << ") and "
+				<< ( ( extension == L"tga" ) ? "DirectXTex" : "WIC" ) << " couldn't load it either";
+			Engine::AssetBuild::OutputErrorMessage( errorMessage.str().c_str(), i_path );
+			return false;
+		}
+		if ( isCacheEnabled )
+		{
+			SaveToSourceImageCache( cacheDirectory, cacheKey, o_image );
+		}
+		return true;
 	}
 
-	bool WriteTextureToFile( const char *const i_path, const DirectX::ScratchImage &i_texture )
+	bool CopyDecodedImage( const char *const i_path, const Engine::AssetBuild::ImageDecoding::sImage& i_decodedImage, DirectX::ScratchImage &o_image )
 	{
-		const DWORD useDefaultBehavior = DirectX::DDS_FLAGS_NONE;
-		std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> stringConverter;
-		const HRESULT result = DirectX::SaveToDDSFile( i_texture.GetImages(), i_texture.GetImageCount(), i_texture.GetMetadata(),
-			useDefaultBehavior, stringConverter.from_bytes( i_path ).c_str() );
-		if ( SUCCEEDED( result ) )
+		if ( FAILED( o_image.Initialize2D( DXGI_FORMAT_R8G8B8A8_UNORM, i_decodedImage.width, i_decodedImage.height, 1, 1 ) ) )
 		{
-			return true;
+			Engine::AssetBuild::OutputErrorMessage( "DirectXTex couldn't allocate the source image", i_path );
+			return false;
 		}
-		else
+		const DirectX::Image& image = *o_image.GetImage( 0, 0, 0 );
+		for ( size_t y = 0; y < i_decodedImage.height; ++y )
+		{
+			memcpy( image.pixels + ( y * image.rowPitch ), &i_decodedImage.pixels[y * i_decodedImage.GetRowPitch()], i_decodedImage.GetRowPitch() );
+		}
+		return true;
+	}
+
+	void SaveToSourceImageCache( const std::string& i_cacheDirectory, const Engine::AssetBuild::SourceImageCache::sKey& i_key,
+		const DirectX::ScratchImage &i_image )
+	{
+		// Only images in the same format as the in-tree decoders' are cached
+		// (WIC can return other formats, like 16 bits per channel for some PNGs)
+		const DirectX::TexMetadata& metadata = i_image.GetMetadata();
+		if ( ( metadata.format != DXGI_FORMAT_R8G8B8A8_UNORM ) || ( metadata.dimension != DirectX::TEX_DIMENSION_TEXTURE2D )
+			|| ( i_image.GetImageCount() != 1 ) )
+		{
+			return;
+		}
+		const DirectX::Image& image = *i_image.GetImage( 0, 0, 0 );
+		Engine::AssetBuild::ImageDecoding::sImage decodedImage;
+		decodedImage.width = image.width;
+		decodedImage.height = image.height;
+		decodedImage.pixels.resize( decodedImage.GetSlicePitch() );
+		for ( size_t y = 0; y < image.height; ++y )
+		{
+			const uint8_t* const row = image.pixels + ( y * image.rowPitch );
+			memcpy( &decodedImage.pixels[y * decodedImage.GetRowPitch()], row, decodedImage.GetRowPitch() );
+			for ( size_t x = 0; ( x < image.width ) && !decodedImage.hasAlpha; ++x )
+			{
+				decodedImage.hasAlpha = row[( x * 4 ) + 3] != 0xff;
+			}
+		}
+		Engine::AssetBuild::SourceImageCache::Save( i_cacheDirectory, i_key, decodedImage );
+	}
+
+	bool WriteTextureToFile( const char *const i_path, const DirectX::ScratchImage &i_texture, const uint64_t* const i_contentKey )
+	{
+		// BC1 and BC3 keep the legacy header that every loader understands,
+		// but every other format is written with a DXT10 header so that its exact DXGI format is stored
+		const DirectX::TexMetadata& metadata = i_texture.GetMetadata();
+		const DXGI_FORMAT format = metadata.format;
+		const DWORD flags = ( ( format == DXGI_FORMAT_BC1_UNORM ) || ( format == DXGI_FORMAT_BC3_UNORM ) ) ?
+			DirectX::DDS_FLAGS_NONE : DirectX::DDS_FLAGS_FORCE_DX10_EXT;
+		DirectX::Blob ddsFile;
+		if ( FAILED( DirectX::SaveToDDSMemory( i_texture.GetImages(), i_texture.GetImageCount(), metadata, flags, ddsFile ) ) )
+		{
+			Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to save the built texture", i_path );
+			return false;
+		}
+
+		// The headers are used as they are, but the mip levels are written in the order that the engine streams them in
+		// (see TextureFormat.h)
+		const DirectX::Image* const mipLevels = i_texture.GetImages();
+		const size_t mipLevelCount = i_texture.GetImageCount();
+		size_t headerSize = ddsFile.GetBufferSize();
+		for ( size_t i = 0; i < mipLevelCount; ++i )
+		{
+			headerSize -= mipLevels[i].slicePitch;
+		}
+		std::vector<uint8_t> headers( reinterpret_cast<const uint8_t*>( ddsFile.GetBufferPointer() ),
+			reinterpret_cast<const uint8_t*>( ddsFile.GetBufferPointer() ) + headerSize );
+		// Only a single 2D texture is streamed in
+		// (the images of arrays, cube maps, and volume textures are written in DirectXTex's order, and the engine loads every level at once)
+		const bool canTextureBeStreamed = ( metadata.dimension == DirectX::TEX_DIMENSION_TEXTURE2D ) && ( metadata.arraySize == 1 ) && !metadata.IsCubemap();
+		const uint32_t firstMipTailLevel = canTextureBeStreamed ? Engine::Graphics::GetFirstMipTailLevel(
+			static_cast<uint32_t>( metadata.width ), static_cast<uint32_t>( metadata.height ), static_cast<uint32_t>( mipLevelCount ) ) : 0;
+		if ( firstMipTailLevel > 0 )
+		{
+			Engine::Graphics::sMipTailHeader mipTailHeader;
+			{
+				mipTailHeader.marker = Engine::Graphics::s_mipTailMarker;
+				mipTailHeader.firstMipLevel = firstMipTailLevel;
+				mipTailHeader.byteCount = 0;
+				for ( size_t i = firstMipTailLevel; i < mipLevelCount; ++i )
+				{
+					mipTailHeader.byteCount += static_cast<uint32_t>( mipLevels[i].slicePitch );
+				}
+			}
+			DirectX::DDS_HEADER* const header = reinterpret_cast<DirectX::DDS_HEADER*>( &headers[sizeof( DirectX::DDS_MAGIC )] );
+			memcpy( header->dwReserved1, &mipTailHeader, sizeof( mipTailHeader ) );
+		}
+		if ( i_contentKey )
+		{
+			Engine::Graphics::sContentKeyHeader contentKeyHeader;
+			contentKeyHeader.marker = Engine::Graphics::s_contentKeyMarker;
+			contentKeyHeader.key_low = static_cast<uint32_t>( *i_contentKey );
+			contentKeyHeader.key_high = static_cast<uint32_t>( *i_contentKey >> 32 );
+			DirectX::DDS_HEADER* const header = reinterpret_cast<DirectX::DDS_HEADER*>( &headers[sizeof( DirectX::DDS_MAGIC )] );
+			memcpy( header->dwReserved1 + ( sizeof( Engine::Graphics::sMipTailHeader ) / sizeof( header->dwReserved1[0] ) ),
+				&contentKeyHeader, sizeof( contentKeyHeader ) );
+		}
+
+		std::ofstream textureFile( i_path, std::ofstream::binary );
+		textureFile.write( reinterpret_cast<const char*>( headers.data() ), headers.size() );
+		for ( size_t i = firstMipTailLevel; i < mipLevelCount; ++i )
+		{
+			textureFile.write( reinterpret_cast<const char*>( mipLevels[i].pixels ), mipLevels[i].slicePitch );
+		}
+		for ( size_t i = firstMipTailLevel; i > 0; --i )
+		{
+			textureFile.write( reinterpret_cast<const char*>( mipLevels[i - 1].pixels ), mipLevels[i - 1].slicePitch );
+		}
+		textureFile.close();
+		if ( !textureFile )
 		{
-			Engine::AssetBuild::OutputErrorMessage( "DirectXTex failed to save the built texture to disk", i_path );
+			Engine::AssetBuild::OutputErrorMessage( "The built texture couldn't be written to disk", i_path );
 			return false;
 		}
+		return true;
+	}
+	uint64_t CalculateContentKey( const sBuildOptions& i_options, const DirectX::ScratchImage &i_sourceImage, const uint64_t i_lastWriteTime_builder )
+	{
+		struct sFnv1a
+		{
+			uint64_t hash;
+
+			void Add( const void* const i_data, const size_t i_size )
+			{
+				const uint8_t* const bytes = reinterpret_cast<const uint8_t*>( i_data );
+				for ( size_t i = 0; i < i_size; ++i )
+				{
+					hash ^= bytes[i];
+					hash *= 0x100000001b3;
+				}
+			}
+		} key = { 0xcbf29ce484222325 };
+
+		key.Add( &i_lastWriteTime_builder, sizeof( i_lastWriteTime_builder ) );
+		{
+#if defined( PLATFORM_D3D )
+			const char* const platform = "D3D";
+#elif defined( PLATFORM_GL )
+			const char* const platform = "GL";
+#endif
+			key.Add( platform, strlen( platform ) + 1 );
+		}
+		{
+			// The options are hashed after they have been resolved (the usage can come from the file name, for example),
+			// and only the ones that the chosen format and encoder actually use are included
+			// so that arguments which don't change anything don't change the key either
+			const DXGI_FORMAT format = ChooseFormat( i_options, i_sourceImage );
+			const bool shouldUseBatchedEncoder = ShouldUseBatchedEncoder( i_options, format );
+			const uint64_t options[] = { static_cast<uint64_t>( i_options.usage ), static_cast<uint64_t>( format ),
+				static_cast<uint64_t>( i_options.mipMapFilter ), i_options.maxMipLevelCount, shouldUseBatchedEncoder ? 1u : 0u,
+				shouldUseBatchedEncoder ? static_cast<uint64_t>( i_options.batchedEncoderQuality ) : 0u,
+				shouldUseBatchedEncoder ? 0u : static_cast<uint64_t>( i_options.compressionOptions ) };
+			key.Add( options, sizeof( options ) );
+		}
+		{
+			const DirectX::TexMetadata& metadata = i_sourceImage.GetMetadata();
+			const uint64_t description[] = { metadata.width, metadata.height, metadata.depth, metadata.arraySize, metadata.mipLevels,
+				static_cast<uint64_t>( metadata.format ), static_cast<uint64_t>( metadata.dimension ), metadata.miscFlags };
+			key.Add( description, sizeof( description ) );
+		}
+		for ( size_t i = 0; i < i_sourceImage.GetImageCount(); ++i )
+		{
+			const DirectX::Image& image = i_sourceImage.GetImages()[i];
+			key.Add( image.pixels, image.slicePitch );
+		}
+		return key.hash;
+	}
+
+	std::string GetBuiltTextureCachePath( const std::string& i_cacheDirectory, const uint64_t i_contentKey )
+	{
+		std::ostringstream path;
+		path << i_cacheDirectory;
+		if ( !i_cacheDirectory.empty() && ( i_cacheDirectory.back() != '/' ) && ( i_cacheDirectory.back() != '\\' ) )
+		{
+			path << '/';
+		}
+		path << std::hex << std::setw( 16 ) << std::setfill( '0' ) << i_contentKey << ".dds";
+		return path.str();
 	}
 }
@@ -0,0 +1,105 @@
+#include "cVertexWelder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	const uint32_t s_emptySlot = UINT32_MAX;
+	// The slot count is always a power of 2
+	const size_t s_minimumSlotCount = 64;
+}
+
+Engine::AssetBuild::cVertexWelder::cVertexWelder( const unsigned int i_keySize, const size_t i_expectedVertexCount )
+	:
+	m_vertexCount( 0 ), m_keySize( std::max( i_keySize, 1u ) )
+{
+	size_t slotCount = s_minimumSlotCount;
+	while ( slotCount < ( i_expectedVertexCount * 2 ) )
+	{
+		slotCount *= 2;
+	}
+	m_slots.assign( slotCount, s_emptySlot );
+	m_keys.reserve( i_expectedVertexCount * m_keySize );
+	m_hashes.reserve( i_expectedVertexCount );
+}
+
+uint32_t Engine::AssetBuild::cVertexWelder::Weld( const uint32_t* const i_key, bool* const o_wasNewVertex )
+{
+	// The table is grown before it is more than half full so that probe sequences stay short
+	if ( ( static_cast<size_t>( m_vertexCount ) + 1 ) * 2 > m_slots.size() )
+	{
+		ResizeSlots( m_slots.size() * 2 );
+	}
+
+	const uint32_t hash = CalculateHash( i_key );
+	const size_t slotMask = m_slots.size() - 1;
+	for ( size_t slot = hash & slotMask; ; slot = ( slot + 1 ) & slotMask )
+	{
+		const uint32_t vertexIndex = m_slots[slot];
+		if ( vertexIndex == s_emptySlot )
+		{
+			m_slots[slot] = m_vertexCount;
+			m_keys.insert( m_keys.end(), i_key, i_key + m_keySize );
+			m_hashes.push_back( hash );
+			if ( o_wasNewVertex )
+			{
+				*o_wasNewVertex = true;
+			}
+			return m_vertexCount++;
+		}
+		else if ( ( m_hashes[vertexIndex] == hash ) && ( memcmp( GetKey( vertexIndex ), i_key, m_keySize * sizeof( uint32_t ) ) == 0 ) )
+		{
+			if ( o_wasNewVertex )
+			{
+				*o_wasNewVertex = false;
+			}
+			return vertexIndex;
+		}
+	}
+}
+
+bool Engine::AssetBuild::cVertexWelder::IsKeyLess( const uint32_t i_lhsVertexIndex, const uint32_t i_rhsVertexIndex ) const
+{
+	const uint32_t* const lhs = GetKey( i_lhsVertexIndex );
+	const uint32_t* const rhs = GetKey( i_rhsVertexIndex );
+	return std::lexicographical_compare( lhs, lhs + m_keySize, rhs, rhs + m_keySize );
+}
+
+uint32_t Engine::AssetBuild::cVertexWelder::CalculateHash( const uint32_t* const i_key ) const
+{
+	// Each integer is mixed into the hash with a multiply and a rotate (like MurmurHash3's 32-bit block step),
+	// which spreads out keys whose indices are close together
+	uint32_t hash = m_keySize;
+	for ( unsigned int i = 0; i < m_keySize; ++i )
+	{
+		uint32_t k = i_key[i] * 0xcc9e2d51u;
+		k = ( k << 15 ) | ( k >> 17 );
+		k *= 0x1b873593u;
+		hash ^= k;
+		hash = ( hash << 13 ) | ( hash >> 19 );
+		hash = ( hash * 5 ) + 0xe6546b64u;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+void Engine::AssetBuild::cVertexWelder::ResizeSlots( const size_t i_slotCount )
+{
+	// The stored hashes mean that the keys don't have to be hashed again
+	m_slots.assign( i_slotCount, s_emptySlot );
+	const size_t slotMask = i_slotCount - 1;
+	for ( uint32_t i = 0; i < m_vertexCount; ++i )
+	{
+		size_t slot = m_hashes[i] & slotMask;
+		while ( m_slots[slot] != s_emptySlot )
+		{
+			slot = ( slot + 1 ) & slotMask;
+		}
+		m_slots[slot] = i;
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef VERTEXWELDING_CVERTEXWELDER_H
+#define VERTEXWELDING_CVERTEXWELDER_H
+
+// This library doesn't depend on Maya or on the engine
+// so that the exporter, MeshBuilder, and the benchmark can all use it
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine
+{
+	namespace AssetBuild
+	{
+		// Finds the unique vertices of a mesh by welding together every corner whose key is the same.
+		// A key is a fixed number of integers (e.g. the indices of a corner's position, normal, and texture coordinate),
+		// and the keys are kept in an open-addressing hash table instead of being formatted as strings
+		class cVertexWelder
+		{
+		public:
+			// The expected vertex count is only used to avoid growing the table
+			cVertexWelder( const unsigned int i_keySize, const size_t i_expectedVertexCount = 0 );
+
+			// Returns the index of the unique vertex with the given key
+			// (vertices are numbered in the order that their keys were first welded)
+			uint32_t Weld( const uint32_t* const i_key, bool* const o_wasNewVertex = NULL );
+
+			uint32_t GetVertexCount() const { return m_vertexCount; }
+			unsigned int GetKeySize() const { return m_keySize; }
+			const uint32_t* GetKey( const uint32_t i_vertexIndex ) const { return &m_keys[i_vertexIndex * m_keySize]; }
+			// Orders vertices by their keys (the first integer is the most significant)
+			bool IsKeyLess( const uint32_t i_lhsVertexIndex, const uint32_t i_rhsVertexIndex ) const;
+
+		private:
+			uint32_t CalculateHash( const uint32_t* const i_key ) const;
+			void ResizeSlots( const size_t i_slotCount );
+
+		private:
+			// Every key is stored once (in vertex order) along with its hash
+			std::vector<uint32_t> m_keys;
+			std::vector<uint32_t> m_hashes;
+			// Each slot is either empty or the index of a vertex (which is found by probing linearly from its hash)
+			std::vector<uint32_t> m_slots;
+			uint32_t m_vertexCount;
+			const unsigned int m_keySize;
+		};
+	}
+}
+
+#endif
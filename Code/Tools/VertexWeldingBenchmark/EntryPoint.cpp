@@ -0,0 +1,153 @@
+// Compares welding the corners of a synthetic mesh with cVertexWelder
+// against the string keys and std::map that MayaMeshExporter used to use.
+// Usage: VertexWeldingBenchmark [quadCountPerSide]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../VertexWelding/cVertexWelder.h"
+
+namespace
+{
+	// The same indices that the exporter uses for a corner:
+	// position, normal, tangent, texture coordinate, vertex color, shading group, and DAG node
+	const unsigned int s_keySize = 7;
+
+	void GenerateCorners( const unsigned int i_quadCountPerSide, std::vector<uint32_t>& o_keys );
+	double WeldWithStrings( const std::vector<uint32_t>& i_keys, size_t& o_vertexCount, std::vector<size_t>& o_indices );
+	double WeldWithWelder( const std::vector<uint32_t>& i_keys, size_t& o_vertexCount, std::vector<uint32_t>& o_indices );
+}
+
+int main( int i_argumentCount, char** i_arguments )
+{
+	const unsigned int quadCountPerSide = ( i_argumentCount > 1 ) ? static_cast<unsigned int>( atoi( i_arguments[1] ) ) : 512;
+	if ( quadCountPerSide == 0 )
+	{
+		fprintf( stderr, "The quad count must be a positive number\n" );
+		return EXIT_FAILURE;
+	}
+
+	std::vector<uint32_t> keys;
+	GenerateCorners( quadCountPerSide, keys );
+	const size_t cornerCount = keys.size() / s_keySize;
+	printf( "%u x %u quads: %u corners\n", quadCountPerSide, quadCountPerSide, static_cast<unsigned int>( cornerCount ) );
+
+	size_t vertexCount_strings, vertexCount_welder;
+	std::vector<size_t> indices_strings;
+	std::vector<uint32_t> indices_welder;
+	const double seconds_strings = WeldWithStrings( keys, vertexCount_strings, indices_strings );
+	const double seconds_welder = WeldWithWelder( keys, vertexCount_welder, indices_welder );
+	printf( "std::map<std::string>: %8.2f ms (%u vertices)\n", seconds_strings * 1000.0, static_cast<unsigned int>( vertexCount_strings ) );
+	printf( "cVertexWelder:         %8.2f ms (%u vertices)\n", seconds_welder * 1000.0, static_cast<unsigned int>( vertexCount_welder ) );
+	printf( "Speedup: %.1fx\n", seconds_strings / seconds_welder );
+
+	// Both must weld the same corners together
+	// (the vertex indices themselves are different, because the map numbers vertices in string order)
+	bool doResultsMatch = vertexCount_strings == vertexCount_welder;
+	{
+		std::vector<uint32_t> stringIndicesToWelderIndices( vertexCount_strings, UINT32_MAX );
+		for ( size_t i = 0; doResultsMatch && ( i < cornerCount ); ++i )
+		{
+			uint32_t& welderIndex = stringIndicesToWelderIndices[indices_strings[i]];
+			if ( welderIndex == UINT32_MAX )
+			{
+				welderIndex = indices_welder[i];
+			}
+			doResultsMatch = welderIndex == indices_welder[i];
+		}
+	}
+	if ( !doResultsMatch )
+	{
+		fprintf( stderr, "The welded vertices don't match\n" );
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+namespace
+{
+	void GenerateCorners( const unsigned int i_quadCountPerSide, std::vector<uint32_t>& o_keys )
+	{
+		// A grid of quads (split into triangles) that shares positions and normals between neighbors,
+		// except that every 8th column is a hard edge (and so has its own normals)
+		// and every 16th row is a UV seam (and so has its own texture coordinates)
+		const uint32_t rowLength = i_quadCountPerSide + 1;
+		const uint32_t hardEdgeNormalOffset = rowLength * rowLength;
+		o_keys.reserve( static_cast<size_t>( i_quadCountPerSide ) * i_quadCountPerSide * 6 * s_keySize );
+		for ( uint32_t y = 0; y < i_quadCountPerSide; ++y )
+		{
+			for ( uint32_t x = 0; x < i_quadCountPerSide; ++x )
+			{
+				const uint32_t quadCorners[4][2] = { { x, y }, { x + 1, y }, { x + 1, y + 1 }, { x, y + 1 } };
+				const unsigned int triangleCorners[6] = { 0, 1, 2, 0, 2, 3 };
+				for ( unsigned int i = 0; i < 6; ++i )
+				{
+					const uint32_t* const corner = quadCorners[triangleCorners[i]];
+					const uint32_t position = ( corner[1] * rowLength ) + corner[0];
+					const bool isHardEdge = ( ( x % 8 ) == 7 ) && ( corner[0] == ( x + 1 ) );
+					const bool isSeam = ( ( y % 16 ) == 15 ) && ( corner[1] == ( y + 1 ) );
+					const uint32_t key[s_keySize] =
+					{
+						position,
+						isHardEdge ? ( hardEdgeNormalOffset + position ) : position,
+						isHardEdge ? ( hardEdgeNormalOffset + position ) : position,
+						isSeam ? ( hardEdgeNormalOffset + position ) : position,
+						UINT32_MAX,
+						0,
+						0,
+					};
+					o_keys.insert( o_keys.end(), key, key + s_keySize );
+				}
+			}
+		}
+	}
+
+	double WeldWithStrings( const std::vector<uint32_t>& i_keys, size_t& o_vertexCount, std::vector<size_t>& o_indices )
+	{
+		const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		const size_t cornerCount = i_keys.size() / s_keySize;
+		std::vector<std::string> cornerKeys( cornerCount );
+		std::map<std::string, size_t> uniqueVertices;
+		for ( size_t i = 0; i < cornerCount; ++i )
+		{
+			const uint32_t* const key = &i_keys[i * s_keySize];
+			std::ostringstream vertexKey;
+			vertexKey << static_cast<int>( key[0] ) << "_" << static_cast<int>( key[1] ) << "_" << static_cast<int>( key[2] )
+				<< "_" << static_cast<int>( key[3] ) << "_" << static_cast<int>( key[4] ) << "_" << key[5] << "_" << "pCube" << key[6];
+			cornerKeys[i] = vertexKey.str();
+			uniqueVertices.insert( std::make_pair( cornerKeys[i], 0 ) );
+		}
+		// Vertices were numbered in key order and then every corner looked its key up again
+		size_t vertexIndex = 0;
+		for ( std::map<std::string, size_t>::iterator i = uniqueVertices.begin(); i != uniqueVertices.end(); ++i, ++vertexIndex )
+		{
+			i->second = vertexIndex;
+		}
+		o_indices.resize( cornerCount );
+		for ( size_t i = 0; i < cornerCount; ++i )
+		{
+			o_indices[i] = uniqueVertices.find( cornerKeys[i] )->second;
+		}
+		o_vertexCount = uniqueVertices.size();
+		return std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+	}
+
+	double WeldWithWelder( const std::vector<uint32_t>& i_keys, size_t& o_vertexCount, std::vector<uint32_t>& o_indices )
+	{
+		const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		const size_t cornerCount = i_keys.size() / s_keySize;
+		Engine::AssetBuild::cVertexWelder welder( s_keySize, cornerCount / 4 );
+		o_indices.resize( cornerCount );
+		for ( size_t i = 0; i < cornerCount; ++i )
+		{
+			o_indices[i] = welder.Weld( &i_keys[i * s_keySize] );
+		}
+		o_vertexCount = welder.GetVertexCount();
+		return std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - startTime ).count();
+	}
+}
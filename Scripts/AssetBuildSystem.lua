@@ -23,6 +23,38 @@ do
 	end
 end
 
+-- Textures are compressed with the preset in the "TexturePreset" environment variable
+-- unless AssetsToBuild.lua gives them their own "preset" argument:
+--	"fast" is for quick iteration, "normal" is the default, and "production" is for release builds
+local s_texturePreset
+do
+	local key = "TexturePreset"
+	s_texturePreset = os.getenv( key ) or ""
+	if s_texturePreset == "" then
+		s_texturePreset = "normal"
+	end
+	if ( s_texturePreset ~= "fast" ) and ( s_texturePreset ~= "normal" ) and ( s_texturePreset ~= "production" ) then
+		error( "The environment variable \"" .. key .. "\" must be \"fast\", \"normal\", or \"production\" (instead of \"" .. s_texturePreset .. "\")" )
+	end
+end
+
+-- The command line arguments that every asset was last built with are saved in the built asset directory,
+-- so that an asset is rebuilt when its arguments change (like when a texture's preset is switched)
+-- even if its source hasn't
+local s_path_buildFingerprints = s_BuiltAssetDir .. "BuildFingerprints.lua"
+local s_buildFingerprints = {}
+
+-- Textures and atlases use the default preset unless they have their own
+local function GetTexturePresetArguments( i_arguments )
+	-- An asset with its own preset isn't rebuilt when the default preset changes
+	for i, argument in ipairs( i_arguments ) do
+		if argument:match( "^preset=" ) then
+			return {}
+		end
+	end
+	return { "preset=" .. s_texturePreset }
+end
+
 local cbAssetTypeInfo = {}
 do
 	cbAssetTypeInfo.__index = cbAssetTypeInfo
@@ -51,7 +83,9 @@ end
 
 local registeredAssetsToBuild = {}
 
-local function RegisterAssetToBeBuilt( i_sourceAssetRelativePath, i_assetType, i_optionalCommandLineArguments )
+-- An asset that is only referenced by another asset (like a material's texture) uses the arguments from AssetsToBuild.lua
+-- if it is also listed there, no matter which is registered first
+local function RegisterAssetToBeBuilt( i_sourceAssetRelativePath, i_assetType, i_optionalCommandLineArguments, i_isReference )
 	local assetTypeInfo
 	do
 		if type( i_assetType ) == "string" then
@@ -84,7 +118,7 @@ local function RegisterAssetToBeBuilt( i_sourceAssetRelativePath, i_assetType, i
 		end
 		registrationInfo = registeredAssetsToBuild[uniquePath]
 		if not registrationInfo then
-			registrationInfo = { path = uniquePath, assetTypeInfo = assetTypeInfo, arguments = arguments }
+			registrationInfo = { path = uniquePath, assetTypeInfo = assetTypeInfo, arguments = arguments, isOnlyReferenced = i_isReference }
 			registeredAssetsToBuild[uniquePath] = registrationInfo
 			registeredAssetsToBuild[#registeredAssetsToBuild + 1] = registrationInfo
 			assetTypeInfo.RegisterReferencedAssets( uniquePath )
@@ -93,6 +127,13 @@ local function RegisterAssetToBeBuilt( i_sourceAssetRelativePath, i_assetType, i
 				error( "The source asset \"" .. tostring( i_sourceAssetRelativePath ) .. "\" can't be registered with type \"" .. assetTypeInfo.type
 					.. "\" because it was already registered with type \"" .. registrationInfo.assetTypeInfo.type .. "\"" )
 			end
+			if i_isReference then
+				return
+			elseif registrationInfo.isOnlyReferenced then
+				registrationInfo.arguments = arguments
+				registrationInfo.isOnlyReferenced = false
+				return
+			end
 			if #arguments == #registrationInfo.arguments then
 				for i, argument in ipairs( arguments ) do
 					if arguments[i] ~= registrationInfo.arguments[i] then
@@ -120,7 +161,14 @@ end
 function cbAssetTypeInfo.RegisterReferencedAssets( i_sourceRelativePath )
 end
 
-function cbAssetTypeInfo.ShouldTargetBeBuilt( i_lastWriteTime_builtAsset )
+-- These are passed to the builder before the asset's own arguments (which can override them)
+function cbAssetTypeInfo.GetDefaultArguments( i_arguments )
+	return {}
+end
+
+-- This is only called when the built asset is newer than its source (and its builder and arguments haven't changed),
+-- for assets that are built from other files too
+function cbAssetTypeInfo.ShouldTargetBeBuilt( i_lastWriteTime_builtAsset, i_path_source )
 	return false
 end
 
@@ -131,6 +179,8 @@ NewAssetTypeInfo( "meshes",
         end,
 		ConvertSourceRelativePathToBuiltRelativePath = function( i_sourceRelativePath )
 			i_sourceRelativePath = i_sourceRelativePath:gsub("lua","bin")
+			i_sourceRelativePath = i_sourceRelativePath:gsub("%.obj$",".bin")
+			i_sourceRelativePath = i_sourceRelativePath:gsub("%.mesh$",".bin")
 			return i_sourceRelativePath
 		end,
 	}
@@ -159,8 +209,8 @@ NewAssetTypeInfo( "effects",
 				local effect = dofile( sourceAbsolutePath )
 				local vertexpath = effect.vertexshaderpath
 				local fragmentpath = effect.fragmentshaderpath
-				RegisterAssetToBeBuilt( vertexpath, "shaders", { "vertex" } )
-				RegisterAssetToBeBuilt( fragmentpath, "shaders", { "fragment" } )
+				RegisterAssetToBeBuilt( vertexpath, "shaders", { "vertex" }, true )
+				RegisterAssetToBeBuilt( fragmentpath, "shaders", { "fragment" }, true )
 			end
 		end,
 	}
@@ -178,6 +228,75 @@ NewAssetTypeInfo( "textures",
 			i_sourceRelativePath = i_sourceRelativePath:gsub("tga","dds")
 			return i_sourceRelativePath
 		end,
+		GetDefaultArguments = function( i_arguments )
+			return GetTexturePresetArguments( i_arguments )
+		end,
+	}
+)
+
+-- An atlas is a Lua file that lists images to pack into as few textures as possible (see Assets/Atlases/UI.atlas).
+-- TextureBuilder builds it into a lookup table and a texture for each page
+NewAssetTypeInfo( "atlases",
+	{
+		GetBuilderRelativePath = function ()
+			return "TextureBuilder.exe"
+		end,
+		ConvertSourceRelativePathToBuiltRelativePath = function( i_sourceRelativePath )
+			i_sourceRelativePath = i_sourceRelativePath:gsub( "%.atlas$", ".bin" )
+			return i_sourceRelativePath
+		end,
+		GetDefaultArguments = function( i_arguments )
+			local arguments = GetTexturePresetArguments( i_arguments )
+			table.insert( arguments, 1, "atlas" )
+			return arguments
+		end,
+		ShouldTargetBeBuilt = function( i_lastWriteTime_builtAsset, i_path_source )
+			-- The atlas is rebuilt when any of its images change
+			local result, atlas = pcall( dofile, i_path_source )
+			if not result or ( type( atlas ) ~= "table" ) or ( type( atlas.images ) ~= "table" ) then
+				return true
+			end
+			for i, image in ipairs( atlas.images ) do
+				local path_image = s_AuthoredAssetDir .. tostring( image.path )
+				if ( not DoesFileExist( path_image ) ) or ( GetLastWriteTime( path_image ) > i_lastWriteTime_builtAsset ) then
+					return true
+				end
+			end
+			return false
+		end,
+	}
+)
+
+-- A texture array is a Lua file that lists images to build into the layers of one texture (see Assets/TextureArrays/cement_wall.texarray).
+-- Every layer is compressed to the same format, and so a material or shader can bind all of them at once
+NewAssetTypeInfo( "texturearrays",
+	{
+		GetBuilderRelativePath = function ()
+			return "TextureBuilder.exe"
+		end,
+		ConvertSourceRelativePathToBuiltRelativePath = function( i_sourceRelativePath )
+			i_sourceRelativePath = i_sourceRelativePath:gsub( "%.texarray$", ".dds" )
+			return i_sourceRelativePath
+		end,
+		GetDefaultArguments = function( i_arguments )
+			local arguments = GetTexturePresetArguments( i_arguments )
+			table.insert( arguments, 1, "array" )
+			return arguments
+		end,
+		ShouldTargetBeBuilt = function( i_lastWriteTime_builtAsset, i_path_source )
+			-- The array is rebuilt when any of its layers change
+			local result, textureArray = pcall( dofile, i_path_source )
+			if not result or ( type( textureArray ) ~= "table" ) or ( type( textureArray.layers ) ~= "table" ) then
+				return true
+			end
+			for i, layer in ipairs( textureArray.layers ) do
+				local path_layer = s_AuthoredAssetDir .. tostring( layer )
+				if ( not DoesFileExist( path_layer ) ) or ( GetLastWriteTime( path_layer ) > i_lastWriteTime_builtAsset ) then
+					return true
+				end
+			end
+			return false
+		end,
 	}
 )
 
@@ -196,17 +315,140 @@ NewAssetTypeInfo( "materials",
 				local mater = dofile( sourceAbsolutePath )
 				local effpath = mater.effectpath
 				local texpath = mater.texturepath
-				RegisterAssetToBeBuilt( effpath, "effects", { "effect" } )
-				RegisterAssetToBeBuilt( texpath, "textures", { "texture" } )
+				RegisterAssetToBeBuilt( effpath, "effects", { "effect" }, true )
+				-- A material can use a texture array instead of a single texture
+				if texpath:match( "%.texarray$" ) then
+					RegisterAssetToBeBuilt( texpath, "texturearrays", {}, true )
+				else
+					RegisterAssetToBeBuilt( texpath, "textures", { "texture" }, true )
+				end
 			end
 		end,
 	}
 )
 
+local function LoadBuildFingerprints()
+	s_buildFingerprints = {}
+	if DoesFileExist( s_path_buildFingerprints ) then
+		-- If the file can't be loaded every asset is rebuilt
+		local result, fingerprints = pcall( dofile, s_path_buildFingerprints )
+		if result and ( type( fingerprints ) == "table" ) then
+			s_buildFingerprints = fingerprints
+		end
+	end
+end
+
+local function SaveBuildFingerprints()
+	CreateDirectoryIfNecessary( s_path_buildFingerprints )
+	local file = io.open( s_path_buildFingerprints, "w" )
+	if not file then
+		OutputErrorMessage( "The build fingerprints couldn't be saved", s_path_buildFingerprints )
+		return false
+	end
+	-- The paths are sorted so that the file only changes when a fingerprint does
+	local paths = {}
+	for path in pairs( s_buildFingerprints ) do
+		paths[#paths + 1] = path
+	end
+	table.sort( paths )
+	file:write( "return\n{\n" )
+	for i, path in ipairs( paths ) do
+		file:write( "\t[", string.format( "%q", path ), "] = ", string.format( "%q", s_buildFingerprints[path] ), ",\n" )
+	end
+	file:write( "}\n" )
+	file:close()
+	return true
+end
+
+-- Textures with the same contents are only loaded once at runtime (see TextureFormat.h):
+-- every texture with the same content key as one before it (sorted by path) is written to the alias table
+local s_path_textureAliases = s_BuiltAssetDir .. "TextureAliases.bin"
+-- This must match s_aliasFileVersion in TextureFormat.h
+local s_textureAliasFileVersion = 1
+
+local function ReadTextureContentKey( i_path )
+	local file = io.open( i_path, "rb" )
+	if not file then
+		return nil
+	end
+	-- The content key header is in DDS_HEADER::dwReserved1 after the mip tail header,
+	-- which is 44 bytes from the start of the file (after the DDS magic number and the first 40 bytes of the header)
+	local header = file:read( 56 )
+	file:close()
+	if ( not header ) or ( #header < 56 ) or ( header:sub( 45, 48 ) ~= "TKEY" ) then
+		return nil
+	end
+	return header:sub( 49, 56 )
+end
+
+local function PackUint32( i_value )
+	return string.char( i_value % 256, math.floor( i_value / 0x100 ) % 256, math.floor( i_value / 0x10000 ) % 256, math.floor( i_value / 0x1000000 ) % 256 )
+end
+
+local function SaveTextureAliases()
+	local paths = {}
+	for i, assetInfo in ipairs( registeredAssetsToBuild ) do
+		if assetInfo.assetTypeInfo.type == "textures" then
+			paths[#paths + 1] = assetInfo.assetTypeInfo.ConvertSourceRelativePathToBuiltRelativePath( assetInfo.path )
+		end
+	end
+	table.sort( paths )
+
+	local aliases = {}
+	do
+		local texturePaths = {}
+		for i, path in ipairs( paths ) do
+			-- Textures that failed to build don't have a content key
+			local contentKey = ReadTextureContentKey( s_BuiltAssetDir .. path )
+			if contentKey then
+				local texturePath = texturePaths[contentKey]
+				if texturePath then
+					aliases[#aliases + 1] = { aliasPath = path, texturePath = texturePath }
+				else
+					texturePaths[contentKey] = path
+				end
+			end
+		end
+	end
+
+	-- The paths are the same as the ones in built materials
+	local pathOffsets, pathData, pathByteCount = {}, {}, 0
+	local function GetPathOffset( i_path )
+		local path = "data/" .. i_path
+		if not pathOffsets[path] then
+			pathOffsets[path] = pathByteCount
+			pathData[#pathData + 1] = path .. "\0"
+			pathByteCount = pathByteCount + #path + 1
+		end
+		return pathOffsets[path]
+	end
+	local aliasData = {}
+	for i, alias in ipairs( aliases ) do
+		aliasData[#aliasData + 1] = PackUint32( GetPathOffset( alias.aliasPath ) ) .. PackUint32( GetPathOffset( alias.texturePath ) )
+	end
+
+	CreateDirectoryIfNecessary( s_path_textureAliases )
+	local file = io.open( s_path_textureAliases, "wb" )
+	if not file then
+		OutputErrorMessage( "The texture alias table couldn't be saved", s_path_textureAliases )
+		return false
+	end
+	file:write( "TALS", PackUint32( s_textureAliasFileVersion ), PackUint32( #aliases ), PackUint32( pathByteCount ) )
+	file:write( table.concat( aliasData ), table.concat( pathData ) )
+	file:close()
+	return true
+end
+
 local function BuildAsset( i_assetInfo )
 	local assetTypeInfo = i_assetInfo.assetTypeInfo
 	local path_source = s_AuthoredAssetDir .. i_assetInfo.path
-	local path_target = s_BuiltAssetDir .. assetTypeInfo.ConvertSourceRelativePathToBuiltRelativePath( i_assetInfo.path )
+	local path_target_relative = assetTypeInfo.ConvertSourceRelativePathToBuiltRelativePath( i_assetInfo.path )
+	local path_target = s_BuiltAssetDir .. path_target_relative
+	local arguments = assetTypeInfo.GetDefaultArguments( i_assetInfo.arguments )
+	for i, argument in ipairs( i_assetInfo.arguments ) do
+		arguments[#arguments + 1] = argument
+	end
+	local fingerprint = table.concat( arguments, " " )
 	if not DoesFileExist( path_source ) then
 		OutputErrorMessage( "The source asset doesn't exist", path_source )
 		return false
@@ -238,7 +480,10 @@ local function BuildAsset( i_assetInfo )
 				local lastWriteTime_builder = GetLastWriteTime( path_builder )
 				shouldTargetBeBuilt = lastWriteTime_builder > lastWriteTime_target
 				if not shouldTargetBeBuilt then
-					shouldTargetBeBuilt = assetTypeInfo.ShouldTargetBeBuilt( lastWriteTime_target )
+					shouldTargetBeBuilt = s_buildFingerprints[path_target_relative] ~= fingerprint
+					if not shouldTargetBeBuilt then
+						shouldTargetBeBuilt = assetTypeInfo.ShouldTargetBeBuilt( lastWriteTime_target, path_source )
+					end
 				end
 			end
 		else
@@ -250,15 +495,18 @@ local function BuildAsset( i_assetInfo )
 		CreateDirectoryIfNecessary( path_target )
 		do
 			local command = "\"" .. path_builder .. "\""
-			local arguments = "\"" .. path_source .. "\" \"" .. path_target .. "\""
-			if #i_assetInfo.arguments > 0 then
-				arguments = arguments .. " " .. table.concat( i_assetInfo.arguments, " " )
+			local commandLineArguments = "\"" .. path_source .. "\" \"" .. path_target .. "\""
+			if #arguments > 0 then
+				commandLineArguments = commandLineArguments .. " " .. table.concat( arguments, " " )
 			end
-			local commandLine = command .. " " .. arguments
+			local commandLine = command .. " " .. commandLineArguments
+			-- The fingerprint is only saved again once the asset has been built successfully
+			s_buildFingerprints[path_target_relative] = nil
 			local result, exitCode = ExecuteCommand( commandLine )
 			if result then
 				if exitCode == 0 then
 					print( "Built " .. path_source )
+					s_buildFingerprints[path_target_relative] = fingerprint
 					return true, exitCode
 				else
 					OutputErrorMessage( "The command " .. commandLine .. " failed with exit code " .. tostring( exitCode ), path_source )
@@ -292,6 +540,7 @@ local function BuildAssets( i_path_assetsToBuild, i_stackLevelOfCaller )
 	end
 
 	registeredAssetsToBuild = {}	
+	LoadBuildFingerprints()
 	for assetType, assetsToBuild_specificType in pairs( assetsToBuild ) do
 		local assetTypeInfo = assetTypeInfos[assetType]
 		if assetTypeInfo then
@@ -317,6 +566,12 @@ local function BuildAssets( i_path_assetsToBuild, i_stackLevelOfCaller )
 			wereThereErrors = true
 		end
 	end
+	if not SaveBuildFingerprints() then
+		wereThereErrors = true
+	end
+	if not SaveTextureAliases() then
+		wereThereErrors = true
+	end
 
 	return not wereThereErrors
 end